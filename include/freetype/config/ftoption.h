@@ -155,6 +155,17 @@ FT_BEGIN_HEADER
 /* #define FT_CONFIG_OPTION_NO_ASSEMBLER */
 
 
+  /**************************************************************************
+   *
+   * If this macro is defined, do not use the SIMD versions (SSE2, AVX2,
+   * or NEON) of performance-critical loops (e.g. in the anti-aliasing
+   * rasterizer).  Otherwise, the best version for the CPU is selected at
+   * run time; the results are the same.  As with the option above, you
+   * should only do that for testing or benchmarking.
+   */
+/* #define FT_CONFIG_OPTION_NO_SIMD */
+
+
   /**************************************************************************
    *
    * If this macro is defined, try to use an inlined assembler version of
@@ -386,6 +397,22 @@ FT_BEGIN_HEADER
 #define FT_RENDER_POOL_SIZE  16384L
 
 
+  /**************************************************************************
+   *
+   * The maximum size in bytes of the render pool that the rasterizers
+   * may allocate from the heap.  If the stack-based pool of
+   * FT_RENDER_POOL_SIZE bytes overflows, the anti-aliasing and the
+   * monochrome rasterizer grow a pool geometrically up to this size,
+   * instead of splitting the glyph into ever smaller bands.  The pool is
+   * freed when the glyph is done, so that threads sharing a library
+   * don't share it.
+   *
+   * Define it to 0 to only use the stack-based pool, for example on
+   * embedded systems with tight memory constraints.
+   */
+#define FT_MAX_RENDER_POOL_SIZE  ( 4L * 1024L * 1024L )
+
+
   /**************************************************************************
    *
    * FT_MAX_MODULES
@@ -834,6 +861,88 @@ FT_BEGIN_HEADER
 /* #define PCF_CONFIG_OPTION_LONG_FAMILY_NAMES */
 
 
+  /*************************************************************************/
+  /*************************************************************************/
+  /****                                                                 ****/
+  /****          G F   D R I V E R    C O N F I G U R A T I O N         ****/
+  /****                                                                 ****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * The GF driver only records the stream offset of each glyph when a
+   * face is opened; a glyph's raster is decoded the first time it is
+   * loaded.  If this option is defined, decoded rasters are kept with the
+   * face so that subsequent loads of the same glyph are free.  Undefine it
+   * to trade speed for memory: every load then decodes into a buffer
+   * owned by the glyph slot.
+   */
+#define GF_CONFIG_OPTION_CACHE_BITMAPS
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /****                                                                 ****/
+  /****          P K   D R I V E R    C O N F I G U R A T I O N         ****/
+  /****                                                                 ****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * Like the GF driver, the PK driver only indexes character packets when
+   * a face is opened and unpacks a glyph's raster the first time it is
+   * loaded.  If this option is defined, unpacked rasters are kept with
+   * the face; otherwise every load unpacks into a buffer owned by the
+   * glyph slot.
+   */
+#define PK_CONFIG_OPTION_CACHE_BITMAPS
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /****                                                                 ****/
+  /****          T F M   M O D U L E    C O N F I G U R A T I O N       ****/
+  /****                                                                 ****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * The `tfm' module shares parsed metrics between all GF and PK faces of
+   * a library.  Define this to protect that cache with a lock, so that
+   * TFM files can be attached to faces of the same library from several
+   * threads at once.  This needs a thread library (POSIX threads or
+   * Win32).  Otherwise, calls to `FT_Attach_File' and `FT_Attach_Stream'
+   * for GF and PK faces of one library must be serialized, just like
+   * `FT_New_Face' and `FT_Done_Face'.
+   */
+/* #define TFM_CONFIG_OPTION_CONCURRENT */
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /****                                                                 ****/
+  /****   C A C H E   S U B - S Y S T E M   C O N F I G U R A T I O N   ****/
+  /****                                                                 ****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * Define this to make `FTC_Manager_NewConcurrent' available, which
+   * creates cache managers that can be shared between threads.  This
+   * needs a thread library (POSIX threads or Win32) and compiler support
+   * for atomic operations; ordinary cache managers are not affected.
+   */
+/* #define FTC_CONFIG_OPTION_CONCURRENT */
+
+
   /*************************************************************************/
   /*************************************************************************/
   /****                                                                 ****/
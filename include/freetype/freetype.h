@@ -3357,6 +3357,25 @@ FT_BEGIN_HEADER
    *     8-bit bitmaps that are 3~times the height of the original
    *     glyph outline in pixels and use the @FT_PIXEL_MODE_LCD_V mode.
    *
+   *   FT_RENDER_MODE_SDF ::
+   *     [Since 2.10] This mode produces an 8-bit signed distance field
+   *     in @FT_PIXEL_MODE_GRAY: each pixel holds the distance from its
+   *     center to the outline, 128 on the outline, larger inside, and
+   *     smaller outside, clamped to the `spread' property of the
+   *     `sdf' renderer (see @sdf_renderer), which maps to 0 and 255.
+   *     The bitmap is padded by the spread on all sides.  Scaled and
+   *     thresholded at 128 with bilinear filtering, such a field gives
+   *     smooth glyph edges at many sizes from a single rendering.
+   *
+   *   FT_RENDER_MODE_MSDF ::
+   *     [Since 2.10] This mode produces a multi-channel signed distance
+   *     field in @FT_PIXEL_MODE_BGRA, not premultiplied, with the same
+   *     mapping and padding as @FT_RENDER_MODE_SDF.  The red, green, and
+   *     blue channels hold distances to differently colored edges of the
+   *     outline; their median keeps corners sharp when the field is
+   *     magnified.  The alpha channel holds the true distance, like
+   *     @FT_RENDER_MODE_SDF.
+   *
    * @note:
    *   Should you define FT_CONFIG_OPTION_SUBPIXEL_RENDERING in your
    *   `ftoption.h', which enables patented ClearType-style rendering,
@@ -3378,6 +3397,8 @@ FT_BEGIN_HEADER
     FT_RENDER_MODE_MONO,
     FT_RENDER_MODE_LCD,
     FT_RENDER_MODE_LCD_V,
+    FT_RENDER_MODE_SDF,
+    FT_RENDER_MODE_MSDF,
 
     FT_RENDER_MODE_MAX
 
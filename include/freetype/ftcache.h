@@ -106,28 +106,50 @@ FT_BEGIN_HEADER
    *   FTC_Face_Requester
    *
    *   FTC_Manager_New
+   *   FTC_Manager_NewConcurrent
    *   FTC_Manager_Reset
    *   FTC_Manager_Done
    *   FTC_Manager_LookupFace
    *   FTC_Manager_LookupSize
    *   FTC_Manager_RemoveFaceID
    *
+   *   FTC_EvictionPolicy
+   *   FTC_Manager_SetEvictionPolicy
+   *   FTC_Manager_SetCacheQuota
+   *
    *   FTC_Node
    *   FTC_Node_Unref
    *
    *   FTC_ImageCache
    *   FTC_ImageCache_New
    *   FTC_ImageCache_Lookup
+   *   FTC_ImageCache_LookupBatch
    *
    *   FTC_SBit
    *   FTC_SBitCache
    *   FTC_SBitCache_New
    *   FTC_SBitCache_Lookup
+   *   FTC_SBitCache_LookupBatch
+   *
+   *   FTC_AtlasPage
+   *   FTC_AtlasPageRec
+   *   FTC_AtlasGlyph
+   *   FTC_AtlasGlyphRec
+   *   FTC_AtlasCache
+   *   FTC_AtlasCache_New
+   *   FTC_AtlasCache_Lookup
    *
    *   FTC_CMapCache
    *   FTC_CMapCache_New
+   *   FTC_CMapCache_NewWithBlockSize
    *   FTC_CMapCache_Lookup
    *
+   *   FTC_SBitCache_SaveSnapshot
+   *   FTC_SBitCache_LoadSnapshot
+   *   FTC_CMapCache_SaveSnapshot
+   *   FTC_CMapCache_LoadSnapshot
+   *   FTC_Manager_FreeSnapshot
+   *
    *************************************************************************/
 
 
@@ -322,6 +344,90 @@ FT_BEGIN_HEADER
                    FTC_Manager        *amanager );
 
 
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_NewConcurrent
+   *
+   * @description:
+   *   Create a new cache manager whose caches can be used from several
+   *   threads at the same time.
+   *
+   *   Cached nodes are distributed over a number of independently locked
+   *   shards, each one owning an equal part of `max_bytes'.  Faces and
+   *   sizes needed to create new nodes are borrowed from a pool of
+   *   `max_threads' face sets, each one holding up to `max_faces' faces
+   *   and `max_sizes' sizes, so that a given face can be opened more
+   *   than once.  Calls to the face requester and to @FT_Done_Face are
+   *   serialized.
+   *
+   * @input:
+   *   library ::
+   *     The parent FreeType library handle to use.
+   *
+   *   max_faces ::
+   *     Maximum number of opened @FT_Face objects per face set.  Use~0
+   *     for defaults.
+   *
+   *   max_sizes ::
+   *     Maximum number of opened @FT_Size objects per face set.  Use~0
+   *     for defaults.
+   *
+   *   max_bytes ::
+   *     Maximum number of bytes to use for cached data nodes, in total.
+   *     Use~0 for defaults.
+   *
+   *   max_threads ::
+   *     The number of threads expected to create nodes simultaneously;
+   *     this sets the number of face sets.  Use~0 for defaults.
+   *
+   *   requester ::
+   *     An application-provided callback used to translate
+   *     face IDs into real @FT_Face objects.
+   *
+   *   req_data ::
+   *     A generic pointer that is passed to the requester
+   *     each time it is called (see @FTC_Face_Requester).
+   *
+   * @output:
+   *   amanager ::
+   *     A handle to a new manager object.  0~in case of
+   *     failure.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.  The error
+   *   `Unimplemented_Feature' is returned if the cache sub-system has
+   *   been compiled without `FTC_CONFIG_OPTION_CONCURRENT'.
+   *
+   * @note:
+   *   Caches must be created (with @FTC_ImageCache_New and the like)
+   *   before the manager is used by more than one thread.  Similarly,
+   *   @FTC_Manager_Reset, @FTC_Manager_RemoveFaceID, and
+   *   @FTC_Manager_Done must not be called while lookups are in progress.
+   *
+   *   Cache lookups are thread-safe.  However, data returned by a lookup
+   *   can be evicted by another thread at any time unless the lookup
+   *   also returns a node handle; release it with @FTC_Node_Unref when
+   *   done.
+   *
+   *   @FTC_Manager_LookupFace and @FTC_Manager_LookupSize don't use the
+   *   shared face sets; they return objects owned by the manager itself
+   *   and must not be called by more than one thread at a time.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_NewConcurrent( FT_Library          library,
+                             FT_UInt             max_faces,
+                             FT_UInt             max_sizes,
+                             FT_ULong            max_bytes,
+                             FT_UInt             max_threads,
+                             FTC_Face_Requester  requester,
+                             FT_Pointer          req_data,
+                             FTC_Manager        *amanager );
+
+
   /**************************************************************************
    *
    * @function:
@@ -564,6 +670,120 @@ FT_BEGIN_HEADER
                             FTC_FaceID   face_id );
 
 
+  /**************************************************************************
+   *
+   * @enum:
+   *   FTC_EvictionPolicy
+   *
+   * @description:
+   *   A list of values to select how a cache manager chooses the cached
+   *   data to discard when its byte budget is exhausted.  See
+   *   @FTC_Manager_SetEvictionPolicy.
+   *
+   * @values:
+   *   FTC_EVICTION_LRU ::
+   *     Discard the least recently used nodes first.  This is the
+   *     default.
+   *
+   *   FTC_EVICTION_SLRU ::
+   *     Segmented LRU.  Nodes that have been used only once are discarded
+   *     before nodes that have been used repeatedly, which are kept in a
+   *     protected segment of up to 80% of the budget.  This prevents a
+   *     run of one-off lookups from flushing the whole cache.
+   *
+   *   FTC_EVICTION_TINYLFU ::
+   *     Like @FTC_EVICTION_SLRU, but the manager additionally estimates
+   *     how often data is requested.  A new node is admitted only if it
+   *     is requested more often than the nodes it would displace
+   *     together; for example, a single large bitmap can't flush many
+   *     small, frequently used ones.  A node that is not admitted is
+   *     still returned by the lookup but discarded soon afterwards.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef enum  FTC_EvictionPolicy_
+  {
+    FTC_EVICTION_LRU = 0,
+    FTC_EVICTION_SLRU,
+    FTC_EVICTION_TINYLFU
+
+  } FTC_EvictionPolicy;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_SetEvictionPolicy
+   *
+   * @description:
+   *   Select the eviction policy of a cache manager.
+   *
+   * @input:
+   *   manager ::
+   *     The cache manager handle.
+   *
+   *   policy ::
+   *     The new policy.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Cached data is kept, but all usage history is forgotten.
+   *
+   *   For a manager created with @FTC_Manager_NewConcurrent, this
+   *   function must not be called while lookups are in progress.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_SetEvictionPolicy( FTC_Manager         manager,
+                                 FTC_EvictionPolicy  policy );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_SetCacheQuota
+   *
+   * @description:
+   *   Limit the number of bytes a single cache may use within the budget
+   *   of its manager.
+   *
+   * @input:
+   *   manager ::
+   *     The cache manager handle.
+   *
+   *   cache ::
+   *     A cache created for `manager' with @FTC_ImageCache_New,
+   *     @FTC_SBitCache_New, or @FTC_CMapCache_New.
+   *
+   *   max_bytes ::
+   *     The maximum number of bytes for cached data nodes of `cache'.
+   *     Use~0 to remove the limit.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   When a cache exceeds its quota, its own least recently used nodes
+   *   are discarded, regardless of the eviction policy.  A new quota
+   *   takes effect the next time a node gets added to the cache.
+   *
+   *   For a manager created with @FTC_Manager_NewConcurrent, this
+   *   function must not be called while lookups are in progress.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_SetCacheQuota( FTC_Manager  manager,
+                             FT_Pointer   cache,
+                             FT_ULong     max_bytes );
+
+
   /*************************************************************************
    *
    * @type:
@@ -606,6 +826,52 @@ FT_BEGIN_HEADER
                      FTC_CMapCache  *acache );
 
 
+  /*************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_NewWithBlockSize
+   *
+   * @description:
+   *   Create a new charmap cache with a given number of character codes
+   *   per cache node.
+   *
+   *   A charmap cache maps character codes block-wise.  When a character
+   *   of a block is looked up for the first time, the glyph indices of
+   *   the whole block are retrieved at once.  Larger blocks suit large
+   *   scripts like CJK; they need fewer nodes for the same text and
+   *   avoid repeated charmap searches.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   block_size ::
+   *     The number of consecutive character codes per node, at most
+   *     16384.  Use~0 for the default of 128, as used by
+   *     @FTC_CMapCache_New.
+   *
+   *   max_nodes ::
+   *     The maximum number of nodes the cache may hold (see
+   *     @FTC_Manager_SetCacheQuota).  Use~0 for no limit other than
+   *     the manager's budget.
+   *
+   * @output:
+   *   acache ::
+   *     A new cache handle.  NULL in case of error.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_CMapCache_NewWithBlockSize( FTC_Manager     manager,
+                                  FT_UInt         block_size,
+                                  FT_UInt         max_nodes,
+                                  FTC_CMapCache  *acache );
+
+
   /************************************************************************
    *
    * @function:
@@ -859,6 +1125,74 @@ FT_BEGIN_HEADER
                                FTC_Node       *anode );
 
 
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_ImageCache_LookupBatch
+   *
+   * @description:
+   *   A variant of @FTC_ImageCache_Lookup that retrieves the glyph images
+   *   of a whole run of glyph indices, all with the same image type.
+   *
+   *   The face ID, size, and load flags are resolved once for the whole
+   *   run instead of once per glyph, which makes this function noticeably
+   *   faster than repeated calls to @FTC_ImageCache_Lookup for typical
+   *   text strings.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source glyph image cache.
+   *
+   *   type ::
+   *     A pointer to a glyph image type descriptor.
+   *
+   *   gindices ::
+   *     An array of `count' glyph indices to retrieve.  Indices may
+   *     appear more than once.
+   *
+   *   count ::
+   *     The number of glyph indices.
+   *
+   * @output:
+   *   aglyphs ::
+   *     An array of `count' elements that receives the corresponding
+   *     @FT_Glyph objects, in the order of `gindices'.
+   *
+   *   anodes ::
+   *     If not NULL, an array of `count' elements that receives the
+   *     addresses of the corresponding cache nodes after incrementing
+   *     their reference counts.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The lookup is all-or-nothing: In case of failure, all elements of
+   *   `aglyphs' (and `anodes') are set to NULL, and no reference count is
+   *   changed.
+   *
+   *   You must call @FTC_Node_Unref once for every element of `anodes'
+   *   to release the nodes, even if the same node is returned more than
+   *   once.
+   *
+   *   If `anodes' is NULL, all glyphs of the run are guaranteed to be
+   *   present in the cache when the function returns; however, they
+   *   could be flushed out of the cache on the next call to one of the
+   *   caching sub-system APIs.  In this case, the function temporarily
+   *   allocates an array of `count' pointers.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_ImageCache_LookupBatch( FTC_ImageCache  cache,
+                              FTC_ImageType   type,
+                              const FT_UInt*  gindices,
+                              FT_UInt         count,
+                              FT_Glyph       *aglyphs,
+                              FTC_Node       *anodes );
+
+
   /**************************************************************************
    *
    * @type:
@@ -1091,6 +1425,552 @@ FT_BEGIN_HEADER
                               FTC_SBit      *sbit,
                               FTC_Node      *anode );
 
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_LookupBatch
+   *
+   * @description:
+   *   A variant of @FTC_SBitCache_Lookup that retrieves the small bitmap
+   *   descriptors of a whole run of glyph indices, all with the same
+   *   image type.
+   *
+   *   The face ID, size, and load flags are resolved once for the whole
+   *   run instead of once per glyph.  Additionally, consecutive glyph
+   *   indices that are stored in the same cache node are found without
+   *   another hash table lookup.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source sbit cache.
+   *
+   *   type ::
+   *     A pointer to the glyph image type descriptor.
+   *
+   *   gindices ::
+   *     An array of `count' glyph indices to retrieve.  Indices may
+   *     appear more than once.
+   *
+   *   count ::
+   *     The number of glyph indices.
+   *
+   * @output:
+   *   asbits ::
+   *     An array of `count' elements that receives the corresponding
+   *     sbit descriptor handles, in the order of `gindices'.
+   *
+   *   anodes ::
+   *     If not NULL, an array of `count' elements that receives the
+   *     addresses of the corresponding cache nodes after incrementing
+   *     their reference counts.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The lookup is all-or-nothing: In case of failure, all elements of
+   *   `asbits' (and `anodes') are set to NULL, and no reference count is
+   *   changed.
+   *
+   *   As with @FTC_SBitCache_Lookup, an sbit descriptor might have a
+   *   NULL `buffer' field if the glyph can't be rendered as a small
+   *   bitmap; check each element individually.
+   *
+   *   You must call @FTC_Node_Unref once for every element of `anodes'
+   *   to release the nodes, even if the same node is returned more than
+   *   once.
+   *
+   *   If `anodes' is NULL, the sbits could be flushed out of the cache on
+   *   the next call to one of the caching sub-system APIs.  In this case,
+   *   the function temporarily allocates an array of `count' pointers.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_LookupBatch( FTC_SBitCache   cache,
+                             FTC_ImageType   type,
+                             const FT_UInt*  gindices,
+                             FT_UInt         count,
+                             FTC_SBit       *asbits,
+                             FTC_Node       *anodes );
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                     GLYPH ATLAS CACHE                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_AtlasPage
+   *
+   * @description:
+   *   A handle to a page of a glyph atlas cache.  See the
+   *   @FTC_AtlasPageRec structure for details.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct FTC_AtlasPageRec_*  FTC_AtlasPage;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_AtlasPageRec
+   *
+   * @description:
+   *   A page of a glyph atlas cache, holding many rendered glyphs in a
+   *   single pixel buffer, for example to be uploaded as a texture.
+   *
+   * @fields:
+   *   bitmap ::
+   *     The page's pixels.  The buffer is owned by the cache and never
+   *     changes its address or size during the life time of the cache.
+   *     Its pixel mode is @FT_PIXEL_MODE_GRAY, @FT_PIXEL_MODE_LCD, or
+   *     @FT_PIXEL_MODE_LCD_V, depending on the cache's render mode.
+   *
+   *   generation ::
+   *     A counter that is incremented whenever a glyph is drawn into the
+   *     page.  Compare it with its value at the last upload to find out
+   *     whether the page has changed.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FTC_AtlasPageRec_
+  {
+    FT_Bitmap  bitmap;
+    FT_ULong   generation;
+
+  } FTC_AtlasPageRec;
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_AtlasGlyph
+   *
+   * @description:
+   *   A handle to a glyph of a glyph atlas cache.  See the
+   *   @FTC_AtlasGlyphRec structure for details.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct FTC_AtlasGlyphRec_*  FTC_AtlasGlyph;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_AtlasGlyphRec
+   *
+   * @description:
+   *   Describes where a rendered glyph is stored in a glyph atlas cache.
+   *
+   * @fields:
+   *   page ::
+   *     The page holding the glyph bitmap.  NULL if the glyph has no
+   *     bitmap (for example, a space), if it is larger than a page, or
+   *     if its embedded bitmap has a pixel mode that can't be stored in
+   *     the page.
+   *
+   *   x ::
+   *     The horizontal offset of the glyph bitmap in the page, in bytes.
+   *
+   *   y ::
+   *     The vertical offset of the glyph bitmap in the page, in rows.
+   *
+   *   width ::
+   *     The width of the glyph bitmap in bytes, as in @FT_Bitmap.  For
+   *     LCD pages, this is three times the width in pixels.
+   *
+   *   rows ::
+   *     The height of the glyph bitmap in rows, as in @FT_Bitmap.  For
+   *     vertical LCD pages, this is three times the height in pixels.
+   *
+   *   left ::
+   *     The horizontal distance from the pen position to the left
+   *     bitmap border.
+   *
+   *   top ::
+   *     The vertical distance from the pen position (on the baseline) to
+   *     the upper bitmap border.  The distance is positive for upwards
+   *     y~coordinates.
+   *
+   *   xadvance ::
+   *     The horizontal advance width in pixels.
+   *
+   *   yadvance ::
+   *     The vertical advance height in pixels.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FTC_AtlasGlyphRec_
+  {
+    FTC_AtlasPage  page;
+
+    FT_UShort      x;
+    FT_UShort      y;
+    FT_UShort      width;
+    FT_UShort      rows;
+
+    FT_Short       left;
+    FT_Short       top;
+    FT_Short       xadvance;
+    FT_Short       yadvance;
+
+  } FTC_AtlasGlyphRec;
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_AtlasCache
+   *
+   * @description:
+   *   A handle to a glyph atlas cache.  Unlike @FTC_SBitCache, which
+   *   allocates a buffer for every glyph bitmap, an atlas cache renders
+   *   glyphs directly into a few large pages, ready to be uploaded as
+   *   textures.
+   *
+   *   Each page is divided into horizontal shelves of glyphs with similar
+   *   heights.  The space of flushed glyphs is reused a whole shelf at a
+   *   time; if all pages are full, the least recently used page is
+   *   emptied completely (except for locked glyphs).  Glyphs are
+   *   separated by one pixel of padding to avoid bleeding when the pages
+   *   are sampled.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct FTC_AtlasCacheRec_*  FTC_AtlasCache;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_AtlasCache_New
+   *
+   * @description:
+   *   Create a new glyph atlas cache.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the source cache manager.
+   *
+   *   page_width ::
+   *     The width of the atlas pages in bytes (at most 65535).  For
+   *     @FT_RENDER_MODE_LCD, use three times the width in pixels.
+   *
+   *   page_rows ::
+   *     The height of the atlas pages in rows (at most 65535).  For
+   *     @FT_RENDER_MODE_LCD_V, use three times the height in pixels.
+   *
+   *   max_pages ::
+   *     The maximum number of pages.  Use~0 for a default of four pages.
+   *     Pages are allocated when needed.
+   *
+   *   render_mode ::
+   *     The render mode for all glyphs of the cache.  Only
+   *     @FT_RENDER_MODE_NORMAL, @FT_RENDER_MODE_LIGHT,
+   *     @FT_RENDER_MODE_LCD, and @FT_RENDER_MODE_LCD_V are supported.
+   *
+   * @output:
+   *   acache ::
+   *     A handle to the new atlas cache.  NULL in case of error.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The pages themselves are not counted in the manager's byte
+   *   budget; only the area taken by the cached glyphs is.
+   *
+   *   In a manager created with @FTC_Manager_NewConcurrent, every shard
+   *   holds its own pages; `max_pages' is split between them, but each
+   *   shard gets at least one page.  Other threads may draw new glyphs
+   *   into a page at any time, so upload pages only while no lookups
+   *   are running.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_AtlasCache_New( FTC_Manager      manager,
+                      FT_UInt          page_width,
+                      FT_UInt          page_rows,
+                      FT_UInt          max_pages,
+                      FT_Render_Mode   render_mode,
+                      FTC_AtlasCache  *acache );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_AtlasCache_Lookup
+   *
+   * @description:
+   *   Look up a glyph in a glyph atlas cache, rendering it into one of
+   *   the pages if necessary, and `lock' it to prevent its flushing from
+   *   the cache until needed.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source atlas cache.
+   *
+   *   type ::
+   *     A pointer to the glyph image type descriptor.  The
+   *     @FT_LOAD_RENDER flag is ignored; the glyph is always rendered
+   *     with the render mode of the cache.
+   *
+   *   gindex ::
+   *     The glyph index.
+   *
+   * @output:
+   *   aglyph ::
+   *     A handle to the glyph's atlas descriptor.
+   *
+   *   anode ::
+   *     Used to return the address of the corresponding cache node after
+   *     incrementing its reference count (see note below).
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   If `anode' is _not_ NULL, it receives the address of the cache
+   *   node containing the glyph, after increasing its reference count.
+   *   This ensures that the glyph's descriptor and its place in the page
+   *   are kept until you call @FTC_Node_Unref to `release' it.
+   *
+   *   If `anode' is NULL, the glyph could be flushed out of the cache on
+   *   the next call to one of the caching sub-system APIs, and its place
+   *   in the page could be taken by another glyph.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_AtlasCache_Lookup( FTC_AtlasCache   cache,
+                         FTC_ImageType    type,
+                         FT_UInt          gindex,
+                         FTC_AtlasGlyph  *aglyph,
+                         FTC_Node        *anode );
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                       CACHE SNAPSHOTS                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_SaveSnapshot
+   *
+   * @description:
+   *   Dump all small bitmaps currently held by an sbit cache into a
+   *   memory buffer, so that another process can preload them with
+   *   @FTC_SBitCache_LoadSnapshot instead of rendering the glyphs again.
+   *
+   *   The buffer contains no pointers; it can be written to a file as-is
+   *   and later be mapped into memory for loading.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source sbit cache.
+   *
+   * @output:
+   *   abuffer ::
+   *     The snapshot.  Release it with @FTC_Manager_FreeSnapshot.
+   *
+   *   asize ::
+   *     The size of the snapshot in bytes.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Face IDs can't be stored in a file.  Instead, a snapshot identifies
+   *   every face referenced by the cache through a hash of its whole font
+   *   file, which gets read for this purpose.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_SaveSnapshot( FTC_SBitCache   cache,
+                              FT_Byte*       *abuffer,
+                              FT_ULong       *asize );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_LoadSnapshot
+   *
+   * @description:
+   *   Preload an sbit cache with the small bitmaps of a snapshot created
+   *   by @FTC_SBitCache_SaveSnapshot.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the target sbit cache.
+   *
+   *   buffer ::
+   *     The snapshot.  It is only read and needn't stay around after the
+   *     call.
+   *
+   *   size ::
+   *     The size of the snapshot in bytes.
+   *
+   *   face_ids ::
+   *     An array of face IDs known to the cache manager.  Each face of
+   *     the snapshot is matched against these by the contents of its font
+   *     file.
+   *
+   *   num_face_ids ::
+   *     The number of elements in `face_ids'.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Bitmaps of faces that match none of `face_ids', for example
+   *   because the font file has changed, are silently skipped.  So are
+   *   bitmaps that are already in the cache.
+   *
+   *   The snapshot is checked for consistency, but a corrupt one can
+   *   still add wrong bitmaps to the cache.  Only load snapshots from
+   *   trusted sources.
+   *
+   *   All font files of `face_ids' are read completely to compute their
+   *   hashes.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_LoadSnapshot( FTC_SBitCache      cache,
+                              const FT_Byte*     buffer,
+                              FT_ULong           size,
+                              const FTC_FaceID*  face_ids,
+                              FT_UInt            num_face_ids );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_SaveSnapshot
+   *
+   * @description:
+   *   Dump all character code mappings currently held by a charmap cache
+   *   into a memory buffer.  See @FTC_SBitCache_SaveSnapshot for details.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source charmap cache.
+   *
+   * @output:
+   *   abuffer ::
+   *     The snapshot.  Release it with @FTC_Manager_FreeSnapshot.
+   *
+   *   asize ::
+   *     The size of the snapshot in bytes.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_CMapCache_SaveSnapshot( FTC_CMapCache   cache,
+                              FT_Byte*       *abuffer,
+                              FT_ULong       *asize );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_LoadSnapshot
+   *
+   * @description:
+   *   Preload a charmap cache with the mappings of a snapshot created by
+   *   @FTC_CMapCache_SaveSnapshot.  See @FTC_SBitCache_LoadSnapshot for
+   *   details.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the target charmap cache.
+   *
+   *   buffer ::
+   *     The snapshot.
+   *
+   *   size ::
+   *     The size of the snapshot in bytes.
+   *
+   *   face_ids ::
+   *     An array of face IDs known to the cache manager.
+   *
+   *   num_face_ids ::
+   *     The number of elements in `face_ids'.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_CMapCache_LoadSnapshot( FTC_CMapCache      cache,
+                              const FT_Byte*     buffer,
+                              FT_ULong           size,
+                              const FTC_FaceID*  face_ids,
+                              FT_UInt            num_face_ids );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_FreeSnapshot
+   *
+   * @description:
+   *   Release a snapshot returned by @FTC_SBitCache_SaveSnapshot or
+   *   @FTC_CMapCache_SaveSnapshot.
+   *
+   * @input:
+   *   manager ::
+   *     The manager of the cache the snapshot was taken from.
+   *
+   *   buffer ::
+   *     The snapshot.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( void )
+  FTC_Manager_FreeSnapshot( FTC_Manager  manager,
+                            FT_Byte*     buffer );
+
   /* */
 
 
@@ -81,6 +81,8 @@
    *   t1_cid_driver
    *   tt_driver
    *   pcf_driver
+   *   smooth_renderer
+   *   sdf_renderer
    *   properties
    *   parameter_tags
    *   lcd_rendering
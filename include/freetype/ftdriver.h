@@ -169,6 +169,55 @@ FT_BEGIN_HEADER
    */
 
 
+  /**************************************************************************
+   *
+   * @section:
+   *   smooth_renderer
+   *
+   * @title:
+   *   The smooth renderer
+   *
+   * @abstract:
+   *   Controlling the anti-aliasing renderer modules.
+   *
+   * @description:
+   *   While FreeType's anti-aliasing renderers don't expose API functions
+   *   by themselves, it is possible to control their behaviour with
+   *   @FT_Property_Set and @FT_Property_Get.
+   *
+   *   The renderers' module names are `smooth' (for gray-level bitmaps),
+   *   `smooth-lcd', and `smooth-lcdv'; each of them has its own set of
+   *   properties.
+   *
+   *   The properties @accumulation-threshold and @band-executor are
+   *   available, as documented in the @properties section.
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @section:
+   *   sdf_renderer
+   *
+   * @title:
+   *   The SDF renderer
+   *
+   * @abstract:
+   *   Controlling the signed distance field renderer module.
+   *
+   * @description:
+   *   The signed distance field renderer produces the bitmaps of
+   *   @FT_RENDER_MODE_SDF and @FT_RENDER_MODE_MSDF.  Its module name is
+   *   `sdf'; it can be controlled with @FT_Property_Set and
+   *   @FT_Property_Get.
+   *
+   *   The property @spread is available, as documented in the
+   *   @properties section.
+   *
+   */
+
+
   /**************************************************************************
    *
    * @section:
@@ -219,8 +268,8 @@ FT_BEGIN_HEADER
    *
    *   The TrueType driver's module name is `truetype'.
    *
-   *   A single property @interpreter-version is available, as documented in
-   *   the @properties section.
+   *   The properties @interpreter-version and @hinted-outline-cache are
+   *   available, as documented in the @properties section.
    *
    *   We start with a list of definitions, kindly provided by Greg
    *   Hitchcock.
@@ -810,6 +859,48 @@ FT_BEGIN_HEADER
    */
 
 
+  /**************************************************************************
+   *
+   * @property:
+   *   hinted-outline-cache
+   *
+   * @description:
+   *   The maximum amount of memory, in bytes, that the TrueType driver
+   *   uses per size object to cache the hinted outlines of simple glyphs.
+   *   Loading a cached glyph again with the same size and rendering mode
+   *   (for example, after an application's glyph cache has evicted the
+   *   rendered bitmap) doesn't run its bytecode instructions.  The default
+   *   value of~0 disables the cache.  A glyph with 50~points needs about
+   *   1KByte on 64-bit platforms.
+   *
+   *   Glyph programs that read values from the storage area, the CVT, or
+   *   the twilight zone that other glyph programs have changed are not
+   *   cached, and such changes remove the cached outlines that depend on
+   *   the old values.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES' environment
+   *   variable.
+   *
+   * @example:
+   *   {
+   *     FT_Library  library;
+   *     FT_ULong    size = 64 * 1024;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "hinted-outline-cache", &size );
+   *   }
+   *
+   * @since:
+   *   2.10
+   */
+
+
   /**************************************************************************
    *
    * @property:
@@ -1223,6 +1314,268 @@ FT_BEGIN_HEADER
    */
 
 
+  /**************************************************************************
+   *
+   * @property:
+   *   accumulation-threshold
+   *
+   * @description:
+   *   The smooth renderers normally sort the cells crossed by the outline
+   *   into a list per scanline.  Alternatively, they can accumulate the
+   *   coverage in a dense buffer as wide as the glyph bitmap (see
+   *   @FT_RASTER_FLAG_ACCUMULATE), which avoids the list insertions but
+   *   needs more memory.  This property gives the maximum bitmap height
+   *   in pixels for which the latter is used; the default is~64.  If the
+   *   value is set to~0, the cell lists are always used.  The rendered
+   *   bitmaps are the same either way.
+   *
+   *   The dense buffer is faster only for small glyphs; for bitmaps taller
+   *   than a few hundred pixels it no longer fits into the processor cache
+   *   and has to be filled in several bands, each decomposing the outline
+   *   again, so that the cell lists win.  The break-even point is at a
+   *   bitmap height of about 100 pixels.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES' environment
+   *   variable.
+   *
+   * @example:
+   *   {
+   *     FT_Library  library;
+   *     FT_UInt     threshold = 0;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "smooth",
+   *                               "accumulation-threshold", &threshold );
+   *   }
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   band-executor
+   *
+   * @description:
+   *   The smooth renderers render a glyph in horizontal bands, one after
+   *   the other.  For very large glyphs, the bands can instead be rendered
+   *   concurrently, each with its own memory pool, by an executor that the
+   *   application supplies (for example, on top of its thread pool); see
+   *   @FT_Prop_BandExecutor.  The rendered bitmaps are the same either
+   *   way.
+   *
+   *   Bands are only rendered concurrently into a target bitmap, not in
+   *   direct mode; vertical LCD bitmaps whose filter is applied while
+   *   rendering are always rendered sequentially.  By default, there is no
+   *   executor.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   The executor is called from within @FT_Render_Glyph (and similar
+   *   functions) and must not return before all bands are rendered.  The
+   *   band function allocates memory with the library's memory manager,
+   *   which must therefore be thread-safe; the default one is.
+   *
+   * @example:
+   *   {
+   *     FT_Library            library;
+   *     FT_Prop_BandExecutor  executor;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     executor.execute   = my_run_in_parallel;
+   *     executor.data      = my_thread_pool;
+   *     executor.max_bands = 8;
+   *     executor.threshold = 1000;
+   *
+   *     FT_Property_Set( library, "smooth", "band-executor", &executor );
+   *   }
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   coverage-table
+   *
+   * @description:
+   *   A table of 256 bytes that the smooth renderers use to map each
+   *   coverage value to the gray level they output, for example to apply
+   *   gamma or contrast correction.  The mapping is done while rendering,
+   *   so that no extra pass over the bitmap is necessary; it applies to
+   *   the spans of @FT_Outline_Render in direct mode and to surfaces also.
+   *   In LCD modes, the filtered values are mapped.
+   *
+   *   The first entry must be~0, since pixels that the outline doesn't
+   *   touch are left alone; @FT_Property_Set returns
+   *   `FT_Err_Invalid_Argument' otherwise.  By default, the table is the
+   *   identity, which disables the mapping.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also, which copies
+   *   the current table to the array it is given.
+   *
+   *   The table is stored per renderer: it must be set for `smooth',
+   *   `smooth-lcd', and `smooth-lcdv' separately.
+   *
+   * @example:
+   *   {
+   *     FT_Library  library;
+   *     FT_Byte     table[256];
+   *     int         i;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     for ( i = 0; i < 256; i++ )
+   *       table[i] = (FT_Byte)( pow( i / 255.0, 1 / 1.8 ) * 255 + 0.5 );
+   *
+   *     FT_Property_Set( library, "smooth", "coverage-table", table );
+   *   }
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   spread
+   *
+   * @description:
+   *   The largest distance, in pixels, that the `sdf' renderer represents
+   *   in a distance field: the values 0 and 255 stand for this distance
+   *   outside and inside the outline, respectively, and the bitmap is
+   *   padded by as many pixels on all sides.  A larger spread allows wider
+   *   effects like outlines and shadows but lowers the precision of the
+   *   field.  The value, an `FT_UInt', must be between 2 and~32;
+   *   otherwise, @FT_Property_Set returns `FT_Err_Invalid_Argument'.  The
+   *   default is~8.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES' environment
+   *   variable (using values 2 to~32).
+   *
+   * @example:
+   *   {
+   *     FT_Library  library;
+   *     FT_UInt     spread = 4;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "sdf", "spread", &spread );
+   *   }
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FT_Prop_BandFunc
+   *
+   * @description:
+   *   A function, supplied by the smooth renderer, that renders a single
+   *   band of a glyph.
+   *
+   * @input:
+   *   band_data ::
+   *     The `band_data' argument passed to @FT_Prop_ExecuteFunc.
+   *
+   *   band_index ::
+   *     The index of the band to render.
+   */
+  typedef void
+  (*FT_Prop_BandFunc)( void*    band_data,
+                       FT_UInt  band_index );
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FT_Prop_ExecuteFunc
+   *
+   * @description:
+   *   A function, supplied by the application, that calls `band_func' once
+   *   for each band index from~0 to `num_bands'-1, possibly concurrently
+   *   and in any order, and returns when all calls have returned.
+   *
+   * @input:
+   *   executor_data ::
+   *     The `data' field of @FT_Prop_BandExecutor.
+   *
+   *   band_func ::
+   *     The function rendering a band.
+   *
+   *   band_data ::
+   *     The first argument to `band_func'.
+   *
+   *   num_bands ::
+   *     The number of bands.
+   */
+  typedef void
+  (*FT_Prop_ExecuteFunc)( void*             executor_data,
+                          FT_Prop_BandFunc  band_func,
+                          void*             band_data,
+                          FT_UInt           num_bands );
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Prop_BandExecutor
+   *
+   * @description:
+   *   The data exchange structure for the @band-executor property.
+   *
+   * @fields:
+   *   execute ::
+   *     The executor function.  If NULL, bands are rendered sequentially.
+   *
+   *   data ::
+   *     The first argument to `execute'.
+   *
+   *   max_bands ::
+   *     The maximum number of bands a glyph is split into, typically the
+   *     number of available threads.  Values less than~2 disable
+   *     concurrent rendering.
+   *
+   *   threshold ::
+   *     The minimum height in pixels of the rendered part of a glyph for
+   *     concurrent rendering.
+   */
+  typedef struct  FT_Prop_BandExecutor_
+  {
+    FT_Prop_ExecuteFunc  execute;
+    void*                data;
+    FT_UInt              max_bands;
+    FT_UInt              threshold;
+
+  } FT_Prop_BandExecutor;
+
+
  /* */
 
 
@@ -984,11 +984,46 @@ FT_BEGIN_HEADER
    *     is clipped to the target pixmap, except
    *     in direct rendering mode where all spans
    *     are generated if no clipping box is set.
+   *
+   *   FT_RASTER_FLAG_ACCUMULATE ::
+   *     [Since 2.10] This flag is only used in
+   *     anti-aliased rendering mode.  If set,
+   *     the smooth raster accumulates the
+   *     coverage of the outline in a dense
+   *     buffer spanning the clipping box instead
+   *     of sorted cell lists.  This is usually
+   *     faster for small glyphs; the rendered
+   *     pixels are the same.  Rasters that don't
+   *     support it ignore the flag.
+   *
+   *   FT_RASTER_FLAG_SURFACE ::
+   *     [Since 2.10] This flag is only used in
+   *     anti-aliased rendering mode.  If set,
+   *     the `user' field must point to an
+   *     @FT_Raster_Surface, and the coverage is
+   *     blended right into it; `target',
+   *     `gray_spans', and `clip_box' are
+   *     ignored.  Not supported by the
+   *     monochrome rasterizer.
+   *
+   *   FT_RASTER_FLAG_SDF ::
+   *     [Since 2.10] This flag selects the signed
+   *     distance field rasterizer of the `sdf'
+   *     module.  The target must be an
+   *     @FT_PIXEL_MODE_GRAY bitmap for a single
+   *     field, or an @FT_PIXEL_MODE_BGRA bitmap
+   *     for a multi-channel one; see
+   *     @FT_RENDER_MODE_SDF and
+   *     @FT_RENDER_MODE_MSDF.  The other
+   *     rasterizers reject it.
    */
-#define FT_RASTER_FLAG_DEFAULT  0x0
-#define FT_RASTER_FLAG_AA       0x1
-#define FT_RASTER_FLAG_DIRECT   0x2
-#define FT_RASTER_FLAG_CLIP     0x4
+#define FT_RASTER_FLAG_DEFAULT     0x0
+#define FT_RASTER_FLAG_AA          0x1
+#define FT_RASTER_FLAG_DIRECT      0x2
+#define FT_RASTER_FLAG_CLIP        0x4
+#define FT_RASTER_FLAG_ACCUMULATE  0x8
+#define FT_RASTER_FLAG_SURFACE     0x10
+#define FT_RASTER_FLAG_SDF         0x20
 
   /* these constants are deprecated; use the corresponding */
   /* `FT_RASTER_FLAG_XXX' values instead                   */
@@ -998,6 +1033,107 @@ FT_BEGIN_HEADER
 #define ft_raster_flag_clip     FT_RASTER_FLAG_CLIP
 
 
+  /**************************************************************************
+   *
+   * @enum:
+   *   FT_Surface_Format
+   *
+   * @description:
+   *   The pixel formats of an @FT_Raster_Surface.
+   *
+   * @values:
+   *   FT_SURFACE_FORMAT_A8 ::
+   *     One alpha byte per pixel.  The coverage is composited over the
+   *     existing pixels.
+   *
+   *   FT_SURFACE_FORMAT_R8 ::
+   *     One byte per pixel, as in a glyph atlas.  The coverage replaces
+   *     the existing pixels.
+   *
+   *   FT_SURFACE_FORMAT_BGRA ::
+   *     Four bytes per pixel in blue, green, red, alpha order, with
+   *     premultiplied alpha.  The surface's solid color, scaled by the
+   *     coverage, is composited over the existing pixels.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef enum  FT_Surface_Format_
+  {
+    FT_SURFACE_FORMAT_A8 = 0,
+    FT_SURFACE_FORMAT_R8,
+    FT_SURFACE_FORMAT_BGRA
+
+  } FT_Surface_Format;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Raster_Surface
+   *
+   * @description:
+   *   A caller-owned pixel buffer to render into with
+   *   @FT_RASTER_FLAG_SURFACE.
+   *
+   * @fields:
+   *   buffer ::
+   *     A pointer to the top row of the surface.
+   *
+   *   width ::
+   *     The number of pixels in a row.
+   *
+   *   rows ::
+   *     The number of rows.
+   *
+   *   pitch ::
+   *     The number of bytes from one row to the next one below; it can
+   *     be negative.
+   *
+   *   format ::
+   *     The pixel format, an @FT_Surface_Format value.
+   *
+   *   clip_box ::
+   *     The part of the surface to draw into, in pixels, with `yMin'
+   *     being the topmost row; `xMax' and `yMax' are exclusive.  It is
+   *     intersected with the surface size.
+   *
+   *   x_offset ::
+   *     The column of the surface that corresponds to the outline's
+   *     x~origin.
+   *
+   *   y_offset ::
+   *     The row of the surface right below the outline's y~origin;
+   *     outline row~0 is drawn into surface row `y_offset-1'.
+   *
+   *   color ::
+   *     The premultiplied blue, green, red, and alpha components of the
+   *     color used for @FT_SURFACE_FORMAT_BGRA.
+   *
+   * @note:
+   *   Rendering into a surface avoids the allocation of an intermediate
+   *   bitmap and the copy of its pixels.  The outline coordinates must
+   *   stay within the range of the `x' field of @FT_Span after the
+   *   offset is removed.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Raster_Surface_
+  {
+    unsigned char*  buffer;
+    unsigned int    width;
+    unsigned int    rows;
+    int             pitch;
+    int             format;
+    FT_BBox         clip_box;
+    int             x_offset;
+    int             y_offset;
+    unsigned char   color[4];
+
+  } FT_Raster_Surface;
+
+
   /**************************************************************************
    *
    * @struct:
@@ -1050,6 +1186,10 @@ FT_BEGIN_HEADER
    *   spans.  This allows direct composition over a pre-existing bitmap
    *   through user-provided callbacks to perform the span drawing and
    *   composition.    Not supported by the monochrome rasterizer.
+   *
+   *   If the @FT_RASTER_FLAG_SURFACE bit flag is set in `flags', the
+   *   raster blends the pixels into the @FT_Raster_Surface given in the
+   *   `user' field instead.
    */
   typedef struct  FT_Raster_Params_
   {
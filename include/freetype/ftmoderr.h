@@ -162,6 +162,7 @@
   FT_MODERRDEF( Type42,   0x1400, "Type 42 module" )
   FT_MODERRDEF( Winfonts, 0x1500, "Windows FON/FNT module" )
   FT_MODERRDEF( GXvalid,  0x1600, "GX validation module" )
+  FT_MODERRDEF( SDF,      0x1700, "SDF renderer module" )
 
 
 #ifdef FT_MODERR_END_LIST
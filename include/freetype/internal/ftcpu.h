@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ * ftcpu.h
+ *
+ *   Run-time CPU feature detection (specification).
+ *
+ * Copyright 2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef FTCPU_H_
+#define FTCPU_H_
+
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+
+FT_BEGIN_HEADER
+
+
+  /**************************************************************************
+   *
+   * The SIMD instruction sets usable by the current process.  SSE2 and
+   * NEON are reported if the compiler targets them anyway; AVX2 is
+   * reported if both the CPU and the operating system support it, since
+   * code using it must be compiled separately.
+   *
+   * All bits are cleared if FT_CONFIG_OPTION_NO_SIMD is defined.
+   */
+#define FT_CPU_SSE2  0x1
+#define FT_CPU_AVX2  0x2
+#define FT_CPU_NEON  0x4
+
+
+  FT_BASE( FT_UInt32 )
+  ft_cpu_features( void );
+
+
+FT_END_HEADER
+
+#endif /* FTCPU_H_ */
+
+
+/* END */
@@ -289,6 +289,46 @@ FT_BEGIN_HEADER
                      FT_Render_Mode       mode,
                      FT_LcdFiveTapFilter  weights );
 
+
+  /* The 5-tap FIR filter, as used by `ft_lcd_filter_fir'.  `row'      */
+  /* filters a row of an FT_PIXEL_MODE_LCD bitmap in place, `columns'  */
+  /* an FT_PIXEL_MODE_LCD_V bitmap (given its bottom row).  `rows'     */
+  /* computes `count' pixels of the latter from five unfiltered input  */
+  /* rows; `in[0]' is the row two pixels ahead of the output, `in[2]'  */
+  /* the one at the output position, and so on.  `out' may be equal to */
+  /* `in[2]', whose unfiltered values are also copied to `save'; this  */
+  /* may be equal to `in[4]'.  The bitmaps must be at least two pixels */
+  /* wide or high, respectively.                                       */
+  typedef struct  FT_LcdFirRec_
+  {
+    void
+    (*row)( FT_Byte*        line,
+            FT_UInt         width,
+            const FT_Byte*  weights );
+
+    void
+    (*columns)( FT_Byte*        origin,
+                FT_UInt         width,
+                FT_UInt         height,
+                FT_Int          pitch,
+                const FT_Byte*  weights );
+
+    void
+    (*rows)( FT_Byte*         out,
+             FT_Byte*         save,
+             const FT_Byte**  in,
+             FT_UInt          count,
+             const FT_Byte*   weights );
+
+  } FT_LcdFirRec, *FT_LcdFir;
+
+
+  /* Select the fastest filter functions for the given weights; */
+  /* these might use SIMD instructions.                         */
+  FT_BASE( void )
+  ft_lcd_fir_select( FT_LcdFir       fir,
+                     const FT_Byte*  weights );
+
 #endif /* FT_CONFIG_OPTION_SUBPIXEL_RENDERING */
 
   /**************************************************************************
@@ -512,6 +512,7 @@ FT_BEGIN_HEADER
 #define FT_SERVICE_WINFNT_H             <freetype/internal/services/svwinfnt.h>
 #define FT_SERVICE_GF_H                 <freetype/internal/services/svgf.h>
 #define FT_SERVICE_PK_H                 <freetype/internal/services/svpk.h>
+#define FT_SERVICE_VF_H                 <freetype/internal/services/svvf.h>
 
  /* */
 
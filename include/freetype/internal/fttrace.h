@@ -39,6 +39,7 @@ FT_TRACE_DEF( mm )        /* MM interface            (ftmm.c)     */
 FT_TRACE_DEF( psprops )   /* PS driver properties    (ftpsprop.c) */
 FT_TRACE_DEF( raccess )   /* resource fork accessor  (ftrfork.c)  */
 FT_TRACE_DEF( raster )    /* monochrome rasterizer   (ftraster.c) */
+FT_TRACE_DEF( sdf )       /* distance field raster   (ftsdf.c)    */
 FT_TRACE_DEF( smooth )    /* anti-aliasing raster    (ftgrays.c)  */
 FT_TRACE_DEF( synth )     /* bold/slant synthesizer  (ftsynth.c)  */
 
@@ -127,6 +128,10 @@ FT_TRACE_DEF( tfmobjs )
 FT_TRACE_DEF( pkdriver )
 FT_TRACE_DEF( pklib )
 
+  /* VF font components */
+FT_TRACE_DEF( vfdriver )
+FT_TRACE_DEF( vflib )
+
   /* PFR font component */
 FT_TRACE_DEF( pfr )
 
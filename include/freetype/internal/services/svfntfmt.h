@@ -44,6 +44,7 @@ FT_BEGIN_HEADER
 #define FT_FONT_FORMAT_WINFNT    "Windows FNT"
 #define FT_FONT_FORMAT_GF        "GF"
 #define FT_FONT_FORMAT_PK        "PK"
+#define FT_FONT_FORMAT_VF        "VF"
 
   /* */
 
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * svvf.h
+ *
+ *   The FreeType VF services (specification).
+ *
+ * Copyright 2003-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef SVVF_H_
+#define SVVF_H_
+
+
+#include FT_INTERNAL_SERVICE_H
+
+
+FT_BEGIN_HEADER
+
+
+#define FT_SERVICE_ID_VF  "vf"
+
+  /* */
+
+
+FT_END_HEADER
+
+
+#endif /* SVVF_H_ */
+
+
+/* END */
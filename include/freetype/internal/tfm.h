@@ -87,6 +87,39 @@ FT_BEGIN_HEADER
   } TFM_Parser_FuncsRec;
 
 
+  /**************************************************************************
+   *
+   * @struct:
+   *   TFM_Metrics_FuncsRec
+   *
+   * @description:
+   *   Functions to get shared, parsed TFM metrics.  The `tfm' module
+   *   keeps recently used metrics keyed by the contents of the TFM
+   *   stream, so attaching the same TFM file to many faces parses it only
+   *   once.
+   *
+   * @fields:
+   *   acquire ::
+   *     Return the metrics of the TFM data in `stream', parsing it if
+   *     necessary.  The result must not be modified by the caller.
+   *
+   *   release ::
+   *     Release metrics returned by `acquire'.
+   */
+  typedef struct  TFM_Metrics_FuncsRec_
+  {
+    FT_Error
+    (*acquire)( FT_Module      module,
+                FT_Stream      stream,
+                TFM_FontInfo  *afi );
+
+    void
+    (*release)( FT_Module     module,
+                TFM_FontInfo  fi );
+
+  } TFM_Metrics_FuncsRec;
+
+
 
   /**************************************************************************
    *
@@ -129,7 +162,8 @@ FT_BEGIN_HEADER
 
   typedef struct  TFM_ServiceRec_
   {
-    const TFM_Parser_FuncsRec* tfm_parser_funcs;
+    const TFM_Parser_FuncsRec*   tfm_parser_funcs;
+    const TFM_Metrics_FuncsRec*  tfm_metrics_funcs;
 
   } TFM_ServiceRec, *TFM_Service;
 
@@ -1600,6 +1600,22 @@ FT_BEGIN_HEADER
    *
    *   ebdt_size ::
    *     The size of the sbit data table.
+   *
+   *   font_program_map ::
+   *     The jump map of the font program, built
+   *     by the bytecode interpreter when the
+   *     program first runs.
+   *
+   *   cvt_program_map ::
+   *     The jump map of the cvt program.
+   *
+   *   prep_results ::
+   *     The states of the bytecode interpreter after running the cvt
+   *     program, shared by size objects with the same scaling.  Most
+   *     recently used first.
+   *
+   *   prep_results_id ::
+   *     The identifier of the last item added to `prep_results'.
    */
   typedef struct  TT_FaceRec_
   {
@@ -1786,6 +1802,12 @@ FT_BEGIN_HEADER
     void*                 cpal;
     void*                 colr;
 
+    FT_UShort*            font_program_map;
+    FT_UShort*            cvt_program_map;
+
+    FT_ListRec            prep_results;
+    FT_ULong              prep_results_id;
+
   } TT_FaceRec;
 
 
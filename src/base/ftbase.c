@@ -22,6 +22,7 @@
 #include "ftadvanc.c"
 #include "ftcalc.c"
 #include "ftcolor.c"
+#include "ftcpu.c"
 #include "ftdbgmem.c"
 #include "ftfntfmt.c"
 #include "ftgloadr.c"
@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * ftcpu.c
+ *
+ *   Run-time CPU feature detection (body).
+ *
+ * Copyright 2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_CPU_H
+
+#if !defined( FT_CONFIG_OPTION_NO_SIMD ) && defined( _MSC_VER )      && \
+    ( defined( _M_IX86 ) || defined( _M_X64 ) )
+#include <intrin.h>
+#endif
+
+
+  /* documentation is in ftcpu.h */
+
+  FT_BASE_DEF( FT_UInt32 )
+  ft_cpu_features( void )
+  {
+    FT_UInt32  features = 0;
+
+
+#ifndef FT_CONFIG_OPTION_NO_SIMD
+
+#if defined( __SSE2__ )                           || \
+    defined( _M_X64 )                             || \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+    features |= FT_CPU_SSE2;
+#endif
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 )
+    features |= FT_CPU_NEON;
+#endif
+
+#if defined( __AVX2__ )
+
+    features |= FT_CPU_AVX2;
+
+#elif ( defined( __GNUC__ ) || defined( __clang__ ) )  && \
+      ( defined( __i386__ ) || defined( __x86_64__ ) )
+
+    /* this also checks that the OS saves the YMM registers */
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx2" ) )
+      features |= FT_CPU_AVX2;
+
+#elif defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+
+    {
+      int  info[4];
+
+
+      __cpuid( info, 0 );
+      if ( info[0] >= 7 )
+      {
+        __cpuid( info, 1 );
+
+        /* OSXSAVE and AVX; the OS must save both XMM and YMM registers */
+        if ( ( info[2] & 0x18000000L ) == 0x18000000L &&
+             ( _xgetbv( 0 ) & 6 ) == 6                )
+        {
+          __cpuidex( info, 7, 0 );
+          if ( info[1] & 0x20 )
+            features |= FT_CPU_AVX2;
+        }
+      }
+    }
+
+#endif
+
+#endif /* !FT_CONFIG_OPTION_NO_SIMD */
+
+    return features;
+  }
+
+
+/* END */
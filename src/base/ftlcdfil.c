@@ -32,6 +32,42 @@
 #define FT_SHIFTCLAMP( x )  ( x >>= 8, (FT_Byte)( x > 255 ? 255 : x ) )
 
 
+  /* SIMD versions of the FIR filter; SSE2 and NEON are used if */
+  /* the compiler targets them, AVX2 if the CPU supports it     */
+#ifndef FT_CONFIG_OPTION_NO_SIMD
+
+#include FT_INTERNAL_CPU_H
+
+#if defined( __SSE2__ )                           || \
+    defined( _M_X64 )                             || \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define FT_LCD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( FT_LCD_SSE2 )                                                && \
+    ( defined( __AVX2__ )                                              || \
+      ( defined( __GNUC__ )                                          &&   \
+        ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) || \
+      defined( __clang__ )                                             || \
+      ( defined( _MSC_VER ) && _MSC_VER >= 1900 )                      )
+#define FT_LCD_AVX2
+#include <immintrin.h>
+#if defined( __GNUC__ ) && !defined( __AVX2__ )
+#define FT_TARGET_AVX2  __attribute__(( target( "avx2" ) ))
+#else
+#define FT_TARGET_AVX2  /* nothing */
+#endif
+#endif
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 )
+#define FT_LCD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif /* !FT_CONFIG_OPTION_NO_SIMD */
+
+
   /* add padding according to filter weights */
   FT_BASE_DEF (void)
   ft_lcd_padding( FT_BBox*        cbox,
@@ -74,107 +110,693 @@
   }
 
 
-  /* FIR filter used by the default and light filters */
-  FT_BASE_DEF( void )
-  ft_lcd_filter_fir( FT_Bitmap*           bitmap,
-                     FT_Render_Mode       mode,
-                     FT_LcdFiveTapFilter  weights )
+  /*
+   * The FIR filter comes in three flavours: `row' filters a row of an
+   * FT_PIXEL_MODE_LCD bitmap in place, `columns' filters a whole
+   * FT_PIXEL_MODE_LCD_V bitmap in place, and `rows' combines five rows of
+   * the latter (or rather their unfiltered values) into one.
+   *
+   * The SIMD versions compute in 16 bits.  This is exact if the weights
+   * add up to at most 257, as the predefined ones do; the results then
+   * need no clamping either.
+   */
+
+  /* filter pixels `xx' to `width - 1' of a row, with `width - xx' at  */
+  /* least 2, given the unfiltered values `a' and `b' of the two       */
+  /* pixels before them                                                */
+  static void
+  ft_lcd_fir_row_tail( FT_Byte*        line,
+                       FT_UInt         xx,
+                       FT_UInt         width,
+                       FT_UInt         a,
+                       FT_UInt         b,
+                       const FT_Byte*  weights )
   {
-    FT_UInt   width  = (FT_UInt)bitmap->width;
-    FT_UInt   height = (FT_UInt)bitmap->rows;
-    FT_Int    pitch  = bitmap->pitch;
-    FT_Byte*  origin = bitmap->buffer;
+    /* the weights are copied, as storing bytes */
+    /* could otherwise change them              */
+    FT_UInt  w0 = weights[0];
+    FT_UInt  w1 = weights[1];
+    FT_UInt  w2 = weights[2];
+    FT_UInt  w3 = weights[3];
+    FT_UInt  w4 = weights[4];
+
+    /* `fir' must be at least 32 bit wide, since the sum of */
+    /* the values in `weights' can exceed 0xFF              */
+    FT_UInt  fir0, fir1, fir2, fir3, fir4;
+    FT_UInt  val;
+
+
+    fir3 = w3 * b + w4 * a;
+    fir4 = w4 * b;
+
+    val  = line[xx];
+    fir2 = fir3 + w2 * val;
+    fir3 = fir4 + w3 * val;
+    fir4 =        w4 * val;
+
+    val  = line[xx + 1];
+    fir1 = fir2 + w1 * val;
+    fir2 = fir3 + w2 * val;
+    fir3 = fir4 + w3 * val;
+    fir4 =        w4 * val;
+
+    for ( xx += 2; xx < width; xx++ )
+    {
+      val  = line[xx];
+      fir0 = fir1 + w0 * val;
+      fir1 = fir2 + w1 * val;
+      fir2 = fir3 + w2 * val;
+      fir3 = fir4 + w3 * val;
+      fir4 =        w4 * val;
+
+      line[xx - 2] = FT_SHIFTCLAMP( fir0 );
+    }
 
+    line[xx - 2] = FT_SHIFTCLAMP( fir1 );
+    line[xx - 1] = FT_SHIFTCLAMP( fir2 );
+  }
 
-    /* take care of bitmap flow */
-    if ( pitch > 0 && height > 0 )
-      origin += pitch * (FT_Int)( height - 1 );
 
-    /* horizontal in-place FIR filter */
-    if ( mode == FT_RENDER_MODE_LCD && width >= 2 )
-    {
-      FT_Byte*  line = origin;
+  static void
+  ft_lcd_fir_row_c( FT_Byte*        line,
+                    FT_UInt         width,
+                    const FT_Byte*  weights )
+  {
+    ft_lcd_fir_row_tail( line, 0, width, 0, 0, weights );
+  }
+
+
+  static void
+  ft_lcd_fir_columns_c( FT_Byte*        origin,
+                        FT_UInt         width,
+                        FT_UInt         height,
+                        FT_Int          pitch,
+                        const FT_Byte*  weights )
+  {
+    FT_Byte*  column = origin;
 
 
-      /* `fir' must be at least 32 bit wide, since the sum of */
-      /* the values in `weights' can exceed 0xFF              */
+    for ( ; width > 0; width--, column++ )
+    {
+      FT_Byte*  col = column;
+      FT_UInt   fir[5];
+      FT_UInt   val, yy;
 
-      for ( ; height > 0; height--, line -= pitch )
-      {
-        FT_UInt  fir[5];
-        FT_UInt  val, xx;
 
+      val    = col[0];
+      fir[2] = weights[2] * val;
+      fir[3] = weights[3] * val;
+      fir[4] = weights[4] * val;
+      col   -= pitch;
 
-        val    = line[0];
-        fir[2] = weights[2] * val;
-        fir[3] = weights[3] * val;
-        fir[4] = weights[4] * val;
+      val    = col[0];
+      fir[1] = fir[2] + weights[1] * val;
+      fir[2] = fir[3] + weights[2] * val;
+      fir[3] = fir[4] + weights[3] * val;
+      fir[4] =          weights[4] * val;
+      col   -= pitch;
 
-        val    = line[1];
+      for ( yy = 2; yy < height; yy++, col -= pitch )
+      {
+        val    = col[0];
+        fir[0] = fir[1] + weights[0] * val;
         fir[1] = fir[2] + weights[1] * val;
         fir[2] = fir[3] + weights[2] * val;
         fir[3] = fir[4] + weights[3] * val;
         fir[4] =          weights[4] * val;
 
-        for ( xx = 2; xx < width; xx++ )
-        {
-          val    = line[xx];
-          fir[0] = fir[1] + weights[0] * val;
-          fir[1] = fir[2] + weights[1] * val;
-          fir[2] = fir[3] + weights[2] * val;
-          fir[3] = fir[4] + weights[3] * val;
-          fir[4] =          weights[4] * val;
-
-          line[xx - 2] = FT_SHIFTCLAMP( fir[0] );
-        }
-
-        line[xx - 2] = FT_SHIFTCLAMP( fir[1] );
-        line[xx - 1] = FT_SHIFTCLAMP( fir[2] );
+        col[pitch * 2]  = FT_SHIFTCLAMP( fir[0] );
       }
+
+      col[pitch * 2]  = FT_SHIFTCLAMP( fir[1] );
+      col[pitch]      = FT_SHIFTCLAMP( fir[2] );
     }
+  }
 
-    /* vertical in-place FIR filter */
-    else if ( mode == FT_RENDER_MODE_LCD_V && height >= 2 )
+
+  static void
+  ft_lcd_fir_rows_c( FT_Byte*         out,
+                     FT_Byte*         save,
+                     const FT_Byte**  in,
+                     FT_UInt          count,
+                     const FT_Byte*   weights )
+  {
+    const FT_Byte*  in0 = in[0];
+    const FT_Byte*  in1 = in[1];
+    const FT_Byte*  in2 = in[2];
+    const FT_Byte*  in3 = in[3];
+    const FT_Byte*  in4 = in[4];
+
+    FT_UInt  w0 = weights[0];
+    FT_UInt  w1 = weights[1];
+    FT_UInt  w2 = weights[2];
+    FT_UInt  w3 = weights[3];
+    FT_UInt  w4 = weights[4];
+    FT_UInt  i;
+
+
+    for ( i = 0; i < count; i++ )
     {
-      FT_Byte*  column = origin;
+      FT_UInt  val = in2[i];
+      FT_UInt  fir = w0 * in0[i] +
+                     w1 * in1[i] +
+                     w2 * val    +
+                     w3 * in3[i] +
+                     w4 * in4[i];
 
 
-      for ( ; width > 0; width--, column++ )
-      {
-        FT_Byte*  col = column;
-        FT_UInt   fir[5];
-        FT_UInt   val, yy;
+      save[i] = (FT_Byte)val;
+      out[i]  = FT_SHIFTCLAMP( fir );
+    }
+  }
 
 
-        val    = col[0];
-        fir[2] = weights[2] * val;
-        fir[3] = weights[3] * val;
-        fir[4] = weights[4] * val;
-        col   -= pitch;
+#ifdef FT_LCD_SSE2
 
-        val    = col[0];
-        fir[1] = fir[2] + weights[1] * val;
-        fir[2] = fir[3] + weights[2] * val;
-        fir[3] = fir[4] + weights[3] * val;
-        fir[4] =          weights[4] * val;
-        col   -= pitch;
+  /* filter 16 pixels, `v[0]' being the ones two pixels ahead */
+  static __m128i
+  ft_lcd_fir_sse2( const __m128i*  v,
+                   const __m128i*  w )
+  {
+    const __m128i  zero = _mm_setzero_si128();
+
+    __m128i  lo = zero;
+    __m128i  hi = zero;
+    int      k;
+
+
+    for ( k = 0; k < 5; k++ )
+    {
+      lo = _mm_add_epi16( lo, _mm_mullo_epi16(
+                                _mm_unpacklo_epi8( v[k], zero ), w[k] ) );
+      hi = _mm_add_epi16( hi, _mm_mullo_epi16(
+                                _mm_unpackhi_epi8( v[k], zero ), w[k] ) );
+    }
+
+    return _mm_packus_epi16( _mm_srli_epi16( lo, 8 ),
+                             _mm_srli_epi16( hi, 8 ) );
+  }
+
+
+  static void
+  ft_lcd_fir_row_sse2( FT_Byte*        line,
+                       FT_UInt         width,
+                       const FT_Byte*  weights )
+  {
+    __m128i  w[5], v[5];
+    __m128i  prev, cur, next;
+    FT_UInt  xx, ab;
+    int      k;
+
+
+    if ( width < 32 )
+    {
+      ft_lcd_fir_row_c( line, width, weights );
+      return;
+    }
+
+    for ( k = 0; k < 5; k++ )
+      w[k] = _mm_set1_epi16( weights[k] );
+
+    /* the pixels are filtered in place, keeping the */
+    /* unfiltered ones still needed in `prev' and `cur' */
+    prev = _mm_setzero_si128();
+    cur  = _mm_loadu_si128( (const __m128i*)line );
+
+    for ( xx = 0; xx + 32 <= width; xx += 16 )
+    {
+      next = _mm_loadu_si128( (const __m128i*)( line + xx + 16 ) );
+
+      v[0] = _mm_or_si128( _mm_srli_si128( cur, 2 ),
+                           _mm_slli_si128( next, 14 ) );
+      v[1] = _mm_or_si128( _mm_srli_si128( cur, 1 ),
+                           _mm_slli_si128( next, 15 ) );
+      v[2] = cur;
+      v[3] = _mm_or_si128( _mm_slli_si128( cur, 1 ),
+                           _mm_srli_si128( prev, 15 ) );
+      v[4] = _mm_or_si128( _mm_slli_si128( cur, 2 ),
+                           _mm_srli_si128( prev, 14 ) );
+
+      _mm_storeu_si128( (__m128i*)( line + xx ), ft_lcd_fir_sse2( v, w ) );
+
+      prev = cur;
+      cur  = next;
+    }
+
+    ab = (FT_UInt)_mm_extract_epi16( prev, 7 );
+    ft_lcd_fir_row_tail( line, xx, width, ab & 0xFF, ab >> 8, weights );
+  }
+
+
+  /* filter a strip of 16 or 8 columns, keeping five rows in registers */
+  static void
+  ft_lcd_fir_strip_sse2( FT_Byte*        line,
+                         FT_UInt         height,
+                         FT_Int          pitch,
+                         const __m128i*  w,
+                         FT_Bool         wide )
+  {
+    __m128i  v[5];
+    FT_UInt  yy;
+
+
+#define FT_LCD_LOAD( p )                                   \
+          ( wide ? _mm_loadu_si128( (const __m128i*)(p) )  \
+                 : _mm_loadl_epi64( (const __m128i*)(p) ) )
+
+    v[4] = _mm_setzero_si128();
+    v[3] = _mm_setzero_si128();
+    v[2] = FT_LCD_LOAD( line );
+    v[1] = FT_LCD_LOAD( line - pitch );
+
+    for ( yy = 0; yy < height; yy++, line -= pitch )
+    {
+      __m128i  out;
+
+
+      v[0] = yy + 2 < height ? FT_LCD_LOAD( line - 2 * pitch )
+                             : _mm_setzero_si128();
+
+      out = ft_lcd_fir_sse2( v, w );
+      if ( wide )
+        _mm_storeu_si128( (__m128i*)line, out );
+      else
+        _mm_storel_epi64( (__m128i*)line, out );
+
+      v[4] = v[3];
+      v[3] = v[2];
+      v[2] = v[1];
+      v[1] = v[0];
+    }
+
+#undef FT_LCD_LOAD
+  }
+
+
+  static void
+  ft_lcd_fir_columns_sse2( FT_Byte*        origin,
+                           FT_UInt         width,
+                           FT_UInt         height,
+                           FT_Int          pitch,
+                           const FT_Byte*  weights )
+  {
+    __m128i  w[5];
+    FT_UInt  xx;
+    int      k;
+
+
+    for ( k = 0; k < 5; k++ )
+      w[k] = _mm_set1_epi16( weights[k] );
+
+    for ( xx = 0; xx + 16 <= width; xx += 16 )
+      ft_lcd_fir_strip_sse2( origin + xx, height, pitch, w, 1 );
+
+    if ( xx + 8 <= width )
+    {
+      ft_lcd_fir_strip_sse2( origin + xx, height, pitch, w, 0 );
+      xx += 8;
+    }
+
+    if ( xx < width )
+      ft_lcd_fir_columns_c( origin + xx, width - xx, height, pitch, weights );
+  }
+
+
+  static void
+  ft_lcd_fir_rows_sse2( FT_Byte*         out,
+                        FT_Byte*         save,
+                        const FT_Byte**  in,
+                        FT_UInt          count,
+                        const FT_Byte*   weights )
+  {
+    __m128i         w[5], v[5];
+    const FT_Byte*  p[5];
+    FT_UInt         i;
+    int             k;
+
+
+    for ( k = 0; k < 5; k++ )
+    {
+      w[k] = _mm_set1_epi16( weights[k] );
+      p[k] = in[k];
+    }
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+      for ( k = 0; k < 5; k++ )
+        v[k] = _mm_loadu_si128( (const __m128i*)( p[k] + i ) );
+
+      _mm_storeu_si128( (__m128i*)( save + i ), v[2] );
+      _mm_storeu_si128( (__m128i*)( out + i ), ft_lcd_fir_sse2( v, w ) );
+    }
+
+    if ( i + 8 <= count )
+    {
+      for ( k = 0; k < 5; k++ )
+        v[k] = _mm_loadl_epi64( (const __m128i*)( p[k] + i ) );
+
+      _mm_storel_epi64( (__m128i*)( save + i ), v[2] );
+      _mm_storel_epi64( (__m128i*)( out + i ), ft_lcd_fir_sse2( v, w ) );
+
+      i += 8;
+    }
+
+    if ( i < count )
+    {
+      for ( k = 0; k < 5; k++ )
+        p[k] += i;
+
+      ft_lcd_fir_rows_c( out + i, save + i, p, count - i, weights );
+    }
+  }
+
+#endif /* FT_LCD_SSE2 */
 
-        for ( yy = 2; yy < height; yy++, col -= pitch )
-        {
-          val    = col[0];
-          fir[0] = fir[1] + weights[0] * val;
-          fir[1] = fir[2] + weights[1] * val;
-          fir[2] = fir[3] + weights[2] * val;
-          fir[3] = fir[4] + weights[3] * val;
-          fir[4] =          weights[4] * val;
-
-          col[pitch * 2]  = FT_SHIFTCLAMP( fir[0] );
-        }
 
-        col[pitch * 2]  = FT_SHIFTCLAMP( fir[1] );
-        col[pitch]      = FT_SHIFTCLAMP( fir[2] );
+#ifdef FT_LCD_AVX2
+
+  FT_TARGET_AVX2
+  static void
+  ft_lcd_fir_rows_avx2( FT_Byte*         out,
+                        FT_Byte*         save,
+                        const FT_Byte**  in,
+                        FT_UInt          count,
+                        const FT_Byte*   weights )
+  {
+    const __m256i   zero = _mm256_setzero_si256();
+    __m256i         w[5], v[5];
+    const FT_Byte*  p[5];
+    FT_UInt         i;
+    int             k;
+
+
+    for ( k = 0; k < 5; k++ )
+    {
+      w[k] = _mm256_set1_epi16( weights[k] );
+      p[k] = in[k];
+    }
+
+    /* unpacking and packing both work within 128-bit lanes, */
+    /* so the pixels end up in their original order          */
+    for ( i = 0; i + 32 <= count; i += 32 )
+    {
+      __m256i  lo = zero;
+      __m256i  hi = zero;
+
+
+      for ( k = 0; k < 5; k++ )
+      {
+        v[k] = _mm256_loadu_si256( (const __m256i*)( p[k] + i ) );
+
+        lo = _mm256_add_epi16( lo, _mm256_mullo_epi16(
+                                     _mm256_unpacklo_epi8( v[k], zero ),
+                                     w[k] ) );
+        hi = _mm256_add_epi16( hi, _mm256_mullo_epi16(
+                                     _mm256_unpackhi_epi8( v[k], zero ),
+                                     w[k] ) );
       }
+
+      _mm256_storeu_si256( (__m256i*)( save + i ), v[2] );
+      _mm256_storeu_si256( (__m256i*)( out + i ),
+                           _mm256_packus_epi16(
+                             _mm256_srli_epi16( lo, 8 ),
+                             _mm256_srli_epi16( hi, 8 ) ) );
+    }
+
+    /* avoid penalties for mixing AVX and SSE code; */
+    /* some compilers do not do this by themselves  */
+    _mm256_zeroupper();
+
+    if ( i < count )
+    {
+      for ( k = 0; k < 5; k++ )
+        p[k] += i;
+
+      ft_lcd_fir_rows_sse2( out + i, save + i, p, count - i, weights );
+    }
+  }
+
+#endif /* FT_LCD_AVX2 */
+
+
+#ifdef FT_LCD_NEON
+
+  /* filter 16 pixels, `v[0]' being the ones two pixels ahead */
+  static uint8x16_t
+  ft_lcd_fir_neon( const uint8x16_t*  v,
+                   const uint8x8_t*   w )
+  {
+    uint16x8_t  lo = vmull_u8( vget_low_u8( v[0] ), w[0] );
+    uint16x8_t  hi = vmull_u8( vget_high_u8( v[0] ), w[0] );
+    int         k;
+
+
+    for ( k = 1; k < 5; k++ )
+    {
+      lo = vmlal_u8( lo, vget_low_u8( v[k] ), w[k] );
+      hi = vmlal_u8( hi, vget_high_u8( v[k] ), w[k] );
+    }
+
+    return vcombine_u8( vshrn_n_u16( lo, 8 ), vshrn_n_u16( hi, 8 ) );
+  }
+
+
+  static void
+  ft_lcd_fir_row_neon( FT_Byte*        line,
+                       FT_UInt         width,
+                       const FT_Byte*  weights )
+  {
+    uint8x8_t   w[5];
+    uint8x16_t  v[5];
+    uint8x16_t  prev, cur, next;
+    FT_UInt     xx;
+    int         k;
+
+
+    if ( width < 32 )
+    {
+      ft_lcd_fir_row_c( line, width, weights );
+      return;
+    }
+
+    for ( k = 0; k < 5; k++ )
+      w[k] = vdup_n_u8( weights[k] );
+
+    /* the pixels are filtered in place, keeping the */
+    /* unfiltered ones still needed in `prev' and `cur' */
+    prev = vdupq_n_u8( 0 );
+    cur  = vld1q_u8( line );
+
+    for ( xx = 0; xx + 32 <= width; xx += 16 )
+    {
+      next = vld1q_u8( line + xx + 16 );
+
+      v[0] = vextq_u8( cur, next, 2 );
+      v[1] = vextq_u8( cur, next, 1 );
+      v[2] = cur;
+      v[3] = vextq_u8( prev, cur, 15 );
+      v[4] = vextq_u8( prev, cur, 14 );
+
+      vst1q_u8( line + xx, ft_lcd_fir_neon( v, w ) );
+
+      prev = cur;
+      cur  = next;
+    }
+
+    ft_lcd_fir_row_tail( line, xx, width,
+                         vgetq_lane_u8( prev, 14 ),
+                         vgetq_lane_u8( prev, 15 ),
+                         weights );
+  }
+
+
+  /* filter a strip of 16 or 8 columns, keeping five rows in registers */
+  static void
+  ft_lcd_fir_strip_neon( FT_Byte*          line,
+                         FT_UInt           height,
+                         FT_Int            pitch,
+                         const uint8x8_t*  w,
+                         FT_Bool           wide )
+  {
+    uint8x16_t  v[5];
+    FT_UInt     yy;
+
+
+#define FT_LCD_LOAD( p )                                     \
+          ( wide ? vld1q_u8( p )                             \
+                 : vcombine_u8( vld1_u8( p ), vdup_n_u8( 0 ) ) )
+
+    v[4] = vdupq_n_u8( 0 );
+    v[3] = vdupq_n_u8( 0 );
+    v[2] = FT_LCD_LOAD( line );
+    v[1] = FT_LCD_LOAD( line - pitch );
+
+    for ( yy = 0; yy < height; yy++, line -= pitch )
+    {
+      uint8x16_t  out;
+
+
+      v[0] = yy + 2 < height ? FT_LCD_LOAD( line - 2 * pitch )
+                             : vdupq_n_u8( 0 );
+
+      out = ft_lcd_fir_neon( v, w );
+      if ( wide )
+        vst1q_u8( line, out );
+      else
+        vst1_u8( line, vget_low_u8( out ) );
+
+      v[4] = v[3];
+      v[3] = v[2];
+      v[2] = v[1];
+      v[1] = v[0];
     }
+
+#undef FT_LCD_LOAD
+  }
+
+
+  static void
+  ft_lcd_fir_columns_neon( FT_Byte*        origin,
+                           FT_UInt         width,
+                           FT_UInt         height,
+                           FT_Int          pitch,
+                           const FT_Byte*  weights )
+  {
+    uint8x8_t  w[5];
+    FT_UInt    xx;
+    int        k;
+
+
+    for ( k = 0; k < 5; k++ )
+      w[k] = vdup_n_u8( weights[k] );
+
+    for ( xx = 0; xx + 16 <= width; xx += 16 )
+      ft_lcd_fir_strip_neon( origin + xx, height, pitch, w, 1 );
+
+    if ( xx + 8 <= width )
+    {
+      ft_lcd_fir_strip_neon( origin + xx, height, pitch, w, 0 );
+      xx += 8;
+    }
+
+    if ( xx < width )
+      ft_lcd_fir_columns_c( origin + xx, width - xx, height, pitch, weights );
+  }
+
+
+  static void
+  ft_lcd_fir_rows_neon( FT_Byte*         out,
+                        FT_Byte*         save,
+                        const FT_Byte**  in,
+                        FT_UInt          count,
+                        const FT_Byte*   weights )
+  {
+    uint8x8_t       w[5];
+    uint8x16_t      v[5];
+    const FT_Byte*  p[5];
+    FT_UInt         i;
+    int             k;
+
+
+    for ( k = 0; k < 5; k++ )
+    {
+      w[k] = vdup_n_u8( weights[k] );
+      p[k] = in[k];
+    }
+
+    for ( i = 0; i + 16 <= count; i += 16 )
+    {
+      for ( k = 0; k < 5; k++ )
+        v[k] = vld1q_u8( p[k] + i );
+
+      vst1q_u8( save + i, v[2] );
+      vst1q_u8( out + i, ft_lcd_fir_neon( v, w ) );
+    }
+
+    if ( i < count )
+    {
+      for ( k = 0; k < 5; k++ )
+        p[k] += i;
+
+      ft_lcd_fir_rows_c( out + i, save + i, p, count - i, weights );
+    }
+  }
+
+#endif /* FT_LCD_NEON */
+
+
+  /* documentation in ftobjs.h */
+
+  FT_BASE_DEF( void )
+  ft_lcd_fir_select( FT_LcdFir       fir,
+                     const FT_Byte*  weights )
+  {
+    fir->row     = ft_lcd_fir_row_c;
+    fir->columns = ft_lcd_fir_columns_c;
+    fir->rows    = ft_lcd_fir_rows_c;
+
+#if defined( FT_LCD_SSE2 ) || defined( FT_LCD_NEON )
+
+    if ( weights[0] + weights[1] + weights[2] +
+         weights[3] + weights[4] <= 257      )
+    {
+#ifdef FT_LCD_SSE2
+      fir->row     = ft_lcd_fir_row_sse2;
+      fir->columns = ft_lcd_fir_columns_sse2;
+      fir->rows    = ft_lcd_fir_rows_sse2;
+#else
+      fir->row     = ft_lcd_fir_row_neon;
+      fir->columns = ft_lcd_fir_columns_neon;
+      fir->rows    = ft_lcd_fir_rows_neon;
+#endif
+
+#ifdef FT_LCD_AVX2
+      if ( ft_cpu_features() & FT_CPU_AVX2 )
+        fir->rows = ft_lcd_fir_rows_avx2;
+#endif
+    }
+
+#else
+
+    FT_UNUSED( weights );
+
+#endif
+  }
+
+
+  /* FIR filter used by the default and light filters */
+  FT_BASE_DEF( void )
+  ft_lcd_filter_fir( FT_Bitmap*           bitmap,
+                     FT_Render_Mode       mode,
+                     FT_LcdFiveTapFilter  weights )
+  {
+    FT_UInt   width  = (FT_UInt)bitmap->width;
+    FT_UInt   height = (FT_UInt)bitmap->rows;
+    FT_Int    pitch  = bitmap->pitch;
+    FT_Byte*  origin = bitmap->buffer;
+
+    FT_LcdFirRec  fir;
+
+
+    ft_lcd_fir_select( &fir, weights );
+
+    /* take care of bitmap flow */
+    if ( pitch > 0 && height > 0 )
+      origin += pitch * (FT_Int)( height - 1 );
+
+    /* horizontal in-place FIR filter */
+    if ( mode == FT_RENDER_MODE_LCD && width >= 2 )
+    {
+      FT_Byte*  line = origin;
+
+
+      for ( ; height > 0; height--, line -= pitch )
+        fir.row( line, width, weights );
+    }
+
+    /* vertical in-place FIR filter */
+    else if ( mode == FT_RENDER_MODE_LCD_V && height >= 2 )
+      fir.columns( origin, width, height, pitch, weights );
   }
 
 
@@ -5318,13 +5318,14 @@
      *   destroyed, resulting in a memory leak
      *
      * Some faces are dependent on other faces, like Type42 faces that
-     * depend on TrueType faces synthesized internally.
+     * depend on TrueType faces synthesized internally, or VF faces that
+     * hold references to PK and GF base faces.
      *
      * The order of drivers should be specified in driver_name[].
      */
     {
       FT_UInt      m, n;
-      const char*  driver_name[] = { "type42", NULL };
+      const char*  driver_name[] = { "type42", "vf", NULL };
 
 
       for ( m = 0;
@@ -19,6 +19,7 @@
 #define FT_MAKE_OPTION_SINGLE_OBJECT
 #include <ft2build.h>
 
+#include "ftcatlas.c"
 #include "ftcbasic.c"
 #include "ftccache.c"
 #include "ftccmap.c"
@@ -27,6 +28,8 @@
 #include "ftcmanag.c"
 #include "ftcmru.c"
 #include "ftcsbits.c"
+#include "ftcsnap.c"
+#include "ftcsync.c"
 
 
 /* END */
@@ -0,0 +1,731 @@
+/****************************************************************************
+ *
+ * ftcatlas.c
+ *
+ *   FreeType glyph atlas cache (body).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcatlas.h"
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+#include FT_ERRORS_H
+
+#include "ftccback.h"
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  trace_cache
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                        ATLAS PAGES                            *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  static FT_Error
+  ftc_apage_new( FTC_ACache  cache,
+                 FTC_APage  *apage )
+  {
+    FT_Memory  memory = FTC_CACHE( cache )->memory;
+    FT_Error   error;
+    FTC_APage  page   = NULL;
+
+
+    if ( !cache->pages && FT_NEW_ARRAY( cache->pages, cache->max_pages ) )
+      goto Exit;
+
+    if ( FT_NEW( page ) )
+      goto Exit;
+
+    if ( FT_ALLOC( page->root.bitmap.buffer,
+                   (FT_ULong)cache->page_width * cache->page_rows ) )
+    {
+      FT_FREE( page );
+      goto Exit;
+    }
+
+    page->root.bitmap.width      = cache->page_width;
+    page->root.bitmap.rows       = cache->page_rows;
+    page->root.bitmap.pitch      = (int)cache->page_width;
+    page->root.bitmap.num_grays  = 256;
+    page->root.bitmap.pixel_mode = cache->pixel_mode;
+
+    cache->pages[cache->num_pages++] = page;
+
+  Exit:
+    *apage = page;
+    return error;
+  }
+
+
+  static void
+  ftc_apage_free( FTC_APage  page,
+                  FT_Memory  memory )
+  {
+    FT_FREE( page->shelves );
+    FT_FREE( page->root.bitmap.buffer );
+    FT_FREE( page );
+  }
+
+
+  /* Reserve `width' bytes in a shelf of at least `height' rows.  If   */
+  /* `any_fit' is not set, only shelves that don't waste too many rows */
+  /* are taken into account.                                           */
+  static FT_Bool
+  ftc_apage_alloc( FTC_ACache  cache,
+                   FTC_APage   page,
+                   FT_UInt     width,
+                   FT_UInt     height,
+                   FT_Bool     any_fit,
+                   FT_UInt    *ashelf )
+  {
+    FT_Memory   memory   = FTC_CACHE( cache )->memory;
+    FT_Error    error;
+    FT_UInt     max_rows = height + height / 2 + FTC_ATLAS_SHELF_ALIGN;
+    FT_UInt     best     = page->num_shelves;
+    FT_UInt     nn;
+    FTC_AShelf  shelf;
+
+
+    /* best fit in existing shelves */
+    for ( nn = 0; nn < page->num_shelves; nn++ )
+    {
+      shelf = page->shelves + nn;
+
+      if ( shelf->height < height                        ||
+           shelf->x + width > cache->page_width          ||
+           ( !any_fit && shelf->height > max_rows )      )
+        continue;
+
+      if ( best == page->num_shelves                     ||
+           shelf->height < page->shelves[best].height    )
+        best = nn;
+    }
+
+    if ( best < page->num_shelves )
+      goto Found;
+
+    /* open a new shelf at the bottom of the page */
+    {
+      FT_UInt  rows = FT_PAD_CEIL( height, FTC_ATLAS_SHELF_ALIGN );
+
+
+      if ( page->top + rows > cache->page_rows )
+        rows = cache->page_rows - page->top;
+
+      if ( rows >= height )
+      {
+        if ( page->num_shelves == page->max_shelves )
+        {
+          FT_UInt  new_max = page->max_shelves + 8;
+
+
+          if ( FT_RENEW_ARRAY( page->shelves,
+                               page->max_shelves, new_max ) )
+            return 0;
+          page->max_shelves = new_max;
+        }
+
+        shelf         = page->shelves + page->num_shelves++;
+        shelf->y      = page->top;
+        shelf->height = rows;
+        shelf->x      = 0;
+        shelf->count  = 0;
+
+        page->top += rows;
+        goto Found;
+      }
+    }
+
+    /* Merge a run of adjacent empty shelves.  Nodes refer to shelves */
+    /* by index, so the merged shelves stay in the array with a       */
+    /* height of zero.                                                */
+    for ( nn = 0; nn < page->num_shelves; nn++ )
+    {
+      FT_UInt  rows = 0;
+      FT_UInt  mm;
+
+
+      for ( mm = nn; mm < page->num_shelves; mm++ )
+      {
+        if ( page->shelves[mm].count )
+          break;
+
+        rows += page->shelves[mm].height;
+        if ( rows >= height )
+          break;
+      }
+
+      if ( rows >= height )
+      {
+        FTC_AShelf  next;
+
+
+        shelf         = page->shelves + nn;
+        shelf->height = rows;
+
+        for ( next = shelf + 1; next <= page->shelves + mm; next++ )
+        {
+          next->y      = shelf->y + rows;
+          next->height = 0;
+        }
+
+        best = nn;
+        goto Found;
+      }
+
+      nn = mm;
+    }
+
+    return 0;
+
+  Found:
+    *ashelf = best;
+    return 1;
+  }
+
+
+  /* Give back the space of a glyph; empty shelves at the bottom of */
+  /* the page are removed, an empty page starts over.               */
+  static void
+  ftc_apage_release( FTC_APage  page,
+                     FT_UInt    idx )
+  {
+    FTC_AShelf  shelf = page->shelves + idx;
+
+
+    if ( --shelf->count == 0 )
+      shelf->x = 0;
+
+    if ( --page->num_glyphs == 0 )
+    {
+      page->num_shelves = 0;
+      page->top         = 0;
+      return;
+    }
+
+    while ( page->num_shelves > 0                             &&
+            page->shelves[page->num_shelves - 1].count == 0   )
+    {
+      page->num_shelves--;
+      page->top = page->shelves[page->num_shelves].y;
+    }
+  }
+
+
+  /* Flush all unlocked glyphs of a page. */
+  static void
+  ftc_apage_evict( FTC_ACache  cache,
+                   FTC_APage   page )
+  {
+    FTC_Manager  manager = FTC_CACHE( cache )->manager;
+    FTC_Node     first   = manager->nodes_list;
+    FTC_Node     node;
+
+
+    if ( !first )
+      return;
+
+    FT_TRACE2(( "ftc_apage_evict: flushing %d glyphs of page %p\n",
+                page->num_glyphs, page ));
+
+    /* go to last node -- it's a circular list */
+    node = FTC_NODE_PREV( first );
+    for (;;)
+    {
+      FTC_Node  prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
+
+
+      if ( node->cache_index == FTC_CACHE( cache )->index         &&
+           FTC_ANODE( node )->glyph.page == &page->root          &&
+           !FTC_NODE_IS_LOCKED( node )                           )
+        ftc_node_destroy( node, manager );
+
+      if ( !prev || !page->num_glyphs )
+        break;
+
+      node = prev;
+    }
+  }
+
+
+  /* Find space for a `width' x `height' rectangle, creating a new page */
+  /* or evicting the least recently used one if necessary.              */
+  static FT_Error
+  ftc_acache_alloc( FTC_ACache  cache,
+                    FT_UInt     width,
+                    FT_UInt     height,
+                    FTC_APage  *apage,
+                    FT_UInt    *ashelf )
+  {
+    FT_Error   error;
+    FTC_APage  page;
+    FT_UInt    pass, nn;
+
+
+    for ( pass = 0; pass < 2; pass++ )
+    {
+      for ( nn = 0; nn < cache->num_pages; nn++ )
+      {
+        page = cache->pages[nn];
+        if ( ftc_apage_alloc( cache, page, width, height, pass, ashelf ) )
+          goto Found;
+      }
+    }
+
+    if ( cache->num_pages < cache->max_pages )
+    {
+      error = ftc_apage_new( cache, &page );
+      if ( error )
+        return error;
+
+      if ( ftc_apage_alloc( cache, page, width, height, 1, ashelf ) )
+        goto Found;
+    }
+
+    /* evict whole pages, least recently used first */
+    for ( nn = 0; nn < cache->num_pages; nn++ )
+    {
+      FT_UInt  mm;
+
+
+      page = cache->pages[0];
+      for ( mm = 1; mm < cache->num_pages; mm++ )
+        if ( cache->pages[mm]->stamp < page->stamp )
+          page = cache->pages[mm];
+
+      ftc_apage_evict( cache, page );
+      page->stamp = ++cache->clock;
+
+      if ( ftc_apage_alloc( cache, page, width, height, 1, ashelf ) )
+        goto Found;
+    }
+
+    /* everything is locked */
+    return FT_THROW( Out_Of_Memory );
+
+  Found:
+    *apage = page;
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_ACache_Setup( FTC_ACache      cache,
+                    FT_UInt         page_width,
+                    FT_UInt         page_rows,
+                    FT_UInt         max_pages,
+                    FT_Render_Mode  render_mode )
+  {
+    FT_Byte  pixel_mode;
+    FT_UInt  pad_x = FTC_ATLAS_PADDING;
+    FT_UInt  pad_y = FTC_ATLAS_PADDING;
+
+
+    if ( max_pages == 0 )
+      max_pages = FTC_ATLAS_DEFAULT_MAX_PAGES;
+
+    switch ( render_mode )
+    {
+    case FT_RENDER_MODE_LCD:
+      pixel_mode = FT_PIXEL_MODE_LCD;
+      pad_x     *= 3;
+      break;
+
+    case FT_RENDER_MODE_LCD_V:
+      pixel_mode = FT_PIXEL_MODE_LCD_V;
+      pad_y     *= 3;
+      break;
+
+    default:
+      pixel_mode = FT_PIXEL_MODE_GRAY;
+    }
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    {
+      FTC_Manager  manager = FTC_CACHE( cache )->manager;
+      FT_UInt      nn;
+
+
+      /* every shard gets an equal part of the pages */
+      if ( manager->num_shards )
+      {
+        FT_UInt  shard_pages = max_pages / manager->num_shards;
+
+
+        if ( shard_pages == 0 )
+          shard_pages = 1;
+
+        for ( nn = 0; nn < manager->num_shards; nn++ )
+          FTC_ACache_Setup(
+            FTC_ACACHE( manager->shards[nn]->caches[FTC_CACHE( cache )
+                                                      ->index] ),
+            page_width, page_rows, shard_pages, render_mode );
+      }
+    }
+#endif
+
+    cache->render_mode = render_mode;
+    cache->pixel_mode  = pixel_mode;
+    cache->page_width  = page_width;
+    cache->page_rows   = page_rows;
+    cache->pad_x       = pad_x;
+    cache->pad_y       = pad_y;
+    cache->max_pages   = max_pages;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  ftc_acache_init( FTC_Cache  ftccache )
+  {
+    FTC_ACache  cache = (FTC_ACache)ftccache;
+
+
+    cache->num_pages = 0;
+    cache->pages     = NULL;
+    cache->clock     = 0;
+
+    return ftc_gcache_init( ftccache );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  ftc_acache_done( FTC_Cache  ftccache )
+  {
+    FTC_ACache  cache  = (FTC_ACache)ftccache;
+    FT_Memory   memory = ftccache->memory;
+    FT_UInt     nn;
+
+
+    /* the nodes refer to the pages */
+    ftc_gcache_done( ftccache );
+
+    for ( nn = 0; nn < cache->num_pages; nn++ )
+      ftc_apage_free( cache->pages[nn], memory );
+
+    FT_FREE( cache->pages );
+    cache->num_pages = 0;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                     ATLAS CACHE NODES                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /* Copy a bitmap into a page; gray and monochrome bitmaps (for */
+  /* example, embedded ones) are stretched to fit LCD pages.     */
+  static void
+  ftc_apage_copy( FTC_APage   page,
+                  FT_UInt     x,
+                  FT_UInt     y,
+                  FT_Bitmap*  bitmap,
+                  FT_UInt     hrep,
+                  FT_UInt     vrep )
+  {
+    FT_Int    pitch = bitmap->pitch;
+    FT_Byte*  src   = bitmap->buffer;
+    FT_Byte*  dst   = page->root.bitmap.buffer +
+                        y * (FT_UInt)page->root.bitmap.pitch + x;
+    FT_UInt   max   = bitmap->num_grays > 1 ? bitmap->num_grays - 1U : 1U;
+    FT_UInt   row, col, n;
+
+
+    if ( pitch < 0 )
+      src -= pitch * (FT_Int)( bitmap->rows - 1 );
+
+    for ( row = 0; row < bitmap->rows; row++, src += pitch )
+    {
+      FT_Byte*  d = dst;
+
+
+      switch ( bitmap->pixel_mode )
+      {
+      case FT_PIXEL_MODE_MONO:
+        for ( col = 0; col < bitmap->width; col++ )
+        {
+          FT_Byte  v = ( src[col >> 3] & ( 0x80 >> ( col & 7 ) ) ) ? 255
+                                                                     : 0;
+
+
+          for ( n = 0; n < hrep; n++ )
+            *d++ = v;
+        }
+        break;
+
+      case FT_PIXEL_MODE_GRAY:
+        if ( hrep == 1 && max == 255 )
+        {
+          FT_MEM_COPY( d, src, bitmap->width );
+          break;
+        }
+
+        for ( col = 0; col < bitmap->width; col++ )
+        {
+          FT_Byte  v = (FT_Byte)( src[col] * 255U / max );
+
+
+          for ( n = 0; n < hrep; n++ )
+            *d++ = v;
+        }
+        break;
+
+      default:  /* LCD and LCD_V into pages of the same mode */
+        FT_MEM_COPY( d, src, bitmap->width );
+      }
+
+      for ( n = 1; n < vrep; n++ )
+        FT_MEM_COPY( dst + n * (FT_UInt)page->root.bitmap.pitch,
+                     dst,
+                     bitmap->width * hrep );
+
+      dst += vrep * (FT_UInt)page->root.bitmap.pitch;
+    }
+
+    page->root.generation++;
+  }
+
+
+  /* Put the bitmap of the glyph slot into a page, if possible.  Glyphs */
+  /* that can't be stored (empty, too large, or with an unsupported    */
+  /* pixel mode) are left without page.                                */
+  static FT_Error
+  ftc_anode_place( FTC_ANode   anode,
+                   FTC_ACache  cache,
+                   FT_Bitmap*  bitmap )
+  {
+    FT_Error    error;
+    FTC_APage   page;
+    FT_UInt     hrep  = 1;
+    FT_UInt     vrep  = 1;
+    FT_UInt     width, rows, idx, row;
+    FTC_AShelf  shelf;
+
+
+    switch ( bitmap->pixel_mode )
+    {
+    case FT_PIXEL_MODE_MONO:
+    case FT_PIXEL_MODE_GRAY:
+      if ( cache->pixel_mode == FT_PIXEL_MODE_LCD )
+        hrep = 3;
+      else if ( cache->pixel_mode == FT_PIXEL_MODE_LCD_V )
+        vrep = 3;
+      break;
+
+    case FT_PIXEL_MODE_LCD:
+    case FT_PIXEL_MODE_LCD_V:
+      if ( bitmap->pixel_mode == cache->pixel_mode )
+        break;
+      /* fall through */
+
+    default:
+      FT_TRACE2(( "ftc_anode_place: unsupported pixel mode %d\n",
+                  bitmap->pixel_mode ));
+      return FT_Err_Ok;
+    }
+
+    width = bitmap->width * hrep;
+    rows  = bitmap->rows * vrep;
+
+    if ( !width || !rows )
+      return FT_Err_Ok;
+
+    if ( width + cache->pad_x > cache->page_width ||
+         rows + cache->pad_y > cache->page_rows   ||
+         width > 0xFFFFU || rows > 0xFFFFU        )
+    {
+      FT_TRACE2(( "ftc_anode_place: glyph too large for atlas page\n" ));
+      return FT_Err_Ok;
+    }
+
+    error = ftc_acache_alloc( cache,
+                              width + cache->pad_x,
+                              rows + cache->pad_y,
+                              &page, &idx );
+    if ( error )
+      return error;
+
+    shelf = page->shelves + idx;
+
+    /* clear the whole slot, leaving padding and stale rows empty */
+    for ( row = 0; row < shelf->height; row++ )
+      FT_MEM_ZERO( page->root.bitmap.buffer +
+                     ( shelf->y + row ) *
+                       (FT_UInt)page->root.bitmap.pitch +
+                     shelf->x,
+                   width + cache->pad_x );
+
+    ftc_apage_copy( page, shelf->x, shelf->y, bitmap, hrep, vrep );
+
+    anode->glyph.page  = &page->root;
+    anode->glyph.x     = (FT_UShort)shelf->x;
+    anode->glyph.y     = (FT_UShort)shelf->y;
+    anode->glyph.width = (FT_UShort)width;
+    anode->glyph.rows  = (FT_UShort)rows;
+    anode->shelf       = idx;
+
+    shelf->x += width + cache->pad_x;
+    shelf->count++;
+    page->num_glyphs++;
+    page->stamp = ++cache->clock;
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  ftc_anode_free( FTC_Node   ftcanode,
+                  FTC_Cache  cache )
+  {
+    FTC_ANode  anode  = (FTC_ANode)ftcanode;
+    FT_Memory  memory = cache->memory;
+
+
+    if ( anode->glyph.page )
+    {
+      ftc_apage_release( FTC_APAGE( anode->glyph.page ), anode->shelf );
+      anode->glyph.page = NULL;
+    }
+
+    FTC_GNode_Done( FTC_GNODE( anode ), cache );
+    FT_FREE( anode );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_ANode_Free( FTC_ANode  anode,
+                  FTC_Cache  cache )
+  {
+    ftc_anode_free( FTC_NODE( anode ), cache );
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_ANode_New( FTC_ANode   *panode,
+                 FTC_GQuery   gquery,
+                 FTC_Cache    cache )
+  {
+    FT_Memory         memory = cache->memory;
+    FT_Error          error;
+    FTC_ANode         anode  = NULL;
+    FTC_Family        family = gquery->family;
+    FT_UInt           gindex = gquery->gindex;
+    FTC_AFamilyClass  clazz  = FTC_CACHE_AFAMILY_CLASS( cache );
+    FT_Face           face;
+    FT_GlyphSlot      slot;
+    FT_Pos            xadvance, yadvance;
+
+
+    if ( FT_NEW( anode ) )
+      goto Exit;
+
+    FTC_GNode_Init( FTC_GNODE( anode ), gindex, family );
+
+    error = clazz->family_load_glyph( family, gindex, cache->manager,
+                                      &face );
+    if ( error )
+      goto Fail;
+
+    slot = face->glyph;
+    if ( slot->format != FT_GLYPH_FORMAT_BITMAP )
+    {
+      error = FT_Render_Glyph( slot, FTC_ACACHE( cache )->render_mode );
+      if ( error )
+        goto Fail;
+    }
+
+    xadvance = ( slot->advance.x + 32 ) >> 6;
+    yadvance = ( slot->advance.y + 32 ) >> 6;
+
+    anode->glyph.left     = (FT_Short)slot->bitmap_left;
+    anode->glyph.top      = (FT_Short)slot->bitmap_top;
+    anode->glyph.xadvance = (FT_Short)xadvance;
+    anode->glyph.yadvance = (FT_Short)yadvance;
+
+    error = ftc_anode_place( anode, FTC_ACACHE( cache ), &slot->bitmap );
+    if ( !error )
+      goto Exit;
+
+  Fail:
+    FTC_ANode_Free( anode, cache );
+    anode = NULL;
+
+  Exit:
+    *panode = anode;
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  ftc_anode_new( FTC_Node   *ftcpanode,
+                 FT_Pointer  ftcgquery,
+                 FTC_Cache   cache )
+  {
+    FTC_ANode  *panode = (FTC_ANode*)ftcpanode;
+    FTC_GQuery  gquery = (FTC_GQuery)ftcgquery;
+
+
+    return FTC_ANode_New( panode, gquery, cache );
+  }
+
+
+  FT_LOCAL_DEF( FT_Offset )
+  ftc_anode_weight( FTC_Node   ftcanode,
+                    FTC_Cache  ftccache )
+  {
+    FTC_ANode   anode = (FTC_ANode)ftcanode;
+    FTC_ACache  cache = (FTC_ACache)ftccache;
+    FT_Offset   size  = sizeof ( *anode );
+
+
+    /* the page area taken by the glyph */
+    if ( anode->glyph.page )
+      size += (FT_Offset)( anode->glyph.width + cache->pad_x ) *
+                         ( anode->glyph.rows + cache->pad_y );
+
+    return size;
+  }
+
+
+  FT_LOCAL_DEF( FT_Bool )
+  ftc_anode_compare( FTC_Node    ftcanode,
+                     FT_Pointer  ftcgquery,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed )
+  {
+    FTC_ANode  anode = (FTC_ANode)ftcanode;
+    FT_Bool    result;
+
+
+    result = ftc_gnode_compare( ftcanode, ftcgquery, cache, list_changed );
+
+    /* keep track of the pages in use for eviction */
+    if ( result && anode->glyph.page )
+      FTC_APAGE( anode->glyph.page )->stamp = ++FTC_ACACHE( cache )->clock;
+
+    return result;
+  }
+
+
+/* END */
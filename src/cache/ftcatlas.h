@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * ftcatlas.h
+ *
+ *   FreeType glyph atlas cache (specification).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+  /**************************************************************************
+   *
+   * An atlas cache stores rendered glyphs in a few large pages instead of
+   * one heap block per glyph.  Each page is divided into horizontal
+   * `shelves'; a glyph goes into the best-fitting shelf with enough room
+   * left, or opens a new shelf at the bottom of the page.
+   *
+   * Space is reclaimed a shelf at a time: a shelf whose glyphs have all
+   * been flushed can be reused for new glyphs, and a page without glyphs
+   * starts over empty.  If all pages are full, the least recently used
+   * page gets evicted as a whole.
+   *
+   * FTC_ACache extends FTC_GCache.  For an implementation example, see
+   * FTC_AtlasCache in `src/cache/ftcbasic.c'.
+   *
+   */
+
+
+#ifndef FTCATLAS_H_
+#define FTCATLAS_H_
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcglyph.h"
+
+
+FT_BEGIN_HEADER
+
+
+  /* empty pixels to the right of and below every glyph, */
+  /* to avoid bleeding when the page is sampled          */
+#define FTC_ATLAS_PADDING  1
+
+  /* heights of new shelves are rounded up to this many rows */
+#define FTC_ATLAS_SHELF_ALIGN  4
+
+#define FTC_ATLAS_DEFAULT_MAX_PAGES  4
+
+
+  typedef struct  FTC_AShelfRec_
+  {
+    FT_UInt  y;       /* first row                         */
+    FT_UInt  height;  /* number of rows                    */
+    FT_UInt  x;       /* first free byte at the right side */
+    FT_UInt  count;   /* number of glyphs in the shelf     */
+
+  } FTC_AShelfRec, *FTC_AShelf;
+
+
+  typedef struct  FTC_APageRec_
+  {
+    FTC_AtlasPageRec  root;
+
+    FT_UInt           top;          /* first row not covered by a shelf */
+    FT_UInt           num_glyphs;
+    FT_ULong          stamp;        /* last use of one of its glyphs    */
+
+    FT_UInt           num_shelves;  /* sorted by `y'                    */
+    FT_UInt           max_shelves;
+    FTC_AShelf        shelves;
+
+  } FTC_APageRec, *FTC_APage;
+
+#define FTC_APAGE( x )  ( (FTC_APage)( x ) )
+
+
+  typedef struct  FTC_ACacheRec_
+  {
+    FTC_GCacheRec   gcache;
+
+    FT_Render_Mode  render_mode;
+    FT_Byte         pixel_mode;
+    FT_UInt         page_width;   /* in bytes */
+    FT_UInt         page_rows;
+    FT_UInt         pad_x;        /* in bytes */
+    FT_UInt         pad_y;
+
+    FT_UInt         max_pages;
+    FT_UInt         num_pages;
+    FTC_APage*      pages;        /* `max_pages' elements, lazily */
+    FT_ULong        clock;
+
+  } FTC_ACacheRec, *FTC_ACache;
+
+#define FTC_ACACHE( x )  ( (FTC_ACache)( x ) )
+
+
+  /* the atlas glyph node type - we store only 1 glyph per node */
+  typedef struct  FTC_ANodeRec_
+  {
+    FTC_GNodeRec       gnode;
+    FTC_AtlasGlyphRec  glyph;
+    FT_UInt            shelf;   /* index of the shelf in `glyph.page' */
+
+  } FTC_ANodeRec, *FTC_ANode;
+
+#define FTC_ANODE( x )         ( (FTC_ANode)( x ) )
+#define FTC_ANODE_GINDEX( x )  FTC_GNODE( x )->gindex
+#define FTC_ANODE_FAMILY( x )  FTC_GNODE( x )->family
+
+
+  /* Load a glyph into the face's glyph slot; the atlas cache renders */
+  /* it itself, using its own render mode.                            */
+  typedef FT_Error
+  (*FTC_AFamily_LoadGlyphFunc)( FTC_Family   family,
+                                FT_UInt      gindex,
+                                FTC_Manager  manager,
+                                FT_Face     *aface );
+
+  typedef struct  FTC_AFamilyClassRec_
+  {
+    FTC_MruListClassRec        clazz;
+    FTC_AFamily_LoadGlyphFunc  family_load_glyph;
+
+  } FTC_AFamilyClassRec;
+
+  typedef const FTC_AFamilyClassRec*  FTC_AFamilyClass;
+
+#define FTC_AFAMILY_CLASS( x )  ((FTC_AFamilyClass)(x))
+
+#define FTC_CACHE_AFAMILY_CLASS( x )  \
+          FTC_AFAMILY_CLASS( FTC_CACHE_GCACHE_CLASS( x )->family_class )
+
+
+  /* Set the page geometry of a new atlas cache and, in concurrent */
+  /* managers, of its clones in all shards.                        */
+  FT_LOCAL( void )
+  FTC_ACache_Setup( FTC_ACache      cache,
+                    FT_UInt         page_width,
+                    FT_UInt         page_rows,
+                    FT_UInt         max_pages,
+                    FT_Render_Mode  render_mode );
+
+  /* can be used as a @FTC_Node_FreeFunc */
+  FT_LOCAL( void )
+  FTC_ANode_Free( FTC_ANode  anode,
+                  FTC_Cache  cache );
+
+  /* Can be used as @FTC_Node_NewFunc.  `gquery.index' and `gquery.family'
+   * must be set correctly.  This function will call the `family_load_glyph'
+   * method, render the glyph, and copy it into one of the cache's pages.
+   */
+  FT_LOCAL( FT_Error )
+  FTC_ANode_New( FTC_ANode   *panode,
+                 FTC_GQuery   gquery,
+                 FTC_Cache    cache );
+
+
+ /* */
+
+FT_END_HEADER
+
+#endif /* FTCATLAS_H_ */
+
+
+/* END */
@@ -19,10 +19,13 @@
 #include <ft2build.h>
 #include FT_INTERNAL_OBJECTS_H
 #include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_STREAM_H
 #include FT_CACHE_H
 #include "ftcglyph.h"
 #include "ftcimage.h"
 #include "ftcsbits.h"
+#include "ftcatlas.h"
+#include "ftcsnap.h"
 
 #include "ftccback.h"
 #include "ftcerror.h"
@@ -150,6 +153,36 @@
   }
 
 
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_basic_family_load_slot( FTC_Family   ftcfamily,
+                              FT_UInt      gindex,
+                              FTC_Manager  manager,
+                              FT_Face     *aface )
+  {
+    FTC_BasicFamily  family = (FTC_BasicFamily)ftcfamily;
+    FT_Error         error;
+    FT_Size          size;
+
+
+    error = FTC_Manager_LookupSize( manager, &family->attrs.scaler, &size );
+    if ( !error )
+    {
+      FT_Face  face = size->face;
+
+
+      /* the caller renders the glyph itself */
+      error = FT_Load_Glyph(
+                face,
+                gindex,
+                (FT_Int)family->attrs.load_flags & ~FT_LOAD_RENDER );
+      if ( !error )
+        *aface = face;
+    }
+
+    return error;
+  }
+
+
   FT_CALLBACK_DEF( FT_Error )
   ftc_basic_family_load_glyph( FTC_Family  ftcfamily,
                                FT_UInt     gindex,
@@ -226,6 +259,120 @@
   }
 
 
+  /*
+   *
+   * batch lookups
+   *
+   */
+
+  /* Look up the nodes for `count' glyphs of the same image type, and   */
+  /* lock them in `nodes'.  The family is only looked up again if the   */
+  /* cache changes (which happens with shards), and a glyph that falls  */
+  /* into the node of its predecessor (in sbit caches, where a node     */
+  /* holds `items_per_node' glyphs) doesn't need a hash table lookup.   */
+  /* In case of error, no node is locked and `nodes' is cleared.        */
+  static FT_Error
+  ftc_basic_lookup_batch( FTC_Cache       cache,
+                          FTC_ImageType   type,
+                          const FT_UInt*  gindices,
+                          FT_UInt         count,
+                          FT_UInt         items_per_node,
+                          FTC_Node*       nodes )
+  {
+    FTC_BasicQueryRec  query;
+    FTC_Cache          fcache = NULL;  /* the cache `family' belongs to */
+    FTC_Family         family = NULL;
+    FTC_Node           node   = NULL;
+    FT_Offset          attr_hash;
+    FT_Error           error  = FT_Err_Ok;
+    FT_UInt            nn;
+
+
+    query.attrs.scaler.face_id = type->face_id;
+    query.attrs.scaler.width   = type->width;
+    query.attrs.scaler.height  = type->height;
+    query.attrs.load_flags     = (FT_UInt)type->flags;
+
+    query.attrs.scaler.pixel = 1;
+    query.attrs.scaler.x_res = 0;  /* make compilers happy */
+    query.attrs.scaler.y_res = 0;
+
+    attr_hash = FTC_BASIC_ATTR_HASH( &query.attrs );
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      FT_UInt    gindex = gindices[nn];
+      FT_Offset  hash   = attr_hash + gindex / items_per_node;
+      FTC_Cache  shard  = FTC_CACHE_LOCK_SHARD( cache, hash );
+      FT_Bool    list_changed;
+
+
+      query.gquery.gindex = gindex;
+
+      if ( shard != fcache )
+      {
+        FTC_MruNode  mrunode;
+
+
+        FTC_MRULIST_LOOKUP( &FTC_GCACHE( shard )->families, &query,
+                            mrunode, error );
+        if ( error )
+        {
+          FTC_CACHE_UNLOCK_SHARD( shard );
+          break;
+        }
+
+        fcache = shard;
+        family = FTC_FAMILY( mrunode );
+      }
+
+      query.gquery.family = family;
+
+      /* prevent the family from being destroyed too early when an */
+      /* out-of-memory condition occurs during node initialization */
+      family->num_nodes++;
+
+      if ( !node                                                     ||
+           node->hash != hash                                        ||
+           !shard->clazz.node_compare( node, &query, shard,
+                                       &list_changed )               )
+        FTC_CACHE_LOOKUP_CMP( shard, shard->clazz.node_compare,
+                              hash, &query, node, error );
+
+      if ( !error )
+        FTC_NODE_REF( node );
+
+      if ( --family->num_nodes == 0 )
+      {
+        FTC_FAMILY_FREE( family, shard );
+        fcache = NULL;
+      }
+
+      FTC_CACHE_UNLOCK_SHARD( shard );
+
+      if ( error )
+        break;
+
+      nodes[nn] = node;
+    }
+
+    if ( error )
+    {
+      FT_UInt  mm;
+
+
+      for ( mm = 0; mm < count; mm++ )
+      {
+        if ( mm < nn )
+          FTC_Node_Unref( nodes[mm], cache->manager );
+        nodes[mm] = NULL;
+      }
+    }
+
+    return error;
+  }
+
+
  /*
   *
   * basic image cache
@@ -291,6 +438,7 @@
     FTC_Node           node = 0; /* make compiler happy */
     FT_Error           error;
     FT_Offset          hash;
+    FTC_Cache          shard;
 
 
     /* some argument checks are delayed to `FTC_Cache_Lookup' */
@@ -328,8 +476,10 @@
 
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
 
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
 #if 1  /* inlining is about 50% faster! */
-    FTC_GCACHE_LOOKUP_CMP( cache,
+    FTC_GCACHE_LOOKUP_CMP( shard,
                            ftc_basic_family_compare,
                            FTC_GNode_Compare,
                            hash, gindex,
@@ -337,7 +487,7 @@
                            node,
                            error );
 #else
-    error = FTC_GCache_Lookup( FTC_GCACHE( cache ),
+    error = FTC_GCache_Lookup( FTC_GCACHE( shard ),
                                hash, gindex,
                                FTC_GQUERY( &query ),
                                &node );
@@ -349,10 +499,12 @@
       if ( anode )
       {
         *anode = node;
-        node->ref_count++;
+        FTC_NODE_REF( node );
       }
     }
 
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
   Exit:
     return error;
   }
@@ -372,6 +524,7 @@
     FTC_Node           node = 0; /* make compiler happy */
     FT_Error           error;
     FT_Offset          hash;
+    FTC_Cache          shard;
 
 
     /* some argument checks are delayed to `FTC_Cache_Lookup' */
@@ -403,7 +556,9 @@
 
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
 
-    FTC_GCACHE_LOOKUP_CMP( cache,
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
+    FTC_GCACHE_LOOKUP_CMP( shard,
                            ftc_basic_family_compare,
                            FTC_GNode_Compare,
                            hash, gindex,
@@ -417,15 +572,66 @@
       if ( anode )
       {
         *anode = node;
-        node->ref_count++;
+        FTC_NODE_REF( node );
       }
     }
 
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
   Exit:
     return error;
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_ImageCache_LookupBatch( FTC_ImageCache  cache,
+                              FTC_ImageType   type,
+                              const FT_UInt*  gindices,
+                              FT_UInt         count,
+                              FT_Glyph       *aglyphs,
+                              FTC_Node       *anodes )
+  {
+    FTC_Node*  nodes = anodes;
+    FT_Memory  memory;
+    FT_Error   error;
+    FT_UInt    nn;
+
+
+    if ( !cache || !type || !aglyphs || ( count && !gindices ) )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !count )
+      return FT_Err_Ok;
+
+    /* without `anodes', we still have to lock all nodes until */
+    /* the whole run is resolved                               */
+    memory = FTC_CACHE( cache )->memory;
+    if ( !nodes && FT_QNEW_ARRAY( nodes, count ) )
+      return error;
+
+    error = ftc_basic_lookup_batch( FTC_CACHE( cache ), type,
+                                    gindices, count, 1, nodes );
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      FTC_Node  node = nodes[nn];
+
+
+      aglyphs[nn] = error ? NULL : FTC_INODE( node )->glyph;
+
+      if ( nodes != anodes )
+        FTC_Node_Unref( node, FTC_CACHE( cache )->manager );
+    }
+
+    if ( nodes != anodes )
+      FT_FREE( nodes );
+
+    return error;
+  }
+
+
   /*
    *
    * basic small bitmap cache
@@ -491,6 +697,7 @@
     FTC_BasicQueryRec  query;
     FTC_Node           node = 0; /* make compiler happy */
     FT_Offset          hash;
+    FTC_Cache          shard;
 
 
     if ( anode )
@@ -528,8 +735,10 @@
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) +
            gindex / FTC_SBIT_ITEMS_PER_NODE;
 
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
 #if 1  /* inlining is about 50% faster! */
-    FTC_GCACHE_LOOKUP_CMP( cache,
+    FTC_GCACHE_LOOKUP_CMP( shard,
                            ftc_basic_family_compare,
                            FTC_SNode_Compare,
                            hash, gindex,
@@ -537,25 +746,26 @@
                            node,
                            error );
 #else
-    error = FTC_GCache_Lookup( FTC_GCACHE( cache ),
+    error = FTC_GCache_Lookup( FTC_GCACHE( shard ),
                                hash,
                                gindex,
                                FTC_GQUERY( &query ),
                                &node );
 #endif
-    if ( error )
-      goto Exit;
-
-    *ansbit = FTC_SNODE( node )->sbits +
-              ( gindex - FTC_GNODE( node )->gindex );
-
-    if ( anode )
+    if ( !error )
     {
-      *anode = node;
-      node->ref_count++;
+      *ansbit = FTC_SNODE( node )->sbits +
+                ( gindex - FTC_GNODE( node )->gindex );
+
+      if ( anode )
+      {
+        *anode = node;
+        FTC_NODE_REF( node );
+      }
     }
 
-  Exit:
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
     return error;
   }
 
@@ -574,6 +784,7 @@
     FTC_BasicQueryRec  query;
     FTC_Node           node = 0; /* make compiler happy */
     FT_Offset          hash;
+    FTC_Cache          shard;
 
 
     if ( anode )
@@ -605,26 +816,464 @@
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) +
              gindex / FTC_SBIT_ITEMS_PER_NODE;
 
-    FTC_GCACHE_LOOKUP_CMP( cache,
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
+    FTC_GCACHE_LOOKUP_CMP( shard,
                            ftc_basic_family_compare,
                            FTC_SNode_Compare,
                            hash, gindex,
                            &query,
                            node,
                            error );
+    if ( !error )
+    {
+      *ansbit = FTC_SNODE( node )->sbits +
+                ( gindex - FTC_GNODE( node )->gindex );
+
+      if ( anode )
+      {
+        *anode = node;
+        FTC_NODE_REF( node );
+      }
+    }
+
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_SBitCache_LookupBatch( FTC_SBitCache   cache,
+                             FTC_ImageType   type,
+                             const FT_UInt*  gindices,
+                             FT_UInt         count,
+                             FTC_SBit       *asbits,
+                             FTC_Node       *anodes )
+  {
+    FTC_Node*  nodes = anodes;
+    FT_Memory  memory;
+    FT_Error   error;
+    FT_UInt    nn;
+
+
+    if ( !cache || !type || !asbits || ( count && !gindices ) )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !count )
+      return FT_Err_Ok;
+
+    /* without `anodes', we still have to lock all nodes until */
+    /* the whole run is resolved                               */
+    memory = FTC_CACHE( cache )->memory;
+    if ( !nodes && FT_QNEW_ARRAY( nodes, count ) )
+      return error;
+
+    error = ftc_basic_lookup_batch( FTC_CACHE( cache ), type,
+                                    gindices, count,
+                                    FTC_SBIT_ITEMS_PER_NODE, nodes );
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      FTC_Node  node = nodes[nn];
+
+
+      asbits[nn] = error ? NULL
+                         : FTC_SNODE( node )->sbits +
+                             ( gindices[nn] - FTC_GNODE( node )->gindex );
+
+      if ( nodes != anodes )
+        FTC_Node_Unref( node, FTC_CACHE( cache )->manager );
+    }
+
+    if ( nodes != anodes )
+      FT_FREE( nodes );
+
+    return error;
+  }
+
+
+  static void
+  ftc_basic_sbit_snapshot_node( FTC_Node      node,
+                                FTC_Cache     cache,
+                                FTC_Snapshot  snap )
+  {
+    FTC_SNode        snode  = FTC_SNODE( node );
+    FTC_BasicFamily  family = (FTC_BasicFamily)FTC_SNODE_FAMILY( node );
+    FTC_Scaler       scaler = &family->attrs.scaler;
+    FTC_SBit         sbit   = snode->sbits;
+    FT_UInt          face   = FTC_Snapshot_AddFace( snap, scaler->face_id );
+    FT_UInt          nn;
+
+    FT_UNUSED( cache );
+
+
+    for ( nn = 0; nn < snode->count; nn++, sbit++ )
+    {
+      /* skip bitmaps not loaded yet */
+      if ( !sbit->buffer && sbit->width == 255 )
+        continue;
+
+      FTC_Snapshot_PutShort( snap, face );
+      FTC_Snapshot_PutByte( snap, scaler->pixel != 0 );
+      FTC_Snapshot_PutByte( snap, 0 );
+      FTC_Snapshot_PutLong( snap, scaler->width );
+      FTC_Snapshot_PutLong( snap, scaler->height );
+      FTC_Snapshot_PutLong( snap, scaler->x_res );
+      FTC_Snapshot_PutLong( snap, scaler->y_res );
+      FTC_Snapshot_PutLong( snap, family->attrs.load_flags );
+      FTC_Snapshot_PutLong( snap, FTC_SNODE_GINDEX( node ) + nn );
+
+      FTC_Snapshot_PutByte( snap, sbit->width );
+      FTC_Snapshot_PutByte( snap, sbit->height );
+      FTC_Snapshot_PutByte( snap, (FT_Byte)sbit->left );
+      FTC_Snapshot_PutByte( snap, (FT_Byte)sbit->top );
+      FTC_Snapshot_PutByte( snap, sbit->format );
+      FTC_Snapshot_PutByte( snap, sbit->max_grays );
+      FTC_Snapshot_PutByte( snap, (FT_Byte)sbit->pitch );
+      FTC_Snapshot_PutByte( snap, (FT_Byte)sbit->xadvance );
+      FTC_Snapshot_PutByte( snap, (FT_Byte)sbit->yadvance );
+      FTC_Snapshot_PutByte( snap, 0 );
+
+      FTC_Snapshot_PutBytes( snap, sbit->buffer,
+                             (FT_ULong)FT_ABS( sbit->pitch ) * sbit->height );
+
+      snap->num_records++;
+    }
+  }
+
+
+  /* check that the rows of a bitmap from a snapshot are wide enough */
+  static FT_Bool
+  ftc_basic_sbit_check( FTC_SBit  sbit )
+  {
+    FT_UInt  width = sbit->width;
+    FT_UInt  pitch = (FT_UInt)FT_ABS( sbit->pitch );
+
+
+    if ( !sbit->height )
+      return 1;
+
+    switch ( sbit->format )
+    {
+    case FT_PIXEL_MODE_MONO:
+      return FT_BOOL( pitch >= ( width + 7 ) >> 3 );
+
+    case FT_PIXEL_MODE_GRAY2:
+      return FT_BOOL( pitch >= ( width + 3 ) >> 2 );
+
+    case FT_PIXEL_MODE_GRAY4:
+      return FT_BOOL( pitch >= ( width + 1 ) >> 1 );
+
+    case FT_PIXEL_MODE_GRAY:
+    case FT_PIXEL_MODE_LCD:
+    case FT_PIXEL_MODE_LCD_V:
+      return FT_BOOL( pitch >= width );
+
+    case FT_PIXEL_MODE_BGRA:
+      return FT_BOOL( pitch >= width * 4 );
+
+    default:
+      return 0;
+    }
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_SBitCache_SaveSnapshot( FTC_SBitCache   cache,
+                              FT_Byte*       *abuffer,
+                              FT_ULong       *asize )
+  {
+    FTC_SnapshotRec  snap;
+
+
+    if ( !cache || !abuffer || !asize )
+      return FT_THROW( Invalid_Argument );
+
+    FTC_Snapshot_Init( &snap, FTC_CACHE( cache )->memory );
+    FTC_Snapshot_Walk( &snap, FTC_CACHE( cache ),
+                       ftc_basic_sbit_snapshot_node );
+
+    return FTC_Snapshot_Finish( &snap, FTC_CACHE( cache ),
+                                FTC_SNAPSHOT_KIND_SBITS, abuffer, asize );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_SBitCache_LoadSnapshot( FTC_SBitCache      cache,
+                              const FT_Byte*     buffer,
+                              FT_ULong           size,
+                              const FTC_FaceID*  face_ids,
+                              FT_UInt            num_face_ids )
+  {
+    FTC_SnapshotReaderRec  reader;
+    FT_Stream              stream = &reader.stream;
+    FT_Error               error;
+    FT_UInt                nn;
+
+
+    if ( !cache || !buffer || ( num_face_ids && !face_ids ) )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_Snapshot_Open( &reader, FTC_CACHE( cache ), buffer, size,
+                               FTC_SNAPSHOT_KIND_SBITS,
+                               face_ids, num_face_ids );
     if ( error )
-      goto Exit;
+      return error;
+
+    for ( nn = 0; nn < reader.num_records; nn++ )
+    {
+      FTC_BasicQueryRec  query;
+      FTC_SBitRec        sbit;
+      FTC_FaceID         face_id;
+      FT_Bool            matched;
+      FT_Byte            pixel;
+      FT_ULong           width, height, x_res, y_res, load_flags, gindex;
+      FT_Byte            left, top, pitch, xadvance, yadvance;
+      const FT_Byte*     data;
+      FT_Offset          hash;
+      FTC_Cache          shard;
+      FTC_MruNode        mrunode;
+
+
+      if ( FT_SET_ERROR( FTC_Snapshot_ReadFace( &reader,
+                                                &face_id, &matched ) ) ||
+           FT_READ_BYTE( pixel )                                      ||
+           FT_STREAM_SKIP( 1 )                                        ||
+           FT_READ_ULONG( width )                                     ||
+           FT_READ_ULONG( height )                                    ||
+           FT_READ_ULONG( x_res )                                     ||
+           FT_READ_ULONG( y_res )                                     ||
+           FT_READ_ULONG( load_flags )                                ||
+           FT_READ_ULONG( gindex )                                    ||
+           FT_READ_BYTE( sbit.width )                                 ||
+           FT_READ_BYTE( sbit.height )                                ||
+           FT_READ_BYTE( left )                                       ||
+           FT_READ_BYTE( top )                                        ||
+           FT_READ_BYTE( sbit.format )                                ||
+           FT_READ_BYTE( sbit.max_grays )                             ||
+           FT_READ_BYTE( pitch )                                      ||
+           FT_READ_BYTE( xadvance )                                   ||
+           FT_READ_BYTE( yadvance )                                   ||
+           FT_STREAM_SKIP( 1 )                                        )
+        break;
+
+      sbit.left     = (FT_Char)left;
+      sbit.top      = (FT_Char)top;
+      sbit.pitch    = (FT_Char)pitch;
+      sbit.xadvance = (FT_Char)xadvance;
+      sbit.yadvance = (FT_Char)yadvance;
+
+      if ( FT_SET_ERROR( FTC_Snapshot_ReadBytes(
+                           &reader,
+                           (FT_ULong)FT_ABS( sbit.pitch ) * sbit.height,
+                           &data ) ) )
+        break;
+
+      if ( !ftc_basic_sbit_check( &sbit ) || gindex > FT_UINT_MAX )
+      {
+        error = FT_THROW( Invalid_File_Format );
+        break;
+      }
+
+      if ( !matched )
+        continue;
+
+      sbit.buffer = (FT_Byte*)data;
+
+      query.attrs.scaler.face_id = face_id;
+      query.attrs.scaler.width   = (FT_UInt)width;
+      query.attrs.scaler.height  = (FT_UInt)height;
+      query.attrs.scaler.pixel   = pixel;
+      query.attrs.scaler.x_res   = (FT_UInt)x_res;
+      query.attrs.scaler.y_res   = (FT_UInt)y_res;
+      query.attrs.load_flags     = (FT_UInt)load_flags;
+      query.gquery.gindex        = (FT_UInt)gindex;
+
+      hash = FTC_BASIC_ATTR_HASH( &query.attrs ) +
+               query.gquery.gindex / FTC_SBIT_ITEMS_PER_NODE;
+
+      shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
+      FTC_MRULIST_LOOKUP( &FTC_GCACHE( shard )->families, &query,
+                          mrunode, error );
+      if ( !error )
+      {
+        FTC_Family  family = FTC_FAMILY( mrunode );
+
+
+        query.gquery.family = family;
+
+        family->num_nodes++;
+        error = FTC_SNode_Preload( shard, FTC_GQUERY( &query ),
+                                   hash, &sbit );
+        if ( --family->num_nodes == 0 )
+          FTC_FAMILY_FREE( family, shard );
+      }
+
+      FTC_CACHE_UNLOCK_SHARD( shard );
+
+      /* glyph indices beyond the face's glyph count can't be cached */
+      if ( FT_ERR_EQ( error, Invalid_Argument ) )
+        error = FT_Err_Ok;
+
+      if ( error )
+        break;
+    }
+
+    FTC_Snapshot_Close( &reader );
+
+    return error;
+  }
+
+
+  /*
+   *
+   * basic glyph atlas cache
+   *
+   */
+
+  static
+  const FTC_AFamilyClassRec  ftc_basic_atlas_family_class =
+  {
+    {
+      sizeof ( FTC_BasicFamilyRec ),
+      ftc_basic_family_compare,     /* FTC_MruNode_CompareFunc  node_compare */
+      ftc_basic_family_init,        /* FTC_MruNode_InitFunc     node_init    */
+      NULL,                         /* FTC_MruNode_ResetFunc    node_reset   */
+      NULL                          /* FTC_MruNode_DoneFunc     node_done    */
+    },
+
+    ftc_basic_family_load_slot
+  };
+
+
+  static
+  const FTC_GCacheClassRec  ftc_basic_atlas_cache_class =
+  {
+    {
+      ftc_anode_new,                  /* FTC_Node_NewFunc      node_new           */
+      ftc_anode_weight,               /* FTC_Node_WeightFunc   node_weight        */
+      ftc_anode_compare,              /* FTC_Node_CompareFunc  node_compare       */
+      ftc_basic_gnode_compare_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
+      ftc_anode_free,                 /* FTC_Node_FreeFunc     node_free          */
+
+      sizeof ( FTC_ACacheRec ),
+      ftc_acache_init,                /* FTC_Cache_InitFunc    cache_init         */
+      ftc_acache_done                 /* FTC_Cache_DoneFunc    cache_done         */
+    },
+
+    (FTC_MruListClass)&ftc_basic_atlas_family_class
+  };
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_AtlasCache_New( FTC_Manager      manager,
+                      FT_UInt          page_width,
+                      FT_UInt          page_rows,
+                      FT_UInt          max_pages,
+                      FT_Render_Mode   render_mode,
+                      FTC_AtlasCache  *acache )
+  {
+    FT_Error    error;
+    FTC_GCache  gcache;
+
+
+    if ( !acache )
+      return FT_THROW( Invalid_Argument );
+
+    *acache = NULL;
+
+    if ( page_width == 0 || page_width > 0xFFFFU ||
+         page_rows == 0  || page_rows > 0xFFFFU  )
+      return FT_THROW( Invalid_Argument );
+
+    if ( render_mode != FT_RENDER_MODE_NORMAL &&
+         render_mode != FT_RENDER_MODE_LIGHT  &&
+         render_mode != FT_RENDER_MODE_LCD    &&
+         render_mode != FT_RENDER_MODE_LCD_V  )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_GCache_New( manager, &ftc_basic_atlas_cache_class,
+                            &gcache );
+    if ( !error )
+    {
+      FTC_ACache_Setup( FTC_ACACHE( gcache ),
+                        page_width, page_rows, max_pages, render_mode );
+
+      *acache = (FTC_AtlasCache)gcache;
+    }
+
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_AtlasCache_Lookup( FTC_AtlasCache   cache,
+                         FTC_ImageType    type,
+                         FT_UInt          gindex,
+                         FTC_AtlasGlyph  *aglyph,
+                         FTC_Node        *anode )
+  {
+    FTC_BasicQueryRec  query;
+    FTC_Node           node = 0; /* make compiler happy */
+    FT_Error           error;
+    FT_Offset          hash;
+    FTC_Cache          shard;
 
-    *ansbit = FTC_SNODE( node )->sbits +
-              ( gindex - FTC_GNODE( node )->gindex );
 
     if ( anode )
+      *anode = NULL;
+
+    /* other argument checks delayed to `FTC_Cache_Lookup' */
+    if ( !aglyph || !type )
+      return FT_THROW( Invalid_Argument );
+
+    *aglyph = NULL;
+
+    query.attrs.scaler.face_id = type->face_id;
+    query.attrs.scaler.width   = type->width;
+    query.attrs.scaler.height  = type->height;
+    query.attrs.load_flags     = (FT_UInt)type->flags;
+
+    query.attrs.scaler.pixel = 1;
+    query.attrs.scaler.x_res = 0;  /* make compilers happy */
+    query.attrs.scaler.y_res = 0;
+
+    hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
+
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
+
+    FTC_GCACHE_LOOKUP_CMP( shard,
+                           ftc_basic_family_compare,
+                           ftc_anode_compare,
+                           hash, gindex,
+                           &query,
+                           node,
+                           error );
+    if ( !error )
     {
-      *anode = node;
-      node->ref_count++;
+      *aglyph = &FTC_ANODE( node )->glyph;
+
+      if ( anode )
+      {
+        *anode = node;
+        FTC_NODE_REF( node );
+      }
     }
 
-  Exit:
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
     return error;
   }
 
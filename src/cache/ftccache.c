@@ -44,46 +44,288 @@
   /*************************************************************************/
   /*************************************************************************/
 
-  /* add a new node to the head of the manager's circular MRU list */
+  static FT_Offset
+  ftc_node_weight( FTC_Node     node,
+                   FTC_Manager  manager )
+  {
+    FTC_Cache  cache = manager->caches[node->cache_index];
+
+
+    return cache->clazz.node_weight( node, cache );
+  }
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* The frequency sketch used by the TinyLFU policy is a count-min sketch */
+  /* with four rows of saturating 4-bit counters (stored in bytes).  All   */
+  /* counters are halved periodically so that old popularity fades away.  */
+  /*                                                                       */
+
+#define FTC_SKETCH_MAX_COUNT  15
+
+  static const FT_UInt32  ftc_sketch_seeds[4] =
+  {
+    0x9E3779B1UL, 0x85EBCA77UL, 0xC2B2AE3DUL, 0x27D4EB2FUL
+  };
+
+
+  static FT_UInt32
+  ftc_sketch_key( FTC_Node  node )
+  {
+    /* nodes of different caches may have the same hash value */
+    return (FT_UInt32)node->hash + (FT_UInt32)node->cache_index * 0x10001UL;
+  }
+
+
+  static FT_UInt
+  ftc_sketch_estimate( FTC_Manager  manager,
+                       FTC_Node     node )
+  {
+    FT_UInt32  key   = ftc_sketch_key( node );
+    FT_UInt    width = manager->sketch_mask + 1;
+    FT_UInt    n, count = FTC_SKETCH_MAX_COUNT;
+
+
+    for ( n = 0; n < 4; n++ )
+    {
+      FT_UInt32  h = key * ftc_sketch_seeds[n];
+      FT_Byte*   p = manager->sketch + n * width +
+                       ( ( h ^ ( h >> 16 ) ) & manager->sketch_mask );
+
+
+      if ( *p < count )
+        count = *p;
+    }
+
+    return count;
+  }
+
+
+  static void
+  ftc_sketch_record( FTC_Manager  manager,
+                     FTC_Node     node )
+  {
+    FT_UInt32  key   = ftc_sketch_key( node );
+    FT_UInt    width = manager->sketch_mask + 1;
+    FT_UInt    n;
+
+
+    for ( n = 0; n < 4; n++ )
+    {
+      FT_UInt32  h = key * ftc_sketch_seeds[n];
+      FT_Byte*   p = manager->sketch + n * width +
+                       ( ( h ^ ( h >> 16 ) ) & manager->sketch_mask );
+
+
+      if ( *p < FTC_SKETCH_MAX_COUNT )
+        (*p)++;
+    }
+
+    /* age all counters after `10 * width' recorded accesses */
+    if ( ++manager->sketch_count >= 10 * width )
+    {
+      FT_Byte*  p     = manager->sketch;
+      FT_Byte*  limit = p + 4 * width;
+
+
+      for ( ; p < limit; p++ )
+        *p >>= 1;
+
+      manager->sketch_count /= 2;
+    }
+  }
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* The MRU list.  Unless the policy is plain LRU, it is segmented: the   */
+  /* protected nodes come first, followed by the probationary ones,        */
+  /* starting with `manager->probation'.                                   */
+  /*                                                                       */
+
+  /* insert a node before `next', or at the tail if `next' is NULL */
+  static void
+  ftc_node_mru_insert( FTC_Node     node,
+                       FTC_Node     next,
+                       FTC_Manager  manager )
+  {
+    FTC_MruNode  list    = (FTC_MruNode)( next ? next
+                                               : manager->nodes_list );
+    FT_Bool      at_head = FT_BOOL( next == manager->nodes_list );
+
+
+    /* this links `node' before the first node of `list' */
+    FTC_MruNode_Prepend( &list, (FTC_MruNode)node );
+
+    if ( at_head )
+      manager->nodes_list = node;
+  }
+
+
+  /* remove a node from the manager's MRU list, keeping the segments */
   static void
-  ftc_node_mru_link( FTC_Node     node,
-                     FTC_Manager  manager )
+  ftc_node_mru_remove( FTC_Node     node,
+                       FTC_Manager  manager )
   {
-    void  *nl = &manager->nodes_list;
+    FTC_MruNode  list = (FTC_MruNode)manager->nodes_list;
+
+
+    if ( node == manager->probation )
+    {
+      FTC_Node  next = FTC_NODE_NEXT( node );
+
 
+      manager->probation = ( next == node                ||
+                             next == manager->nodes_list ) ? NULL : next;
+    }
+
+    FTC_MruNode_Remove( &list, (FTC_MruNode)node );
+
+    manager->nodes_list = FTC_NODE( list );
+  }
+
+
+  /* add a new node to the manager's circular MRU list -- at its head, */
+  /* or at the head of the probationary segment                        */
+  static void
+  ftc_node_mru_link( FTC_Node   node,
+                     FTC_Cache  cache )
+  {
+    FTC_Manager  manager = cache->manager;
+    FT_Offset    weight  = cache->clazz.node_weight( node, cache );
+
+
+    node->flags = 0;
+
+    if ( manager->policy == FTC_EVICTION_LRU )
+    {
+      void  *nl = &manager->nodes_list;
+
+
+      FTC_MruNode_Prepend( (FTC_MruNode*)nl,
+                           (FTC_MruNode)node );
+    }
+    else
+    {
+      ftc_node_mru_insert( node, manager->probation, manager );
+      manager->probation = node;
+
+      if ( manager->sketch )
+        ftc_sketch_record( manager, node );
+    }
 
-    FTC_MruNode_Prepend( (FTC_MruNode*)nl,
-                         (FTC_MruNode)node );
     manager->num_nodes++;
+    manager->cur_weight += weight;
+    cache->cur_weight   += weight;
   }
 
 
   /* remove a node from the manager's MRU list */
   static void
-  ftc_node_mru_unlink( FTC_Node     node,
-                       FTC_Manager  manager )
+  ftc_node_mru_unlink( FTC_Node   node,
+                       FTC_Cache  cache )
   {
-    void  *nl = &manager->nodes_list;
+    FTC_Manager  manager = cache->manager;
+    FT_Offset    weight  = cache->clazz.node_weight( node, cache );
 
 
-    FTC_MruNode_Remove( (FTC_MruNode*)nl,
-                        (FTC_MruNode)node );
+    if ( node->flags & FTC_NODE_FLAG_PROTECTED )
+      manager->cur_protected -= weight;
+
+    if ( node == manager->rejected )
+      manager->rejected = NULL;
+
+    ftc_node_mru_remove( node, manager );
+
     manager->num_nodes--;
+    manager->cur_weight -= weight;
+    cache->cur_weight   -= weight;
   }
 
 
-#ifndef FTC_INLINE
+  /* documentation is in ftccache.h */
 
-  /* move a node to the head of the manager's MRU list */
-  static void
-  ftc_node_mru_up( FTC_Node     node,
-                   FTC_Manager  manager )
+  FT_LOCAL_DEF( void )
+  ftc_node_mru_up( FTC_Node   node,
+                   FTC_Cache  cache )
   {
-    FTC_MruNode_Up( (FTC_MruNode*)&manager->nodes_list,
-                    (FTC_MruNode)node );
+    FTC_Manager  manager = cache->manager;
+    void*        nl      = &manager->nodes_list;
+
+
+    if ( manager->policy == FTC_EVICTION_LRU )
+    {
+      if ( node != manager->nodes_list )
+        FTC_MruNode_Up( (FTC_MruNode*)nl,
+                        (FTC_MruNode)node );
+      return;
+    }
+
+    if ( manager->sketch )
+      ftc_sketch_record( manager, node );
+
+    if ( node == manager->rejected )
+      manager->rejected = NULL;
+
+    /* a hit promotes a probationary node into the protected segment */
+    if ( !( node->flags & FTC_NODE_FLAG_PROTECTED ) )
+    {
+      if ( node == manager->probation )
+      {
+        FTC_Node  next = FTC_NODE_NEXT( node );
+
+
+        manager->probation = ( next == manager->nodes_list ) ? NULL : next;
+      }
+
+      node->flags            |= FTC_NODE_FLAG_PROTECTED;
+      manager->cur_protected += cache->clazz.node_weight( node, cache );
+    }
+
+    if ( node != manager->nodes_list )
+      FTC_MruNode_Up( (FTC_MruNode*)nl,
+                      (FTC_MruNode)node );
+
+    /* if the protected segment is too large, demote its tail; */
+    /* this simply moves the segment boundary                  */
+    while ( manager->cur_protected > manager->max_protected )
+    {
+      FTC_Node  last = FTC_NODE_PREV( manager->probation
+                                        ? manager->probation
+                                        : manager->nodes_list );
+
+
+      if ( last == node || !( last->flags & FTC_NODE_FLAG_PROTECTED ) )
+        break;
+
+      last->flags            &= ~FTC_NODE_FLAG_PROTECTED;
+      manager->cur_protected -= ftc_node_weight( last, manager );
+      manager->probation      = last;
+    }
   }
 
 
+  /* documentation is in ftccache.h */
+
+  FT_LOCAL_DEF( void )
+  ftc_node_add_weight( FTC_Node   node,
+                       FTC_Cache  cache,
+                       FT_Offset  size )
+  {
+    FTC_Manager  manager = cache->manager;
+
+
+    if ( node->flags & FTC_NODE_FLAG_PROTECTED )
+      manager->cur_protected += size;
+
+    manager->cur_weight += size;
+    cache->cur_weight   += size;
+  }
+
+
+#ifndef FTC_INLINE
+
   /* get a top bucket for specified hash from cache,
    * body for FTC_NODE_TOP_FOR_HASH( cache, hash )
    */
@@ -295,10 +537,8 @@
     }
 #endif
 
-    manager->cur_weight -= cache->clazz.node_weight( node, cache );
-
     /* remove node from mru list */
-    ftc_node_mru_unlink( node, manager );
+    ftc_node_mru_unlink( node, cache );
 
     /* remove node from cache's hash table */
     ftc_node_hash_unlink( node, cache );
@@ -352,9 +592,8 @@
   {
     if ( cache && cache->buckets )
     {
-      FTC_Manager  manager = cache->manager;
-      FT_UFast     i;
-      FT_UFast     count;
+      FT_UFast  i;
+      FT_UFast  count;
 
 
       count = cache->p + cache->mask + 1;
@@ -370,11 +609,9 @@
           node->link  = NULL;
 
           /* remove node from mru list */
-          ftc_node_mru_unlink( node, manager );
+          ftc_node_mru_unlink( node, cache );
 
           /* now finalize it */
-          manager->cur_weight -= cache->clazz.node_weight( node, cache );
-
           cache->clazz.node_free( node, cache );
           node = next;
         }
@@ -412,31 +649,125 @@
   }
 
 
+  /* Evict the least recently used nodes of a cache until it fits */
+  /* into its quota.                                               */
+  static void
+  ftc_cache_compress( FTC_Cache  cache )
+  {
+    FTC_Manager  manager = cache->manager;
+    FTC_Node     first   = manager->nodes_list;
+    FTC_Node     node;
+
+
+    /* go to last node -- it's a circular list */
+    node = FTC_NODE_PREV( first );
+    do
+    {
+      FTC_Node  prev;
+
+
+      prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
+
+      if ( node->cache_index == cache->index &&
+           !FTC_NODE_IS_LOCKED( node )       )
+        ftc_node_destroy( node, manager );
+
+      node = prev;
+
+    } while ( node && cache->cur_weight > cache->max_weight );
+  }
+
+
+  /* TinyLFU admission: a new node is only worth the nodes it would */
+  /* evict if it is accessed more often than all of them together.  */
+  /* This keeps large, rarely used nodes from flushing many small,  */
+  /* popular ones.                                                  */
+  static FT_Bool
+  ftc_node_admit( FTC_Node     node,
+                  FTC_Manager  manager )
+  {
+    FT_UInt    freq   = ftc_sketch_estimate( manager, node );
+    FT_UInt    total  = 0;
+    FT_Offset  excess = manager->cur_weight - manager->max_weight;
+    FT_Offset  freed  = 0;
+    FTC_Node   first  = manager->nodes_list;
+    FTC_Node   victim = FTC_NODE_PREV( first );
+    FT_UInt    count;
+
+
+    for ( count = 0; count < FTC_ADMIT_MAX_VICTIMS; count++ )
+    {
+      if ( victim != node && !FTC_NODE_IS_LOCKED( victim ) )
+      {
+        total += ftc_sketch_estimate( manager, victim );
+        if ( total >= freq )
+          return 0;
+
+        freed += ftc_node_weight( victim, manager );
+        if ( freed >= excess )
+          return 1;
+      }
+
+      if ( victim == first )
+        break;
+
+      victim = FTC_NODE_PREV( victim );
+    }
+
+    return 1;
+  }
+
+
+  /* A rejected node is still returned to the caller but placed at  */
+  /* the tail, from where it is evicted when the next node is added. */
+  static void
+  ftc_node_reject( FTC_Node     node,
+                   FTC_Manager  manager )
+  {
+    FTC_Node  prev = manager->rejected;
+
+
+    if ( prev && !FTC_NODE_IS_LOCKED( prev ) )
+      ftc_node_destroy( prev, manager );
+
+    ftc_node_mru_remove( node, manager );
+    ftc_node_mru_insert( node, NULL, manager );
+    if ( !manager->probation )
+      manager->probation = node;
+
+    manager->rejected = node;
+  }
+
+
   static void
   ftc_cache_add( FTC_Cache  cache,
                  FT_Offset  hash,
                  FTC_Node   node )
   {
+    FTC_Manager  manager = cache->manager;
+
+
     node->hash        = hash;
-    node->cache_index = (FT_UInt16)cache->index;
+    node->cache_index = (FT_Byte)cache->index;
     node->ref_count   = 0;
 
     ftc_node_hash_link( node, cache );
-    ftc_node_mru_link( node, cache->manager );
-
-    {
-      FTC_Manager  manager = cache->manager;
+    ftc_node_mru_link( node, cache );
 
+    FTC_NODE_REF( node );
 
-      manager->cur_weight += cache->clazz.node_weight( node, cache );
+    if ( cache->max_weight && cache->cur_weight > cache->max_weight )
+      ftc_cache_compress( cache );
 
-      if ( manager->cur_weight >= manager->max_weight )
-      {
-        node->ref_count++;
+    if ( manager->cur_weight >= manager->max_weight )
+    {
+      if ( manager->sketch && !ftc_node_admit( node, manager ) )
+        ftc_node_reject( node, manager );
+      else
         FTC_Manager_Compress( manager );
-        node->ref_count--;
-      }
     }
+
+    FTC_NODE_UNREF( node );
   }
 
 
@@ -477,6 +808,15 @@
   }
 
 
+  FT_LOCAL_DEF( void )
+  FTC_Cache_AddNode( FTC_Cache  cache,
+                     FT_Offset  hash,
+                     FTC_Node   node )
+  {
+    ftc_cache_add( cache, hash, node );
+  }
+
+
 #ifndef FTC_INLINE
 
   FT_LOCAL_DEF( FT_Error )
@@ -542,13 +882,8 @@
     }
 
     /* move to head of MRU list */
-    {
-      FTC_Manager  manager = cache->manager;
+    ftc_node_mru_up( node, cache );
 
-
-      if ( node != manager->nodes_list )
-        ftc_node_mru_up( node, manager );
-    }
     *anode = node;
 
     return error;
@@ -560,13 +895,57 @@
 #endif /* !FTC_INLINE */
 
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+  FT_LOCAL_DEF( FTC_Cache )
+  FTC_Cache_LockShard( FTC_Cache  cache,
+                       FT_Offset  hash )
+  {
+    FTC_Manager  shard;
+
+
+    if ( !cache || !cache->manager->num_shards )
+      return cache;
+
+    shard = FTC_MANAGER_SHARD( cache->manager, hash );
+    FTC_Mutex_Lock( shard->lock );
+
+    return shard->caches[cache->index];
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Cache_UnlockShard( FTC_Cache  cache )
+  {
+    FTC_Manager  shard;
+
+
+    if ( !cache )
+      return;
+
+    shard = cache->manager;
+    if ( !shard->lease )
+      return;
+
+    /* the lease has been taken by a node creation, if at all */
+    if ( shard->lease_held )
+    {
+      shard->lease_held = 0;
+      FTC_Mutex_Unlock( shard->lease->lock );
+    }
+
+    FTC_Mutex_Unlock( shard->lock );
+  }
+
+#endif /* FTC_CONFIG_OPTION_CONCURRENT */
+
+
   FT_LOCAL_DEF( void )
   FTC_Cache_RemoveFaceID( FTC_Cache   cache,
                           FTC_FaceID  face_id )
   {
-    FT_UFast     i, count;
-    FTC_Manager  manager = cache->manager;
-    FTC_Node     frees   = NULL;
+    FT_UFast  i, count;
+    FTC_Node  frees = NULL;
 
 
     count = cache->p + cache->mask + 1;
@@ -606,8 +985,7 @@
       node  = frees;
       frees = node->link;
 
-      manager->cur_weight -= cache->clazz.node_weight( node, cache );
-      ftc_node_mru_unlink( node, manager );
+      ftc_node_mru_unlink( node, cache );
 
       cache->clazz.node_free( node, cache );
 
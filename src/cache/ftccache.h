@@ -21,6 +21,7 @@
 
 
 #include "ftcmru.h"
+#include "ftcsync.h"
 
 FT_BEGIN_HEADER
 
@@ -60,18 +61,40 @@ FT_BEGIN_HEADER
     FTC_MruNodeRec  mru;          /* circular mru list pointer           */
     FTC_Node        link;         /* used for hashing                    */
     FT_Offset       hash;         /* used for hashing too                */
-    FT_UShort       cache_index;  /* index of cache the node belongs to  */
+    FT_Byte         cache_index;  /* index of cache the node belongs to  */
+    FT_Byte         flags;        /* see FTC_NODE_FLAG_XXX below         */
     FT_Short        ref_count;    /* reference count for this node       */
 
   } FTC_NodeRec;
 
 
+  /* the node is in the protected segment of the manager's MRU list */
+#define FTC_NODE_FLAG_PROTECTED  1
+
+
 #define FTC_NODE( x )    ( (FTC_Node)(x) )
 #define FTC_NODE_P( x )  ( (FTC_Node*)(x) )
 
 #define FTC_NODE_NEXT( x )  FTC_NODE( (x)->mru.next )
 #define FTC_NODE_PREV( x )  FTC_NODE( (x)->mru.prev )
 
+  /* reference counts are released without holding any lock */
+  /* in concurrent managers, thus these must be atomic       */
+#define FTC_NODE_REF( x )        FTC_ATOMIC_INC( &(x)->ref_count )
+#define FTC_NODE_UNREF( x )      FTC_ATOMIC_DEC( &(x)->ref_count )
+#define FTC_NODE_IS_LOCKED( x )  ( FTC_ATOMIC_GET( &(x)->ref_count ) > 0 )
+
+  /* move a node to the head of the manager's MRU list after a hit */
+  FT_LOCAL( void )
+  ftc_node_mru_up( FTC_Node   node,
+                   FTC_Cache  cache );
+
+  /* account for data added to a node after its creation */
+  FT_LOCAL( void )
+  ftc_node_add_weight( FTC_Node   node,
+                       FTC_Cache  cache,
+                       FT_Offset  size );
+
 #ifdef FTC_INLINE
 #define FTC_NODE_TOP_FOR_HASH( cache, hash )                      \
         ( ( cache )->buckets +                                    \
@@ -155,6 +178,9 @@ FT_BEGIN_HEADER
 
     FTC_CacheClass     org_class;   /* original class pointer */
 
+    FT_Offset          max_weight;  /* quota; 0~if none        */
+    FT_Offset          cur_weight;
+
   } FTC_CacheRec;
 
 
@@ -190,6 +216,13 @@ FT_BEGIN_HEADER
                      FT_Pointer  query,
                      FTC_Node   *anode );
 
+  /* Add a node created by other means than `node_new', e.g., from a */
+  /* snapshot.  Like `FTC_Cache_NewNode', it returns it unlocked.    */
+  FT_LOCAL( void )
+  FTC_Cache_AddNode( FTC_Cache  cache,
+                     FT_Offset  hash,
+                     FTC_Node   node );
+
   /* Remove all nodes that relate to a given face_id.  This is useful
    * when un-installing fonts.  Note that if a cache node relates to
    * the face_id but is locked (i.e., has `ref_count > 0'), the node
@@ -205,6 +238,31 @@ FT_BEGIN_HEADER
                           FTC_FaceID  face_id );
 
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+  /* Return the cache that holds the nodes for `hash'.  For caches of a */
+  /* concurrent manager, this is the cache's clone in the corresponding */
+  /* shard, which is returned locked; otherwise it is `cache' itself.   */
+  FT_LOCAL( FTC_Cache )
+  FTC_Cache_LockShard( FTC_Cache  cache,
+                       FT_Offset  hash );
+
+  /* unlock a cache returned by `FTC_Cache_LockShard' */
+  FT_LOCAL( void )
+  FTC_Cache_UnlockShard( FTC_Cache  cache );
+
+#define FTC_CACHE_LOCK_SHARD( cache, hash )                 \
+          FTC_Cache_LockShard( FTC_CACHE( cache ), (hash) )
+#define FTC_CACHE_UNLOCK_SHARD( cache )  FTC_Cache_UnlockShard( cache )
+
+#else /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+#define FTC_CACHE_LOCK_SHARD( cache, hash )  FTC_CACHE( cache )
+#define FTC_CACHE_UNLOCK_SHARD( cache )      FT_DUMMY_STMNT
+
+#endif /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+
 #ifdef FTC_INLINE
 
 #define FTC_CACHE_LOOKUP_CMP( cache, nodecmp, hash, query, node, error ) \
@@ -269,7 +327,9 @@ FT_BEGIN_HEADER
       void*        _nl      = &_manager->nodes_list;                     \
                                                                          \
                                                                          \
-      if ( _node != _manager->nodes_list )                               \
+      if ( _manager->policy != FTC_EVICTION_LRU )                        \
+        ftc_node_mru_up( _node, _cache );                                \
+      else if ( _node != _manager->nodes_list )                          \
         FTC_MruNode_Up( (FTC_MruNode*)_nl,                               \
                         (FTC_MruNode)_node );                            \
     }                                                                    \
@@ -25,6 +25,7 @@
 #include "ftcmanag.h"
 #include "ftcglyph.h"
 #include "ftcsbits.h"
+#include "ftcatlas.h"
 
 
   FT_LOCAL( void )
@@ -61,6 +62,32 @@
                      FT_Bool*    list_changed );
 
 
+  FT_LOCAL( void )
+  ftc_anode_free( FTC_Node   anode,
+                  FTC_Cache  cache );
+
+  FT_LOCAL( FT_Error )
+  ftc_anode_new( FTC_Node   *panode,
+                 FT_Pointer  gquery,
+                 FTC_Cache   cache );
+
+  FT_LOCAL( FT_Offset )
+  ftc_anode_weight( FTC_Node   anode,
+                    FTC_Cache  cache );
+
+  FT_LOCAL( FT_Bool )
+  ftc_anode_compare( FTC_Node    anode,
+                     FT_Pointer  gquery,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed );
+
+  FT_LOCAL( FT_Error )
+  ftc_acache_init( FTC_Cache  cache );
+
+  FT_LOCAL( void )
+  ftc_acache_done( FTC_Cache  cache );
+
+
   FT_LOCAL( FT_Bool )
   ftc_gnode_compare( FTC_Node    gnode,
                      FT_Pointer  gquery,
@@ -23,6 +23,8 @@
 #include FT_INTERNAL_MEMORY_H
 #include FT_INTERNAL_OBJECTS_H
 #include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_STREAM_H
+#include "ftcsnap.h"
 
 #include "ftccback.h"
 #include "ftcerror.h"
@@ -36,22 +38,36 @@
    * Each FTC_CMapNode contains a simple array to map a range of character
    * codes to equivalent glyph indices.
    *
-   * For now, the implementation is very basic: Each node maps a range of
-   * 128 consecutive character codes to their corresponding glyph indices.
-   *
-   * We could do more complex things, but I don't think it is really very
-   * useful.
+   * Each node maps a block of consecutive character codes to their
+   * corresponding glyph indices.  The block size is a property of the
+   * cache, 128 by default.  When the first unknown character of a block
+   * is looked up, the whole block is filled in a single pass over the
+   * charmap, using its `char_next' method.
    *
    */
 
 
-  /* number of glyph indices / character code per node */
+  /* default number of glyph indices / character code per node */
 #define FTC_CMAP_INDICES_MAX  128
 
+  /* maximum number of glyph indices / character code per node */
+#define FTC_CMAP_BLOCK_SIZE_MAX  16384
+
   /* compute a query/node hash */
-#define FTC_CMAP_HASH( faceid, index, charcode )         \
-          ( FTC_FACE_ID_HASH( faceid ) + 211 * (index) + \
-            ( (charcode) / FTC_CMAP_INDICES_MAX )      )
+#define FTC_CMAP_HASH( faceid, index, charcode, block_size )  \
+          ( FTC_FACE_ID_HASH( faceid ) + 211 * (index) +      \
+            ( (charcode) / (block_size) )                   )
+
+
+  /* the charmap cache */
+  typedef struct  FTC_CMapCacheRec_
+  {
+    FTC_CacheRec  cache;
+    FT_UInt       block_size;  /* character codes per node */
+
+  } FTC_CMapCacheRec;
+
+#define FTC_CMAP_CACHE( x )  ((FTC_CMapCacheRec*)(x))
 
   /* the charmap query */
   typedef struct  FTC_CMapQueryRec_
@@ -70,8 +86,9 @@
     FTC_NodeRec  node;
     FTC_FaceID   face_id;
     FT_UInt      cmap_index;
-    FT_UInt32    first;                         /* first character in node */
-    FT_UInt16    indices[FTC_CMAP_INDICES_MAX]; /* array of glyph indices  */
+    FT_UInt32    first;    /* first character in node                */
+    FT_UInt16*   indices;  /* `block_size' glyph indices, allocated   */
+                           /* together with the node                  */
 
   } FTC_CMapNodeRec, *FTC_CMapNode;
 
@@ -114,17 +131,18 @@
     FT_Error       error;
     FT_Memory      memory = cache->memory;
     FTC_CMapNode   node   = NULL;
+    FT_UInt        count  = FTC_CMAP_CACHE( cache )->block_size;
     FT_UInt        nn;
 
 
-    if ( !FT_NEW( node ) )
+    if ( !FT_ALLOC( node, sizeof ( *node ) + count * sizeof ( FT_UInt16 ) ) )
     {
       node->face_id    = query->face_id;
       node->cmap_index = query->cmap_index;
-      node->first      = (query->char_code / FTC_CMAP_INDICES_MAX) *
-                         FTC_CMAP_INDICES_MAX;
+      node->first      = ( query->char_code / count ) * count;
+      node->indices    = (FT_UInt16*)( node + 1 );
 
-      for ( nn = 0; nn < FTC_CMAP_INDICES_MAX; nn++ )
+      for ( nn = 0; nn < count; nn++ )
         node->indices[nn] = FTC_CMAP_UNKNOWN;
     }
 
@@ -139,9 +157,9 @@
                         FTC_Cache  cache )
   {
     FT_UNUSED( cnode );
-    FT_UNUSED( cache );
 
-    return sizeof ( *cnode );
+    return sizeof ( FTC_CMapNodeRec ) +
+             FTC_CMAP_CACHE( cache )->block_size * sizeof ( FT_UInt16 );
   }
 
 
@@ -154,7 +172,6 @@
   {
     FTC_CMapNode   node  = (FTC_CMapNode)ftcnode;
     FTC_CMapQuery  query = (FTC_CMapQuery)ftcquery;
-    FT_UNUSED( cache );
 
 
     if ( list_changed )
@@ -165,7 +182,7 @@
       FT_UInt32  offset = (FT_UInt32)( query->char_code - node->first );
 
 
-      return FT_BOOL( offset < FTC_CMAP_INDICES_MAX );
+      return FT_BOOL( offset < FTC_CMAP_CACHE( cache )->block_size );
     }
 
     return 0;
@@ -189,6 +206,63 @@
   }
 
 
+  /* Fill all glyph indices of a node from `cmap', which may be NULL.  */
+  /* Instead of searching every character code, we enumerate only the */
+  /* mapped ones; `char_next' is incremental for the common TrueType   */
+  /* formats.                                                          */
+  static void
+  ftc_cmap_node_fill( FTC_CMapNode  node,
+                      FT_UInt       count,
+                      FT_CMap       cmap,
+                      FT_Face       face )
+  {
+    FT_UInt32  char_code = node->first;
+    FT_UInt32  offset    = 0;
+    FT_UInt    gindex    = 0;
+    FT_UInt    nn;
+
+
+    if ( !cmap || !cmap->clazz->char_next )
+    {
+      for ( nn = 0; nn < count; nn++ )
+      {
+        gindex = cmap ? cmap->clazz->char_index( cmap, node->first + nn )
+                      : 0;
+        if ( gindex >= (FT_UInt)face->num_glyphs )
+          gindex = 0;
+
+        node->indices[nn] = (FT_UInt16)gindex;
+      }
+      return;
+    }
+
+    /* `char_next' only reports codes after its argument */
+    gindex = cmap->clazz->char_index( cmap, char_code );
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      if ( nn == offset )
+      {
+        if ( gindex >= (FT_UInt)face->num_glyphs )
+          gindex = 0;
+
+        node->indices[nn] = (FT_UInt16)gindex;
+
+        /* find the next mapped character code within the block */
+        if ( nn + 1 < count )
+        {
+          gindex = cmap->clazz->char_next( cmap, &char_code );
+          offset = (FT_UInt32)( char_code - node->first );
+          if ( !gindex || offset >= count || offset <= nn )
+            offset = count;
+        }
+      }
+      else
+        node->indices[nn] = 0;
+    }
+  }
+
+
   /*************************************************************************/
   /*************************************************************************/
   /*****                                                               *****/
@@ -198,6 +272,15 @@
   /*************************************************************************/
 
 
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_cmap_cache_init( FTC_Cache  cache )
+  {
+    FTC_CMAP_CACHE( cache )->block_size = FTC_CMAP_INDICES_MAX;
+
+    return ftc_cache_init( cache );
+  }
+
+
   static
   const FTC_CacheClassRec  ftc_cmap_cache_class =
   {
@@ -207,8 +290,8 @@
     ftc_cmap_node_remove_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
     ftc_cmap_node_free,          /* FTC_Node_FreeFunc     node_free          */
 
-    sizeof ( FTC_CacheRec ),
-    ftc_cache_init,              /* FTC_Cache_InitFunc    cache_init         */
+    sizeof ( FTC_CMapCacheRec ),
+    ftc_cmap_cache_init,         /* FTC_Cache_InitFunc    cache_init         */
     ftc_cache_done,              /* FTC_Cache_DoneFunc    cache_done         */
   };
 
@@ -225,6 +308,68 @@
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_CMapCache_NewWithBlockSize( FTC_Manager     manager,
+                                  FT_UInt         block_size,
+                                  FT_UInt         max_nodes,
+                                  FTC_CMapCache  *acache )
+  {
+    FT_Error   error;
+    FTC_Cache  cache;
+
+
+    if ( !acache )
+      return FT_THROW( Invalid_Argument );
+
+    *acache = NULL;
+
+    if ( block_size == 0 )
+      block_size = FTC_CMAP_INDICES_MAX;
+
+    if ( block_size > FTC_CMAP_BLOCK_SIZE_MAX )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_Manager_RegisterCache( manager,
+                                       &ftc_cmap_cache_class,
+                                       &cache );
+    if ( error )
+      return error;
+
+    /* the new cache is still empty */
+    FTC_CMAP_CACHE( cache )->block_size = block_size;
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    {
+      FT_UInt  nn;
+
+
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+        FTC_CMAP_CACHE( manager->shards[nn]->caches[cache->index] )
+          ->block_size = block_size;
+    }
+#endif
+
+    if ( max_nodes )
+    {
+      FT_ULong  weight = ftc_cmap_node_weight( NULL, cache );
+      FT_ULong  quota  = FT_ULONG_MAX;
+
+
+      if ( max_nodes < FT_ULONG_MAX / weight )
+        quota = max_nodes * weight;
+
+      error = FTC_Manager_SetCacheQuota( manager, cache, quota );
+    }
+
+    if ( !error )
+      *acache = (FTC_CMapCache)cache;
+
+    return error;
+  }
+
+
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( FT_UInt )
@@ -239,6 +384,7 @@
     FT_Error          error;
     FT_UInt           gindex = 0;
     FT_Offset         hash;
+    FTC_Cache         shard;
     FT_Int            no_cmap_change = 0;
 
 
@@ -263,64 +409,220 @@
     query.cmap_index = (FT_UInt)cmap_index;
     query.char_code  = char_code;
 
-    hash = FTC_CMAP_HASH( face_id, (FT_UInt)cmap_index, char_code );
+    hash = FTC_CMAP_HASH( face_id, (FT_UInt)cmap_index, char_code,
+                          FTC_CMAP_CACHE( cache )->block_size );
+
+    shard = FTC_CACHE_LOCK_SHARD( cache, hash );
 
 #if 1
-    FTC_CACHE_LOOKUP_CMP( cache, ftc_cmap_node_compare, hash, &query,
+    FTC_CACHE_LOOKUP_CMP( shard, ftc_cmap_node_compare, hash, &query,
                           node, error );
 #else
-    error = FTC_Cache_Lookup( cache, hash, &query, &node );
+    error = FTC_Cache_Lookup( shard, hash, &query, &node );
 #endif
     if ( error )
       goto Exit;
 
     FT_ASSERT( (FT_UInt)( char_code - FTC_CMAP_NODE( node )->first ) <
-                FTC_CMAP_INDICES_MAX );
+                FTC_CMAP_CACHE( shard )->block_size );
 
     /* something rotten can happen with rogue clients */
     if ( (FT_UInt)( char_code - FTC_CMAP_NODE( node )->first >=
-                    FTC_CMAP_INDICES_MAX ) )
-      return 0; /* XXX: should return appropriate error */
+                    FTC_CMAP_CACHE( shard )->block_size ) )
+      goto Exit; /* XXX: should return appropriate error */
 
     gindex = FTC_CMAP_NODE( node )->indices[char_code -
                                             FTC_CMAP_NODE( node )->first];
     if ( gindex == FTC_CMAP_UNKNOWN )
     {
-      FT_Face  face;
+      FT_Face     face;
+      FT_CharMap  cmap = NULL;
 
 
       gindex = 0;
 
-      error = FTC_Manager_LookupFace( cache->manager,
+      error = FTC_Manager_LookupFace( shard->manager,
                                       FTC_CMAP_NODE( node )->face_id,
                                       &face );
       if ( error )
         goto Exit;
 
       if ( (FT_UInt)cmap_index < (FT_UInt)face->num_charmaps )
+        cmap = no_cmap_change ? face->charmap : face->charmaps[cmap_index];
+
+      /* fill the whole block, not only `char_code' */
+      ftc_cmap_node_fill( FTC_CMAP_NODE( node ),
+                          FTC_CMAP_CACHE( shard )->block_size,
+                          FT_CMAP( cmap ), face );
+
+      gindex = FTC_CMAP_NODE( node )->indices[char_code -
+                                              FTC_CMAP_NODE( node )->first];
+    }
+
+  Exit:
+    FTC_CACHE_UNLOCK_SHARD( shard );
+
+    return gindex;
+  }
+
+
+  static void
+  ftc_cmap_snapshot_node( FTC_Node      ftcnode,
+                          FTC_Cache     cache,
+                          FTC_Snapshot  snap )
+  {
+    FTC_CMapNode  node  = (FTC_CMapNode)ftcnode;
+    FT_UInt       count = FTC_CMAP_CACHE( cache )->block_size;
+    FT_UInt       nn;
+
+
+    for ( nn = 0; nn < count; nn++ )
+      if ( node->indices[nn] != FTC_CMAP_UNKNOWN )
+        break;
+
+    if ( nn == count )
+      return;
+
+    FTC_Snapshot_PutShort( snap, FTC_Snapshot_AddFace( snap,
+                                                       node->face_id ) );
+    FTC_Snapshot_PutShort( snap, count );
+    FTC_Snapshot_PutLong( snap, node->cmap_index );
+    FTC_Snapshot_PutLong( snap, node->first );
+
+    for ( nn = 0; nn < count; nn++ )
+      FTC_Snapshot_PutShort( snap, node->indices[nn] );
+
+    snap->num_records++;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_CMapCache_SaveSnapshot( FTC_CMapCache   cmap_cache,
+                              FT_Byte*       *abuffer,
+                              FT_ULong       *asize )
+  {
+    FTC_Cache        cache = FTC_CACHE( cmap_cache );
+    FTC_SnapshotRec  snap;
+
+
+    if ( !cache || !abuffer || !asize )
+      return FT_THROW( Invalid_Argument );
+
+    FTC_Snapshot_Init( &snap, cache->memory );
+    FTC_Snapshot_Walk( &snap, cache, ftc_cmap_snapshot_node );
+
+    return FTC_Snapshot_Finish( &snap, cache, FTC_SNAPSHOT_KIND_CMAP,
+                                abuffer, asize );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_CMapCache_LoadSnapshot( FTC_CMapCache      cmap_cache,
+                              const FT_Byte*     buffer,
+                              FT_ULong           size,
+                              const FTC_FaceID*  face_ids,
+                              FT_UInt            num_face_ids )
+  {
+    FTC_Cache              cache  = FTC_CACHE( cmap_cache );
+    FTC_SnapshotReaderRec  reader;
+    FT_Stream              stream = &reader.stream;
+    FT_Error               error;
+    FT_UInt                nn;
+
+
+    if ( !cache || !buffer || ( num_face_ids && !face_ids ) )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_Snapshot_Open( &reader, cache, buffer, size,
+                               FTC_SNAPSHOT_KIND_CMAP,
+                               face_ids, num_face_ids );
+    if ( error )
+      return error;
+
+    for ( nn = 0; nn < reader.num_records; nn++ )
+    {
+      FTC_CMapQueryRec  query;
+      FTC_FaceID        face_id;
+      FT_Bool           matched;
+      FT_UShort         count;
+      FT_ULong          cmap_index, first;
+      const FT_Byte*    indices;
+      FT_UInt           mm;
+
+
+      if ( FT_SET_ERROR( FTC_Snapshot_ReadFace( &reader,
+                                                &face_id, &matched ) ) ||
+           FT_READ_USHORT( count )                                    ||
+           FT_READ_ULONG( cmap_index )                                ||
+           FT_READ_ULONG( first )                                     ||
+           FT_SET_ERROR( FTC_Snapshot_ReadBytes( &reader,
+                                                 2 * (FT_ULong)count,
+                                                 &indices ) )         )
+        break;
+
+      if ( !count                                    ||
+           first > 0xFFFFFFFFUL - ( count - 1U )         ||
+           cmap_index > 0xFFFFU                          )
       {
-        FT_CharMap  old, cmap  = NULL;
+        error = FT_THROW( Invalid_File_Format );
+        break;
+      }
+
+      if ( !matched )
+        continue;
+
+      query.face_id    = face_id;
+      query.cmap_index = (FT_UInt)cmap_index;
+
+      /* the range may span several nodes */
+      for ( mm = 0; mm < count && !error; )
+      {
+        FTC_Node      node;
+        FTC_CMapNode  cnode;
+        FT_Offset     hash;
+        FTC_Cache     shard;
+
+
+        query.char_code = (FT_UInt32)( first + mm );
 
+        hash  = FTC_CMAP_HASH( face_id, query.cmap_index, query.char_code,
+                               FTC_CMAP_CACHE( cache )->block_size );
+        shard = FTC_CACHE_LOCK_SHARD( cache, hash );
 
-        old  = face->charmap;
-        cmap = face->charmaps[cmap_index];
+        FTC_CACHE_LOOKUP_CMP( shard, ftc_cmap_node_compare, hash, &query,
+                              node, error );
+        if ( !error )
+        {
+          cnode = FTC_CMAP_NODE( node );
 
-        if ( old != cmap && !no_cmap_change )
-          FT_Set_Charmap( face, cmap );
+          for ( ; mm < count; mm++ )
+          {
+            FT_UInt32  offset = (FT_UInt32)( first + mm - cnode->first );
 
-        gindex = FT_Get_Char_Index( face, char_code );
 
-        if ( old != cmap && !no_cmap_change )
-          FT_Set_Charmap( face, old );
+            if ( offset >= FTC_CMAP_CACHE( shard )->block_size )
+              break;
+
+            /* keep the indices that are already known */
+            if ( cnode->indices[offset] == FTC_CMAP_UNKNOWN )
+              cnode->indices[offset] = FT_PEEK_USHORT( indices + 2 * mm );
+          }
+        }
+
+        FTC_CACHE_UNLOCK_SHARD( shard );
       }
 
-      FTC_CMAP_NODE( node )->indices[char_code -
-                                     FTC_CMAP_NODE( node )->first]
-        = (FT_UShort)gindex;
+      if ( error )
+        break;
     }
 
-  Exit:
-    return gindex;
+    FTC_Snapshot_Close( &reader );
+
+    return error;
   }
 
 
@@ -31,6 +31,45 @@
 #define FT_COMPONENT  trace_cache
 
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+  /* Calls that modify the library (i.e., opening and closing faces) */
+  /* must be serialized across all sub-managers of a concurrent one. */
+#define FTC_MANAGER_LOCK_LIBRARY( manager )             \
+          FT_BEGIN_STMNT                                \
+            if ( (manager)->root->lock )                \
+              FTC_Mutex_Lock( (manager)->root->lock );  \
+          FT_END_STMNT
+
+#define FTC_MANAGER_UNLOCK_LIBRARY( manager )             \
+          FT_BEGIN_STMNT                                  \
+            if ( (manager)->root->lock )                  \
+              FTC_Mutex_Unlock( (manager)->root->lock );  \
+          FT_END_STMNT
+
+
+  /* A shard creating a node borrows faces and sizes from its lease; */
+  /* the lease stays locked until the shard itself gets unlocked.    */
+  static FTC_Manager
+  ftc_manager_take_lease( FTC_Manager  shard )
+  {
+    if ( !shard->lease_held )
+    {
+      FTC_Mutex_Lock( shard->lease->lock );
+      shard->lease_held = 1;
+    }
+
+    return shard->lease;
+  }
+
+#else /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+#define FTC_MANAGER_LOCK_LIBRARY( manager )    FT_DUMMY_STMNT
+#define FTC_MANAGER_UNLOCK_LIBRARY( manager )  FT_DUMMY_STMNT
+
+#endif /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+
   static FT_Error
   ftc_scaler_lookup_size( FTC_Manager  manager,
                           FTC_Scaler   scaler,
@@ -192,6 +231,11 @@
     if ( !manager )
       return FT_THROW( Invalid_Cache_Handle );
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    if ( manager->lease )
+      manager = ftc_manager_take_lease( manager );
+#endif
+
 #ifdef FTC_INLINE
 
     FTC_MRULIST_LOOKUP_CMP( &manager->sizes, scaler, ftc_size_node_compare,
@@ -240,10 +284,12 @@
 
     node->face_id = face_id;
 
+    FTC_MANAGER_LOCK_LIBRARY( manager );
     error = manager->request_face( face_id,
                                    manager->library,
                                    manager->request_data,
                                    &node->face );
+    FTC_MANAGER_UNLOCK_LIBRARY( manager );
     if ( !error )
     {
       /* destroy initial size object; it will be re-created later */
@@ -270,7 +316,9 @@
                                  node->face_id );
 
     /* all right, we can discard the face now */
+    FTC_MANAGER_LOCK_LIBRARY( manager );
     FT_Done_Face( node->face );
+    FTC_MANAGER_UNLOCK_LIBRARY( manager );
     node->face    = NULL;
     node->face_id = NULL;
   }
@@ -319,6 +367,11 @@
     if ( !manager )
       return FT_THROW( Invalid_Cache_Handle );
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    if ( manager->lease )
+      manager = ftc_manager_take_lease( manager );
+#endif
+
     /* we break encapsulation for the sake of speed */
 #ifdef FTC_INLINE
 
@@ -388,6 +441,10 @@
     manager->request_face = requester;
     manager->request_data = req_data;
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    manager->root         = manager;
+#endif
+
     FTC_MruList_Init( &manager->faces,
                       &ftc_face_list_class,
                       max_faces,
@@ -407,6 +464,142 @@
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_NewConcurrent( FT_Library          library,
+                             FT_UInt             max_faces,
+                             FT_UInt             max_sizes,
+                             FT_ULong            max_bytes,
+                             FT_UInt             max_threads,
+                             FTC_Face_Requester  requester,
+                             FT_Pointer          req_data,
+                             FTC_Manager        *amanager )
+  {
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+    FT_Error     error;
+    FT_Memory    memory;
+    FTC_Manager  manager = NULL;
+    FT_UInt      num_shards, shard_bits;
+    FT_ULong     shard_bytes;
+    FT_UInt      nn;
+
+
+    if ( !amanager )
+      return FT_THROW( Invalid_Argument );
+
+    *amanager = NULL;
+
+    error = FTC_Manager_New( library, max_faces, max_sizes, max_bytes,
+                             requester, req_data, &manager );
+    if ( error )
+      goto Exit;
+
+    memory = manager->memory;
+
+    error = FTC_Mutex_New( memory, &manager->lock );
+    if ( error )
+      goto Fail;
+
+    if ( max_threads == 0 )
+      max_threads = FTC_MAX_LEASES_DEFAULT;
+
+    /* use a few shards per thread to keep lock contention low */
+    shard_bits = 1;
+    num_shards = 2;
+    while ( num_shards < FTC_MAX_SHARDS && num_shards < 4 * max_threads )
+    {
+      shard_bits++;
+      num_shards <<= 1;
+    }
+
+    if ( max_threads > num_shards )
+      max_threads = num_shards;
+
+    /* each shard gets an equal part of the byte budget */
+    shard_bytes = manager->max_weight / num_shards;
+    if ( shard_bytes == 0 )
+      shard_bytes = 1;
+
+    if ( FT_NEW_ARRAY( manager->leases, max_threads ) )
+      goto Fail;
+
+    for ( nn = 0; nn < max_threads; nn++ )
+    {
+      FTC_Manager  lease;
+
+
+      error = FTC_Manager_New( library, max_faces, max_sizes, 0,
+                               requester, req_data, &lease );
+      if ( error )
+        goto Fail;
+
+      manager->leases[manager->num_leases++] = lease;
+      lease->root                            = manager;
+
+      error = FTC_Mutex_New( memory, &lease->lock );
+      if ( error )
+        goto Fail;
+    }
+
+    if ( FT_NEW_ARRAY( manager->shards, num_shards ) )
+      goto Fail;
+
+    for ( nn = 0; nn < num_shards; nn++ )
+    {
+      FTC_Manager  shard;
+
+
+      error = FTC_Manager_New( library, 0, 0, shard_bytes,
+                               requester, req_data, &shard );
+      if ( error )
+        goto Fail;
+
+      manager->shards[manager->num_shards++] = shard;
+      shard->root                            = manager;
+      shard->lease                           = manager->leases[nn %
+                                                 manager->num_leases];
+
+      error = FTC_Mutex_New( memory, &shard->lock );
+      if ( error )
+        goto Fail;
+    }
+
+    manager->shard_shift = 32 - shard_bits;
+
+    FT_TRACE1(( "FTC_Manager_NewConcurrent:"
+                " %d shards of %ld bytes, %d leases\n",
+                num_shards, shard_bytes, max_threads ));
+
+    *amanager = manager;
+
+  Exit:
+    return error;
+
+  Fail:
+    FTC_Manager_Done( manager );
+    return error;
+
+#else /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+    FT_UNUSED( library );
+    FT_UNUSED( max_faces );
+    FT_UNUSED( max_sizes );
+    FT_UNUSED( max_bytes );
+    FT_UNUSED( max_threads );
+    FT_UNUSED( requester );
+    FT_UNUSED( req_data );
+
+    if ( amanager )
+      *amanager = NULL;
+
+    return FT_THROW( Unimplemented_Feature );
+
+#endif /* !FTC_CONFIG_OPTION_CONCURRENT */
+  }
+
+
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( void )
@@ -421,6 +614,20 @@
 
     memory = manager->memory;
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    /* shards hold the nodes, and leases the faces; */
+    /* the latter still need the top-level lock     */
+    for ( idx = manager->num_shards; idx-- > 0; )
+      FTC_Manager_Done( manager->shards[idx] );
+    FT_FREE( manager->shards );
+    manager->num_shards = 0;
+
+    for ( idx = manager->num_leases; idx-- > 0; )
+      FTC_Manager_Done( manager->leases[idx] );
+    FT_FREE( manager->leases );
+    manager->num_leases = 0;
+#endif
+
     /* now discard all caches */
     for (idx = manager->num_caches; idx-- > 0; )
     {
@@ -440,6 +647,12 @@
     FTC_MruList_Done( &manager->sizes );
     FTC_MruList_Done( &manager->faces );
 
+    FT_FREE( manager->sketch );
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    FTC_Mutex_Done( manager->lock, memory );
+#endif
+
     manager->library = NULL;
     manager->memory  = NULL;
 
@@ -455,6 +668,34 @@
     if ( !manager )
       return;
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    {
+      FT_UInt  nn;
+
+
+      /* never hold a shard and a lease lock at the same time here */
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        FTC_Mutex_Lock( shard->lock );
+        FTC_Manager_FlushN( shard, shard->num_nodes );
+        FTC_Mutex_Unlock( shard->lock );
+      }
+
+      for ( nn = 0; nn < manager->num_leases; nn++ )
+      {
+        FTC_Manager  lease = manager->leases[nn];
+
+
+        FTC_Mutex_Lock( lease->lock );
+        FTC_Manager_Reset( lease );
+        FTC_Mutex_Unlock( lease->lock );
+      }
+    }
+#endif
+
     FTC_MruList_Reset( &manager->sizes );
     FTC_MruList_Reset( &manager->faces );
 
@@ -561,7 +802,7 @@
 
       prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
 
-      if ( node->ref_count <= 0 )
+      if ( !FTC_NODE_IS_LOCKED( node ) )
         ftc_node_destroy( node, manager );
 
       node = prev;
@@ -615,6 +856,43 @@
 
         manager->caches[manager->num_caches++] = cache;
       }
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+      /* every shard gets its own clone of the cache at the same index */
+      if ( !error && manager->num_shards )
+      {
+        FT_UInt    nn;
+        FTC_Cache  clone;
+
+
+        for ( nn = 0; nn < manager->num_shards; nn++ )
+        {
+          error = FTC_Manager_RegisterCache( manager->shards[nn],
+                                             clazz, &clone );
+          if ( error )
+            break;
+        }
+
+        if ( error )
+        {
+          /* roll back, keeping all cache indices in sync */
+          while ( nn-- > 0 )
+          {
+            FTC_Manager  shard = manager->shards[nn];
+
+
+            clone = shard->caches[--shard->num_caches];
+            clone->clazz.cache_done( clone );
+            FT_FREE( clone );
+            shard->caches[shard->num_caches] = NULL;
+          }
+
+          manager->caches[--manager->num_caches] = NULL;
+          cache->clazz.cache_done( cache );
+          FT_FREE( cache );
+        }
+      }
+#endif
     }
 
   Exit:
@@ -645,7 +923,7 @@
 
 
       /* don't touch locked nodes */
-      if ( node->ref_count <= 0 )
+      if ( !FTC_NODE_IS_LOCKED( node ) )
       {
         ftc_node_destroy( node, manager );
         result++;
@@ -681,6 +959,171 @@
 
     for ( nn = 0; nn < manager->num_caches; nn++ )
       FTC_Cache_RemoveFaceID( manager->caches[nn], face_id );
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    /* never hold a shard and a lease lock at the same time here */
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
+
+
+      FTC_Mutex_Lock( shard->lock );
+      FTC_Manager_RemoveFaceID( shard, face_id );
+      FTC_Mutex_Unlock( shard->lock );
+    }
+
+    for ( nn = 0; nn < manager->num_leases; nn++ )
+    {
+      FTC_Manager  lease = manager->leases[nn];
+
+
+      FTC_Mutex_Lock( lease->lock );
+      FTC_Manager_RemoveFaceID( lease, face_id );
+      FTC_Mutex_Unlock( lease->lock );
+    }
+#endif
+  }
+
+
+  static FT_Error
+  ftc_manager_set_policy( FTC_Manager         manager,
+                          FTC_EvictionPolicy  policy )
+  {
+    FT_Memory  memory = manager->memory;
+    FT_Error   error  = FT_Err_Ok;
+    FTC_Node   first  = manager->nodes_list;
+
+
+    /* start over with all nodes on probation */
+    if ( first )
+    {
+      FTC_Node  node = first;
+
+
+      do
+      {
+        node->flags &= ~FTC_NODE_FLAG_PROTECTED;
+        node         = FTC_NODE_NEXT( node );
+
+      } while ( node != first );
+    }
+
+    manager->probation     = first;
+    manager->cur_protected = 0;
+    manager->max_protected = manager->max_weight / 100 *
+                               FTC_SLRU_PROTECTED_PERCENT;
+    manager->rejected      = NULL;
+
+    FT_FREE( manager->sketch );
+    manager->sketch_mask  = 0;
+    manager->sketch_count = 0;
+
+    if ( policy == FTC_EVICTION_TINYLFU )
+    {
+      FT_UInt  width = FTC_SKETCH_MIN_WIDTH;
+
+
+      while ( width < FTC_SKETCH_MAX_WIDTH                               &&
+              width < manager->max_weight / FTC_SKETCH_BYTES_PER_SLOT )
+        width <<= 1;
+
+      if ( FT_NEW_ARRAY( manager->sketch, 4 * width ) )
+        policy = FTC_EVICTION_LRU;
+      else
+        manager->sketch_mask = width - 1;
+    }
+
+    manager->policy = policy;
+
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_SetEvictionPolicy( FTC_Manager         manager,
+                                 FTC_EvictionPolicy  policy )
+  {
+    FT_Error  error;
+
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( policy != FTC_EVICTION_LRU  &&
+         policy != FTC_EVICTION_SLRU &&
+         policy != FTC_EVICTION_TINYLFU )
+      return FT_THROW( Invalid_Argument );
+
+    error = ftc_manager_set_policy( manager, policy );
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    {
+      FT_UInt  nn;
+
+
+      for ( nn = 0; !error && nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        FTC_Mutex_Lock( shard->lock );
+        error = ftc_manager_set_policy( shard, policy );
+        FTC_Mutex_Unlock( shard->lock );
+      }
+    }
+#endif
+
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_SetCacheQuota( FTC_Manager  manager,
+                             FT_Pointer   cache,
+                             FT_ULong     max_bytes )
+  {
+    FT_UInt  idx;
+
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    for ( idx = 0; idx < manager->num_caches; idx++ )
+      if ( manager->caches[idx] == (FTC_Cache)cache )
+        break;
+
+    if ( !cache || idx == manager->num_caches )
+      return FT_THROW( Invalid_Argument );
+
+    manager->caches[idx]->max_weight = max_bytes;
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    {
+      FT_UInt  nn;
+
+
+      /* as with the total budget, each shard gets an equal part */
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+        FT_ULong     quota = max_bytes / manager->num_shards;
+
+
+        if ( max_bytes && !quota )
+          quota = 1;
+
+        FTC_Mutex_Lock( shard->lock );
+        shard->caches[idx]->max_weight = quota;
+        FTC_Mutex_Unlock( shard->lock );
+      }
+    }
+#endif
+
+    return FT_Err_Ok;
   }
 
 
@@ -693,7 +1136,7 @@
     if ( node                                             &&
          manager                                          &&
          (FT_UInt)node->cache_index < manager->num_caches )
-      node->ref_count--;
+      FTC_NODE_UNREF( node );
   }
 
 
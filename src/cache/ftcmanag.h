@@ -67,6 +67,7 @@
 #include FT_CACHE_H
 #include "ftcmru.h"
 #include "ftccache.h"
+#include "ftcsync.h"
 
 
 FT_BEGIN_HEADER
@@ -87,6 +88,22 @@ FT_BEGIN_HEADER
   /* maximum number of caches registered in a single manager */
 #define FTC_MAX_CACHES         16
 
+  /* limits for concurrent managers */
+#define FTC_MAX_LEASES_DEFAULT  4
+#define FTC_MAX_SHARDS         64
+
+  /* share of the byte budget for the protected segment of an SLRU list */
+#define FTC_SLRU_PROTECTED_PERCENT  80
+
+  /* the TinyLFU frequency sketch has one counter per this many bytes */
+  /* of budget in each of its four rows, within the given limits      */
+#define FTC_SKETCH_BYTES_PER_SLOT  64
+#define FTC_SKETCH_MIN_WIDTH       256
+#define FTC_SKETCH_MAX_WIDTH       65536
+
+  /* maximum number of eviction candidates examined for admission */
+#define FTC_ADMIT_MAX_VICTIMS  16
+
 
   typedef struct  FTC_ManagerRec_
   {
@@ -98,6 +115,26 @@ FT_BEGIN_HEADER
     FT_Offset           cur_weight;
     FT_UInt             num_nodes;
 
+    /*
+     * With the SLRU and TinyLFU eviction policies, `nodes_list' is split
+     * into a protected segment at its head, holding nodes that have been
+     * hit at least once, and a probationary segment, starting with node
+     * `probation' and extending to the tail.  New nodes enter the
+     * probationary segment; eviction starts at the tail.  For TinyLFU,
+     * `sketch' estimates access frequencies; a node whose admission has
+     * been refused sits at the tail as `rejected' until the next node
+     * gets added.
+     */
+    FTC_EvictionPolicy  policy;
+    FTC_Node            probation;
+    FT_Offset           max_protected;
+    FT_Offset           cur_protected;
+    FTC_Node            rejected;
+
+    FT_Byte*            sketch;       /* four rows of `sketch_mask + 1' */
+    FT_UInt             sketch_mask;
+    FT_UInt             sketch_count;
+
     FTC_Cache           caches[FTC_MAX_CACHES];
     FT_UInt             num_caches;
 
@@ -107,6 +144,30 @@ FT_BEGIN_HEADER
     FT_Pointer          request_data;
     FTC_Face_Requester  request_face;
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    /*
+     * A concurrent manager (created with `FTC_Manager_NewConcurrent')
+     * does not hold any nodes itself.  It distributes them by hash value
+     * over `shards', which are managers of their own, each protected by
+     * a mutex and holding a slice of the byte budget.  To create nodes,
+     * a shard borrows faces and sizes from one of the `leases', again
+     * managers, whose face and size lists are used by one thread at a
+     * time.  The `lock' of the top-level manager serializes calls to the
+     * face requester and `FT_Done_Face', which modify the library.
+     */
+    FTC_Manager         root;        /* top-level manager               */
+    FTC_Mutex           lock;
+
+    FT_UInt             num_shards;  /* top-level manager only          */
+    FT_UInt             shard_shift;
+    FTC_Manager*        shards;
+    FT_UInt             num_leases;
+    FTC_Manager*        leases;
+
+    FTC_Manager         lease;       /* shards only                     */
+    FT_Bool             lease_held;
+#endif
+
   } FTC_ManagerRec;
 
 
@@ -150,6 +211,16 @@ FT_BEGIN_HEADER
                              FTC_CacheClass   clazz,
                              FTC_Cache       *acache );
 
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+  /* the shard of a concurrent manager that holds the nodes for `hash' */
+#define FTC_MANAGER_SHARD( manager, hash )                                \
+          ( (manager)->shards[(FT_UInt32)( (FT_UInt32)(hash) *            \
+                                           0x9E3779B1UL ) >>              \
+                              (manager)->shard_shift] )
+
+#endif
+
  /* */
 
 #define FTC_SCALER_COMPARE( a, b )                \
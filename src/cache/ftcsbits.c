@@ -206,10 +206,11 @@
   }
 
 
-  FT_LOCAL_DEF( FT_Error )
-  FTC_SNode_New( FTC_SNode  *psnode,
-                 FTC_GQuery  gquery,
-                 FTC_Cache   cache )
+  /* create a node for `gquery' with all of its bitmaps unloaded */
+  static FT_Error
+  ftc_snode_alloc( FTC_SNode  *psnode,
+                   FTC_GQuery  gquery,
+                   FTC_Cache   cache )
   {
     FT_Memory   memory = cache->memory;
     FT_Error    error;
@@ -246,10 +247,29 @@
       {
         snode->sbits[node_count].width = 255;
       }
+    }
+
+  Exit:
+    *psnode = snode;
+    return error;
+  }
+
 
+  FT_LOCAL_DEF( FT_Error )
+  FTC_SNode_New( FTC_SNode  *psnode,
+                 FTC_GQuery  gquery,
+                 FTC_Cache   cache )
+  {
+    FT_Error   error;
+    FTC_SNode  snode;
+
+
+    error = ftc_snode_alloc( &snode, gquery, cache );
+    if ( !error )
+    {
       error = ftc_snode_load( snode,
                               cache->manager,
-                              gindex,
+                              gquery->gindex,
                               NULL );
       if ( error )
       {
@@ -258,12 +278,73 @@
       }
     }
 
-  Exit:
     *psnode = snode;
     return error;
   }
 
 
+  FT_LOCAL_DEF( FT_Error )
+  FTC_SNode_Preload( FTC_Cache   cache,
+                     FTC_GQuery  gquery,
+                     FT_Offset   hash,
+                     FTC_SBit    sbit )
+  {
+    FT_Memory  memory = cache->memory;
+    FT_Error   error  = FT_Err_Ok;
+    FT_UInt    gindex = gquery->gindex;
+    FTC_Node   node;
+    FTC_SNode  snode  = NULL;
+    FTC_SBit   slot;
+    FT_Byte*   buffer = NULL;
+    FT_ULong   size;
+
+
+    /* we can't use the `node_compare' method, which loads the glyph */
+    for ( node = *FTC_NODE_TOP_FOR_HASH( cache, hash );
+          node;
+          node = node->link )
+    {
+      if ( node->hash == hash                                        &&
+           FTC_GNODE( node )->family == gquery->family               &&
+           (FT_UInt)( gindex - FTC_GNODE( node )->gindex ) <
+             FTC_SNODE( node )->count                                )
+      {
+        snode = FTC_SNODE( node );
+        break;
+      }
+    }
+
+    if ( !snode )
+    {
+      error = ftc_snode_alloc( &snode, gquery, cache );
+      if ( error )
+        goto Exit;
+
+      FTC_Cache_AddNode( cache, hash, FTC_NODE( snode ) );
+    }
+
+    /* keep bitmaps that are already loaded */
+    slot = snode->sbits + ( gindex - FTC_GNODE( snode )->gindex );
+    if ( slot->buffer || slot->width != 255 )
+      goto Exit;
+
+    size = (FT_ULong)FT_ABS( sbit->pitch ) * sbit->height;
+    if ( size && FT_QALLOC( buffer, size ) )
+      goto Exit;
+
+    if ( size )
+      FT_MEM_COPY( buffer, sbit->buffer, size );
+
+    *slot        = *sbit;
+    slot->buffer = buffer;
+
+    ftc_node_add_weight( FTC_NODE( snode ), cache, size );
+
+  Exit:
+    return error;
+  }
+
+
   FT_LOCAL_DEF( FT_Error )
   ftc_snode_new( FTC_Node   *ftcpsnode,
                  FT_Pointer  ftcgquery,
@@ -384,8 +465,8 @@
         FT_Error  error;
 
 
-        ftcsnode->ref_count++;  /* lock node to prevent flushing */
-                                /* in retry loop                 */
+        FTC_NODE_REF( ftcsnode );  /* lock node to prevent flushing */
+                                   /* in retry loop                 */
 
         FTC_CACHE_TRYLOOP( cache )
         {
@@ -393,12 +474,12 @@
         }
         FTC_CACHE_TRYLOOP_END( list_changed );
 
-        ftcsnode->ref_count--;  /* unlock the node */
+        FTC_NODE_UNREF( ftcsnode );  /* unlock the node */
 
         if ( error )
           result = 0;
         else
-          cache->manager->cur_weight += size;
+          ftc_node_add_weight( ftcsnode, cache, size );
       }
     }
 
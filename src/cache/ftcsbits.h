@@ -77,6 +77,15 @@ FT_BEGIN_HEADER
                  FTC_GQuery   gquery,
                  FTC_Cache    cache );
 
+  /* Store the bitmap `sbit' (whose buffer gets copied) for          */
+  /* `gquery.index' without loading the glyph, adding a node with the */
+  /* given hash if necessary.  Bitmaps already loaded are left alone. */
+  FT_LOCAL( FT_Error )
+  FTC_SNode_Preload( FTC_Cache   cache,
+                     FTC_GQuery  gquery,
+                     FT_Offset   hash,
+                     FTC_SBit    sbit );
+
 #if 0
   FT_LOCAL( FT_ULong )
   FTC_SNode_Weight( FTC_SNode  inode );
@@ -0,0 +1,666 @@
+/****************************************************************************
+ *
+ * ftcsnap.c
+ *
+ *   FreeType cache snapshots (body).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_STREAM_H
+#include FT_INTERNAL_DEBUG_H
+#include "ftcsnap.h"
+#include "ftcmanag.h"
+
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  trace_cache
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                        FACE IDENTITY                          *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+  /*
+   * A face is identified by two independent 32-bit hashes of its font
+   * file (FNV-1a and a multiplicative hash seeded with the file size),
+   * its index within the file, and its number of glyphs.  Reading the
+   * whole file is expensive but only done once per face and snapshot.
+   */
+
+  typedef struct  FTC_SnapFaceRec_
+  {
+    FT_UInt32  hash1;
+    FT_UInt32  hash2;
+    FT_UInt32  face_index;
+    FT_UInt32  num_glyphs;  /* 0 if the face couldn't be opened */
+
+  } FTC_SnapFaceRec, *FTC_SnapFace;
+
+
+#define FTC_SNAP_HASH_CHUNK  4096
+
+#define FTC_SNAP_PUT_USHORT( p, v )             \
+          FT_BEGIN_STMNT                        \
+            (p)[0] = (FT_Byte)( (v) >> 8 );     \
+            (p)[1] = (FT_Byte)(v);              \
+            (p)   += 2;                         \
+          FT_END_STMNT
+
+#define FTC_SNAP_PUT_ULONG( p, v )              \
+          FT_BEGIN_STMNT                        \
+            (p)[0] = (FT_Byte)( (v) >> 24 );    \
+            (p)[1] = (FT_Byte)( (v) >> 16 );    \
+            (p)[2] = (FT_Byte)( (v) >> 8 );     \
+            (p)[3] = (FT_Byte)(v);              \
+            (p)   += 4;                         \
+          FT_END_STMNT
+
+
+  static void
+  ftc_snap_hash_bytes( FTC_SnapFace    id,
+                       const FT_Byte*  p,
+                       FT_ULong        count )
+  {
+    FT_UInt32  h1 = id->hash1;
+    FT_UInt32  h2 = id->hash2;
+
+
+    for ( ; count > 0; count--, p++ )
+    {
+      h1 = ( h1 ^ *p ) * 16777619UL;
+      h2 = h2 * 31 + *p;
+    }
+
+    id->hash1 = h1 & 0xFFFFFFFFUL;
+    id->hash2 = h2 & 0xFFFFFFFFUL;
+  }
+
+
+  static FT_Error
+  ftc_snap_face_identity( FTC_Cache     cache,
+                          FTC_FaceID    face_id,
+                          FTC_SnapFace  id )
+  {
+    FT_Error   error;
+    FT_Face    face;
+    FT_Stream  stream;
+    FTC_Cache  shard;
+
+
+    id->hash1      = 0;
+    id->hash2      = 0;
+    id->face_index = 0;
+    id->num_glyphs = 0;
+
+    shard = FTC_CACHE_LOCK_SHARD( cache, FTC_FACE_ID_HASH( face_id ) );
+
+    error = FTC_Manager_LookupFace( shard->manager, face_id, &face );
+    if ( error || !face || !face->stream )
+    {
+      /* keep the face's records unmatchable instead of failing */
+      FT_TRACE1(( "ftc_snap_face_identity: cannot open face %p\n",
+                  face_id ));
+      error = FT_ERR_EQ( error, Out_Of_Memory ) ? error : FT_Err_Ok;
+      goto Exit;
+    }
+
+    stream = face->stream;
+
+    id->hash1      = 2166136261UL;
+    id->hash2      = (FT_UInt32)stream->size;
+    id->face_index = (FT_UInt32)face->face_index;
+    id->num_glyphs = (FT_UInt32)face->num_glyphs;
+
+    /* memory-based streams have no `read' function */
+    if ( !stream->read )
+      ftc_snap_hash_bytes( id, stream->base, stream->size );
+    else
+    {
+      FT_Byte   chunk[FTC_SNAP_HASH_CHUNK];
+      FT_ULong  pos = 0;
+
+
+      while ( pos < stream->size )
+      {
+        FT_ULong  count = stream->size - pos;
+
+
+        if ( count > FTC_SNAP_HASH_CHUNK )
+          count = FTC_SNAP_HASH_CHUNK;
+
+        error = FT_Stream_ReadAt( stream, pos, chunk, count );
+        if ( error )
+        {
+          id->num_glyphs = 0;
+          error          = FT_Err_Ok;
+          break;
+        }
+
+        ftc_snap_hash_bytes( id, chunk, count );
+        pos += count;
+      }
+    }
+
+  Exit:
+    FTC_CACHE_UNLOCK_SHARD( shard );
+    return error;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      SNAPSHOT WRITING                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_Init( FTC_Snapshot  snap,
+                     FT_Memory     memory )
+  {
+    FT_ZERO( snap );
+    snap->memory = memory;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_Done( FTC_Snapshot  snap )
+  {
+    FT_Memory  memory = snap->memory;
+
+
+    FT_FREE( snap->records );
+    FT_FREE( snap->faces );
+    snap->size      = 0;
+    snap->max_size  = 0;
+    snap->num_faces = 0;
+    snap->max_faces = 0;
+  }
+
+
+  /* make room for `count' more bytes */
+  static FT_Byte*
+  ftc_snapshot_grow( FTC_Snapshot  snap,
+                     FT_ULong      count )
+  {
+    FT_Memory  memory = snap->memory;
+    FT_Error   error;
+    FT_Byte*   p;
+
+
+    if ( snap->error )
+      return NULL;
+
+    if ( count > 0xFFFFFFFFUL - snap->size )
+    {
+      snap->error = FT_THROW( Array_Too_Large );
+      return NULL;
+    }
+
+    if ( snap->size + count > snap->max_size )
+    {
+      FT_ULong  new_max = snap->max_size;
+
+
+      if ( new_max < 1024 )
+        new_max = 1024;
+
+      while ( new_max < snap->size + count )
+        new_max += new_max >> 1;
+
+      if ( FT_QREALLOC( snap->records, snap->max_size, new_max ) )
+      {
+        snap->error = error;
+        return NULL;
+      }
+
+      snap->max_size = new_max;
+    }
+
+    p           = snap->records + snap->size;
+    snap->size += count;
+
+    return p;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_PutByte( FTC_Snapshot  snap,
+                        FT_UInt       value )
+  {
+    FT_Byte*  p = ftc_snapshot_grow( snap, 1 );
+
+
+    if ( p )
+      p[0] = (FT_Byte)value;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_PutShort( FTC_Snapshot  snap,
+                         FT_UInt       value )
+  {
+    FT_Byte*  p = ftc_snapshot_grow( snap, 2 );
+
+
+    if ( p )
+      FTC_SNAP_PUT_USHORT( p, value );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_PutLong( FTC_Snapshot  snap,
+                        FT_ULong      value )
+  {
+    FT_Byte*  p = ftc_snapshot_grow( snap, 4 );
+
+
+    if ( p )
+      FTC_SNAP_PUT_ULONG( p, value );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_PutBytes( FTC_Snapshot    snap,
+                         const FT_Byte*  bytes,
+                         FT_ULong        count )
+  {
+    FT_Byte*  p;
+
+
+    if ( !count )
+      return;
+
+    p = ftc_snapshot_grow( snap, count );
+    if ( p )
+      FT_MEM_COPY( p, bytes, count );
+  }
+
+
+  FT_LOCAL_DEF( FT_UInt )
+  FTC_Snapshot_AddFace( FTC_Snapshot  snap,
+                        FTC_FaceID    face_id )
+  {
+    FT_Memory  memory = snap->memory;
+    FT_Error   error;
+    FT_UInt    nn;
+
+
+    /* a snapshot refers to a handful of faces at most */
+    for ( nn = 0; nn < snap->num_faces; nn++ )
+      if ( snap->faces[nn] == face_id )
+        return nn;
+
+    if ( snap->num_faces >= 0xFFFFU )
+    {
+      if ( !snap->error )
+        snap->error = FT_THROW( Array_Too_Large );
+      return 0;
+    }
+
+    if ( snap->num_faces >= snap->max_faces )
+    {
+      FT_UInt  new_max = snap->max_faces + 8;
+
+
+      if ( FT_QRENEW_ARRAY( snap->faces, snap->max_faces, new_max ) )
+      {
+        if ( !snap->error )
+          snap->error = error;
+        return 0;
+      }
+
+      snap->max_faces = new_max;
+    }
+
+    snap->faces[snap->num_faces] = face_id;
+
+    return snap->num_faces++;
+  }
+
+
+  static void
+  ftc_snapshot_walk_cache( FTC_Snapshot           snap,
+                           FTC_Cache              cache,
+                           FTC_Snapshot_NodeFunc  func )
+  {
+    FT_UFast  count = cache->p + cache->mask + 1;
+    FT_UFast  nn;
+
+
+    for ( nn = 0; nn < count && !snap->error; nn++ )
+    {
+      FTC_Node  node;
+
+
+      for ( node = cache->buckets[nn]; node; node = node->link )
+        func( node, cache, snap );
+    }
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Snapshot_Walk( FTC_Snapshot           snap,
+                     FTC_Cache              cache,
+                     FTC_Snapshot_NodeFunc  func )
+  {
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+    FTC_Manager  manager = cache->manager;
+
+
+    if ( manager->num_shards )
+    {
+      FT_UInt  nn;
+
+
+      for ( nn = 0; nn < manager->num_shards && !snap->error; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        FTC_Mutex_Lock( shard->lock );
+        ftc_snapshot_walk_cache( snap, shard->caches[cache->index], func );
+        FTC_Mutex_Unlock( shard->lock );
+      }
+
+      return snap->error;
+    }
+#endif
+
+    ftc_snapshot_walk_cache( snap, cache, func );
+
+    return snap->error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Snapshot_Finish( FTC_Snapshot  snap,
+                       FTC_Cache     cache,
+                       FT_UInt       kind,
+                       FT_Byte*     *abuffer,
+                       FT_ULong     *asize )
+  {
+    FT_Memory  memory = snap->memory;
+    FT_Error   error  = snap->error;
+    FT_Byte*   buffer = NULL;
+    FT_Byte*   p;
+    FT_ULong   size;
+    FT_UInt    nn;
+
+
+    *abuffer = NULL;
+    *asize   = 0;
+
+    if ( error )
+      goto Exit;
+
+    size = FTC_SNAPSHOT_HEADER_SIZE +
+           FTC_SNAPSHOT_FACE_SIZE * (FT_ULong)snap->num_faces;
+    if ( snap->size > 0xFFFFFFFFUL - size )
+    {
+      error = FT_THROW( Array_Too_Large );
+      goto Exit;
+    }
+    size += snap->size;
+
+    if ( FT_QALLOC( buffer, size ) )
+      goto Exit;
+
+    p = buffer;
+    FTC_SNAP_PUT_ULONG( p, FTC_SNAPSHOT_TAG );
+    FTC_SNAP_PUT_USHORT( p, FTC_SNAPSHOT_VERSION );
+    FTC_SNAP_PUT_USHORT( p, kind );
+    FTC_SNAP_PUT_ULONG( p, snap->num_faces );
+    FTC_SNAP_PUT_ULONG( p, snap->num_records );
+
+    for ( nn = 0; nn < snap->num_faces; nn++ )
+    {
+      FTC_SnapFaceRec  id;
+
+
+      error = ftc_snap_face_identity( cache, snap->faces[nn], &id );
+      if ( error )
+        goto Exit;
+
+      FTC_SNAP_PUT_ULONG( p, id.hash1 );
+      FTC_SNAP_PUT_ULONG( p, id.hash2 );
+      FTC_SNAP_PUT_ULONG( p, id.face_index );
+      FTC_SNAP_PUT_ULONG( p, id.num_glyphs );
+    }
+
+    if ( snap->size )
+      FT_MEM_COPY( p, snap->records, snap->size );
+
+    *abuffer = buffer;
+    *asize   = size;
+    buffer   = NULL;
+
+  Exit:
+    FT_FREE( buffer );
+    FTC_Snapshot_Done( snap );
+
+    return error;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      SNAPSHOT READING                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Snapshot_Open( FTC_SnapshotReader  reader,
+                     FTC_Cache           cache,
+                     const FT_Byte*      buffer,
+                     FT_ULong            size,
+                     FT_UInt             kind,
+                     const FTC_FaceID*   face_ids,
+                     FT_UInt             num_face_ids )
+  {
+    FT_Memory        memory = cache->memory;
+    FT_Error         error;
+    FT_Stream        stream = &reader->stream;
+    FTC_SnapFaceRec  id;
+    FT_ULong         tag, num_faces, num_records;
+    FT_UShort        version, snap_kind;
+    FT_UInt          nn, mm;
+
+
+    FT_ZERO( reader );
+    reader->memory   = memory;
+    reader->face_ids = face_ids;
+
+    FT_Stream_OpenMemory( stream, buffer, size );
+
+    if ( FT_READ_ULONG( tag )        ||
+         FT_READ_USHORT( version )   ||
+         FT_READ_USHORT( snap_kind ) ||
+         FT_READ_ULONG( num_faces )  ||
+         FT_READ_ULONG( num_records ) )
+      goto Invalid;
+
+    if ( tag != FTC_SNAPSHOT_TAG || version != FTC_SNAPSHOT_VERSION )
+    {
+      FT_TRACE0(( "FTC_Snapshot_Open: unknown snapshot format\n" ));
+      goto Invalid;
+    }
+
+    if ( snap_kind != kind )
+    {
+      FT_TRACE0(( "FTC_Snapshot_Open: snapshot of another cache type\n" ));
+      goto Invalid;
+    }
+
+    if ( num_faces > 0xFFFFU                                            ||
+         num_faces * FTC_SNAPSHOT_FACE_SIZE > size - FT_Stream_Pos( stream ) )
+      goto Invalid;
+
+    reader->num_faces   = (FT_UInt)num_faces;
+    reader->num_records = (FT_UInt)num_records;
+
+    if ( FT_NEW_ARRAY( reader->face_map, num_faces ) )
+      goto Exit;
+
+    /* compute the caller's face identities only if we have to */
+    if ( num_faces && num_face_ids )
+    {
+      FTC_SnapFace  ids;
+
+
+      if ( FT_NEW_ARRAY( ids, num_face_ids ) )
+        goto Exit;
+
+      for ( mm = 0; mm < num_face_ids; mm++ )
+      {
+        error = ftc_snap_face_identity( cache, face_ids[mm], &ids[mm] );
+        if ( error )
+          break;
+      }
+
+      for ( nn = 0; nn < num_faces && !error; nn++ )
+      {
+        if ( FT_READ_ULONG( id.hash1 )      ||
+             FT_READ_ULONG( id.hash2 )      ||
+             FT_READ_ULONG( id.face_index ) ||
+             FT_READ_ULONG( id.num_glyphs ) )
+          break;
+
+        if ( !id.num_glyphs )
+          continue;
+
+        for ( mm = 0; mm < num_face_ids; mm++ )
+        {
+          if ( ids[mm].hash1      == id.hash1      &&
+               ids[mm].hash2      == id.hash2      &&
+               ids[mm].face_index == id.face_index &&
+               ids[mm].num_glyphs == id.num_glyphs )
+          {
+            reader->face_map[nn] = mm + 1;
+            break;
+          }
+        }
+
+        if ( mm == num_face_ids )
+          FT_TRACE2(( "FTC_Snapshot_Open: skipping stale face %d\n", nn ));
+      }
+
+      FT_FREE( ids );
+      if ( error )
+        goto Exit;
+    }
+    else if ( FT_STREAM_SKIP( num_faces * FTC_SNAPSHOT_FACE_SIZE ) )
+      goto Exit;
+
+    return FT_Err_Ok;
+
+  Invalid:
+    error = FT_THROW( Invalid_File_Format );
+
+  Exit:
+    FTC_Snapshot_Close( reader );
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Snapshot_ReadFace( FTC_SnapshotReader  reader,
+                         FTC_FaceID         *aface_id,
+                         FT_Bool            *amatched )
+  {
+    FT_Stream  stream = &reader->stream;
+    FT_Error   error;
+    FT_UShort  index;
+
+
+    *aface_id = NULL;
+    *amatched = FALSE;
+
+    if ( FT_READ_USHORT( index ) )
+      return error;
+
+    if ( index >= reader->num_faces )
+      return FT_THROW( Invalid_File_Format );
+
+    if ( reader->face_map[index] )
+    {
+      *aface_id = reader->face_ids[reader->face_map[index] - 1];
+      *amatched = TRUE;
+    }
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Snapshot_ReadBytes( FTC_SnapshotReader  reader,
+                          FT_ULong            count,
+                          const FT_Byte*     *abytes )
+  {
+    FT_Stream  stream = &reader->stream;
+    FT_Error   error;
+
+
+    *abytes = stream->base + FT_Stream_Pos( stream );
+
+    if ( FT_STREAM_SKIP( count ) )
+      *abytes = NULL;
+
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Snapshot_Close( FTC_SnapshotReader  reader )
+  {
+    FT_Memory  memory = reader->memory;
+
+
+    FT_FREE( reader->face_map );
+    reader->num_faces   = 0;
+    reader->num_records = 0;
+    FT_Stream_Close( &reader->stream );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_FreeSnapshot( FTC_Manager  manager,
+                            FT_Byte*     buffer )
+  {
+    FT_Memory  memory;
+
+
+    if ( !manager )
+      return;
+
+    memory = manager->memory;
+    FT_FREE( buffer );
+  }
+
+
+/* END */
@@ -0,0 +1,189 @@
+/****************************************************************************
+ *
+ * ftcsnap.h
+ *
+ *   FreeType cache snapshots (specification).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+  /**************************************************************************
+   *
+   * A snapshot is a flat, position-independent dump of the nodes of a
+   * single cache, which can be loaded into a cache of the same type in
+   * another process.  All numbers are stored in big-endian byte order.
+   *
+   *   header:
+   *     `FTCS'                  magic
+   *     USHORT  version         FTC_SNAPSHOT_VERSION
+   *     USHORT  kind            FTC_SNAPSHOT_KIND_XXX
+   *     ULONG   num_faces
+   *     ULONG   num_records
+   *
+   *   num_faces face records:
+   *     ULONG   hash1           two independent hashes of the font file
+   *     ULONG   hash2
+   *     ULONG   face_index
+   *     ULONG   num_glyphs
+   *
+   *   num_records cache-specific records, each starting with a USHORT
+   *   index into the face records
+   *
+   * Face IDs are meaningless outside of the process that created the
+   * snapshot; a face is identified by the contents of its font file
+   * instead.  When a snapshot is loaded, the caller provides the face
+   * IDs to match against the face records; records of faces without a
+   * match are skipped.
+   *
+   */
+
+
+#ifndef FTCSNAP_H_
+#define FTCSNAP_H_
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include FT_INTERNAL_STREAM_H
+#include "ftccache.h"
+
+
+FT_BEGIN_HEADER
+
+
+#define FTC_SNAPSHOT_TAG      FT_MAKE_TAG( 'F', 'T', 'C', 'S' )
+#define FTC_SNAPSHOT_VERSION  1
+
+#define FTC_SNAPSHOT_KIND_SBITS  1
+#define FTC_SNAPSHOT_KIND_CMAP   2
+
+#define FTC_SNAPSHOT_HEADER_SIZE  16
+#define FTC_SNAPSHOT_FACE_SIZE    16
+
+
+  /* a snapshot being written */
+  typedef struct  FTC_SnapshotRec_
+  {
+    FT_Memory    memory;
+    FT_Error     error;         /* first error of the `Put' functions */
+
+    FT_Byte*     records;
+    FT_ULong     size;
+    FT_ULong     max_size;
+    FT_UInt      num_records;
+
+    FTC_FaceID*  faces;
+    FT_UInt      num_faces;
+    FT_UInt      max_faces;
+
+  } FTC_SnapshotRec, *FTC_Snapshot;
+
+
+  /* write a node of the given cache to the snapshot */
+  typedef void
+  (*FTC_Snapshot_NodeFunc)( FTC_Node      node,
+                            FTC_Cache     cache,
+                            FTC_Snapshot  snap );
+
+
+  FT_LOCAL( void )
+  FTC_Snapshot_Init( FTC_Snapshot  snap,
+                     FT_Memory     memory );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_Done( FTC_Snapshot  snap );
+
+  /* return the index of a face in the face records, adding it if needed */
+  FT_LOCAL( FT_UInt )
+  FTC_Snapshot_AddFace( FTC_Snapshot  snap,
+                        FTC_FaceID    face_id );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_PutByte( FTC_Snapshot  snap,
+                        FT_UInt       value );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_PutShort( FTC_Snapshot  snap,
+                         FT_UInt       value );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_PutLong( FTC_Snapshot  snap,
+                        FT_ULong      value );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_PutBytes( FTC_Snapshot    snap,
+                         const FT_Byte*  bytes,
+                         FT_ULong        count );
+
+  /* call `func' for all nodes of a cache (in all shards) */
+  FT_LOCAL( FT_Error )
+  FTC_Snapshot_Walk( FTC_Snapshot           snap,
+                     FTC_Cache              cache,
+                     FTC_Snapshot_NodeFunc  func );
+
+  /* compute the face records and return the complete snapshot */
+  FT_LOCAL( FT_Error )
+  FTC_Snapshot_Finish( FTC_Snapshot  snap,
+                       FTC_Cache     cache,
+                       FT_UInt       kind,
+                       FT_Byte*     *abuffer,
+                       FT_ULong     *asize );
+
+
+  /* a snapshot being read */
+  typedef struct  FTC_SnapshotReaderRec_
+  {
+    FT_StreamRec       stream;       /* positioned at the next record    */
+    FT_UInt            num_records;
+
+    const FTC_FaceID*  face_ids;     /* as passed to `FTC_Snapshot_Open' */
+    FT_UInt*           face_map;     /* 1 + index into `face_ids' for    */
+                                     /* every face record; 0 if stale    */
+    FT_UInt            num_faces;
+    FT_Memory          memory;
+
+  } FTC_SnapshotReaderRec, *FTC_SnapshotReader;
+
+
+  /* validate the header and match the face records against `face_ids' */
+  FT_LOCAL( FT_Error )
+  FTC_Snapshot_Open( FTC_SnapshotReader  reader,
+                     FTC_Cache           cache,
+                     const FT_Byte*      buffer,
+                     FT_ULong            size,
+                     FT_UInt             kind,
+                     const FTC_FaceID*   face_ids,
+                     FT_UInt             num_face_ids );
+
+  /* read the face index starting a record; `*amatched' is false */
+  /* if the record's face isn't among the caller's faces          */
+  FT_LOCAL( FT_Error )
+  FTC_Snapshot_ReadFace( FTC_SnapshotReader  reader,
+                         FTC_FaceID         *aface_id,
+                         FT_Bool            *amatched );
+
+  /* skip `count' bytes, returning a pointer to them */
+  FT_LOCAL( FT_Error )
+  FTC_Snapshot_ReadBytes( FTC_SnapshotReader  reader,
+                          FT_ULong            count,
+                          const FT_Byte*     *abytes );
+
+  FT_LOCAL( void )
+  FTC_Snapshot_Close( FTC_SnapshotReader  reader );
+
+
+FT_END_HEADER
+
+#endif /* FTCSNAP_H_ */
+
+
+/* END */
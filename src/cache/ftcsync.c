@@ -0,0 +1,174 @@
+/****************************************************************************
+ *
+ * ftcsync.c
+ *
+ *   FreeType cache synchronization primitives (body).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+#include "ftcsync.h"
+
+#include "ftcerror.h"
+
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <intrin.h>
+
+  typedef struct  FTC_MutexRec_
+  {
+    CRITICAL_SECTION  section;
+
+  } FTC_MutexRec;
+
+#define FTC_MUTEX_INIT( m )    ( InitializeCriticalSection( &(m)->section ), \
+                                 0 )
+#define FTC_MUTEX_DONE( m )    DeleteCriticalSection( &(m)->section )
+#define FTC_MUTEX_LOCK( m )    EnterCriticalSection( &(m)->section )
+#define FTC_MUTEX_UNLOCK( m )  LeaveCriticalSection( &(m)->section )
+
+#else /* !_WIN32 */
+
+#include <pthread.h>
+
+  typedef struct  FTC_MutexRec_
+  {
+    pthread_mutex_t  mutex;
+
+  } FTC_MutexRec;
+
+#define FTC_MUTEX_INIT( m )    pthread_mutex_init( &(m)->mutex, NULL )
+#define FTC_MUTEX_DONE( m )    pthread_mutex_destroy( &(m)->mutex )
+#define FTC_MUTEX_LOCK( m )    pthread_mutex_lock( &(m)->mutex )
+#define FTC_MUTEX_UNLOCK( m )  pthread_mutex_unlock( &(m)->mutex )
+
+#endif /* !_WIN32 */
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Mutex_New( FT_Memory   memory,
+                 FTC_Mutex  *amutex )
+  {
+    FT_Error   error;
+    FTC_Mutex  mutex;
+
+
+    *amutex = NULL;
+
+    if ( FT_NEW( mutex ) )
+      return error;
+
+    if ( FTC_MUTEX_INIT( mutex ) )
+    {
+      FT_FREE( mutex );
+      return FT_THROW( Out_Of_Memory );
+    }
+
+    *amutex = mutex;
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Mutex_Done( FTC_Mutex  mutex,
+                  FT_Memory  memory )
+  {
+    if ( !mutex )
+      return;
+
+    FTC_MUTEX_DONE( mutex );
+    FT_FREE( mutex );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Mutex_Lock( FTC_Mutex  mutex )
+  {
+    FTC_MUTEX_LOCK( mutex );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Mutex_Unlock( FTC_Mutex  mutex )
+  {
+    FTC_MUTEX_UNLOCK( mutex );
+  }
+
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+
+  FT_LOCAL_DEF( void )
+  FTC_Atomic_Inc( FT_Short*  pvalue )
+  {
+    (void)__atomic_add_fetch( pvalue, 1, __ATOMIC_ACQ_REL );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Atomic_Dec( FT_Short*  pvalue )
+  {
+    (void)__atomic_sub_fetch( pvalue, 1, __ATOMIC_ACQ_REL );
+  }
+
+
+  FT_LOCAL_DEF( FT_Short )
+  FTC_Atomic_Get( FT_Short*  pvalue )
+  {
+    return __atomic_load_n( pvalue, __ATOMIC_ACQUIRE );
+  }
+
+#elif defined( _MSC_VER )
+
+  FT_LOCAL_DEF( void )
+  FTC_Atomic_Inc( FT_Short*  pvalue )
+  {
+    (void)_InterlockedIncrement16( (short volatile*)pvalue );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Atomic_Dec( FT_Short*  pvalue )
+  {
+    (void)_InterlockedDecrement16( (short volatile*)pvalue );
+  }
+
+
+  FT_LOCAL_DEF( FT_Short )
+  FTC_Atomic_Get( FT_Short*  pvalue )
+  {
+    return (FT_Short)_InterlockedOr16( (short volatile*)pvalue, 0 );
+  }
+
+#else
+
+#error "FTC_CONFIG_OPTION_CONCURRENT needs atomic operations;"
+#error "please add them for your compiler to `src/cache/ftcsync.c'."
+
+#endif
+
+#else /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+  /* ANSI C doesn't like empty source files */
+  typedef int  _ftc_sync_dummy;
+
+#endif /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+
+/* END */
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * ftcsync.h
+ *
+ *   FreeType cache synchronization primitives (specification).
+ *
+ * Copyright 2000-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+  /**************************************************************************
+   *
+   * Concurrent cache managers (see `FTC_Manager_NewConcurrent') need
+   * mutexes and atomic reference counts.  FreeType itself has no notion
+   * of threads, so both are only available if the cache sub-system is
+   * compiled with `FTC_CONFIG_OPTION_CONCURRENT'; otherwise, the atomic
+   * operations below reduce to ordinary arithmetic.
+   *
+   */
+
+
+#ifndef FTCSYNC_H_
+#define FTCSYNC_H_
+
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+
+FT_BEGIN_HEADER
+
+
+#ifdef FTC_CONFIG_OPTION_CONCURRENT
+
+  typedef struct FTC_MutexRec_*  FTC_Mutex;
+
+
+  FT_LOCAL( FT_Error )
+  FTC_Mutex_New( FT_Memory   memory,
+                 FTC_Mutex  *amutex );
+
+  FT_LOCAL( void )
+  FTC_Mutex_Done( FTC_Mutex  mutex,
+                  FT_Memory  memory );
+
+  FT_LOCAL( void )
+  FTC_Mutex_Lock( FTC_Mutex  mutex );
+
+  FT_LOCAL( void )
+  FTC_Mutex_Unlock( FTC_Mutex  mutex );
+
+
+  FT_LOCAL( void )
+  FTC_Atomic_Inc( FT_Short*  pvalue );
+
+  FT_LOCAL( void )
+  FTC_Atomic_Dec( FT_Short*  pvalue );
+
+  FT_LOCAL( FT_Short )
+  FTC_Atomic_Get( FT_Short*  pvalue );
+
+
+#define FTC_ATOMIC_INC( p )  FTC_Atomic_Inc( p )
+#define FTC_ATOMIC_DEC( p )  FTC_Atomic_Dec( p )
+#define FTC_ATOMIC_GET( p )  FTC_Atomic_Get( p )
+
+#else /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+#define FTC_ATOMIC_INC( p )  ( (void)( (*(p))++ ) )
+#define FTC_ATOMIC_DEC( p )  ( (void)( (*(p))-- ) )
+#define FTC_ATOMIC_GET( p )  ( *(p) )
+
+#endif /* !FTC_CONFIG_OPTION_CONCURRENT */
+
+
+FT_END_HEADER
+
+#endif /* FTCSYNC_H_ */
+
+
+/* END */
@@ -28,26 +28,32 @@ CACHE_COMPILE := $(CC) $(ANSIFLAGS)                              \
 
 # Cache driver sources (i.e., C files)
 #
-CACHE_DRV_SRC := $(CACHE_DIR)/ftcbasic.c \
+CACHE_DRV_SRC := $(CACHE_DIR)/ftcatlas.c \
+                 $(CACHE_DIR)/ftcbasic.c \
                  $(CACHE_DIR)/ftccache.c \
                  $(CACHE_DIR)/ftccmap.c  \
                  $(CACHE_DIR)/ftcglyph.c \
                  $(CACHE_DIR)/ftcimage.c \
                  $(CACHE_DIR)/ftcmanag.c \
                  $(CACHE_DIR)/ftcmru.c   \
-                 $(CACHE_DIR)/ftcsbits.c
+                 $(CACHE_DIR)/ftcsbits.c \
+                 $(CACHE_DIR)/ftcsnap.c  \
+                 $(CACHE_DIR)/ftcsync.c
 
 
 # Cache driver headers
 #
-CACHE_DRV_H := $(CACHE_DIR)/ftccache.h \
+CACHE_DRV_H := $(CACHE_DIR)/ftcatlas.h \
+               $(CACHE_DIR)/ftccache.h \
                $(CACHE_DIR)/ftccback.h \
                $(CACHE_DIR)/ftcerror.h \
                $(CACHE_DIR)/ftcglyph.h \
                $(CACHE_DIR)/ftcimage.h \
                $(CACHE_DIR)/ftcmanag.h \
                $(CACHE_DIR)/ftcmru.h   \
-               $(CACHE_DIR)/ftcsbits.h
+               $(CACHE_DIR)/ftcsbits.h \
+               $(CACHE_DIR)/ftcsnap.h  \
+               $(CACHE_DIR)/ftcsync.h
 
 
 # Cache driver object(s)
@@ -90,7 +90,7 @@
       code = (FT_ULong)encodings[i].enc;
       if ( charcode == code )
       {
-        result = encodings[i].glyph;
+        result = encodings[i].glyph + 1;
         goto Exit;
       }
     }
@@ -157,6 +157,22 @@
 
     memory = FT_FACE_MEMORY( face );
 
+    if ( face->tfm_data )
+    {
+      TFM_Service  tfm        = (TFM_Service)face->tfm;
+      FT_Module    tfm_module = FT_Get_Module( FT_FACE_LIBRARY( face ),
+                                               "tfm" );
+
+
+      /* during library shutdown the `tfm' module might be gone */
+      /* already; it has then discarded all metrics by itself   */
+      if ( tfm_module )
+        tfm->tfm_metrics_funcs->release( tfm_module,
+                                         (TFM_FontInfo)face->tfm_data );
+
+      face->tfm_data = NULL;
+    }
+
     FT_FREE( gfface->available_sizes );
 
     if( face->gf_glyph )
@@ -244,11 +260,12 @@
      */
 
     gfface->family_name     = NULL;
-    gfface->num_glyphs      = (FT_Long)go->nglyphs;
+    /* glyph index 0 is an alias of the first glyph, as with BDF */
+    gfface->num_glyphs      = (FT_Long)go->nglyphs + 1;
 
     FT_TRACE4(( "  number of glyphs: allocated %d\n",gfface->num_glyphs ));
 
-    if ( gfface->num_glyphs <= 0 )
+    if ( gfface->num_glyphs <= 1 )
     {
       FT_ERROR(( "GF_Face_Init: glyphs not allocated\n" ));
       error = FT_THROW( Invalid_File_Format );
@@ -417,10 +434,10 @@
       goto Exit;
     }
 
-    FT_TRACE1(( "GF_Glyph_Load: glyph index %d charcode is %d\n", glyph_index, go->bm_table[glyph_index].code ));
+    if ( glyph_index > 0 )
+      glyph_index--;
 
-    if ( (FT_Int)glyph_index < 0 )
-      glyph_index = 0;
+    FT_TRACE1(( "GF_Glyph_Load: glyph index %d charcode is %d\n", glyph_index, go->bm_table[glyph_index].code ));
 
     if ( !go->bm_table )
     {
@@ -432,6 +449,11 @@
     /* slot, bitmap => freetype, bm => gflib */
     bm = &gf->gf_glyph->bm_table[glyph_index];
 
+    /* glyph rasters are decoded lazily, on first request */
+    error = gf_load_glyph( FT_FACE_STREAM( face ), bm, FT_FACE_MEMORY( face ) );
+    if ( error )
+      goto Exit;
+
     bitmap->rows       = bm->bbx_height;
     bitmap->width      = bm->bbx_width;
     bitmap->pixel_mode = FT_PIXEL_MODE_MONO;
@@ -445,9 +467,17 @@
 
     bitmap->pitch = (int)bm->raster ;
 
+#ifdef GF_CONFIG_OPTION_CACHE_BITMAPS
     /* note: we don't allocate a new array to hold the bitmap; */
-    /*       we can simply point to it                         */
+    /*       we can simply point to the cached one             */
     ft_glyphslot_set_bitmap( slot, bm->bitmap );
+#else
+    /* hand the decoded raster over to the slot, which frees it */
+    /* when the next glyph gets loaded                          */
+    ft_glyphslot_set_bitmap( slot, bm->bitmap );
+    slot->internal->flags |= FT_GLYPH_OWN_BITMAP;
+    bm->bitmap             = NULL;
+#endif
 
     slot->format      = FT_GLYPH_FORMAT_BITMAP;
     slot->bitmap_left = bm->off_x ;
@@ -474,91 +504,58 @@
     return error;
   }
 
-  FT_LOCAL_DEF( void )
-  TFM_Done_Metrics( FT_Memory     memory,
-                    TFM_FontInfo  fi )
-  {
-    FT_FREE(fi->width);
-    FT_FREE(fi->height);
-    FT_FREE(fi->depth);
-    FT_FREE( fi );
-  }
-
-  /* parse a TFM metrics file */
+  /* attach TFM metrics, shared through the `tfm' module's cache */
   FT_LOCAL_DEF( FT_Error )
   TFM_Read_Metrics( FT_Face    gf_face,
                     FT_Stream  stream )
   {
     TFM_Service    tfm;
-    FT_Memory      memory  = stream->memory;
-    TFM_ParserRec  parser;
+    FT_Module      tfm_module;
     TFM_FontInfo   fi      = NULL;
     FT_Error       error   = FT_ERR( Unknown_File_Format );
     GF_Face        face    = (GF_Face)gf_face;
-    GF_Glyph       gf_glyph= face->gf_glyph;
 
 
+    tfm        = (TFM_Service)face->tfm;
+    tfm_module = FT_Get_Module( FT_FACE_LIBRARY( face ), "tfm" );
+    if ( !tfm_module || !tfm->tfm_metrics_funcs )
+      return FT_THROW( Missing_Module );
+
     if ( face->tfm_data )
     {
       FT_TRACE1(( "TFM_Read_Metrics:"
-                  " Freeing previously attached metrics data.\n" ));
-      TFM_Done_Metrics( memory, (TFM_FontInfo)face->tfm_data );
+                  " Releasing previously attached metrics data.\n" ));
+      tfm->tfm_metrics_funcs->release( tfm_module,
+                                       (TFM_FontInfo)face->tfm_data );
 
       face->tfm_data = NULL;
     }
 
-    if ( FT_NEW( fi ) )
-      goto Exit;
-
     FT_TRACE4(( "TFM_Read_Metrics: Invoking TFM_Service.\n" ));
 
-    tfm = (TFM_Service)face->tfm;
-    if ( tfm->tfm_parser_funcs )
-    {
-      /* Initialise TFM Service */
-      error = tfm->tfm_parser_funcs->init( &parser,
-                                           memory,
-                                           stream );
-
-      if ( !error )
-      {
-        FT_TRACE4(( "TFM_Read_Metrics: Initialised tfm metric data.\n" ));
-        parser.FontInfo  = fi;
-        parser.user_data = gf_glyph;
-
-        error = tfm->tfm_parser_funcs->parse_metrics( &parser );
-        if( !error )
-          FT_TRACE4(( "TFM_Read_Metrics: parsing TFM metric information done.\n" ));
-
-        FT_TRACE6(( "TFM_Read_Metrics: TFM Metric Information:\n"
-                    "                  Check Sum  : %ld\n"
-                    "                  Design Size: %ld\n"
-                    "                  Begin Char : %d\n"
-                    "                  End Char   : %d\n"
-                    "                  font_bbx_w : %d\n"
-                    "                  font_bbx_h : %d\n"
-                    "                  slant      : %d\n", parser.FontInfo->cs, parser.FontInfo->design_size, parser.FontInfo->begin_char,
-                                                           parser.FontInfo->end_char, parser.FontInfo->font_bbx_w,
-                                                           parser.FontInfo->font_bbx_h, parser.FontInfo->slant ));
-        tfm->tfm_parser_funcs->done( &parser );
-      }
-    }
+    error = tfm->tfm_metrics_funcs->acquire( tfm_module, stream, &fi );
+    if ( error )
+      return error;
 
-    if ( !error )
-    {
-      /* Modify GF_Glyph data according to TFM metric values */
+    FT_TRACE6(( "TFM_Read_Metrics: TFM Metric Information:\n"
+                "                  Check Sum  : %ld\n"
+                "                  Design Size: %ld\n"
+                "                  Begin Char : %d\n"
+                "                  End Char   : %d\n"
+                "                  font_bbx_w : %d\n"
+                "                  font_bbx_h : %d\n"
+                "                  slant      : %d\n", fi->cs, fi->design_size, fi->begin_char,
+                                                       fi->end_char, fi->font_bbx_w,
+                                                       fi->font_bbx_h, fi->slant ));
 
-      /*
-      face->gf_glyph->font_bbx_w = fi->font_bbx_w;
-      face->gf_glyph->font_bbx_h = fi->font_bbx_h;
-      */
+    /* Modify GF_Glyph data according to TFM metric values */
 
-      face->tfm_data       = fi;
-    }
+    /*
+    face->gf_glyph->font_bbx_w = fi->font_bbx_w;
+    face->gf_glyph->font_bbx_h = fi->font_bbx_h;
+    */
 
-  Exit:
-    if ( fi )
-      TFM_Done_Metrics( memory, fi );
+    face->tfm_data = fi;
 
     return error;
   }
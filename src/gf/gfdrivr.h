@@ -44,6 +44,7 @@ FT_BEGIN_HEADER
     FT_Byte         *bitmap;
     FT_UInt         raster;
     FT_UShort       code;
+    FT_ULong        char_offset;  /* stream offset of the glyph's BOC */
 
   } GF_BitmapRec, *GF_Bitmap;
 
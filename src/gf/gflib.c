@@ -280,13 +280,9 @@ FT_Byte  bit_table[] = {
       }
 
       /* allocate and build bitmap */
-      if ((bm->bitmap = (FT_Byte*)malloc(h*((w+7)/8))) == NULL)
-      {
-        error = FT_THROW( Invalid_File_Format );
+      if ( FT_ALLOC_MULT( bm->bitmap, h, (w+7)/8 ) )
         return -1;
-      }
 
-      memset(bm->bitmap, 0, h*((w+7)/8));
       bm->raster     = (FT_UInt)(w+7)/8;
       bm->bbx_width  = w;
       bm->bbx_height = h;
@@ -397,7 +393,7 @@ FT_Byte  bit_table[] = {
     FT_Long          ds, check_sum, hppp, vppp;
     FT_Long          min_m, max_m, min_n, max_n, w;
     FT_UInt          dx, dy;
-    FT_Long          ptr_post, ptr_p, ptr, optr, rptr;
+    FT_Long          ptr_post, ptr_p, ptr, rptr;
     FT_Int           bc, ec, nchars, i, ngphs, idx;
     FT_Error         error  = FT_Err_Ok;
     FT_Memory        memory = extmemory; /* needed for FT_NEW */
@@ -651,9 +647,12 @@ FT_Byte  bit_table[] = {
         goto Exit;
       }
 
-      optr = stream->pos;
-      if( FT_STREAM_SEEK( ptr ) )
+      if ( ptr < 0 || (FT_ULong)ptr >= stream->size )
+      {
+        FT_ERROR(( "gf_load_font: invalid character offset\n" ));
+        error = FT_THROW( Invalid_File_Format );
         goto Exit;
+      }
 
       for ( i = 0; i < 256; i++ )
       {
@@ -665,16 +664,14 @@ FT_Byte  bit_table[] = {
       }
       bm = &go->bm_table[idx];
 
-      bm->mv_x     = dx;
-      bm->mv_y     = dy;
-      bm->code     = code;
-      go->nglyphs += 1;
-
-      if (gf_read_glyph( stream, bm, memory ) < 0)
-        goto Exit;
-
-      if(FT_STREAM_SEEK( optr ))
-        goto Exit;
+      /* the glyph's raster is decoded by `gf_load_glyph' on first use; */
+      /* here we only remember where its BOC command starts             */
+      bm->mv_x        = dx;
+      bm->mv_y        = dy;
+      bm->code        = code;
+      bm->char_offset = (FT_ULong)ptr;
+      bm->bitmap      = NULL;
+      go->nglyphs    += 1;
     }
 
     FT_FREE(of);
@@ -696,16 +693,45 @@ FT_Byte  bit_table[] = {
   }
 
 
+  /* Decode the raster of glyph `bm' if it has not been done yet.  The */
+  /* stream position is not preserved.                                */
+  FT_LOCAL_DEF( FT_Error )
+  gf_load_glyph( FT_Stream    stream,
+                 GF_Bitmap    bm,
+                 FT_Memory    memory )
+  {
+    FT_Error  error;
+
+
+    if ( bm->bitmap )
+      return FT_Err_Ok;
+
+    if ( FT_STREAM_SEEK( bm->char_offset ) )
+      return error;
+
+    if ( gf_read_glyph( stream, bm, memory ) )
+    {
+      FT_ERROR(( "gf_load_glyph: cannot decode glyph %d\n", bm->code ));
+      FT_FREE( bm->bitmap );
+      return FT_THROW( Invalid_File_Format );
+    }
+
+    return FT_Err_Ok;
+  }
+
+
   FT_LOCAL_DEF( void )
   gf_free_font( GF_Face face )
   {
     FT_Memory  memory = FT_FACE( face )->memory;
     GF_Glyph   go     = face->gf_glyph;
-    FT_UInt    nchars = FT_FACE( face )->num_glyphs,i;
+    FT_UInt    nchars, i;
 
     if ( !go )
       return;
 
+    nchars = (FT_UInt)go->nglyphs;
+
     if( go->bm_table )
     {
       for (i = 0; i < nchars; i++)
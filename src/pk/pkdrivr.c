@@ -89,7 +89,7 @@
       code = (FT_ULong)encodings[i].enc;
       if ( charcode == code )
       {
-        result = encodings[i].glyph;
+        result = encodings[i].glyph + 1;
         goto Exit;
       }
     }
@@ -157,6 +157,25 @@
 
     memory = FT_FACE_MEMORY( face );
 
+    if ( face->tfm_data )
+    {
+      TFM_Service  tfm        = (TFM_Service)face->tfm;
+      FT_Module    tfm_module = FT_Get_Module( FT_FACE_LIBRARY( face ),
+                                               "tfm" );
+
+
+      /* during library shutdown the `tfm' module might be gone */
+      /* already; it has then discarded all metrics by itself   */
+      if ( tfm_module )
+        tfm->tfm_metrics_funcs->release( tfm_module,
+                                         (TFM_FontInfo)face->tfm_data );
+
+      face->tfm_data = NULL;
+    }
+
+    if( face->pk_glyph )
+      FT_FREE( face->pk_glyph->encodings );
+
     pk_free_font( face );
 
     FT_FREE( pkface->available_sizes );
@@ -174,7 +193,6 @@
     FT_Error    error  = FT_Err_Ok;
     FT_Memory   memory = FT_FACE_MEMORY( face );
     PK_Glyph    go=NULL;
-    FT_UInt16   i,count;
 
     TFM_Service tfm;
 
@@ -240,17 +258,12 @@
      */
 
     pkface->family_name     = NULL;
-    count=0;
-    for (i = 0; i < 256; i++)
-    {
-      if(go->bm_table[i].bitmap != NULL)
-        count++;
-    }
-    pkface->num_glyphs      = (FT_Long)count;
+    /* glyph index 0 is an alias of the first glyph, as with BDF */
+    pkface->num_glyphs      = (FT_Long)go->nglyphs + 1;
 
     FT_TRACE4(( "  number of glyphs: allocated %d\n",pkface->num_glyphs ));
 
-    if ( pkface->num_glyphs <= 0 )
+    if ( pkface->num_glyphs <= 1 )
     {
       FT_ERROR(( "PK_Face_Init: glyphs not allocated\n" ));
       error = FT_THROW( Invalid_File_Format );
@@ -420,6 +433,9 @@
       goto Exit;
     }
 
+    if ( glyph_index > 0 )
+      glyph_index--;
+
     FT_TRACE1(( "PK_Glyph_Load: glyph index %d\n", glyph_index ));
 
     if ( !go->bm_table )
@@ -432,6 +448,11 @@
     /* slot, bitmap => freetype, bm => pklib */
     bm = &pk->pk_glyph->bm_table[glyph_index];
 
+    /* glyph rasters are unpacked lazily, on first request */
+    error = pk_load_glyph( FT_FACE_STREAM( face ), bm, FT_FACE_MEMORY( face ) );
+    if ( error )
+      goto Exit;
+
     bitmap->rows       = bm->bbx_height;
     bitmap->width      = bm->bbx_width;
     bitmap->pixel_mode = FT_PIXEL_MODE_MONO;
@@ -445,9 +466,17 @@
 
     bitmap->pitch = (int)bm->raster ;
 
+#ifdef PK_CONFIG_OPTION_CACHE_BITMAPS
     /* note: we don't allocate a new array to hold the bitmap; */
-    /*       we can simply point to it                         */
+    /*       we can simply point to the cached one             */
+    ft_glyphslot_set_bitmap( slot, bm->bitmap );
+#else
+    /* hand the unpacked raster over to the slot, which frees it */
+    /* when the next glyph gets loaded                           */
     ft_glyphslot_set_bitmap( slot, bm->bitmap );
+    slot->internal->flags |= FT_GLYPH_OWN_BITMAP;
+    bm->bitmap             = NULL;
+#endif
 
     slot->format      = FT_GLYPH_FORMAT_BITMAP;
     slot->bitmap_left = bm->off_x ;
@@ -466,92 +495,58 @@
   }
 
 
-  FT_LOCAL_DEF( void )
-  TFM_Done_Metrics( FT_Memory     memory,
-                    TFM_FontInfo  fi )
-  {
-    FT_FREE(fi->width);
-    FT_FREE(fi->height);
-    FT_FREE(fi->depth);
-    FT_FREE( fi );
-  }
-
-
-  /* parse a TFM metrics file */
+  /* attach TFM metrics, shared through the `tfm' module's cache */
   FT_LOCAL_DEF( FT_Error )
   TFM_Read_Metrics( FT_Face    pk_face,
                     FT_Stream  stream )
   {
     TFM_Service    tfm;
-    FT_Memory      memory  = stream->memory;
-    TFM_ParserRec  parser;
+    FT_Module      tfm_module;
     TFM_FontInfo   fi      = NULL;
     FT_Error       error   = FT_ERR( Unknown_File_Format );
     PK_Face        face    = (PK_Face)pk_face;
-    PK_Glyph       pk_glyph= face->pk_glyph;
 
 
+    tfm        = (TFM_Service)face->tfm;
+    tfm_module = FT_Get_Module( FT_FACE_LIBRARY( face ), "tfm" );
+    if ( !tfm_module || !tfm->tfm_metrics_funcs )
+      return FT_THROW( Missing_Module );
+
     if ( face->tfm_data )
     {
       FT_TRACE1(( "TFM_Read_Metrics:"
-                  " Freeing previously attached metrics data.\n" ));
-      TFM_Done_Metrics( memory, (TFM_FontInfo)face->tfm_data );
+                  " Releasing previously attached metrics data.\n" ));
+      tfm->tfm_metrics_funcs->release( tfm_module,
+                                       (TFM_FontInfo)face->tfm_data );
 
       face->tfm_data = NULL;
     }
 
-    if ( FT_NEW( fi ) )
-      goto Exit;
-
     FT_TRACE4(( "TFM_Read_Metrics: Invoking TFM_Service.\n" ));
 
-    tfm = (TFM_Service)face->tfm;
-    if ( tfm->tfm_parser_funcs )
-    {
-      /* Initialise TFM Service */
-      error = tfm->tfm_parser_funcs->init( &parser,
-                                           memory,
-                                           stream );
-
-      if ( !error )
-      {
-        FT_TRACE4(( "TFM_Read_Metrics: Initialised tfm metric data.\n" ));
-        parser.FontInfo  = fi;
-        parser.user_data = pk_glyph;
-
-        error = tfm->tfm_parser_funcs->parse_metrics( &parser );
-        if( !error )
-          FT_TRACE4(( "TFM_Read_Metrics: parsing TFM metric information done.\n" ));
-
-        FT_TRACE6(( "TFM_Read_Metrics: TFM Metric Information:\n"
-                    "                  Check Sum  : %ld\n"
-                    "                  Design Size: %ld\n"
-                    "                  Begin Char : %d\n"
-                    "                  End Char   : %d\n"
-                    "                  font_bbx_w : %d\n"
-                    "                  font_bbx_h : %d\n"
-                    "                  slant      : %d\n", parser.FontInfo->cs, parser.FontInfo->design_size, parser.FontInfo->begin_char,
-                                                           parser.FontInfo->end_char, parser.FontInfo->font_bbx_w,
-                                                           parser.FontInfo->font_bbx_h, parser.FontInfo->slant ));
-        tfm->tfm_parser_funcs->done( &parser );
-      }
-    }
+    error = tfm->tfm_metrics_funcs->acquire( tfm_module, stream, &fi );
+    if ( error )
+      return error;
 
-    if ( !error )
-    {
-      /* Modify PK_Glyph data according to TFM metric values */
+    FT_TRACE6(( "TFM_Read_Metrics: TFM Metric Information:\n"
+                "                  Check Sum  : %ld\n"
+                "                  Design Size: %ld\n"
+                "                  Begin Char : %d\n"
+                "                  End Char   : %d\n"
+                "                  font_bbx_w : %d\n"
+                "                  font_bbx_h : %d\n"
+                "                  slant      : %d\n", fi->cs, fi->design_size, fi->begin_char,
+                                                       fi->end_char, fi->font_bbx_w,
+                                                       fi->font_bbx_h, fi->slant ));
 
-      /*
-      face->pk_glyph->font_bbx_w = fi->font_bbx_w;
-      face->pk_glyph->font_bbx_h = fi->font_bbx_h;
-      */
+    /* Modify PK_Glyph data according to TFM metric values */
 
-      face->tfm_data       = fi;
-    }
+    /*
+    face->pk_glyph->font_bbx_w = fi->font_bbx_w;
+    face->pk_glyph->font_bbx_h = fi->font_bbx_h;
+    */
 
-  Exit:
-    if ( fi )
-      TFM_Done_Metrics( memory, fi );
+    face->tfm_data = fi;
 
     return error;
   }
@@ -43,6 +43,10 @@ FT_BEGIN_HEADER
     FT_Byte         *bitmap;
     FT_UInt         raster;
     FT_UShort       code;
+    FT_ULong        char_offset;  /* stream offset of the packed raster */
+    FT_ULong        raster_size;  /* size of the packed raster          */
+    FT_Byte         dyn_f;
+    FT_Byte         turn_on;
 
   } PK_BitmapRec, *PK_Bitmap;
 
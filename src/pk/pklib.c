@@ -54,12 +54,12 @@ FT_Byte  bits_table[] = {
   FT_ULong  pk_read_uintn( FT_Stream, FT_Int );
 
 #define READ_UINT1( stream )    (FT_Byte)pk_read_uintn( stream, 1)
-#define READ_UINT2( stream )    (FT_Byte)pk_read_uintn( stream, 2)
-#define READ_UINT3( stream )    (FT_Byte)pk_read_uintn( stream, 3)
-#define READ_UINT4( stream )    (FT_Byte)pk_read_uintn( stream, 4)
+#define READ_UINT2( stream )    (FT_UShort)pk_read_uintn( stream, 2)
+#define READ_UINT3( stream )    (FT_ULong)pk_read_uintn( stream, 3)
+#define READ_UINT4( stream )    (FT_ULong)pk_read_uintn( stream, 4)
 #define READ_UINTN( stream,n)   (FT_ULong)pk_read_uintn( stream, n)
 #define READ_INT1( stream )     (FT_String)pk_read_intn( stream, 1)
-#define READ_INT2( stream )     (FT_String)pk_read_intn( stream, 2)
+#define READ_INT2( stream )     (FT_Short)pk_read_intn( stream, 2)
 #define READ_INT4( stream )     (FT_Long)pk_read_intn( stream, 4)
 
 /*
@@ -109,180 +109,254 @@ FT_Byte  bits_table[] = {
     return v;
   }
 
-  FT_Int  pk_read_nyble_rest_cnt;
-  FT_Int  pk_read_nyble_max_bytes;
+  /**************************************************************************
+   *
+   * Raster unpacking.
+   *
+   * Glyph rasters are unpacked from a frame holding the complete packed
+   * raster of a character (which is a plain pointer into the font data
+   * for memory-based streams).  Runs are painted as whole spans, using
+   * the mask tables below for the partial bytes at either end.
+   *
+   */
+
+  /* bits at and right of position `i' within a byte */
+  static const FT_Byte  pk_lmask_table[8] =
+    { 0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01 };
+
+  /* bits left of position `i' within a byte; used for the row end */
+  static const FT_Byte  pk_rmask_table[8] =
+    { 0xFF, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE };
+
 
-  void
-  pk_read_nyble_init( FT_Int max )
+  typedef struct  PK_UnpackerRec_
   {
-    pk_read_nyble_rest_cnt  = 0;
-    pk_read_nyble_max_bytes = max;
-  }
+    FT_Byte*  cursor;
+    FT_Byte*  limit;
+    FT_Int    low;       /* next nybble is the low one of `*cursor' */
+    FT_Int    dyn_f;
+
+  } PK_UnpackerRec, *PK_Unpacker;
 
-  FT_Int
-  pk_read_nyble(FT_Stream stream)
+
+  /* return the next nybble or -1 if the packed data is exhausted */
+  static FT_Int
+  pk_get_nybble( PK_Unpacker  u )
   {
-    static FT_Byte  d;
-    FT_Int          v;
+    FT_Int  v;
+
 
-    switch (pk_read_nyble_rest_cnt)
+    if ( u->cursor >= u->limit )
+      return -1;
+
+    if ( u->low )
+    {
+      v      = *u->cursor++ & 0x0F;
+      u->low = 0;
+    }
+    else
     {
-    case 0:
-      d = READ_UINT1( stream );
-      if (--pk_read_nyble_max_bytes < 0)
-        return -1L;
-      v = d / 0x10;
-      d = d % 0x10;
-      pk_read_nyble_rest_cnt = 1;
-      break;
-    case 1:
-    default:
-      v = d;
-      pk_read_nyble_rest_cnt = 0;
-      break;
+      v      = *u->cursor >> 4;
+      u->low = 1;
     }
-  return v;
+
+    return v;
   }
 
-  FT_Long
-  pk_read_packed_number(FT_Long* repeat, FT_Stream stream, int dyn_f)
+
+  /* decode the next run count, setting `*repeat' if a repeat count */
+  /* precedes it; return -1 if the packed data is exhausted         */
+  static FT_Long
+  pk_get_packed_number( PK_Unpacker  u,
+                        FT_Long*     repeat )
   {
+    FT_Int   dyn_f = u->dyn_f;
     FT_Int   d, n;
-    FT_Long  di;
+    FT_Long  j;
+
+
+    for (;;)
+    {
+      d = pk_get_nybble( u );
+      if ( d < 0 )
+        return -1;
 
-    entry:
-      d = pk_read_nyble( stream );
-      if (d == 0)
+      if ( d == 0 )
       {
         n = 0;
         do
         {
-          di = pk_read_nyble( stream );
+          j = pk_get_nybble( u );
+          if ( j < 0 )
+            return -1;
           n++;
+
+        } while ( j == 0 );
+
+        for ( ; n > 0; n-- )
+        {
+          d = pk_get_nybble( u );
+          if ( d < 0 || j > 0x7FFFFFL )
+            return -1;
+          j = j * 16 + d;
         }
-        while (di == 0);
-        for ( ; n > 0; n--)
-          di = di*16 + pk_read_nyble( stream );
-        return di - 15 + (13 - dyn_f)*16 + dyn_f;
+
+        return j - 15 + ( 13 - dyn_f ) * 16 + dyn_f;
       }
-    if (d <= dyn_f)
-      return d;
-    if (d <= 13)
-      return (d - dyn_f - 1)*16 + pk_read_nyble( stream ) + dyn_f + 1;
-    *repeat = 1;
-    if (d == 14)
-      *repeat = pk_read_packed_number(repeat, stream, dyn_f);
-    goto entry;
+
+      if ( d <= dyn_f )
+        return d;
+
+      if ( d <= 13 )
+      {
+        n = pk_get_nybble( u );
+        if ( n < 0 )
+          return -1;
+
+        return ( d - dyn_f - 1 ) * 16 + n + dyn_f + 1;
+      }
+
+      if ( d == 14 )
+      {
+        *repeat = pk_get_packed_number( u, repeat );
+        if ( *repeat < 0 )
+          return -1;
+      }
+      else
+        *repeat = 1;
+    }
   }
 
-  FT_Int
-  pk_read_14( FT_Stream stream,
-              FT_ULong rs,
-              PK_Bitmap bm )
+
+  /* set `count' bits of `row', starting at bit `x' */
+  static void
+  pk_fill_span( FT_Byte*  row,
+                FT_Long   x,
+                FT_Long   count )
   {
-    FT_Long   x, y, x8, xm;
-    FT_Byte   *bm_ptr;
-    FT_ULong  bit16_buff;
-    FT_Int    rest_bit16_buff;
+    FT_Byte*  p     = row + ( x >> 3 );
+    FT_Long   x2    = x + count;           /* first bit after the span */
+    FT_Byte*  limit = row + ( x2 >> 3 );
+
+
+    if ( p == limit )
+    {
+      *p |= pk_lmask_table[x & 7] & (FT_Byte)~pk_lmask_table[x2 & 7];
+      return;
+    }
+
+    *p++ |= pk_lmask_table[x & 7];
 
-    static FT_UInt mask_table[] =
-      { 0xdead,   0x80,   0xc0,   0xe0,   0xf0,   0xf8,   0xfc,   0xfe, 0xdead };
+    if ( limit > p )
+      FT_MEM_SET( p, 0xFF, limit - p );
 
-    if (rs == 0)
-      return 0;
+    if ( x2 & 7 )
+      *limit |= pk_rmask_table[x2 & 7];
+  }
+
+
+  /* unpack a run-length encoded raster (dyn_f < 14) */
+  static FT_Error
+  pk_unpack_runs( FT_Byte*   data,
+                  FT_ULong   size,
+                  FT_Int     dyn_f,
+                  FT_Int     turn_on,
+                  PK_Bitmap  bm )
+  {
+    PK_UnpackerRec  u;
+    FT_Byte*        row    = bm->bitmap;
+    FT_UInt         raster = bm->raster;
+    FT_Long         width  = bm->bbx_width;
+    FT_Long         y      = 0;
+    FT_Long         x, n, count, repeat;
+    FT_Int          black;
 
-    x8 = bm->bbx_width / 8;
-    xm = bm->bbx_width % 8;
-    bm_ptr = bm->bitmap;
 
-    bit16_buff = READ_UINT1( stream ) << 8;
-    rest_bit16_buff = 8;
-    --rs;
+    u.cursor = data;
+    u.limit  = data + size;
+    u.low    = 0;
+    u.dyn_f  = dyn_f;
 
-    for(y = 0; y < bm->bbx_height; y++)
+    count = 0;
+    black = !turn_on;
+
+    while ( y < bm->bbx_height )
     {
-      for(x = 0; x < x8; x++)
+      repeat = 0;
+
+      for ( x = 0; x < width; x += n )
       {
-        *(bm_ptr++) = bit16_buff >> 8;
-        rest_bit16_buff -= 8;
-        bit16_buff = (bit16_buff << 8) & 0xffff;
-        if (rs > 0)
+        if ( count == 0 )
         {
-	        bit16_buff |= (READ_UINT1( stream ) << (8 - rest_bit16_buff));
-	        rest_bit16_buff += 8;
-	        --rs;
+          black = !black;
+          count = pk_get_packed_number( &u, &repeat );
+          if ( count < 0 )
+            return FT_THROW( Invalid_File_Format );
+          if ( count == 0 )
+          {
+            n = 0;
+            continue;
+          }
         }
+
+        n = FT_MIN( count, width - x );
+        if ( black )
+          pk_fill_span( row, x, n );
+        count -= n;
       }
-      if (xm != 0)
+
+      row += raster;
+      y++;
+
+      for ( ; repeat > 0 && y < bm->bbx_height; repeat--, y++ )
       {
-        *(bm_ptr++) = (bit16_buff >> 8) & mask_table[xm];
-        rest_bit16_buff -= xm;
-        bit16_buff = (bit16_buff << xm) & 0xffff;
-        if (rest_bit16_buff < 8)
-        {
-	        if (rs > 0)
-	        {
-	          bit16_buff |= (READ_UINT1( stream ) << (8 - rest_bit16_buff));
-	          rest_bit16_buff += 8;
-	          --rs;
-	        }
-        }
+        FT_MEM_COPY( row, row - raster, raster );
+        row += raster;
       }
     }
-    return 0;
+
+    return FT_Err_Ok;
   }
 
-  FT_Int
-  pk_read_n14( FT_Stream stream,
-               FT_Int dyn_f,
-               FT_Int bw,
-               FT_ULong rs,
-               PK_Bitmap bm )
+
+  /* unpack a raster stored as a plain bit stream (dyn_f == 14) */
+  static void
+  pk_unpack_bits( FT_Byte*   data,
+                  FT_ULong   size,
+                  PK_Bitmap  bm )
   {
-    FT_Long   x, y, xx, yy, repeat;
-    FT_Int    bits, b_p;
-    FT_Byte   *p, *p0, *p1;
-
-    pk_read_nyble_init(rs);
-    p    = bm->bitmap;
-    bw   = 1-bw;
-    bits = 0;
-    for (y = 0; y < bm->bbx_height; )
+    FT_Byte*  row    = bm->bitmap;
+    FT_UInt   raster = bm->raster;
+    FT_ULong  pos    = 0;      /* bit position in `data' */
+    FT_Long   y;
+    FT_UInt   i;
+
+
+    if ( !raster )
+      return;
+
+    for ( y = 0; y < bm->bbx_height; y++ )
     {
-      b_p    = 0;
-      repeat = 0;
-      p0     = p;
-      for (x = 0; x < bm->bbx_width; x++)
-      {
-        if (bits == 0)
-        {
-	        bw   = 1-bw;
-	        if ((bits = pk_read_packed_number(&repeat, stream, dyn_f)) < 0)
-	          return -1;
-        }
-        if (bw == 1)
-	        *p = *p | bits_table[b_p];
-        --bits;
-        if (++b_p >= 8)
-        {
-	        b_p = 0;
-	        p++;
-        }
-      }
-      if (b_p != 0)
-        p++;
-      y++;
-      for (yy = 0; yy < repeat; yy++)
+      for ( i = 0; i < raster; i++ )
       {
-        p1 = p0;
-        for (xx = 0; xx < bm->raster; xx++)
-	        *(p++) = *(p1++);
-        y++;
+        FT_ULong  idx = ( pos >> 3 ) + i;
+        FT_UInt   v;
+
+
+        v  = idx < size ? (FT_UInt)data[idx] << 8 : 0;
+        v |= idx + 1 < size ? data[idx + 1] : 0;
+
+        row[i] = (FT_Byte)( ( v << ( pos & 7 ) ) >> 8 );
       }
+
+      row[raster - 1] &= pk_rmask_table[bm->bbx_width & 7];
+
+      row += raster;
+      pos += (FT_ULong)bm->bbx_width;
     }
-    return 0;
   }
 
+
   /**************************************************************************
    *
    * API.
@@ -300,7 +374,7 @@ FT_Byte  bits_table[] = {
     FT_UInt    flag, dny_f, bw, ess, size;
     FT_ULong   cc, tfm, dx, dy, dm, w, h, rs;
     FT_Long    hoff, voff, mv_x, mv_y, gptr;
-    FT_Int     bc, ec, nchars, index, i;
+    FT_Int     bc, ec, nchars, index;
     FT_Error   error  = FT_Err_Ok;
     FT_Memory  memory = extmemory; /* needed for FT_NEW */
     PK_Encoding   encoding = NULL;
@@ -395,7 +469,7 @@ FT_Byte  bits_table[] = {
       goto Exit;
 
     if ( FT_NEW_ARRAY( encoding, nchars ) )
-      return error;
+      goto Exit;
 
     go->ds   = (FT_UInt)ds/(1<<20);
     go->hppp = (FT_UInt)hppp/(1<<16);
@@ -492,53 +566,39 @@ FT_Byte  bits_table[] = {
           mv_y = (FT_UInt)dy/(FT_UInt)(1<<16);
         }
 
-        if ((cc < go->code_min) || (go->code_max < cc))
+        if ((cc < go->code_min) || (go->code_max < cc) || index >= nchars)
         {
           error = FT_THROW( Invalid_File_Format );
           goto Exit;
         }
 
-        go->bm_table[index].bbx_width  = w;
-        go->bm_table[index].bbx_height = h;
-        go->bm_table[index].raster = (w+7)/8;
-        go->bm_table[index].off_x  = -hoff;
-        go->bm_table[index].off_y  = voff;
-        go->bm_table[index].mv_x   = mv_x;
-        go->bm_table[index].mv_y   = mv_y;
-        go->bm_table[index].bitmap = (unsigned char*)malloc(h*((w+7)/8));
-        go->bm_table[index].code   = cc ; /* For backward compatibility */
-        go->nglyphs               += 1;
+        /* only remember where the packed raster lives; */
+        /* it gets unpacked by `pk_load_glyph'          */
+        go->bm_table[index].bbx_width   = w;
+        go->bm_table[index].bbx_height  = h;
+        go->bm_table[index].raster      = (w+7)/8;
+        go->bm_table[index].off_x       = -hoff;
+        go->bm_table[index].off_y       = voff;
+        go->bm_table[index].mv_x        = mv_x;
+        go->bm_table[index].mv_y        = mv_y;
+        go->bm_table[index].bitmap      = NULL;
+        go->bm_table[index].code        = cc ; /* For backward compatibility */
+        go->bm_table[index].char_offset = stream->pos;
+        go->bm_table[index].raster_size = rs;
+        go->bm_table[index].dyn_f       = (FT_Byte)dny_f;
+        go->bm_table[index].turn_on     = (FT_Byte)bw;
+        go->nglyphs                    += 1;
 
         encoding[index].enc   = cc ;
         encoding[index].glyph = index;
 
-
-        if (go->bm_table[index].bitmap == NULL)
+        if ( dny_f == 15 || FT_STREAM_SKIP( rs ) )
         {
+          FT_ERROR(( "pk_load_font: invalid character packet\n" ));
           error = FT_THROW( Invalid_File_Format );
           goto Exit;
         }
 
-        memset(go->bm_table[index].bitmap, 0, h*((w+7)/8));
-
-        if (dny_f == 14)
-        {
-          if ( pk_read_14(stream, rs, &(go->bm_table[index]) ) < 0)
-          {
-            FT_ERROR(( "pk_load_font: error in `pk_read_14'\n" ));
-            error = FT_THROW( Unknown_File_Format );
-            goto Exit;
-          }
-        }
-        else
-        {
-          if (pk_read_n14(stream, dny_f, bw, rs, &(go->bm_table[index]) ) < 0)
-          {
-            FT_ERROR(( "pk_load_font: error in `pk_read_n14'\n" ));
-            error = FT_THROW( Unknown_File_Format );
-            goto Exit;
-          }
-        }
         if (go->font_bbx_w < w)
           go->font_bbx_w = w;
         if (go->font_bbx_h < h)
@@ -559,29 +619,70 @@ FT_Byte  bits_table[] = {
     return error;
 
     Exit:
+      FT_FREE(encoding);
       if (go != NULL)
       {
-        for (i = 0; i < nchars; i++)
-        {
-          if (go->bm_table[i].bitmap != NULL)
-           FT_FREE(go->bm_table[i].bitmap);
-        }
         FT_FREE(go->bm_table);
         FT_FREE(go);
       }
       return error;
   }
 
+
+  /* Unpack the raster of glyph `bm' if it has not been done yet.  The */
+  /* stream position is not preserved.                                 */
+  FT_LOCAL_DEF( FT_Error )
+  pk_load_glyph( FT_Stream    stream,
+                 PK_Bitmap    bm,
+                 FT_Memory    memory )
+  {
+    FT_Error  error;
+
+
+    if ( bm->bitmap )
+      return FT_Err_Ok;
+
+    if ( FT_ALLOC_MULT( bm->bitmap, bm->bbx_height, bm->raster ) )
+      return error;
+
+    /* an empty packet leaves the raster blank */
+    if ( !bm->bitmap || !bm->raster_size )
+      return FT_Err_Ok;
+
+    if ( FT_STREAM_SEEK( bm->char_offset )  ||
+         FT_FRAME_ENTER( bm->raster_size ) )
+      goto Fail;
+
+    if ( bm->dyn_f == 14 )
+      pk_unpack_bits( stream->cursor, bm->raster_size, bm );
+    else
+      error = pk_unpack_runs( stream->cursor, bm->raster_size,
+                              bm->dyn_f, bm->turn_on, bm );
+
+    FT_FRAME_EXIT();
+
+    if ( !error )
+      return FT_Err_Ok;
+
+    FT_ERROR(( "pk_load_glyph: cannot unpack glyph %d\n", bm->code ));
+
+  Fail:
+    FT_FREE( bm->bitmap );
+    return error;
+  }
+
   FT_LOCAL_DEF( void )
   pk_free_font( PK_Face face )
   {
     FT_Memory  memory = FT_FACE( face )->memory;
     PK_Glyph   go     = face->pk_glyph;
-    FT_UInt    nchars = FT_FACE( face )->num_glyphs,i;
+    FT_UInt    nchars, i;
 
     if ( !go )
       return;
 
+    nchars = (FT_UInt)go->nglyphs;
+
     if( go->bm_table )
     {
       for (i = 0; i < nchars; i++)
@@ -137,7 +137,10 @@
    *   optimize performance (see technical note on the sweep below).
    *
    *   Of course, the raster detects whether the two stacks collide and
-   *   handles the situation properly.
+   *   handles the situation properly: the render pool is replaced with a
+   *   larger one allocated from the heap for the rest of the rendering,
+   *   and the glyph is converted again.  Only if the pool can't grow any
+   *   further is the glyph split into bands (see Render_Single_Pass()).
    *
    */
 
@@ -294,6 +297,9 @@
                         /* Setting this constant to more than 32 is a   */
                         /* pure waste of space.                         */
 
+#define MaxRects   16   /* The maximum number of rectangles drawn by */
+                        /* `Render_Rectangles'.                      */
+
 #define Pixel_Bits  6   /* fractional bits of *input* coordinates */
 
 
@@ -466,6 +472,22 @@
 #define FT_MAX_BLACK_POOL  ( 2048 / sizeof ( Long ) )
 #endif
 
+  /* maximum number of Longs in the heap-allocated render pool; */
+  /* without a memory allocator only the stack buffer is used   */
+#ifndef FT_MAX_RENDER_POOL_SIZE
+#define FT_MAX_RENDER_POOL_SIZE  ( 4L * 1024L * 1024L )
+#endif
+
+#if !defined( STANDALONE_ )                         && \
+    FT_MAX_RENDER_POOL_SIZE > FT_RENDER_POOL_SIZE   && \
+    FT_MAX_RENDER_POOL_SIZE > 2048
+#define BLACK_HEAP_POOL
+#define FT_MAX_BLACK_HEAP  ( FT_MAX_RENDER_POOL_SIZE / sizeof ( Long ) )
+#endif
+
+
+  typedef struct black_TRaster_  black_TRaster, *black_PRaster;
+
   /* The most used variables are positioned at the top of the structure. */
   /* Thus, their offset can be coded with less opcodes, resulting in a   */
   /* smaller executable.                                                 */
@@ -535,14 +557,17 @@
     black_TBand  band_stack[16];    /* band stack used for sub-banding     */
     Int          band_top;          /* band stack top                      */
 
+    black_PRaster  raster;          /* provides the memory allocator       */
+    PLong          heap;            /* heap render pool of this rendering  */
+
   };
 
 
-  typedef struct  black_TRaster_
+  struct  black_TRaster_
   {
-    void*          memory;
+    void*  memory;
 
-  } black_TRaster, *black_PRaster;
+  };
 
 #ifdef FT_STATIC_RASTER
 
@@ -2991,6 +3016,54 @@
 #endif /* STANDALONE_ */
 
 
+#ifdef BLACK_HEAP_POOL
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   Grow_Pool
+   *
+   * @Description:
+   *   Replace the render pool with a heap pool twice as large, but not
+   *   larger than FT_MAX_BLACK_HEAP Longs.  Its contents need not be
+   *   preserved since the band gets converted again.  The pool is freed
+   *   by ft_black_render() when the glyph is done; it can't be kept in
+   *   the raster object, which all threads of a library share.
+   *
+   * @Return:
+   *   TRUE if the pool has grown, FALSE otherwise.
+   */
+  static Bool
+  Grow_Pool( RAS_ARG )
+  {
+    FT_Memory  memory = (FT_Memory)ras.raster->memory;
+    FT_Error   error;
+    ULong      size   = (ULong)( ras.sizeBuff - ras.buff );
+    PLong      pool;
+
+
+    if ( size >= FT_MAX_BLACK_HEAP )
+      return FALSE;
+
+    size = FT_MIN( 2 * size, FT_MAX_BLACK_HEAP );
+
+    if ( FT_QNEW_ARRAY( pool, size ) )
+      return FALSE;
+
+    FT_FREE( ras.heap );
+    ras.heap = pool;
+
+    ras.buff     = pool;
+    ras.sizeBuff = pool + size;
+
+    FT_TRACE7(( "Grow_Pool: %ld Longs\n", size ));
+
+    return TRUE;
+  }
+
+#endif /* BLACK_HEAP_POOL */
+
+
   /**************************************************************************
    *
    * @Function:
@@ -3028,6 +3101,12 @@
 
         ras.error = Raster_Err_None;
 
+#ifdef BLACK_HEAP_POOL
+        /* render pool overflow; try again with a larger pool */
+        if ( Grow_Pool( RAS_VAR ) )
+          continue;
+#endif
+
         /* sub-banding */
 
 #ifdef DEBUG_RASTER
@@ -3067,6 +3146,136 @@
   }
 
 
+  /**************************************************************************
+   *
+   * @Function:
+   *   Render_Rectangles
+   *
+   * @Description:
+   *   Fill an outline made of separate axis-aligned rectangles directly.
+   *   If no edge passes through a pixel center and every rectangle is
+   *   wider and taller than one pixel plus the jitter threshold, neither
+   *   the drop-out rules nor the horizontal pass ever change a pixel,
+   *   and the sweep boils down to filling the pixels whose centers are
+   *   inside a rectangle.  Both the contours' orientation and the fill
+   *   rule are irrelevant as long as the rectangles don't overlap.
+   *
+   * @Return:
+   *   TRUE if the outline has been rendered, FALSE if it must go
+   *   through the profiles.
+   */
+  static Bool
+  Render_Rectangles( RAS_ARG )
+  {
+    FT_BBox  rects[MaxRects];
+    Long     min_size = ras.precision + ras.precision_jitter;
+    Int      n, i, first;
+
+
+    if ( ras.outline.n_contours > MaxRects )
+      return FALSE;
+
+    first = 0;
+    for ( n = 0; n < ras.outline.n_contours; n++ )
+    {
+      FT_Vector*  p    = ras.outline.points + first;
+      char*       tags = ras.outline.tags + first;
+      FT_BBox*    r    = rects + n;
+
+
+      if ( ras.outline.contours[n] != first + 3 )
+        return FALSE;
+
+      for ( i = 0; i < 4; i++ )
+        if ( FT_CURVE_TAG( tags[i] ) != FT_CURVE_TAG_ON )
+          return FALSE;
+
+      /* the sides must alternate between vertical and horizontal */
+      if ( p[0].x == p[1].x )
+      {
+        if ( p[1].y != p[2].y || p[2].x != p[3].x || p[3].y != p[0].y )
+          return FALSE;
+      }
+      else if ( p[0].y != p[1].y || p[1].x != p[2].x ||
+                p[2].y != p[3].y || p[3].x != p[0].x )
+        return FALSE;
+
+      r->xMin = SCALED( p[0].x );
+      r->xMax = SCALED( p[2].x );
+      r->yMin = SCALED( p[0].y );
+      r->yMax = SCALED( p[2].y );
+
+      if ( r->xMin > r->xMax )
+        SWAP_( r->xMin, r->xMax );
+      if ( r->yMin > r->yMax )
+        SWAP_( r->yMin, r->yMax );
+
+      if ( !FRAC( r->xMin ) || !FRAC( r->xMax ) ||
+           !FRAC( r->yMin ) || !FRAC( r->yMax ) )
+        return FALSE;
+
+      if ( r->xMax - r->xMin <= min_size ||
+           r->yMax - r->yMin <= min_size )
+        return FALSE;
+
+      for ( i = 0; i < n; i++ )
+        if ( rects[i].xMin < r->xMax && r->xMin < rects[i].xMax &&
+             rects[i].yMin < r->yMax && r->yMin < rects[i].yMax )
+          return FALSE;
+
+      first += 4;
+    }
+
+    for ( n = 0; n < ras.outline.n_contours; n++ )
+    {
+      Long  e1 = TRUNC( CEILING( rects[n].xMin ) );
+      Long  e2 = TRUNC( FLOOR( rects[n].xMax ) );
+      Long  y1 = TRUNC( CEILING( rects[n].yMin ) );
+      Long  y2 = TRUNC( FLOOR( rects[n].yMax ) );
+
+      Int    c1, c2;
+      Byte   f1, f2;
+      Byte*  target;
+
+
+      if ( e1 < 0 )
+        e1 = 0;
+      if ( e2 >= ras.bWidth )
+        e2 = ras.bWidth - 1;
+      if ( y1 < 0 )
+        y1 = 0;
+      if ( y2 >= (Long)ras.target.rows )
+        y2 = (Long)ras.target.rows - 1;
+
+      if ( e1 > e2 || y1 > y2 )
+        continue;
+
+      c1 = (Int)( e1 >> 3 );
+      c2 = (Int)( e2 >> 3 ) - c1;
+
+      f1 = (Byte)  ( 0xFF >> ( e1 & 7 ) );
+      f2 = (Byte) ~( 0x7F >> ( e2 & 7 ) );
+
+      for ( ; y1 <= y2; y1++ )
+      {
+        target = ras.bOrigin - y1 * ras.target.pitch + c1;
+
+        if ( c2 > 0 )
+        {
+          target[0] |= f1;
+          for ( i = 1; i < c2; i++ )
+            target[i] = 0xFF;
+          target[c2] |= f2;
+        }
+        else
+          *target |= ( f1 & f2 );
+      }
+    }
+
+    return TRUE;
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -3121,6 +3330,9 @@
     if ( ras.target.pitch > 0 )
       ras.bOrigin += (Long)( ras.target.rows - 1 ) * ras.target.pitch;
 
+    if ( Render_Rectangles( RAS_VAR ) )
+      return Raster_Err_None;
+
     if ( ( error = Render_Single_Pass( RAS_VARS 0 ) ) != 0 )
       return error;
 
@@ -3252,8 +3464,11 @@
     const FT_Outline*  outline    = (const FT_Outline*)params->source;
     const FT_Bitmap*   target_map = params->target;
     FT_BBox            cbox;
+    int                error;
 
+#ifndef FT_STATIC_RASTER
     black_TWorker  worker[1];
+#endif
 
     Long  buffer[FT_MAX_BLACK_POOL];
 
@@ -3276,10 +3491,10 @@
       return FT_THROW( Invalid );
 
     /* this version of the raster does not support direct rendering, sorry */
-    if ( params->flags & FT_RASTER_FLAG_DIRECT )
+    if ( params->flags & ( FT_RASTER_FLAG_DIRECT | FT_RASTER_FLAG_SURFACE ) )
       return FT_THROW( Unsupported );
 
-    if ( params->flags & FT_RASTER_FLAG_AA )
+    if ( params->flags & ( FT_RASTER_FLAG_AA | FT_RASTER_FLAG_SDF ) )
       return FT_THROW( Unsupported );
 
     if ( !target_map )
@@ -3313,10 +3528,23 @@
     ras.outline = *outline;
     ras.target  = *target_map;
 
-    worker->buff     = buffer;
-    worker->sizeBuff = (&buffer)[1]; /* Points to right after buffer. */
+    ras.buff     = buffer;
+    ras.sizeBuff = (&buffer)[1]; /* Points to right after buffer. */
+    ras.raster   = (black_PRaster)raster;
+    ras.heap     = NULL;
+
+    error = Render_Glyph( RAS_VAR );
+
+#ifdef BLACK_HEAP_POOL
+    {
+      FT_Memory  memory = (FT_Memory)ras.raster->memory;
 
-    return Render_Glyph( RAS_VAR );
+
+      FT_FREE( ras.heap );
+    }
+#endif
+
+    return error;
   }
 
 
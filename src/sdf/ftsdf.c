@@ -0,0 +1,1849 @@
+/****************************************************************************
+ *
+ * ftsdf.c
+ *
+ *   Signed distance field rasterizer (body).
+ *
+ * Copyright 2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+  /**************************************************************************
+   *
+   * This rasterizer computes signed distance fields directly from an
+   * outline: each pixel of the target gets the distance from its center
+   * to the nearest point of the outline, positive inside and negative
+   * outside, clamped to the spread and mapped to 0..255 so that 128 lies
+   * on the outline.
+   *
+   * The distances are exact up to the fixed-point precision.  Curves are
+   * split into cubic arcs at most SDF_PIECE_SIZE pixels wide and high
+   * (conic arcs are elevated to cubics), and the nearest point of each
+   * arc is found with a few Newton iterations, as in Viktor Chlumsky's
+   * msdfgen, starting from the nearest of a handful of samples.  The
+   * sign is the winding number of the pixel center, computed on a finely
+   * flattened copy of the outline, so that overlapping contours are
+   * handled like by the other rasterizers.
+   *
+   * To avoid testing every piece against every pixel, the bitmap is
+   * divided into a grid of square cells, each with a list of the pieces
+   * that may come closer to it than the spread, sorted by the distance
+   * of their control boxes to the cell.  A pixel stops scanning the list
+   * when that distance exceeds the best distance found so far.
+   *
+   * For a multi-channel field, the edges of each contour are colored so
+   * that the two edges meeting at a corner share a single channel, and
+   * each channel holds the pseudo-distance to the nearest edge of its
+   * color, which continues an edge along its tangent beyond the corners.
+   * The median of the three channels then keeps corners sharp when the
+   * field is magnified.  The alpha channel holds the true distance.
+   *
+   * All computations use 16.16 fixed-point pixels.  Outline coordinates
+   * and bitmap dimensions must stay below SDF_MAX_SIZE pixels.
+   *
+   */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_CALC_H
+#include FT_OUTLINE_H
+
+#include "ftsdf.h"
+#include "ftsdferrs.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  trace_sdf
+
+
+  /* the limit of all coordinates, in pixels */
+#define SDF_MAX_SIZE  0x2000
+
+  /* the grid cells are 2^SDF_CELL_SHIFT pixels wide and high */
+#define SDF_CELL_SHIFT  3
+#define SDF_CELL_SIZE   ( 1 << SDF_CELL_SHIFT )
+
+  /* the largest extent of a curve piece in pixels; together with */
+  /* SDF_MAX_SPREAD, it keeps the Newton iterations from overflow */
+#define SDF_PIECE_SIZE  8
+#define SDF_MAX_DEPTH   16
+
+  /* a cubic piece is sampled at t = k/SDF_SAMPLES, and a few Newton */
+  /* iterations start from the sample nearest to a pixel center      */
+#define SDF_SAMPLES       4
+#define SDF_NEWTON_STEPS  3
+
+  /* sin(3), the threshold of msdfgen's corner detection */
+#define SDF_CORNER_CROSS  0x2421L
+
+  /* 26.6 to 16.16 */
+#define SDF_UPSCALE( x )  ( (FT_Pos)(x) * 1024 )
+
+  /* the channels of a multi-channel field, and edge colors */
+#define SDF_RED      1
+#define SDF_GREEN    2
+#define SDF_BLUE     4
+#define SDF_YELLOW   ( SDF_RED | SDF_GREEN )
+#define SDF_MAGENTA  ( SDF_RED | SDF_BLUE )
+#define SDF_CYAN     ( SDF_GREEN | SDF_BLUE )
+#define SDF_WHITE    ( SDF_RED | SDF_GREEN | SDF_BLUE )
+
+  /* edge flags */
+#define SDF_EDGE_START   1  /* the piece starts an edge of its color */
+#define SDF_EDGE_END     2  /* the piece ends an edge of its color   */
+#define SDF_EDGE_CORNER  4  /* a corner precedes the outline edge    */
+
+#define SDF_DOT( a, b )                              \
+          ( FT_MulFix( (a).x, (b).x ) + FT_MulFix( (a).y, (b).y ) )
+#define SDF_CROSS( a, b )                            \
+          ( FT_MulFix( (a).x, (b).y ) - FT_MulFix( (a).y, (b).x ) )
+
+  /* the distance of `v' to the range [lo,hi] */
+#define SDF_RANGE_DIST( v, lo, hi )                   \
+          ( (v) < (lo) ? (lo) - (v)                   \
+                       : (v) > (hi) ? (v) - (hi) : 0 )
+
+
+  /* an outline edge, or a piece of it */
+  typedef struct  SDF_Edge_
+  {
+    FT_Vector  p[4];     /* control points                          */
+    FT_Vector  samples[SDF_SAMPLES - 1];  /* inner points of an arc */
+    FT_BBox    cbox;     /* their control box                       */
+    FT_Vector  t0, t1;   /* unit tangents at the start and the end  */
+    FT_Int     degree;   /* 1 for lines, 3 for cubic arcs           */
+    FT_UInt    source;   /* the outline edge of a piece             */
+    FT_Byte    color;    /* the channels of a multi-channel field   */
+    FT_Byte    flags;
+
+  } SDF_Edge;
+
+
+  /* a line of the flattened outline, from bottom to top */
+  typedef struct  SDF_Segment_
+  {
+    FT_Pos  x0, y0;
+    FT_Pos  x1, y1;
+    FT_Int  dir;     /* +1 if the outline goes up, -1 otherwise */
+
+  } SDF_Segment;
+
+
+  /* an entry of a cell list */
+  typedef struct  SDF_Ref_
+  {
+    FT_UInt   edge;
+    FT_Fixed  sq;    /* the squared distance of the cell to its cbox */
+
+  } SDF_Ref;
+
+
+  typedef struct  SDF_Crossing_
+  {
+    FT_Pos  x;
+    FT_Int  dir;
+
+  } SDF_Crossing;
+
+
+  /* the nearest point of an edge to a pixel center */
+  typedef struct  SDF_Nearest_
+  {
+    FT_Vector  d;        /* from the nearest point to the center      */
+    FT_Fixed   sq;       /* the squared length of `d'                 */
+    FT_Fixed   t;        /* the parameter of the point, 0 to 0x10000  */
+    FT_Vector  tangent;  /* the direction of the edge there           */
+
+  } SDF_Nearest;
+
+
+  /* the nearest edge of a color */
+  typedef struct  SDF_Channel_
+  {
+    const SDF_Edge*  edge;
+    SDF_Nearest      nearest;
+    FT_Fixed         ortho;    /* |d.tangent| at an end, or 0 */
+
+  } SDF_Channel;
+
+
+  typedef struct  SDF_TRaster_
+  {
+    FT_Memory  memory;
+    FT_UInt    spread;
+
+  } SDF_TRaster, *SDF_PRaster;
+
+
+  typedef struct  SDF_Worker_
+  {
+    SDF_PRaster  raster;
+
+    FT_Fixed     max_dist;     /* the spread                         */
+    FT_Fixed     max_sq;       /* its square                         */
+    FT_Bool      multi;        /* a multi-channel field              */
+    FT_Bool      fill_left;    /* the inside is left of the outline  */
+    FT_Bool      even_odd;
+
+    FT_Vector    last;         /* the current point                  */
+    FT_UInt      num_contour;
+    FT_UInt      num_edges;
+    FT_UInt      num_segments;
+
+    FT_Int       width;        /* of the target, in pixels           */
+    FT_Int       rows;
+    FT_Int       cols;         /* of the grid, in cells              */
+    FT_Int       bands;
+    FT_UInt*     cell_start;   /* `cols * bands + 1' offsets in refs */
+    FT_UInt*     band_start;   /* `bands + 1' offsets in lines       */
+
+    /* buffers of this rendering, grown as needed; the raster object */
+    /* is shared by all threads using the library                    */
+    SDF_Edge*      contour;       /* outline edges of a contour  */
+    FT_UInt        max_contour;
+    SDF_Edge*      edges;         /* pieces of all edges         */
+    FT_UInt        max_edges;
+    SDF_Segment*   segments;      /* the flattened outline       */
+    FT_UInt        max_segments;
+    FT_UInt*       cells;         /* offsets of the lists below  */
+    FT_UInt        max_cells;
+    SDF_Ref*       refs;          /* pieces per cell             */
+    FT_UInt        max_refs;
+    FT_UInt*       lines;         /* segments per band of cells  */
+    FT_UInt        max_lines;
+    SDF_Crossing*  crossings;
+    FT_UInt        max_crossings;
+
+  } SDF_Worker;
+
+
+  static FT_UInt
+  sdf_new_max( FT_UInt  max,
+               FT_UInt  needed )
+  {
+    FT_UInt  new_max = max < 64 ? 64 : max;
+
+
+    while ( new_max < needed )
+      new_max *= 2;
+
+    return new_max;
+  }
+
+
+  /* make the array `buffer' of `max' items hold `needed' items; */
+  /* this needs `memory' and `error', and jumps to `Exit' on     */
+  /* failure                                                     */
+#define SDF_RESERVE( buffer, max, needed )                            \
+          FT_BEGIN_STMNT                                              \
+            if ( (FT_UInt)(needed) > (max) )                          \
+            {                                                         \
+              FT_UInt  new_max_ = sdf_new_max( (max),                 \
+                                               (FT_UInt)(needed) );   \
+                                                                      \
+                                                                      \
+              if ( FT_QRENEW_ARRAY( buffer, max, new_max_ ) )         \
+                goto Exit;                                            \
+              (max) = new_max_;                                       \
+            }                                                         \
+          FT_END_STMNT
+
+
+  /**************************************************************************
+   *
+   * Building the edges.
+   *
+   */
+
+  /* set the unit tangents of `edge'; return FALSE for a single point */
+  static FT_Bool
+  sdf_edge_tangents( SDF_Edge*  edge )
+  {
+    FT_Vector*  p = edge->p;
+    FT_Int      n = edge->degree;
+    FT_Int      i;
+
+
+    for ( i = 1; i <= n; i++ )
+      if ( p[i].x != p[0].x || p[i].y != p[0].y )
+        break;
+
+    if ( i > n )
+      return FALSE;
+
+    edge->t0.x = p[i].x - p[0].x;
+    edge->t0.y = p[i].y - p[0].y;
+    FT_Vector_NormLen( &edge->t0 );
+
+    for ( i = n - 1; i > 0; i-- )
+      if ( p[i].x != p[n].x || p[i].y != p[n].y )
+        break;
+
+    edge->t1.x = p[n].x - p[i].x;
+    edge->t1.y = p[n].y - p[i].y;
+    FT_Vector_NormLen( &edge->t1 );
+
+    return TRUE;
+  }
+
+
+  /* split a cubic arc into two halves, in place; see `gray_split_cubic' */
+  static void
+  sdf_split_cubic( FT_Vector*  base )
+  {
+    FT_Pos  a, b, c;
+
+
+    /* points can be SDF_MAX_SIZE apart, so we average differences */
+    base[6].x = base[3].x;
+    a         = base[0].x + ( base[1].x - base[0].x ) / 2;
+    b         = base[1].x + ( base[2].x - base[1].x ) / 2;
+    c         = base[2].x + ( base[3].x - base[2].x ) / 2;
+    base[1].x = a;
+    base[5].x = c;
+    a         = a + ( b - a ) / 2;
+    c         = b + ( c - b ) / 2;
+    base[2].x = a;
+    base[4].x = c;
+    base[3].x = a + ( c - a ) / 2;
+
+    base[6].y = base[3].y;
+    a         = base[0].y + ( base[1].y - base[0].y ) / 2;
+    b         = base[1].y + ( base[2].y - base[1].y ) / 2;
+    c         = base[2].y + ( base[3].y - base[2].y ) / 2;
+    base[1].y = a;
+    base[5].y = c;
+    a         = a + ( b - a ) / 2;
+    c         = b + ( c - b ) / 2;
+    base[2].y = a;
+    base[4].y = c;
+    base[3].y = a + ( c - a ) / 2;
+  }
+
+
+  /* whether a cubic arc is small enough to be a piece */
+  static FT_Bool
+  sdf_arc_is_piece( const FT_Vector*  arc )
+  {
+    FT_Pos  x_min = arc[0].x, x_max = arc[0].x;
+    FT_Pos  y_min = arc[0].y, y_max = arc[0].y;
+    FT_Int  i;
+
+
+    for ( i = 1; i < 4; i++ )
+    {
+      if ( arc[i].x < x_min )
+        x_min = arc[i].x;
+      if ( arc[i].x > x_max )
+        x_max = arc[i].x;
+      if ( arc[i].y < y_min )
+        y_min = arc[i].y;
+      if ( arc[i].y > y_max )
+        y_max = arc[i].y;
+    }
+
+    return FT_BOOL( x_max - x_min <= SDF_PIECE_SIZE * 0x10000L &&
+                    y_max - y_min <= SDF_PIECE_SIZE * 0x10000L );
+  }
+
+
+  /* Evaluate a cubic arc given as `c[0] + 3t c[1] + 3t^2 c[2] + t^3 c[3]' */
+  /* at `t', together with its first and second derivatives if needed.   */
+  static void
+  sdf_cubic_eval( const FT_Vector*  c,
+                  FT_Fixed          t,
+                  FT_Vector*        pos,
+                  FT_Vector*        d1,
+                  FT_Vector*        d2 )
+  {
+    FT_Fixed  t2 = FT_MulFix( t, t );
+    FT_Fixed  t3 = FT_MulFix( t2, t );
+
+
+    pos->x = c[0].x + 3 * FT_MulFix( t, c[1].x ) +
+             3 * FT_MulFix( t2, c[2].x ) + FT_MulFix( t3, c[3].x );
+    pos->y = c[0].y + 3 * FT_MulFix( t, c[1].y ) +
+             3 * FT_MulFix( t2, c[2].y ) + FT_MulFix( t3, c[3].y );
+
+    if ( d1 )
+    {
+      d1->x = 3 * c[1].x + 6 * FT_MulFix( t, c[2].x ) +
+              3 * FT_MulFix( t2, c[3].x );
+      d1->y = 3 * c[1].y + 6 * FT_MulFix( t, c[2].y ) +
+              3 * FT_MulFix( t2, c[3].y );
+      d2->x = 6 * c[2].x + 6 * FT_MulFix( t, c[3].x );
+      d2->y = 6 * c[2].y + 6 * FT_MulFix( t, c[3].y );
+    }
+  }
+
+
+  /* the coefficients of `sdf_cubic_eval' for the arc `p', relative to `o' */
+  static void
+  sdf_cubic_coefficients( const FT_Vector*  p,
+                          FT_Pos            ox,
+                          FT_Pos            oy,
+                          FT_Vector*        c )
+  {
+    c[0].x = p[0].x - ox;
+    c[0].y = p[0].y - oy;
+    c[1].x = p[1].x - p[0].x;
+    c[1].y = p[1].y - p[0].y;
+    c[2].x = ( p[2].x - p[1].x ) - c[1].x;
+    c[2].y = ( p[2].y - p[1].y ) - c[1].y;
+    c[3].x = ( p[3].x - p[0].x ) - 3 * ( p[2].x - p[1].x );
+    c[3].y = ( p[3].y - p[0].y ) - 3 * ( p[2].y - p[1].y );
+  }
+
+
+  static FT_Error
+  sdf_add_segment( SDF_Worker*       worker,
+                   const FT_Vector*  a,
+                   const FT_Vector*  b )
+  {
+    FT_Memory     memory = worker->raster->memory;
+    FT_Error      error  = FT_Err_Ok;
+    SDF_Segment*  seg;
+
+
+    if ( a->y == b->y )
+      goto Exit;
+
+    SDF_RESERVE( worker->segments, worker->max_segments,
+                 worker->num_segments + 1 );
+
+    seg = worker->segments + worker->num_segments++;
+
+    if ( a->y < b->y )
+    {
+      seg->x0  = a->x;
+      seg->y0  = a->y;
+      seg->x1  = b->x;
+      seg->y1  = b->y;
+      seg->dir = 1;
+    }
+    else
+    {
+      seg->x0  = b->x;
+      seg->y0  = b->y;
+      seg->x1  = a->x;
+      seg->y1  = a->y;
+      seg->dir = -1;
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  /* flatten a piece for the winding numbers, within 1/256 pixel */
+  static FT_Error
+  sdf_add_segments( SDF_Worker*      worker,
+                    const SDF_Edge*  edge )
+  {
+    const FT_Vector*  p = edge->p;
+    FT_Vector         c[4], prev, next;
+    FT_Pos            dev;
+    FT_Fixed          n, k;
+    FT_Error          error = FT_Err_Ok;
+
+
+    if ( edge->degree == 1 )
+      return sdf_add_segment( worker, &p[0], &p[1] );
+
+    /* for `n' lines, the error is at most 3/4 dev/n^2 */
+    sdf_cubic_coefficients( p, 0, 0, c );
+
+    dev = FT_MAX( FT_MAX( FT_ABS( c[2].x ), FT_ABS( c[2].y ) ),
+                  FT_MAX( FT_ABS( c[2].x + c[3].x ),
+                          FT_ABS( c[2].y + c[3].y ) ) );
+
+    for ( n = 1; n * n * 1024 < 3 * dev; n++ )
+      ;
+
+    prev = p[0];
+    for ( k = 1; k <= n && !error; k++ )
+    {
+      if ( k == n )
+        next = p[3];
+      else
+        sdf_cubic_eval( c, FT_DivFix( k, n ), &next, NULL, NULL );
+
+      error = sdf_add_segment( worker, &prev, &next );
+      prev  = next;
+    }
+
+    return error;
+  }
+
+
+  static FT_Error
+  sdf_add_piece( SDF_Worker*       worker,
+                 const FT_Vector*  p,
+                 FT_Int            degree,
+                 FT_UInt           source,
+                 FT_Byte           color )
+  {
+    FT_Memory    memory = worker->raster->memory;
+    FT_Error     error  = FT_Err_Ok;
+    SDF_Edge*    edge;
+    FT_Int       i;
+
+
+    SDF_RESERVE( worker->edges, worker->max_edges, worker->num_edges + 1 );
+
+    edge = worker->edges + worker->num_edges;
+
+    edge->degree = degree;
+    edge->source = source;
+    edge->color  = color;
+    edge->flags  = 0;
+
+    edge->cbox.xMin = edge->cbox.xMax = p[0].x;
+    edge->cbox.yMin = edge->cbox.yMax = p[0].y;
+
+    for ( i = 0; i <= degree; i++ )
+    {
+      edge->p[i] = p[i];
+
+      if ( p[i].x < edge->cbox.xMin )
+        edge->cbox.xMin = p[i].x;
+      if ( p[i].x > edge->cbox.xMax )
+        edge->cbox.xMax = p[i].x;
+      if ( p[i].y < edge->cbox.yMin )
+        edge->cbox.yMin = p[i].y;
+      if ( p[i].y > edge->cbox.yMax )
+        edge->cbox.yMax = p[i].y;
+    }
+
+    /* pieces of the same edge can collapse */
+    if ( !sdf_edge_tangents( edge ) )
+      goto Exit;
+
+    if ( degree == 3 )
+    {
+      FT_Vector  c[4];
+
+
+      sdf_cubic_coefficients( p, 0, 0, c );
+
+      for ( i = 1; i < SDF_SAMPLES; i++ )
+        sdf_cubic_eval( c, i * 0x10000L / SDF_SAMPLES,
+                        &edge->samples[i - 1], NULL, NULL );
+    }
+
+    worker->num_edges++;
+
+    error = sdf_add_segments( worker, edge );
+
+  Exit:
+    return error;
+  }
+
+
+  /* split an outline edge into pieces, at least 2^min_depth of them */
+  static FT_Error
+  sdf_split_edge( SDF_Worker*      worker,
+                  const SDF_Edge*  edge,
+                  FT_UInt          source,
+                  FT_Int           min_depth )
+  {
+    const FT_Vector*  p = edge->p;
+    FT_Error          error;
+
+
+    if ( edge->degree == 1 )
+    {
+      FT_Int     count = 1 << min_depth;
+      FT_Int     k;
+      FT_Vector  q[2];
+
+
+      q[0]  = p[0];
+      error = FT_Err_Ok;
+
+      for ( k = 1; k <= count && !error; k++ )
+      {
+        if ( k == count )
+          q[1] = p[1];
+        else
+        {
+          q[1].x = p[0].x + FT_MulDiv( p[1].x - p[0].x, k, count );
+          q[1].y = p[0].y + FT_MulDiv( p[1].y - p[0].y, k, count );
+        }
+
+        error = sdf_add_piece( worker, q, 1, source, edge->color );
+        q[0]  = q[1];
+      }
+    }
+    else
+    {
+      /* like `gray_render_cubic', the arc is stored backwards */
+      FT_Vector   stack[3 * SDF_MAX_DEPTH + 4];
+      FT_Int      levels[SDF_MAX_DEPTH + 1];
+      FT_Vector*  arc = stack;
+      FT_Int      top = 0;
+
+
+      arc[0]    = p[3];
+      arc[1]    = p[2];
+      arc[2]    = p[1];
+      arc[3]    = p[0];
+      levels[0] = 0;
+
+      for (;;)
+      {
+        FT_Int  level = levels[top];
+
+
+        if ( level < SDF_MAX_DEPTH                          &&
+             ( level < min_depth || !sdf_arc_is_piece( arc ) ) )
+        {
+          sdf_split_cubic( arc );
+          arc += 3;
+          top++;
+          levels[top]     = level + 1;
+          levels[top - 1] = level + 1;
+          continue;
+        }
+        else
+        {
+          FT_Vector  q[4];
+
+
+          q[0] = arc[3];
+          q[1] = arc[2];
+          q[2] = arc[1];
+          q[3] = arc[0];
+
+          error = sdf_add_piece( worker, q, 3, source, edge->color );
+          if ( error || top == 0 )
+            break;
+        }
+
+        arc -= 3;
+        top--;
+      }
+    }
+
+    return error;
+  }
+
+
+  static FT_Bool
+  sdf_is_corner( const FT_Vector*  a,
+                 const FT_Vector*  b )
+  {
+    FT_Fixed  dot   = SDF_DOT( *a, *b );
+    FT_Fixed  cross = SDF_CROSS( *a, *b );
+
+
+    return FT_BOOL( dot <= 0 || FT_ABS( cross ) > SDF_CORNER_CROSS );
+  }
+
+
+  /* the next color at a corner, following msdfgen with a zero seed */
+  static FT_Byte
+  sdf_switch_color( FT_Byte  color,
+                    FT_Byte  banned )
+  {
+    FT_Byte  combined = color & banned;
+
+
+    if ( combined == SDF_RED   ||
+         combined == SDF_GREEN ||
+         combined == SDF_BLUE  )
+      return combined ^ SDF_WHITE;
+
+    if ( color == SDF_WHITE )
+      return SDF_CYAN;
+
+    return ( ( color << 1 ) | ( color >> 2 ) ) & SDF_WHITE;
+  }
+
+
+  /* msdfgen's `symmetricalTrichotomy': -1, 0, or 1 for the first, */
+  /* middle, and last third of `n' items                           */
+  static FT_Int
+  sdf_trichotomy( FT_UInt  position,
+                  FT_UInt  n )
+  {
+    return (FT_Int)( ( 33 * ( n - 1 ) + 46 * position ) /
+                     ( 16 * ( n - 1 ) ) ) - 3;
+  }
+
+
+  /* color the edges of the current contour and convert them to pieces */
+  static FT_Error
+  sdf_close_contour( SDF_Worker*  worker )
+  {
+    SDF_Edge*  contour   = worker->contour;
+    FT_UInt    n         = worker->num_contour;
+    FT_UInt    first     = worker->num_edges;
+    FT_UInt    corners   = 0;
+    FT_UInt    corner    = 0;
+    FT_Int     min_depth = 0;
+    FT_UInt    i, k, m;
+    FT_Error   error     = FT_Err_Ok;
+
+
+    if ( !n )
+      goto Exit;
+
+    worker->num_contour = 0;
+
+    for ( i = 0; i < n; i++ )
+    {
+      contour[i].flags = 0;
+      contour[i].color = SDF_WHITE;
+
+      if ( sdf_is_corner( &contour[i ? i - 1 : n - 1].t1, &contour[i].t0 ) )
+      {
+        contour[i].flags = SDF_EDGE_CORNER;
+        if ( !corners++ )
+          corner = i;
+      }
+    }
+
+    if ( corners == 1 )
+    {
+      /* a teardrop is colored per piece below; make at least three */
+      if ( n < 3 )
+        min_depth = 2;
+    }
+    else if ( corners > 1 )
+    {
+      FT_Byte  color   = sdf_switch_color( SDF_WHITE, 0 );
+      FT_Byte  initial = color;
+      FT_UInt  seen    = 0;
+
+
+      for ( k = 0; k < n; k++ )
+      {
+        i = ( corner + k ) % n;
+
+        if ( k && ( contour[i].flags & SDF_EDGE_CORNER ) )
+        {
+          seen++;
+          color = sdf_switch_color( color,
+                                    seen == corners - 1 ? initial : 0 );
+        }
+
+        contour[i].color = color;
+      }
+    }
+
+    for ( i = 0; i < n; i++ )
+    {
+      FT_UInt  start = worker->num_edges;
+
+
+      error = sdf_split_edge( worker, &contour[i], i, min_depth );
+      if ( error )
+        goto Exit;
+
+      if ( worker->num_edges > start )
+      {
+        worker->edges[start].flags                 |= SDF_EDGE_START;
+        worker->edges[worker->num_edges - 1].flags |= SDF_EDGE_END;
+      }
+    }
+
+    m = worker->num_edges - first;
+
+    if ( corners == 1 && m >= 3 )
+    {
+      SDF_Edge*  edges     = worker->edges + first;
+      FT_Byte    colors[3] = { SDF_CYAN, SDF_WHITE, SDF_MAGENTA };
+      FT_UInt    k0;
+
+
+      for ( k0 = 0; k0 < m; k0++ )
+        if ( edges[k0].source == corner )
+          break;
+
+      for ( k = 0; k < m; k++ )
+        edges[( k0 + k ) % m].color = colors[1 + sdf_trichotomy( k, m )];
+
+      for ( k = 0; k < m; k++ )
+      {
+        SDF_Edge*  prev = &edges[( k + m - 1 ) % m];
+
+
+        if ( prev->color != edges[k].color )
+        {
+          prev->flags     |= SDF_EDGE_END;
+          edges[k].flags  |= SDF_EDGE_START;
+        }
+      }
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  static FT_Error
+  sdf_add_edge( SDF_Worker*       worker,
+                const FT_Vector*  p,
+                FT_Int            degree )
+  {
+    FT_Memory    memory = worker->raster->memory;
+    FT_Error     error  = FT_Err_Ok;
+    SDF_Edge*    edge;
+    FT_Int       i;
+
+
+    SDF_RESERVE( worker->contour, worker->max_contour,
+                 worker->num_contour + 1 );
+
+    edge         = worker->contour + worker->num_contour;
+    edge->degree = degree;
+    edge->p[0]   = worker->last;
+
+    for ( i = 0; i < degree; i++ )
+      edge->p[i + 1] = p[i];
+
+    worker->last = p[degree - 1];
+
+    /* drop edges of zero length */
+    if ( sdf_edge_tangents( edge ) )
+      worker->num_contour++;
+
+  Exit:
+    return error;
+  }
+
+
+  static int
+  sdf_move_to( const FT_Vector*  to,
+               void*             worker_ )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)worker_;
+
+
+    worker->last.x = SDF_UPSCALE( to->x );
+    worker->last.y = SDF_UPSCALE( to->y );
+
+    return sdf_close_contour( worker );
+  }
+
+
+  static int
+  sdf_line_to( const FT_Vector*  to,
+               void*             worker_ )
+  {
+    FT_Vector  p[1];
+
+
+    p[0].x = SDF_UPSCALE( to->x );
+    p[0].y = SDF_UPSCALE( to->y );
+
+    return sdf_add_edge( (SDF_Worker*)worker_, p, 1 );
+  }
+
+
+  static int
+  sdf_conic_to( const FT_Vector*  control,
+                const FT_Vector*  to,
+                void*             worker_ )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)worker_;
+    FT_Vector    c, p[3];
+
+
+    /* elevate to a cubic arc */
+    c.x    = SDF_UPSCALE( control->x );
+    c.y    = SDF_UPSCALE( control->y );
+    p[2].x = SDF_UPSCALE( to->x );
+    p[2].y = SDF_UPSCALE( to->y );
+
+    p[0].x = worker->last.x + FT_MulDiv( c.x - worker->last.x, 2, 3 );
+    p[0].y = worker->last.y + FT_MulDiv( c.y - worker->last.y, 2, 3 );
+    p[1].x = p[2].x + FT_MulDiv( c.x - p[2].x, 2, 3 );
+    p[1].y = p[2].y + FT_MulDiv( c.y - p[2].y, 2, 3 );
+
+    return sdf_add_edge( worker, p, 3 );
+  }
+
+
+  static int
+  sdf_cubic_to( const FT_Vector*  control1,
+                const FT_Vector*  control2,
+                const FT_Vector*  to,
+                void*             worker_ )
+  {
+    FT_Vector  p[3];
+
+
+    p[0].x = SDF_UPSCALE( control1->x );
+    p[0].y = SDF_UPSCALE( control1->y );
+    p[1].x = SDF_UPSCALE( control2->x );
+    p[1].y = SDF_UPSCALE( control2->y );
+    p[2].x = SDF_UPSCALE( to->x );
+    p[2].y = SDF_UPSCALE( to->y );
+
+    return sdf_add_edge( (SDF_Worker*)worker_, p, 3 );
+  }
+
+
+  static const FT_Outline_Funcs  sdf_decompose_funcs =
+  {
+    sdf_move_to,
+    sdf_line_to,
+    sdf_conic_to,
+    sdf_cubic_to,
+    0,
+    0
+  };
+
+
+  /**************************************************************************
+   *
+   * The grid.
+   *
+   */
+
+  /* the range of cells within the spread of `edge'; FALSE if empty */
+  static FT_Bool
+  sdf_edge_cells( SDF_Worker*      worker,
+                  const SDF_Edge*  edge,
+                  FT_Int*          i0,
+                  FT_Int*          i1,
+                  FT_Int*          j0,
+                  FT_Int*          j1 )
+  {
+    FT_Pos  x_min = edge->cbox.xMin - worker->max_dist;
+    FT_Pos  y_min = edge->cbox.yMin - worker->max_dist;
+    FT_Pos  x_max = edge->cbox.xMax + worker->max_dist;
+    FT_Pos  y_max = edge->cbox.yMax + worker->max_dist;
+
+
+    if ( x_max < 0 || y_max < 0 )
+      return FALSE;
+
+    *i0 = x_min < 0 ? 0 : (FT_Int)( x_min >> ( 16 + SDF_CELL_SHIFT ) );
+    *j0 = y_min < 0 ? 0 : (FT_Int)( y_min >> ( 16 + SDF_CELL_SHIFT ) );
+    *i1 = (FT_Int)( x_max >> ( 16 + SDF_CELL_SHIFT ) );
+    *j1 = (FT_Int)( y_max >> ( 16 + SDF_CELL_SHIFT ) );
+
+    if ( *i1 >= worker->cols )
+      *i1 = worker->cols - 1;
+    if ( *j1 >= worker->bands )
+      *j1 = worker->bands - 1;
+
+    return FT_BOOL( *i0 <= *i1 && *j0 <= *j1 );
+  }
+
+
+  /* whether a line can come within the spread of cell (i,j) */
+  static FT_Bool
+  sdf_line_near_cell( SDF_Worker*      worker,
+                      const SDF_Edge*  edge,
+                      FT_Int           i,
+                      FT_Int           j )
+  {
+    FT_Vector  c;
+    FT_Fixed   cross;
+
+
+    if ( edge->degree != 1 )
+      return TRUE;
+
+    /* the distance of the cell center to the infinite line */
+    c.x   = ( ( (FT_Pos)i << SDF_CELL_SHIFT ) << 16 ) +
+            ( SDF_CELL_SIZE << 15 ) - edge->p[0].x;
+    c.y   = ( ( (FT_Pos)j << SDF_CELL_SHIFT ) << 16 ) +
+            ( SDF_CELL_SIZE << 15 ) - edge->p[0].y;
+    cross = SDF_CROSS( edge->t0, c );
+
+    /* half the diagonal is less than 3/4 of the side */
+    return FT_BOOL( FT_ABS( cross ) <= worker->max_dist +
+                                         ( 3 * SDF_CELL_SIZE << 14 ) );
+  }
+
+
+  /* the squared distance between cell (i,j) and the cbox of `edge' */
+  static FT_Fixed
+  sdf_cell_sq( const SDF_Edge*  edge,
+               FT_Int           i,
+               FT_Int           j )
+  {
+    FT_Pos  x0 = (FT_Pos)i << ( 16 + SDF_CELL_SHIFT );
+    FT_Pos  y0 = (FT_Pos)j << ( 16 + SDF_CELL_SHIFT );
+    FT_Pos  x1 = x0 + ( SDF_CELL_SIZE << 16 );
+    FT_Pos  y1 = y0 + ( SDF_CELL_SIZE << 16 );
+    FT_Pos  dx = 0;
+    FT_Pos  dy = 0;
+
+
+    if ( edge->cbox.xMin > x1 )
+      dx = edge->cbox.xMin - x1;
+    else if ( edge->cbox.xMax < x0 )
+      dx = x0 - edge->cbox.xMax;
+
+    if ( edge->cbox.yMin > y1 )
+      dy = edge->cbox.yMin - y1;
+    else if ( edge->cbox.yMax < y0 )
+      dy = y0 - edge->cbox.yMax;
+
+    return FT_MulFix( dx, dx ) + FT_MulFix( dy, dy );
+  }
+
+
+  static int
+  sdf_compare_refs( const void*  a,
+                    const void*  b )
+  {
+    FT_Fixed  sa = ( (const SDF_Ref*)a )->sq;
+    FT_Fixed  sb = ( (const SDF_Ref*)b )->sq;
+
+
+    return sa < sb ? -1 : sa > sb;
+  }
+
+
+  static FT_Error
+  sdf_build_grid( SDF_Worker*  worker )
+  {
+    FT_Memory    memory = worker->raster->memory;
+    FT_Error     error  = FT_Err_Ok;
+    FT_UInt      num_cells, n;
+    FT_UInt      *cell_start, *band_start;
+    FT_Int       i, j, i0, i1, j0, j1;
+    FT_Int       pass;
+
+
+    worker->cols  = ( worker->width + SDF_CELL_SIZE - 1 ) >> SDF_CELL_SHIFT;
+    worker->bands = ( worker->rows + SDF_CELL_SIZE - 1 ) >> SDF_CELL_SHIFT;
+
+    num_cells = (FT_UInt)( worker->cols * worker->bands );
+
+    SDF_RESERVE( worker->cells, worker->max_cells,
+                 num_cells + 1 + (FT_UInt)worker->bands + 1 );
+
+    cell_start = worker->cells;
+    band_start = cell_start + num_cells + 1;
+
+    worker->cell_start = cell_start;
+    worker->band_start = band_start;
+
+    FT_ARRAY_ZERO( cell_start, num_cells + 1 + (FT_UInt)worker->bands + 1 );
+
+    /* count the list entries in the first pass, store them in the second */
+    for ( pass = 0; pass < 2; pass++ )
+    {
+      for ( n = 0; n < worker->num_edges; n++ )
+      {
+        const SDF_Edge*  edge = worker->edges + n;
+
+
+        if ( !sdf_edge_cells( worker, edge, &i0, &i1, &j0, &j1 ) )
+          continue;
+
+        for ( j = j0; j <= j1; j++ )
+          for ( i = i0; i <= i1; i++ )
+          {
+            FT_UInt  cell = (FT_UInt)( j * worker->cols + i );
+
+
+            if ( !sdf_line_near_cell( worker, edge, i, j ) )
+              continue;
+
+            if ( pass )
+            {
+              SDF_Ref*  ref = worker->refs + cell_start[cell]++;
+
+
+              ref->edge = n;
+              ref->sq   = sdf_cell_sq( edge, i, j );
+            }
+            else
+              cell_start[cell + 1]++;
+          }
+      }
+
+      for ( n = 0; n < worker->num_segments; n++ )
+      {
+        const SDF_Segment*  seg = worker->segments + n;
+
+
+        if ( seg->y1 < 0 )
+          continue;
+
+        j0 = seg->y0 < 0 ? 0
+                         : (FT_Int)( seg->y0 >> ( 16 + SDF_CELL_SHIFT ) );
+        j1 = (FT_Int)( seg->y1 >> ( 16 + SDF_CELL_SHIFT ) );
+        if ( j1 >= worker->bands )
+          j1 = worker->bands - 1;
+
+        for ( j = j0; j <= j1; j++ )
+        {
+          if ( pass )
+            worker->lines[band_start[j]++] = n;
+          else
+            band_start[j + 1]++;
+        }
+      }
+
+      if ( pass )
+        break;
+
+      /* turn the counts into offsets */
+      for ( n = 1; n <= num_cells; n++ )
+        cell_start[n] += cell_start[n - 1];
+
+      for ( j = 1; j <= worker->bands; j++ )
+        band_start[j] += band_start[j - 1];
+
+      SDF_RESERVE( worker->refs, worker->max_refs, cell_start[num_cells] );
+      SDF_RESERVE( worker->lines, worker->max_lines,
+                   band_start[worker->bands] );
+    }
+
+    /* the second pass has moved each offset to the next list */
+    for ( j = worker->bands; j > 0; j-- )
+      band_start[j] = band_start[j - 1];
+    band_start[0] = 0;
+
+    for ( n = num_cells; n > 0; n-- )
+      cell_start[n] = cell_start[n - 1];
+    cell_start[0] = 0;
+
+    /* nearer pieces first, so that a pixel can stop early */
+    for ( n = 0; n < num_cells; n++ )
+    {
+      FT_UInt  count = cell_start[n + 1] - cell_start[n];
+
+
+      if ( count > 1 )
+        ft_qsort( worker->refs + cell_start[n], count, sizeof ( SDF_Ref ),
+                  sdf_compare_refs );
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  /**************************************************************************
+   *
+   * Distances.
+   *
+   */
+
+  /* Find the nearest point of `edge' to (x,y), if it is within the     */
+  /* spread.  The caller has checked that the control box is, which     */
+  /* bounds all values below.                                           */
+  static FT_Bool
+  sdf_nearest( const SDF_Edge*  edge,
+               FT_Pos           x,
+               FT_Pos           y,
+               FT_Fixed         max_dist,
+               SDF_Nearest*     nearest )
+  {
+    const FT_Vector*  p = edge->p;
+    FT_Vector         d;
+
+
+    if ( edge->degree == 1 )
+    {
+      FT_Vector  u = edge->t0;
+
+
+      nearest->tangent = u;
+
+      d.x = x - p[0].x;
+      d.y = y - p[0].y;
+
+      if ( SDF_DOT( d, u ) <= 0 )
+        nearest->t = 0;
+      else
+      {
+        FT_Vector  e;
+
+
+        e.x = x - p[1].x;
+        e.y = y - p[1].y;
+
+        if ( SDF_DOT( e, u ) >= 0 )
+        {
+          d          = e;
+          nearest->t = 0x10000L;
+        }
+        else
+        {
+          /* the perpendicular distance, positive to the left */
+          FT_Fixed  c = SDF_CROSS( u, d );
+
+
+          if ( FT_ABS( c ) >= max_dist )
+            return FALSE;
+
+          nearest->d.x = -FT_MulFix( c, u.y );
+          nearest->d.y = FT_MulFix( c, u.x );
+          nearest->sq  = FT_MulFix( c, c );
+          nearest->t   = 0x8000L;
+
+          return TRUE;
+        }
+      }
+    }
+    else
+    {
+      FT_Vector  c[4], pos, d1, d2;
+      FT_Fixed   t, sq, best_sq, best_t;
+      FT_Int     i, step;
+
+
+      sdf_cubic_coefficients( p, x, y, c );
+
+      /* start with the ends */
+      best_t  = 0;
+      best_sq = SDF_DOT( c[0], c[0] );
+
+      d.x = p[3].x - x;
+      d.y = p[3].y - y;
+      sq  = SDF_DOT( d, d );
+      if ( sq < best_sq )
+      {
+        best_sq = sq;
+        best_t  = 0x10000L;
+      }
+
+      /* the nearest sample is close to the nearest point; it also */
+      /* copes with very uneven parametrizations                   */
+      for ( i = 1; i < SDF_SAMPLES; i++ )
+      {
+        d.x = edge->samples[i - 1].x - x;
+        d.y = edge->samples[i - 1].y - y;
+        sq  = SDF_DOT( d, d );
+        if ( sq < best_sq )
+        {
+          best_sq = sq;
+          best_t  = i * 0x10000L / SDF_SAMPLES;
+        }
+      }
+
+      t = best_t;
+      sdf_cubic_eval( c, t, &pos, &d1, &d2 );
+
+      for ( step = 0; step < SDF_NEWTON_STEPS; step++ )
+      {
+        /* the derivative of |pos|^2/2 is pos.d1, and its own is */
+        /* d1.d1 + pos.d2; the latter is positive near a minimum */
+        FT_Fixed  f  = SDF_DOT( pos, d1 );
+        FT_Fixed  f1 = SDF_DOT( d1, d1 ) + SDF_DOT( pos, d2 );
+
+
+        if ( f1 <= 0 )
+          break;
+
+        t -= FT_DivFix( f, f1 );
+        if ( t <= 0 || t >= 0x10000L )
+          break;
+
+        sdf_cubic_eval( c, t, &pos, &d1, &d2 );
+
+        sq = SDF_DOT( pos, pos );
+        if ( sq >= best_sq )
+          break;
+
+        best_sq = sq;
+        best_t  = t;
+      }
+
+      nearest->t = best_t;
+
+      if ( best_t == 0 )
+      {
+        d.x              = -c[0].x;
+        d.y              = -c[0].y;
+        nearest->tangent = edge->t0;
+      }
+      else if ( best_t == 0x10000L )
+      {
+        d.x              = x - p[3].x;
+        d.y              = y - p[3].y;
+        nearest->tangent = edge->t1;
+      }
+      else
+      {
+        if ( t != best_t )
+          sdf_cubic_eval( c, best_t, &pos, &d1, &d2 );
+
+        d.x              = -pos.x;
+        d.y              = -pos.y;
+        nearest->tangent = d1;
+      }
+    }
+
+    if ( FT_ABS( d.x ) >= max_dist || FT_ABS( d.y ) >= max_dist )
+      return FALSE;
+
+    nearest->d  = d;
+    nearest->sq = SDF_DOT( d, d );
+
+    return TRUE;
+  }
+
+
+  /* The square root of `sq', a squared distance less than the squared */
+  /* spread, to 1/2048 pixel; much faster than `FT_Hypot'.             */
+  static FT_Fixed
+  sdf_sqrt( FT_Fixed  sq )
+  {
+    FT_UInt32  x    = (FT_UInt32)sq << 6;
+    FT_UInt32  root = 0;
+    FT_UInt32  bit  = 1UL << 30;
+
+
+    while ( bit > x )
+      bit >>= 2;
+
+    /* without branches, which would be hard to predict */
+    while ( bit )
+    {
+      FT_UInt32  t    = root + bit;
+      FT_UInt32  mask = (FT_UInt32)-(FT_Int32)( x >= t );
+
+
+      x   -= t & mask;
+      root = ( root >> 1 ) + ( bit & mask );
+      bit >>= 2;
+    }
+
+    return (FT_Fixed)root << 5;
+  }
+
+
+  /* the signed pseudo-distance of a channel, positive inside */
+  static FT_Fixed
+  sdf_pseudo_distance( SDF_Worker*         worker,
+                       const SDF_Channel*  channel )
+  {
+    const SDF_Edge*     edge    = channel->edge;
+    const SDF_Nearest*  nearest = &channel->nearest;
+    FT_Fixed            dist    = sdf_sqrt( nearest->sq );
+
+
+    if ( SDF_CROSS( nearest->tangent, nearest->d ) < 0 )
+      dist = -dist;
+
+    /* beyond an end of an edge, extend it along its tangent */
+    if ( ( nearest->t == 0 && ( edge->flags & SDF_EDGE_START ) &&
+           SDF_DOT( nearest->d, edge->t0 ) < 0                 )   ||
+         ( nearest->t == 0x10000L && ( edge->flags & SDF_EDGE_END ) &&
+           SDF_DOT( nearest->d, edge->t1 ) > 0                      ) )
+    {
+      FT_Fixed  pseudo = SDF_CROSS( nearest->tangent, nearest->d );
+
+
+      if ( FT_ABS( pseudo ) <= FT_ABS( dist ) )
+        dist = pseudo;
+    }
+
+    return worker->fill_left ? dist : -dist;
+  }
+
+
+  /* map a signed distance to 0..255 */
+  static FT_Byte
+  sdf_value( SDF_Worker*  worker,
+             FT_Fixed     dist )
+  {
+    FT_Fixed  v = 128 + FT_MulDiv( dist, 128, worker->max_dist );
+
+
+    return (FT_Byte)( v < 0 ? 0 : v > 255 ? 255 : v );
+  }
+
+
+  static FT_Byte
+  sdf_pixel( SDF_Worker*       worker,
+             const SDF_Ref*    refs,
+             FT_UInt           count,
+             const SDF_Edge**  hint,
+             FT_Pos            x,
+             FT_Pos            y,
+             FT_Bool           inside )
+  {
+    const SDF_Edge*  edges    = worker->edges;
+    const SDF_Edge*  best     = NULL;
+    FT_Fixed         max_dist = worker->max_dist;
+    FT_Fixed         best_sq  = worker->max_sq;
+    FT_Fixed         dist     = max_dist;
+    SDF_Nearest      nearest;
+    FT_UInt          n;
+
+
+    /* the nearest edge of the previous pixel gives a good start; */
+    /* it need not be in this cell's list                         */
+    for ( n = 0; n <= count; n++ )
+    {
+      const SDF_Edge*  edge;
+      FT_Pos           bx, by;
+
+
+      if ( n == 0 )
+      {
+        edge = *hint;
+        if ( !edge )
+          continue;
+      }
+      else
+      {
+        /* no later piece can be nearer */
+        if ( refs[n - 1].sq >= best_sq )
+          break;
+
+        edge = edges + refs[n - 1].edge;
+        if ( edge == *hint )
+          continue;
+      }
+
+      bx = SDF_RANGE_DIST( x, edge->cbox.xMin, edge->cbox.xMax );
+      by = SDF_RANGE_DIST( y, edge->cbox.yMin, edge->cbox.yMax );
+
+      if ( bx >= max_dist || by >= max_dist                 ||
+           FT_MulFix( bx, bx ) + FT_MulFix( by, by ) >= best_sq )
+        continue;
+
+      if ( sdf_nearest( edge, x, y, max_dist, &nearest ) &&
+           nearest.sq < best_sq                          )
+      {
+        best_sq = nearest.sq;
+        best    = edge;
+      }
+    }
+
+    if ( best )
+    {
+      dist  = sdf_sqrt( best_sq );
+      *hint = best;
+    }
+
+    return sdf_value( worker, inside ? dist : -dist );
+  }
+
+
+  static void
+  sdf_pixel_multi( SDF_Worker*     worker,
+                   const SDF_Ref*  refs,
+                   FT_UInt         count,
+                   FT_Pos          x,
+                   FT_Pos          y,
+                   FT_Bool         inside,
+                   FT_Byte*        bgra )
+  {
+    const SDF_Edge*  edges    = worker->edges;
+    FT_Fixed         max_dist = worker->max_dist;
+    FT_Fixed         best_sq  = worker->max_sq;
+    FT_Fixed         dist     = max_dist;
+    SDF_Channel      channels[3];
+    SDF_Nearest      nearest;
+    FT_UInt          n;
+    FT_Int           c;
+
+
+    for ( c = 0; c < 3; c++ )
+    {
+      channels[c].edge       = NULL;
+      channels[c].nearest.sq = worker->max_sq;
+      channels[c].ortho      = 0;
+    }
+
+    for ( n = 0; n < count; n++ )
+    {
+      const SDF_Edge*  edge  = edges + refs[n].edge;
+      FT_Fixed         limit = 0;
+      FT_Fixed         ortho = 0;
+      FT_Pos           bx, by;
+
+
+      if ( refs[n].sq > channels[0].nearest.sq &&
+           refs[n].sq > channels[1].nearest.sq &&
+           refs[n].sq > channels[2].nearest.sq )
+        break;
+
+      /* an edge only matters to its own channels */
+      for ( c = 0; c < 3; c++ )
+        if ( ( edge->color & ( 1 << c ) )          &&
+             channels[c].nearest.sq > limit )
+          limit = channels[c].nearest.sq;
+
+      bx = SDF_RANGE_DIST( x, edge->cbox.xMin, edge->cbox.xMax );
+      by = SDF_RANGE_DIST( y, edge->cbox.yMin, edge->cbox.yMax );
+
+      if ( bx >= max_dist || by >= max_dist               ||
+           FT_MulFix( bx, bx ) + FT_MulFix( by, by ) > limit )
+        continue;
+
+      if ( !sdf_nearest( edge, x, y, max_dist, &nearest ) )
+        continue;
+
+      if ( nearest.sq < best_sq )
+      {
+        best_sq = nearest.sq;
+      }
+
+      /* at an end, prefer the edge more perpendicular to `d' */
+      if ( nearest.t == 0 || nearest.t == 0x10000L )
+        ortho = FT_ABS( SDF_DOT( nearest.tangent, nearest.d ) );
+
+      for ( c = 0; c < 3; c++ )
+      {
+        SDF_Channel*  channel = channels + c;
+
+
+        if ( !( edge->color & ( 1 << c ) ) )
+          continue;
+
+        if ( nearest.sq < channel->nearest.sq                     ||
+             ( nearest.sq == channel->nearest.sq &&
+               channel->edge && ortho < channel->ortho )          )
+        {
+          channel->edge    = edge;
+          channel->nearest = nearest;
+          channel->ortho   = ortho;
+        }
+      }
+    }
+
+    for ( c = 0; c < 3; c++ )
+    {
+      FT_Fixed  pseudo;
+
+
+      if ( channels[c].edge )
+        pseudo = sdf_pseudo_distance( worker, channels + c );
+      else
+        pseudo = inside ? max_dist : -max_dist;
+
+      bgra[2 - c] = sdf_value( worker, pseudo );
+    }
+
+    if ( best_sq < worker->max_sq )
+      dist = sdf_sqrt( best_sq );
+
+    bgra[3] = sdf_value( worker, inside ? dist : -dist );
+
+    /* The median of the channels can have the wrong sign where edges   */
+    /* of different colors are about as near, like outside of an acute  */
+    /* corner.  Since the true distance is known, such pixels simply    */
+    /* get it in all channels; this is the cheapest part of msdfgen's   */
+    /* error correction.                                                */
+    {
+      FT_Byte  r = bgra[2], g = bgra[1], b = bgra[0];
+      FT_Byte  median = FT_MAX( FT_MIN( r, g ),
+                                FT_MIN( FT_MAX( r, g ), b ) );
+
+
+      if ( ( median >= 128 ) != ( bgra[3] >= 128 ) )
+        bgra[0] = bgra[1] = bgra[2] = bgra[3];
+    }
+  }
+
+
+  static int
+  sdf_compare_crossings( const void*  a,
+                         const void*  b )
+  {
+    FT_Pos  xa = ( (const SDF_Crossing*)a )->x;
+    FT_Pos  xb = ( (const SDF_Crossing*)b )->x;
+
+
+    return xa < xb ? -1 : xa > xb;
+  }
+
+
+  static FT_Error
+  sdf_sweep( SDF_Worker*       worker,
+             const FT_Bitmap*  target )
+  {
+    FT_Memory    memory = worker->raster->memory;
+    FT_Error     error  = FT_Err_Ok;
+    FT_Byte*     origin = target->buffer;
+    FT_UInt      max_crossings = 0;
+    FT_Int       xp, yp, j;
+
+
+    /* the bottom row is at `origin', as in the other rasterizers */
+    if ( target->pitch > 0 )
+      origin += (FT_ULong)( worker->rows - 1 ) * (FT_ULong)target->pitch;
+
+    for ( j = 0; j < worker->bands; j++ )
+      if ( worker->band_start[j + 1] - worker->band_start[j] >
+             max_crossings )
+        max_crossings = worker->band_start[j + 1] - worker->band_start[j];
+
+    SDF_RESERVE( worker->crossings, worker->max_crossings, max_crossings );
+
+    for ( yp = 0; yp < worker->rows; yp++ )
+    {
+      FT_Byte*          line = origin - yp * target->pitch;
+      FT_Pos            y    = ( (FT_Pos)yp << 16 ) + 0x8000L;
+      const FT_UInt*    band;
+      const FT_UInt*    band_end;
+      const FT_UInt*    cell;
+      SDF_Crossing*     crossings = worker->crossings;
+      FT_UInt           num_crossings = 0;
+      FT_UInt           k = 0;
+      FT_Int            winding = 0;
+      const SDF_Edge*   hint = NULL;
+
+
+      j        = yp >> SDF_CELL_SHIFT;
+      band     = worker->lines + worker->band_start[j];
+      band_end = worker->lines + worker->band_start[j + 1];
+      cell     = worker->cell_start + j * worker->cols;
+
+      /* where the flattened outline crosses the row, and how */
+      for ( ; band < band_end; band++ )
+      {
+        const SDF_Segment*  seg = worker->segments + *band;
+
+
+        if ( seg->y0 <= y && y < seg->y1 )
+        {
+          crossings[num_crossings].x   = seg->x0 +
+                                           FT_MulDiv( y - seg->y0,
+                                                      seg->x1 - seg->x0,
+                                                      seg->y1 - seg->y0 );
+          crossings[num_crossings].dir = seg->dir;
+          num_crossings++;
+        }
+      }
+
+      if ( num_crossings > 1 )
+        ft_qsort( crossings, num_crossings, sizeof ( SDF_Crossing ),
+                  sdf_compare_crossings );
+
+      for ( xp = 0; xp < worker->width; xp++ )
+      {
+        FT_Pos          x     = ( (FT_Pos)xp << 16 ) + 0x8000L;
+        FT_Int          i     = xp >> SDF_CELL_SHIFT;
+        const SDF_Ref*  refs  = worker->refs + cell[i];
+        FT_UInt         count = cell[i + 1] - cell[i];
+        FT_Bool         inside;
+
+
+        for ( ; k < num_crossings && crossings[k].x <= x; k++ )
+          winding += crossings[k].dir;
+
+        inside = FT_BOOL( worker->even_odd ? ( winding & 1 ) : winding );
+
+        if ( worker->multi )
+          sdf_pixel_multi( worker, refs, count, x, y, inside,
+                           line + 4 * xp );
+        else
+          line[xp] = sdf_pixel( worker, refs, count, &hint,
+                                x, y, inside );
+      }
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  /* free the buffers of a rendering */
+  static void
+  sdf_worker_done( SDF_Worker*  worker )
+  {
+    FT_Memory  memory = worker->raster->memory;
+
+
+    FT_FREE( worker->contour );
+    FT_FREE( worker->edges );
+    FT_FREE( worker->segments );
+    FT_FREE( worker->cells );
+    FT_FREE( worker->refs );
+    FT_FREE( worker->lines );
+    FT_FREE( worker->crossings );
+  }
+
+
+  /**************************************************************************
+   *
+   * The raster interface.
+   *
+   */
+
+  static int
+  ft_sdf_raster_render( FT_Raster                raster_,
+                        const FT_Raster_Params*  params )
+  {
+    SDF_PRaster       raster  = (SDF_PRaster)raster_;
+    FT_Outline*       outline = (FT_Outline*)params->source;
+    const FT_Bitmap*  target  = params->target;
+    SDF_Worker        worker[1];
+    FT_BBox           cbox;
+    FT_Error          error;
+
+
+    if ( !raster )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !outline )
+      return FT_THROW( Invalid_Outline );
+
+    /* only distance fields, and only into bitmaps */
+    if ( !( params->flags & FT_RASTER_FLAG_SDF )                        ||
+         ( params->flags & ( FT_RASTER_FLAG_DIRECT                    |
+                             FT_RASTER_FLAG_SURFACE                   ) ) )
+      return FT_THROW( Cannot_Render_Glyph );
+
+    if ( !target )
+      return FT_THROW( Invalid_Argument );
+
+    /* nothing to do for an empty glyph; there is no buffer either */
+    if ( !target->width || !target->rows )
+      return FT_Err_Ok;
+
+    if ( !target->buffer )
+      return FT_THROW( Invalid_Argument );
+
+    if ( target->pixel_mode != FT_PIXEL_MODE_GRAY &&
+         target->pixel_mode != FT_PIXEL_MODE_BGRA )
+      return FT_THROW( Invalid_Argument );
+
+    FT_Outline_Get_CBox( outline, &cbox );
+
+    if ( target->width > SDF_MAX_SIZE          ||
+         target->rows > SDF_MAX_SIZE           ||
+         cbox.xMin <= -SDF_MAX_SIZE * 64L      ||
+         cbox.yMin <= -SDF_MAX_SIZE * 64L      ||
+         cbox.xMax >= SDF_MAX_SIZE * 64L       ||
+         cbox.yMax >= SDF_MAX_SIZE * 64L       )
+      return FT_THROW( Raster_Overflow );
+
+    FT_ZERO( worker );
+
+    worker->raster    = raster;
+    worker->max_dist  = (FT_Fixed)raster->spread << 16;
+    worker->max_sq    = FT_MulFix( worker->max_dist, worker->max_dist );
+    worker->multi     = FT_BOOL( target->pixel_mode == FT_PIXEL_MODE_BGRA );
+    worker->fill_left = FT_BOOL( FT_Outline_Get_Orientation( outline ) ==
+                                   FT_ORIENTATION_FILL_LEFT );
+    worker->even_odd  = FT_BOOL( outline->flags & FT_OUTLINE_EVEN_ODD_FILL );
+    worker->width     = (FT_Int)target->width;
+    worker->rows      = (FT_Int)target->rows;
+
+    error = FT_Outline_Decompose( outline, &sdf_decompose_funcs, worker );
+    if ( !error )
+      error = sdf_close_contour( worker );
+    if ( !error )
+      error = sdf_build_grid( worker );
+    if ( !error )
+      error = sdf_sweep( worker, target );
+
+    FT_TRACE7(( "ft_sdf_raster_render: %d pieces, %d lines, error %d\n",
+                worker->num_edges, worker->num_segments, error ));
+
+    sdf_worker_done( worker );
+
+    return error;
+  }
+
+
+  static int
+  ft_sdf_raster_new( FT_Memory   memory,
+                     FT_Raster*  araster )
+  {
+    FT_Error     error;
+    SDF_PRaster  raster = NULL;
+
+
+    *araster = 0;
+    if ( !FT_ALLOC( raster, sizeof ( SDF_TRaster ) ) )
+    {
+      raster->memory = memory;
+      raster->spread = SDF_DEFAULT_SPREAD;
+      *araster       = (FT_Raster)raster;
+    }
+
+    return error;
+  }
+
+
+  static void
+  ft_sdf_raster_done( FT_Raster  raster_ )
+  {
+    SDF_PRaster  raster = (SDF_PRaster)raster_;
+    FT_Memory    memory;
+
+
+    if ( !raster )
+      return;
+
+    memory = raster->memory;
+
+    FT_FREE( raster );
+  }
+
+
+  static void
+  ft_sdf_raster_reset( FT_Raster       raster,
+                       unsigned char*  pool_base,
+                       unsigned long   pool_size )
+  {
+    FT_UNUSED( raster );
+    FT_UNUSED( pool_base );
+    FT_UNUSED( pool_size );
+  }
+
+
+  static int
+  ft_sdf_raster_set_mode( FT_Raster      raster_,
+                          unsigned long  mode,
+                          void*          args )
+  {
+    SDF_PRaster  raster = (SDF_PRaster)raster_;
+
+
+    if ( mode == FT_SDF_MODE_SPREAD )
+    {
+      FT_UInt  spread = *(FT_UInt*)args;
+
+
+      if ( spread < SDF_MIN_SPREAD || spread > SDF_MAX_SPREAD )
+        return FT_THROW( Invalid_Argument );
+
+      raster->spread = spread;
+
+      return 0;
+    }
+
+    return FT_THROW( Invalid_Argument );
+  }
+
+
+  FT_DEFINE_RASTER_FUNCS(
+    ft_sdf_raster,
+
+    FT_GLYPH_FORMAT_OUTLINE,
+
+    (FT_Raster_New_Func)     ft_sdf_raster_new,       /* raster_new      */
+    (FT_Raster_Reset_Func)   ft_sdf_raster_reset,     /* raster_reset    */
+    (FT_Raster_Set_Mode_Func)ft_sdf_raster_set_mode,  /* raster_set_mode */
+    (FT_Raster_Render_Func)  ft_sdf_raster_render,    /* raster_render   */
+    (FT_Raster_Done_Func)    ft_sdf_raster_done       /* raster_done     */
+  )
+
+
+/* END */
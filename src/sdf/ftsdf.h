@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * ftsdf.h
+ *
+ *   Signed distance field rasterizer (specification).
+ *
+ * Copyright 2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef FTSDF_H_
+#define FTSDF_H_
+
+
+#include <ft2build.h>
+#include FT_CONFIG_CONFIG_H
+#include FT_IMAGE_H
+
+
+FT_BEGIN_HEADER
+
+
+  /* the range and default value of the `spread' property, in pixels */
+#define SDF_MIN_SPREAD      2
+#define SDF_MAX_SPREAD      32
+#define SDF_DEFAULT_SPREAD  8
+
+
+  /**************************************************************************
+   *
+   * The `sdf' renderer passes the value of its `spread' property, a
+   * pointer to an FT_UInt between SDF_MIN_SPREAD and SDF_MAX_SPREAD, to
+   * the rasterizer by calling `raster_set_mode' with this tag.
+   */
+#define FT_SDF_MODE_SPREAD  0x73707264UL  /* `sprd' */
+
+
+  FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_sdf_raster;
+
+
+FT_END_HEADER
+
+#endif /* FTSDF_H_ */
+
+
+/* END */
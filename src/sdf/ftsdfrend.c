@@ -0,0 +1,341 @@
+/****************************************************************************
+ *
+ * ftsdfrend.c
+ *
+ *   Signed distance field renderer interface (body).
+ *
+ * Copyright 2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_OUTLINE_H
+#include FT_SERVICE_PROPERTIES_H
+#include FT_DRIVER_H
+#include "ftsdfrend.h"
+#include "ftsdf.h"
+
+#include "ftsdferrs.h"
+
+
+  /* initialize renderer -- init its raster */
+  static FT_Error
+  ft_sdf_init( FT_Renderer  render )
+  {
+    SDF_Renderer  sdf = (SDF_Renderer)render;
+
+
+    sdf->spread = SDF_DEFAULT_SPREAD;
+
+    return render->clazz->raster_class->raster_set_mode( render->raster,
+                                                         FT_SDF_MODE_SPREAD,
+                                                         &sdf->spread );
+  }
+
+
+  /* sets render-specific mode */
+  static FT_Error
+  ft_sdf_set_mode( FT_Renderer  render,
+                   FT_ULong     mode_tag,
+                   FT_Pointer   data )
+  {
+    /* we simply pass it to the raster */
+    return render->clazz->raster_class->raster_set_mode( render->raster,
+                                                         mode_tag,
+                                                         data );
+  }
+
+
+  /* transform a given glyph image */
+  static FT_Error
+  ft_sdf_transform( FT_Renderer       render,
+                    FT_GlyphSlot      slot,
+                    const FT_Matrix*  matrix,
+                    const FT_Vector*  delta )
+  {
+    FT_Error  error = FT_Err_Ok;
+
+
+    if ( slot->format != render->glyph_format )
+    {
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    if ( matrix )
+      FT_Outline_Transform( &slot->outline, matrix );
+
+    if ( delta )
+      FT_Outline_Translate( &slot->outline, delta->x, delta->y );
+
+  Exit:
+    return error;
+  }
+
+
+  /* return the glyph's control box */
+  static void
+  ft_sdf_get_cbox( FT_Renderer   render,
+                   FT_GlyphSlot  slot,
+                   FT_BBox*      cbox )
+  {
+    FT_ZERO( cbox );
+
+    if ( slot->format == render->glyph_format )
+      FT_Outline_Get_CBox( &slot->outline, cbox );
+  }
+
+
+  /* convert a slot's glyph image into a distance field */
+  static FT_Error
+  ft_sdf_render( FT_Renderer       render,
+                 FT_GlyphSlot      slot,
+                 FT_Render_Mode    mode,
+                 const FT_Vector*  origin )
+  {
+    FT_Error     error   = FT_Err_Ok;
+    FT_Outline*  outline = &slot->outline;
+    FT_Bitmap*   bitmap  = &slot->bitmap;
+    FT_Memory    memory  = render->root.memory;
+    FT_Int       spread  = (FT_Int)( (SDF_Renderer)render )->spread;
+    FT_Pos       x_shift = 0;
+    FT_Pos       y_shift = 0;
+
+    FT_Raster_Params  params;
+
+
+    /* check glyph image format */
+    if ( slot->format != render->glyph_format )
+    {
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    /* check mode */
+    if ( mode != FT_RENDER_MODE_SDF && mode != FT_RENDER_MODE_MSDF )
+    {
+      error = FT_THROW( Cannot_Render_Glyph );
+      goto Exit;
+    }
+
+    /* release old bitmap buffer */
+    if ( slot->internal->flags & FT_GLYPH_OWN_BITMAP )
+    {
+      FT_FREE( bitmap->buffer );
+      slot->internal->flags &= ~FT_GLYPH_OWN_BITMAP;
+    }
+
+    ft_glyphslot_preset_bitmap( slot, mode, origin );
+
+    /* the field extends beyond the outline by the spread */
+    if ( bitmap->width && bitmap->rows )
+    {
+      slot->bitmap_left -= spread;
+      slot->bitmap_top  += spread;
+      bitmap->width     += 2 * (FT_UInt)spread;
+      bitmap->rows      += 2 * (FT_UInt)spread;
+    }
+
+    if ( mode == FT_RENDER_MODE_MSDF )
+    {
+      bitmap->pixel_mode = FT_PIXEL_MODE_BGRA;
+      bitmap->pitch      = (int)bitmap->width * 4;
+    }
+    else
+      bitmap->pitch = (int)bitmap->width;
+
+    if ( bitmap->width > 0x2000 || bitmap->rows > 0x2000 )
+    {
+      error = FT_THROW( Raster_Overflow );
+      goto Exit;
+    }
+
+    /* an empty glyph results in an empty bitmap */
+    if ( !bitmap->width || !bitmap->rows )
+      goto Exit;
+
+    /* allocate new one */
+    if ( FT_ALLOC_MULT( bitmap->buffer, bitmap->rows, bitmap->pitch ) )
+      goto Exit;
+
+    slot->internal->flags |= FT_GLYPH_OWN_BITMAP;
+
+    x_shift = 64 * -slot->bitmap_left;
+    y_shift = 64 * -slot->bitmap_top + 64 * (FT_Int)bitmap->rows;
+
+    if ( origin )
+    {
+      x_shift += origin->x;
+      y_shift += origin->y;
+    }
+
+    /* translate outline to render it into the bitmap */
+    if ( x_shift || y_shift )
+      FT_Outline_Translate( outline, x_shift, y_shift );
+
+    /* set up parameters */
+    params.target = bitmap;
+    params.source = outline;
+    params.flags  = FT_RASTER_FLAG_SDF;
+
+    error = render->raster_render( render->raster, &params );
+
+  Exit:
+    if ( !error )
+    {
+      /* everything is fine; the glyph is now officially a bitmap */
+      slot->format = FT_GLYPH_FORMAT_BITMAP;
+    }
+    else if ( slot->internal->flags & FT_GLYPH_OWN_BITMAP )
+    {
+      FT_FREE( bitmap->buffer );
+      slot->internal->flags &= ~FT_GLYPH_OWN_BITMAP;
+    }
+
+    if ( x_shift || y_shift )
+      FT_Outline_Translate( outline, -x_shift, -y_shift );
+
+    return error;
+  }
+
+
+  static FT_Error
+  ft_sdf_property_set( FT_Module    module,   /* SDF_Renderer */
+                       const char*  property_name,
+                       const void*  value,
+                       FT_Bool      value_is_string )
+  {
+    SDF_Renderer  sdf    = (SDF_Renderer)module;
+    FT_Renderer   render = &sdf->root;
+
+#ifndef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+    FT_UNUSED( value_is_string );
+#endif
+
+
+    if ( !ft_strcmp( property_name, "spread" ) )
+    {
+      FT_UInt  spread;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+        long         t = ft_strtol( s, NULL, 10 );
+
+
+        if ( t < SDF_MIN_SPREAD || t > SDF_MAX_SPREAD )
+          return FT_THROW( Invalid_Argument );
+
+        spread = (FT_UInt)t;
+      }
+      else
+#endif
+      {
+        spread = *(const FT_UInt*)value;
+
+        if ( spread < SDF_MIN_SPREAD || spread > SDF_MAX_SPREAD )
+          return FT_THROW( Invalid_Argument );
+      }
+
+      sdf->spread = spread;
+
+      return render->clazz->raster_class->raster_set_mode( render->raster,
+                                                           FT_SDF_MODE_SPREAD,
+                                                           &sdf->spread );
+    }
+
+    FT_TRACE0(( "ft_sdf_property_set: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  static FT_Error
+  ft_sdf_property_get( FT_Module    module,   /* SDF_Renderer */
+                       const char*  property_name,
+                       const void*  value )
+  {
+    SDF_Renderer  sdf = (SDF_Renderer)module;
+
+
+    if ( !ft_strcmp( property_name, "spread" ) )
+    {
+      FT_UInt*  val = (FT_UInt*)value;
+
+
+      *val = sdf->spread;
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_sdf_property_get: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  FT_DEFINE_SERVICE_PROPERTIESREC(
+    ft_sdf_service_properties,
+
+    (FT_Properties_SetFunc)ft_sdf_property_set,     /* set_property */
+    (FT_Properties_GetFunc)ft_sdf_property_get      /* get_property */
+  )
+
+
+  static const FT_ServiceDescRec  ft_sdf_services[] =
+  {
+    { FT_SERVICE_ID_PROPERTIES, &ft_sdf_service_properties },
+    { NULL, NULL }
+  };
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  ft_sdf_get_interface( FT_Module    module,
+                        const char*  sdf_interface )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( ft_sdf_services, sdf_interface );
+  }
+
+
+  FT_DEFINE_RENDERER(
+    ft_sdf_renderer_class,
+
+      FT_MODULE_RENDERER,
+      sizeof ( SDF_RendererRec ),
+
+      "sdf",
+      0x10000L,
+      0x20000L,
+
+      NULL,    /* module specific interface */
+
+      (FT_Module_Constructor)ft_sdf_init,          /* module_init   */
+      (FT_Module_Destructor) NULL,                 /* module_done   */
+      (FT_Module_Requester)  ft_sdf_get_interface, /* get_interface */
+
+    FT_GLYPH_FORMAT_OUTLINE,
+
+    (FT_Renderer_RenderFunc)   ft_sdf_render,     /* render_glyph    */
+    (FT_Renderer_TransformFunc)ft_sdf_transform,  /* transform_glyph */
+    (FT_Renderer_GetCBoxFunc)  ft_sdf_get_cbox,   /* get_glyph_cbox  */
+    (FT_Renderer_SetModeFunc)  ft_sdf_set_mode,   /* set_mode        */
+
+    (FT_Raster_Funcs*)&ft_sdf_raster              /* raster_class    */
+  )
+
+
+/* END */
@@ -151,6 +151,7 @@
           (long)( -(unsigned long)(a) )
 
 
+#define ft_memcpy   memcpy
 #define ft_memset   memset
 
 #define ft_setjmp   setjmp
@@ -276,6 +277,7 @@ typedef ptrdiff_t  FT_PtrDist;
 #include FT_INTERNAL_DEBUG_H
 #include FT_INTERNAL_CALC_H
 #include FT_OUTLINE_H
+#include FT_DRIVER_H
 
 #include "ftsmerrs.h"
 
@@ -284,6 +286,53 @@ typedef ptrdiff_t  FT_PtrDist;
 #define ErrRaster_Memory_Overflow   Smooth_Err_Out_Of_Memory
 
 
+  /* SIMD versions of the accumulation buffer sweep; SSE2 and NEON are */
+  /* used if the compiler targets them, AVX2 if the CPU supports it    */
+#ifndef FT_CONFIG_OPTION_NO_SIMD
+
+#include FT_INTERNAL_CPU_H
+
+#if defined( __SSE2__ )                           || \
+    defined( _M_X64 )                             || \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define GRAY_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( GRAY_SSE2 )                                                  && \
+    ( defined( __AVX2__ )                                              || \
+      ( defined( __GNUC__ )                                          &&   \
+        ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) || \
+      defined( __clang__ )                                             || \
+      ( defined( _MSC_VER ) && _MSC_VER >= 1900 )                      )
+#define GRAY_AVX2
+#include <immintrin.h>
+#if defined( __GNUC__ ) && !defined( __AVX2__ )
+#define GRAY_TARGET_AVX2  __attribute__(( target( "avx2" ) ))
+#else
+#define GRAY_TARGET_AVX2  /* nothing */
+#endif
+#endif
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 )
+#define GRAY_NEON
+#include <arm_neon.h>
+#endif
+
+#endif /* !FT_CONFIG_OPTION_NO_SIMD */
+
+
+  /* fused LCD filtering, only needed for subpixel rendering */
+#ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
+#define GRAY_LCD_FILTER
+#endif
+
+  /* concurrent rendering of bands needs a worker object for each band */
+#ifndef FT_STATIC_RASTER
+#define GRAY_PARALLEL
+#endif
+
+
 #endif /* !STANDALONE_ */
 
 
@@ -291,6 +340,10 @@ typedef ptrdiff_t  FT_PtrDist;
 #define FT_MEM_SET( d, s, c )  ft_memset( d, s, c )
 #endif
 
+#ifndef FT_MEM_COPY
+#define FT_MEM_COPY( d, s, c )  ft_memcpy( d, s, c )
+#endif
+
 #ifndef FT_MEM_ZERO
 #define FT_MEM_ZERO( dest, count )  FT_MEM_SET( dest, 0, count )
 #endif
@@ -418,6 +471,23 @@ typedef ptrdiff_t  FT_PtrDist;
 
   } TCell;
 
+  typedef unsigned int  TMask;   /* at least MASK_BITS wide */
+
+#define MASK_BITS  32
+
+
+  /* Convert `count' cells of an accumulation buffer scanline to gray */
+  /* levels, starting with the running cover sum `acc', and return    */
+  /* the updated sum.  All pixels are written, even zero ones.        */
+  typedef TArea
+  (*gray_Resolve_Func)( const TArea*    area,
+                        const TCoord*   cover,
+                        unsigned char*  line,
+                        TCoord          count,
+                        TArea           acc,
+                        int             even_odd );
+
+
   typedef struct TPixmap_
   {
     unsigned char*  origin;  /* pixmap origin at the bottom-left */
@@ -432,6 +502,25 @@ typedef ptrdiff_t  FT_PtrDist;
 #define FT_MAX_GRAY_POOL  ( 2048 / sizeof ( TCell ) )
 #endif
 
+  /* maximum number of gray cells in the heap-allocated buffer; */
+  /* without a memory allocator only the stack buffer is used   */
+#ifndef FT_MAX_RENDER_POOL_SIZE
+#define FT_MAX_RENDER_POOL_SIZE  ( 4L * 1024L * 1024L )
+#endif
+
+#if !defined( STANDALONE_ )                         && \
+    FT_MAX_RENDER_POOL_SIZE > FT_RENDER_POOL_SIZE   && \
+    FT_MAX_RENDER_POOL_SIZE > 2048
+#define GRAY_HEAP_POOL
+#define FT_MAX_GRAY_HEAP  ( FT_MAX_RENDER_POOL_SIZE / sizeof ( TCell ) )
+#endif
+
+  /* maximum size in bytes of the accumulation buffer; */
+  /* larger glyphs are rendered in several bands       */
+#ifndef FT_MAX_GRAY_ACCUM
+#define FT_MAX_GRAY_ACCUM  ( 1024L * 1024L )
+#endif
+
 
 #if defined( _MSC_VER )      /* Visual C++ (and Intel C++) */
   /* We disable the warning `structure was padded due to   */
@@ -458,6 +547,37 @@ typedef ptrdiff_t  FT_PtrDist;
     FT_PtrDist  max_cells;
     FT_PtrDist  num_cells;
 
+    /* dense buffers of the accumulation backend, holding `accum_pitch' */
+    /* cells per scanline, the first one for cells left of `min_ex',    */
+    /* and a bit mask of the touched cells with `accum_words' words per */
+    /* scanline; `accum_area' is NULL if the cell lists are used        */
+    TArea*      accum_area;
+    TCoord*     accum_cover;
+    TMask*      accum_mask;
+    TCoord      accum_pitch;
+    TCoord      accum_words;
+
+    gray_Resolve_Func  resolve;  /* SIMD sweep of dense cells, or NULL */
+
+    const unsigned char*  coverage_table;  /* applied to the spans, or NULL */
+
+#ifdef GRAY_LCD_FILTER
+    /* fused LCD filtering of the target rows (see `gray_lcd_filter'); */
+    /* `lcd_weights' is NULL if it is off                              */
+    const unsigned char*  lcd_weights;
+    FT_LcdFirRec          lcd_fir;
+    int                   lcd_vertical;
+    TCoord                lcd_width;   /* size of the target bitmap      */
+    TCoord                lcd_height;
+    TCoord                lcd_y;       /* next row to be filtered        */
+    TCoord                lcd_end;     /* vertical: end of filtered rows */
+    unsigned char*        lcd_save;    /* vertical: unfiltered values of */
+                                       /* the two rows below `lcd_y',    */
+                                       /* allocated per rendering        */
+    const unsigned char*  lcd_table;   /* coverage table applied to the  */
+                                       /* filtered rows, or NULL         */
+#endif
+
     TPos    x,  y;
 
     FT_Outline  outline;
@@ -465,6 +585,7 @@ typedef ptrdiff_t  FT_PtrDist;
 
     FT_Raster_Span_Func  render_span;
     void*                render_span_data;
+    int                  render_surface;  /* spans of an FT_Raster_Surface */
 
   } gray_TWorker, *gray_PWorker;
 
@@ -482,7 +603,15 @@ typedef ptrdiff_t  FT_PtrDist;
 
   typedef struct gray_TRaster_
   {
-    void*         memory;
+    void*          memory;
+
+    gray_Resolve_Func  resolve;
+
+    const unsigned char*  coverage_table;  /* see FT_GRAY_MODE_COVERAGE_TABLE */
+
+#ifdef GRAY_PARALLEL
+    FT_Prop_BandExecutor  executor;  /* for concurrent rendering of bands */
+#endif
 
   } gray_TRaster, *gray_PRaster;
 
@@ -516,7 +645,8 @@ typedef ptrdiff_t  FT_PtrDist;
 
   /**************************************************************************
    *
-   * Record the current cell in the table.
+   * Record the current cell in the table (or add it to the accumulation
+   * buffer).
    */
   static void
   gray_record_cell( RAS_ARG )
@@ -525,6 +655,21 @@ typedef ptrdiff_t  FT_PtrDist;
     TCoord  x = ras.ex;
 
 
+    if ( ras.accum_area )
+    {
+      FT_PtrDist  row = ras.ey - ras.min_ey;
+      TCoord      i   = x - ras.min_ex + 1;
+      FT_PtrDist  idx = row * ras.accum_pitch + i;
+
+
+      ras.accum_area[idx]  += ras.area;
+      ras.accum_cover[idx] += ras.cover;
+
+      ras.accum_mask[row * ras.accum_words + i / MASK_BITS] |=
+        1U << ( i % MASK_BITS );
+      return;
+    }
+
     pcell = &ras.ycells[ras.ey - ras.min_ey];
     for (;;)
     {
@@ -972,6 +1117,220 @@ typedef ptrdiff_t  FT_PtrDist;
 
 #endif
 
+#ifdef FT_LONG64
+
+  /*
+   * Curves are flattened into 2^shift lines of equal parameter steps
+   * `h = 2^-shift', with the shift computed from the curve's flatness.
+   * Per axis, the distance between an arc and its chords is at most
+   * `M * h^2 / 4' for a conic, where `M' is its second difference
+   * `|P0 - 2*P1 + P2|', and `3 * M * h^2 / 4' for a cubic, where `M' is
+   * the larger of its two second differences.  Each halving of the step
+   * quarters the distance, so the shift that keeps it below 1/16 pixel
+   * is found without any subdivision; a shift of 11 is enough for the
+   * largest glyphs.
+   *
+   * The points are computed by forward differencing.  The differences
+   * have `2 * shift' (conic) or `3 * shift' (cubic) fractional bits, in
+   * which they are exact: the emitted points are truncated curve points
+   * without any accumulated error.  Scaled up by these bits, the
+   * distances within the control polygon must still fit into 64 bits;
+   * the shift is reduced for arcs spanning more than 2^18 pixels, which
+   * are then flattened more coarsely.  `gray_raster_render' rejects such
+   * glyphs anyway, but the flattening doesn't rely on that limit.
+   */
+
+#define GRAY_MAX_FLATTEN_SHIFT  11
+
+
+  static void
+  gray_render_conic( RAS_ARG_ const FT_Vector*  control,
+                              const FT_Vector*  to )
+  {
+    TPos      x0, y0, x2, y2;
+    TPos      ax, ay, bx, by, dx, dy;
+    FT_Int64  px, py, qx, qy, rx, ry, ext;
+    FT_UInt   count;
+    int       shift;
+
+
+    x0 = ras.x;
+    y0 = ras.y;
+    x2 = UPSCALE( to->x );
+    y2 = UPSCALE( to->y );
+    bx = UPSCALE( control->x );
+    by = UPSCALE( control->y );
+
+    /* short-cut the arc that crosses the current band */
+    if ( ( TRUNC( y0 ) >= ras.max_ey &&
+           TRUNC( by ) >= ras.max_ey &&
+           TRUNC( y2 ) >= ras.max_ey ) ||
+         ( TRUNC( y0 ) <  ras.min_ey &&
+           TRUNC( by ) <  ras.min_ey &&
+           TRUNC( y2 ) <  ras.min_ey ) )
+    {
+      ras.x = x2;
+      ras.y = y2;
+      return;
+    }
+
+    bx -= x0;               /* P1 - P0          */
+    by -= y0;
+    ax  = x2 - x0 - 2 * bx; /* P0 - 2 * P1 + P2 */
+    ay  = y2 - y0 - 2 * by;
+
+    dx = FT_ABS( ax );
+    dy = FT_ABS( ay );
+    if ( dx < dy )
+      dx = dy;
+
+    shift = 0;
+    while ( dx > ONE_PIXEL / 4 && shift < GRAY_MAX_FLATTEN_SHIFT )
+    {
+      dx   >>= 2;
+      shift += 1;
+    }
+
+    /* the differences are at most 4 * ext * 2^(2 * shift) */
+    ext = FT_MAX( FT_ABS( bx ), FT_ABS( by ) );
+    ext = FT_MAX( ext, FT_ABS( x2 - x0 ) );
+    ext = FT_MAX( ext, FT_ABS( y2 - y0 ) );
+    while ( shift > 0 && ( ext >> ( 60 - 2 * shift ) ) )
+      shift--;
+
+    if ( shift > 0 )
+    {
+      /*
+       * With P(t) = P0 + 2*B*t + A*t^2, the first difference is
+       * Q = 2*B*h + A*h^2, growing by R = 2*A*h^2 with each step.
+       */
+      rx = (FT_Int64)ax * 2;
+      ry = (FT_Int64)ay * 2;
+      qx = (FT_Int64)bx * ( (FT_Int64)2 << shift ) + ax;
+      qy = (FT_Int64)by * ( (FT_Int64)2 << shift ) + ay;
+      px = 0;
+      py = 0;
+
+      for ( count = ( 1U << shift ) - 1; count > 0; count-- )
+      {
+        px += qx;
+        py += qy;
+        qx += rx;
+        qy += ry;
+
+        gray_render_line( RAS_VAR_ x0 + (TPos)( px >> ( 2 * shift ) ),
+                                   y0 + (TPos)( py >> ( 2 * shift ) ) );
+      }
+    }
+
+    gray_render_line( RAS_VAR_ x2, y2 );
+  }
+
+
+  static void
+  gray_render_cubic( RAS_ARG_ const FT_Vector*  control1,
+                              const FT_Vector*  control2,
+                              const FT_Vector*  to )
+  {
+    TPos      x0, y0, x1, y1, x2, y2, x3, y3;
+    TPos      ax, ay, bx, by, cx, cy, dx, dy;
+    FT_Int64  px, py, qx, qy, rx, ry, sx, sy, ext;
+    FT_UInt   count;
+    int       shift;
+
+
+    x0 = ras.x;
+    y0 = ras.y;
+    x1 = UPSCALE( control1->x );
+    y1 = UPSCALE( control1->y );
+    x2 = UPSCALE( control2->x );
+    y2 = UPSCALE( control2->y );
+    x3 = UPSCALE( to->x );
+    y3 = UPSCALE( to->y );
+
+    /* short-cut the arc that crosses the current band */
+    if ( ( TRUNC( y0 ) >= ras.max_ey &&
+           TRUNC( y1 ) >= ras.max_ey &&
+           TRUNC( y2 ) >= ras.max_ey &&
+           TRUNC( y3 ) >= ras.max_ey ) ||
+         ( TRUNC( y0 ) <  ras.min_ey &&
+           TRUNC( y1 ) <  ras.min_ey &&
+           TRUNC( y2 ) <  ras.min_ey &&
+           TRUNC( y3 ) <  ras.min_ey ) )
+    {
+      ras.x = x3;
+      ras.y = y3;
+      return;
+    }
+
+    bx = x1 - x0;               /* P1 - P0                    */
+    by = y1 - y0;
+    ax = x2 - 2 * x1 + x0;      /* P0 - 2 * P1 + P2           */
+    ay = y2 - 2 * y1 + y0;
+    cx = x3 - 2 * x2 + x1 - ax; /* P3 - 3 * P2 + 3 * P1 - P0 */
+    cy = y3 - 2 * y2 + y1 - ay;
+
+    dx = FT_MAX( FT_ABS( ax ), FT_ABS( ax + cx ) );
+    dy = FT_MAX( FT_ABS( ay ), FT_ABS( ay + cy ) );
+    if ( dx < dy )
+      dx = dy;
+    dx *= 3;
+
+    shift = 0;
+    while ( dx > ONE_PIXEL / 4 && shift < GRAY_MAX_FLATTEN_SHIFT )
+    {
+      dx   >>= 2;
+      shift += 1;
+    }
+
+    /* the differences are at most 8 * ext * 2^(3 * shift) */
+    ext = FT_MAX( FT_ABS( bx ), FT_ABS( by ) );
+    ext = FT_MAX( ext, FT_ABS( x2 - x0 ) );
+    ext = FT_MAX( ext, FT_ABS( y2 - y0 ) );
+    ext = FT_MAX( ext, FT_ABS( x3 - x0 ) );
+    ext = FT_MAX( ext, FT_ABS( y3 - y0 ) );
+    while ( shift > 0 && ( ext >> ( 59 - 3 * shift ) ) )
+      shift--;
+
+    if ( shift > 0 )
+    {
+      /*
+       * With P(t) = P0 + 3*B*t + 3*A*t^2 + C*t^3, the first difference
+       * is Q = 3*B*h + 3*A*h^2 + C*h^3, the second one starts at
+       * R = 6*A*h^2 + 6*C*h^3, and the third one is S = 6*C*h^3.
+       */
+      sx = (FT_Int64)cx * 6;
+      sy = (FT_Int64)cy * 6;
+      rx = (FT_Int64)ax * ( (FT_Int64)6 << shift ) + sx;
+      ry = (FT_Int64)ay * ( (FT_Int64)6 << shift ) + sy;
+      qx = (FT_Int64)bx * ( (FT_Int64)3 << ( 2 * shift ) ) +
+           (FT_Int64)ax * ( (FT_Int64)3 << shift ) + cx;
+      qy = (FT_Int64)by * ( (FT_Int64)3 << ( 2 * shift ) ) +
+           (FT_Int64)ay * ( (FT_Int64)3 << shift ) + cy;
+      px = 0;
+      py = 0;
+
+      for ( count = ( 1U << shift ) - 1; count > 0; count-- )
+      {
+        px += qx;
+        py += qy;
+        qx += rx;
+        qy += ry;
+        rx += sx;
+        ry += sy;
+
+        gray_render_line( RAS_VAR_ x0 + (TPos)( px >> ( 3 * shift ) ),
+                                   y0 + (TPos)( py >> ( 3 * shift ) ) );
+      }
+    }
+
+    gray_render_line( RAS_VAR_ x3, y3 );
+  }
+
+#else /* !FT_LONG64 */
+
+  /* without 64-bit integers, the curves are bisected recursively */
+
   static void
   gray_split_conic( FT_Vector*  base )
   {
@@ -1178,6 +1537,8 @@ typedef ptrdiff_t  FT_PtrDist;
     }
   }
 
+#endif /* !FT_LONG64 */
+
 
   static int
   gray_move_to( const FT_Vector*  to,
@@ -1228,11 +1589,9 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
-  static void
-  gray_hline( RAS_ARG_ TCoord  x,
-                       TCoord  y,
-                       TArea   coverage,
-                       TCoord  acount )
+  /* convert an accumulated cell area to a gray level */
+  static TArea
+  gray_coverage( RAS_ARG_ TArea  coverage )
   {
     /* scale the coverage from 0..(ONE_PIXEL*ONE_PIXEL*2) to 0..256  */
     coverage >>= PIXEL_BITS * 2 + 1 - 8;
@@ -1254,6 +1613,37 @@ typedef ptrdiff_t  FT_PtrDist;
         coverage = 255;
     }
 
+    return coverage;
+  }
+
+
+#ifndef STANDALONE_
+
+  /* map `count' gray levels with the coverage table */
+  static void
+  gray_map_coverage( const unsigned char*  table,
+                     unsigned char*        p,
+                     TCoord                count )
+  {
+    for ( ; count > 0; count--, p++ )
+      *p = table[*p];
+  }
+
+#endif
+
+
+  static void
+  gray_hline( RAS_ARG_ TCoord  x,
+                       TCoord  y,
+                       TArea   coverage,
+                       TCoord  acount )
+  {
+    coverage = gray_coverage( RAS_VAR_ coverage );
+
+    /* a span has a single value, so the table costs one lookup */
+    if ( ras.coverage_table )
+      coverage = ras.coverage_table[coverage];
+
     if ( ras.render_span )  /* for FT_RASTER_FLAG_DIRECT only */
     {
       FT_Span  span;
@@ -1292,6 +1682,131 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+#ifdef GRAY_LCD_FILTER
+
+  /**************************************************************************
+   *
+   * Fused LCD filtering.  The five-tap FIR filter of `ft_lcd_filter_fir'
+   * is applied to the rows of the target bitmap as soon as the sweep has
+   * finished them, while they are still in the cache, with bit-identical
+   * results.  Rows are swept bottom-up, one after the other, even if the
+   * glyph is split into bands.
+   *
+   * A horizontal filter only needs the row itself.  A vertical filter
+   * producing row `y' needs rows `y - 2' to `y + 2'; it lags two rows
+   * behind the sweep and saves the unfiltered values of the two rows
+   * below the current one.  Rows outside of the clip box are zero
+   * before filtering; only the two rows above and below it can get
+   * non-zero values, which are handled by `gray_lcd_filter_v' once the
+   * glyph is complete.
+   */
+
+  static void
+  gray_lcd_filter_h( RAS_ARG_ TCoord  y )
+  {
+    unsigned char*  line = ras.target.origin - ras.target.pitch * y;
+
+
+    ras.lcd_fir.row( line, (FT_UInt)ras.lcd_width, ras.lcd_weights );
+
+    if ( ras.lcd_table )
+      gray_map_coverage( ras.lcd_table, line, ras.lcd_width );
+  }
+
+
+  /* filter the rows from `lcd_y' up to (but not including) `limit' */
+  static void
+  gray_lcd_filter_v( RAS_ARG_ TCoord  limit )
+  {
+    TCoord  width = ras.max_ex - ras.min_ex;
+    int     pitch = ras.target.pitch;
+
+    /* two saved rows and a row of zeros */
+    unsigned char*  save  = ras.lcd_save;
+    unsigned char*  zeros = save + 2 * width;
+
+
+    for ( ; ras.lcd_y < limit; ras.lcd_y++ )
+    {
+      TCoord          y    = ras.lcd_y;
+      unsigned char*  line = ras.target.origin - pitch * y + ras.min_ex;
+      const FT_Byte*  in[5];
+
+
+      in[0] = y + 2 < ras.lcd_height ? line - 2 * pitch : zeros;
+      in[1] = y + 1 < ras.lcd_height ? line - pitch     : zeros;
+      in[2] = line;
+      in[3] = save + ( ~y & 1 ) * width;   /* row y - 1 */
+      in[4] = save + (  y & 1 ) * width;   /* row y - 2 */
+
+      /* row `y' replaces row `y - 2' */
+      ras.lcd_fir.rows( line, (FT_Byte*)in[4], in,
+                        (FT_UInt)width, ras.lcd_weights );
+
+      if ( ras.lcd_table )
+        gray_map_coverage( ras.lcd_table, line, width );
+    }
+  }
+
+
+  /* called by the sweep functions after row `y' is complete */
+  static void
+  gray_lcd_filter( RAS_ARG_ TCoord  y )
+  {
+    if ( ras.lcd_vertical )
+      gray_lcd_filter_v( RAS_VAR_ y - 1 );
+    else
+      gray_lcd_filter_h( RAS_VAR_ y );
+  }
+
+
+  /* set up fused LCD filtering for the current rendering */
+  static int
+  gray_lcd_filter_init( RAS_ARG_ gray_PRaster            raster,
+                                 const gray_TLcdParams*  params )
+  {
+    const FT_Bitmap*  target_map = params->root.target;
+
+
+    ras.lcd_weights  = NULL;
+    ras.lcd_vertical = target_map->pixel_mode == FT_PIXEL_MODE_LCD_V;
+    ras.lcd_width    = (TCoord)target_map->width;
+    ras.lcd_height   = (TCoord)target_map->rows;
+
+    /* `ft_lcd_filter_fir' leaves such bitmaps alone */
+    if ( ras.lcd_vertical ? ras.lcd_height < 2 : ras.lcd_width < 2 )
+      return 0;
+
+    if ( ras.lcd_vertical )
+    {
+      FT_Memory      memory = (FT_Memory)raster->memory;
+      unsigned long  size   = 3 * (unsigned long)( ras.max_ex - ras.min_ex );
+      FT_Error       error;
+
+
+      /* the rows below the clip box are zero, as is the extra row  */
+      /* at the end; the buffer is freed by `gray_raster_render', as */
+      /* the raster object is shared between threads                */
+      if ( FT_ALLOC( ras.lcd_save, size ) )
+        return error;
+
+      ras.lcd_y   = FT_MAX( ras.min_ey - 2, 0 );
+      ras.lcd_end = FT_MIN( ras.max_ey + 2, ras.lcd_height );
+    }
+
+    ras.lcd_weights = params->weights;
+    ft_lcd_fir_select( &ras.lcd_fir, params->weights );
+
+    /* the table applies to the filtered values */
+    ras.lcd_table      = ras.coverage_table;
+    ras.coverage_table = NULL;
+
+    return 0;
+  }
+
+#endif /* GRAY_LCD_FILTER */
+
+
   static void
   gray_sweep( RAS_ARG )
   {
@@ -1322,79 +1837,281 @@ typedef ptrdiff_t  FT_PtrDist;
 
       if ( cover != 0 )
         gray_hline( RAS_VAR_ x, y, cover, ras.max_ex - x );
+
+#ifdef GRAY_LCD_FILTER
+      if ( ras.lcd_weights )
+        gray_lcd_filter( RAS_VAR_ y );
+#endif
     }
   }
 
-
-#ifdef STANDALONE_
-
   /**************************************************************************
    *
-   * The following functions should only compile in stand-alone mode,
-   * i.e., when building this component without the rest of FreeType.
+   * Outlines made only of horizontal and vertical lines, like bars,
+   * box-drawing characters, and many strokes of CJK and icon fonts, are
+   * rendered without the cell pool.  Horizontal lines don't add any
+   * coverage; a vertical line adds to the cell it crosses in each
+   * scanline a cover of its height there and an area proportional to
+   * its distance from the cell's left border, exactly as in
+   * `gray_render_line'.  These few cells are sorted and swept directly,
+   * and a scanline whose cells are the same as the previous one's is
+   * copied from it.  The output is identical to the normal rendering.
    *
+   * Return -1 if the outline doesn't qualify.
    */
 
-  /**************************************************************************
-   *
-   * @Function:
-   *   FT_Outline_Decompose
-   *
-   * @Description:
-   *   Walk over an outline's structure to decompose it into individual
-   *   segments and Bézier arcs.  This function is also able to emit
-   *   `move to' and `close to' operations to indicate the start and end
-   *   of new contours in the outline.
-   *
-   * @Input:
-   *   outline ::
-   *     A pointer to the source target.
-   *
-   *   func_interface ::
-   *     A table of `emitters', i.e., function pointers
-   *     called during decomposition to indicate path
-   *     operations.
-   *
-   * @InOut:
-   *   user ::
-   *     A typeless pointer which is passed to each
-   *     emitter during the decomposition.  It can be
-   *     used to store the state during the
-   *     decomposition.
-   *
-   * @Return:
-   *   Error code.  0 means success.
-   */
-  static int
-  FT_Outline_Decompose( const FT_Outline*        outline,
-                        const FT_Outline_Funcs*  func_interface,
-                        void*                    user )
+#define GRAY_MAX_EDGES  32
+
+  typedef struct  gray_TEdge_
   {
-#undef SCALED
-#define SCALED( x )  ( ( (x) << shift ) - delta )
+    TPos  x;
+    TPos  y1, y2;   /* y1 < y2   */
+    int   dir;      /* 1 or -1   */
 
-    FT_Vector   v_last;
-    FT_Vector   v_control;
-    FT_Vector   v_start;
+  } gray_TEdge;
 
-    FT_Vector*  point;
-    FT_Vector*  limit;
-    char*       tags;
 
-    int         error;
+  static int
+  gray_convert_glyph_rect( RAS_ARG )
+  {
+    const FT_Outline*  outline = &ras.outline;
 
-    int   n;         /* index of contour in outline     */
-    int   first;     /* index of first point in contour */
-    char  tag;       /* current point's state           */
+    gray_TEdge  edges[GRAY_MAX_EDGES];
+    TCell       cells[2][GRAY_MAX_EDGES];
+    int         num_edges = 0;
+    int         num_cells, prev_cells = -1;
+    int         n, first, last, i, j;
+    int         copy = !ras.render_span;
+    TCoord      y;
 
-    int   shift;
-    TPos  delta;
 
+    first = 0;
+    for ( n = 0; n < outline->n_contours; n++ )
+    {
+      last = outline->contours[n];
+      if ( last < first || last >= outline->n_points )
+        return -1;
 
-    if ( !outline )
-      return FT_THROW( Invalid_Outline );
+      for ( i = first; i <= last; i++ )
+      {
+        const FT_Vector*  a = outline->points + i;
+        const FT_Vector*  b = outline->points + ( i < last ? i + 1 : first );
 
-    if ( !func_interface )
+
+        if ( FT_CURVE_TAG( outline->tags[i] ) != FT_CURVE_TAG_ON )
+          return -1;
+
+        if ( a->x != b->x )
+        {
+          if ( a->y != b->y )
+            return -1;
+          continue;
+        }
+
+        if ( a->y == b->y )
+          continue;
+
+        if ( num_edges == GRAY_MAX_EDGES )
+          return -1;
+
+        edges[num_edges].x = UPSCALE( a->x );
+        if ( a->y < b->y )
+        {
+          edges[num_edges].y1  = UPSCALE( a->y );
+          edges[num_edges].y2  = UPSCALE( b->y );
+          edges[num_edges].dir = 1;
+        }
+        else
+        {
+          edges[num_edges].y1  = UPSCALE( b->y );
+          edges[num_edges].y2  = UPSCALE( a->y );
+          edges[num_edges].dir = -1;
+        }
+        num_edges++;
+      }
+
+      first = last + 1;
+    }
+
+#ifdef GRAY_LCD_FILTER
+    if ( ras.lcd_weights )
+      copy = 0;
+#endif
+
+    for ( y = ras.min_ey; y < ras.max_ey; y++ )
+    {
+      PCell   row   = cells[y & 1];
+      TPos    top   = SUBPIXELS( y + 1 );
+      TPos    bot   = SUBPIXELS( y );
+      TCoord  x     = ras.min_ex;
+      TArea   cover = 0;
+      TArea   area;
+
+
+      /* the cells of this scanline, sorted and merged */
+      num_cells = 0;
+
+      for ( i = 0; i < num_edges; i++ )
+      {
+        const gray_TEdge*  e = edges + i;
+
+        TCoord  ex = TRUNC( e->x );
+        TCoord  h;
+        TArea   a;
+
+
+        if ( e->y1 >= top || e->y2 <= bot || ex >= ras.max_ex )
+          continue;
+
+        h = (TCoord)( FT_MIN( e->y2, top ) - FT_MAX( e->y1, bot ) ) *
+              e->dir;
+        a = (TArea)h * ( e->x - SUBPIXELS( ex ) ) * 2;
+
+        if ( ex < ras.min_ex )
+          ex = ras.min_ex - 1;
+
+        for ( j = 0; j < num_cells && row[j].x < ex; j++ )
+          ;
+
+        if ( j < num_cells && row[j].x == ex )
+        {
+          row[j].cover += h;
+          row[j].area  += a;
+        }
+        else
+        {
+          for ( n = num_cells; n > j; n-- )
+            row[n] = row[n - 1];
+
+          row[j].x     = ex;
+          row[j].cover = h;
+          row[j].area  = a;
+          num_cells++;
+        }
+      }
+
+      /* a copy of the previous scanline's pixels, if possible */
+      if ( copy && num_cells == prev_cells )
+      {
+        PCell  prev = cells[~y & 1];
+
+
+        for ( i = 0; i < num_cells; i++ )
+          if ( row[i].x     != prev[i].x     ||
+               row[i].cover != prev[i].cover ||
+               row[i].area  != prev[i].area  )
+            break;
+
+        if ( i == num_cells )
+        {
+          unsigned char*  q = ras.target.origin - ras.target.pitch * y;
+
+
+          FT_MEM_COPY( q + ras.min_ex,
+                       q + ras.target.pitch + ras.min_ex,
+                       ras.max_ex - ras.min_ex );
+          continue;
+        }
+      }
+
+      prev_cells = num_cells;
+
+      for ( i = 0; i < num_cells; i++ )
+      {
+        if ( cover != 0 && row[i].x > x )
+          gray_hline( RAS_VAR_ x, y, cover, row[i].x - x );
+
+        cover += (TArea)row[i].cover * ( ONE_PIXEL * 2 );
+        area   = cover - row[i].area;
+
+        if ( area != 0 && row[i].x >= ras.min_ex )
+          gray_hline( RAS_VAR_ row[i].x, y, area, 1 );
+
+        x = row[i].x + 1;
+      }
+
+      if ( cover != 0 )
+        gray_hline( RAS_VAR_ x, y, cover, ras.max_ex - x );
+
+#ifdef GRAY_LCD_FILTER
+      if ( ras.lcd_weights )
+        gray_lcd_filter( RAS_VAR_ y );
+#endif
+    }
+
+    return 0;
+  }
+
+
+#ifdef STANDALONE_
+
+  /**************************************************************************
+   *
+   * The following functions should only compile in stand-alone mode,
+   * i.e., when building this component without the rest of FreeType.
+   *
+   */
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   FT_Outline_Decompose
+   *
+   * @Description:
+   *   Walk over an outline's structure to decompose it into individual
+   *   segments and Bézier arcs.  This function is also able to emit
+   *   `move to' and `close to' operations to indicate the start and end
+   *   of new contours in the outline.
+   *
+   * @Input:
+   *   outline ::
+   *     A pointer to the source target.
+   *
+   *   func_interface ::
+   *     A table of `emitters', i.e., function pointers
+   *     called during decomposition to indicate path
+   *     operations.
+   *
+   * @InOut:
+   *   user ::
+   *     A typeless pointer which is passed to each
+   *     emitter during the decomposition.  It can be
+   *     used to store the state during the
+   *     decomposition.
+   *
+   * @Return:
+   *   Error code.  0 means success.
+   */
+  static int
+  FT_Outline_Decompose( const FT_Outline*        outline,
+                        const FT_Outline_Funcs*  func_interface,
+                        void*                    user )
+  {
+#undef SCALED
+#define SCALED( x )  ( ( (x) << shift ) - delta )
+
+    FT_Vector   v_last;
+    FT_Vector   v_control;
+    FT_Vector   v_start;
+
+    FT_Vector*  point;
+    FT_Vector*  limit;
+    char*       tags;
+
+    int         error;
+
+    int   n;         /* index of contour in outline     */
+    int   first;     /* index of first point in contour */
+    char  tag;       /* current point's state           */
+
+    int   shift;
+    TPos  delta;
+
+
+    if ( !outline )
+      return FT_THROW( Invalid_Outline );
+
+    if ( !func_interface )
       return FT_THROW( Invalid_Argument );
 
     shift = func_interface->shift;
@@ -1734,20 +2451,83 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+#ifdef GRAY_HEAP_POOL
+
+  /**************************************************************************
+   *
+   * Replace the heap render pool `*apool' of `*asize' cells with one twice
+   * as large, but not larger than FT_MAX_GRAY_HEAP cells.  The pool
+   * belongs to the current rendering only, since the raster object is
+   * shared by all threads rendering with the same library.  Return 0 if
+   * the pool can't grow any further.
+   */
   static int
-  gray_convert_glyph( RAS_ARG )
+  gray_grow_pool( FT_Memory  memory,
+                  PCell*     apool,
+                  size_t*    asize )
+  {
+    FT_Error  error;
+    PCell     pool;
+    size_t    size = *asize;
+
+
+    if ( size >= FT_MAX_GRAY_HEAP )
+      return 0;
+
+    size = FT_MIN( 2 * size, FT_MAX_GRAY_HEAP );
+
+    /* the contents need not be preserved */
+    if ( FT_QALLOC( pool, size * sizeof ( TCell ) ) )
+      return 0;
+
+    FT_FREE( *apool );
+    *apool = pool;
+    *asize = size;
+
+    FT_TRACE7(( "gray_grow_pool: %d cells\n", (int)size ));
+
+    return 1;
+  }
+
+#endif /* GRAY_HEAP_POOL */
+
+
+  /**************************************************************************
+   *
+   * Render the glyph with the cell lists, in bands small enough for the
+   * render pool.  If the pool overflows, a larger pool is allocated on
+   * the heap for the rest of this rendering and the remaining bands are
+   * set up anew; if that isn't possible, the offending band is bisected.
+   */
+  static int
+  gray_convert_glyph( RAS_ARG_ gray_PRaster  raster )
   {
-    const TCoord  yMin = ras.min_ey;
     const TCoord  yMax = ras.max_ey;
 
     TCell    buffer[FT_MAX_GRAY_POOL];
-    size_t   height = (size_t)( yMax - yMin );
-    size_t   n = FT_MAX_GRAY_POOL / 8;
-    TCoord   y;
+    PCell    pool      = buffer;
+    size_t   pool_size = FT_MAX_GRAY_POOL;
+    size_t   height;
+    size_t   n;
+    TCoord   y = ras.min_ey;
     TCoord   bands[32];  /* enough to accommodate bisections */
     TCoord*  band;
+    int      result = 0;
+
+#ifdef GRAY_HEAP_POOL
+    FT_Memory  memory = (FT_Memory)raster->memory;
+    PCell      heap   = NULL;
+#else
+    FT_UNUSED( raster );
+#endif
 
 
+#ifdef GRAY_HEAP_POOL
+  Setup:
+#endif
+    height = (size_t)( yMax - y );
+    n      = pool_size / 8;
+
     /* set up vertical bands */
     if ( height > n )
     {
@@ -1759,11 +2539,11 @@ typedef ptrdiff_t  FT_PtrDist;
     /* memory management */
     n = ( height * sizeof ( PCell ) + sizeof ( TCell ) - 1 ) / sizeof ( TCell );
 
-    ras.cells     = buffer + n;
-    ras.max_cells = (FT_PtrDist)( FT_MAX_GRAY_POOL - n );
-    ras.ycells    = (PCell*)buffer;
+    ras.cells     = pool + n;
+    ras.max_cells = (FT_PtrDist)( pool_size - n );
+    ras.ycells    = (PCell*)pool;
 
-    for ( y = yMin; y < yMax; )
+    while ( y < yMax )
     {
       ras.min_ey = y;
       y         += height;
@@ -1795,7 +2575,21 @@ typedef ptrdiff_t  FT_PtrDist;
           continue;
         }
         else if ( error != ErrRaster_Memory_Overflow )
-          return 1;
+        {
+          result = 1;
+          goto Exit;
+        }
+
+#ifdef GRAY_HEAP_POOL
+        /* render pool overflow; try a larger pool for the rest */
+        /* of the glyph, starting with the current band         */
+        if ( gray_grow_pool( memory, &heap, &pool_size ) )
+        {
+          pool = heap;
+          y    = band[1];
+          goto Setup;
+        }
+#endif
 
         /* render pool overflow; we will reduce the render band by half */
         width >>= 1;
@@ -1804,7 +2598,8 @@ typedef ptrdiff_t  FT_PtrDist;
         if ( width == 0 )
         {
           FT_TRACE7(( "gray_convert_glyph: rotten glyph\n" ));
-          return 1;
+          result = 1;
+          goto Exit;
         }
 
         band++;
@@ -1813,99 +2608,954 @@ typedef ptrdiff_t  FT_PtrDist;
       } while ( band >= bands );
     }
 
-    return 0;
+  Exit:
+#ifdef GRAY_HEAP_POOL
+    FT_FREE( heap );
+#endif
+
+    return result;
   }
 
 
-  static int
-  gray_raster_render( FT_Raster                raster,
-                      const FT_Raster_Params*  params )
+#ifdef GRAY_PARALLEL
+
+  /**************************************************************************
+   *
+   * Concurrent rendering with the executor of the `band-executor'
+   * property.  The glyph is split into horizontal bands of about equal
+   * height, each rendered by `gray_convert_glyph' with a copy of the
+   * worker; the render pools are local to `gray_convert_glyph' anyway.
+   * The bands write disjoint rows of the target
+   * bitmap; as the cells of a row don't depend on the banding, the result
+   * is the same as with sequential rendering.
+   */
+
+  typedef struct  gray_TBand_
   {
-    const FT_Outline*  outline    = (const FT_Outline*)params->source;
-    const FT_Bitmap*   target_map = params->target;
-    FT_BBox            cbox, clip;
+    gray_TWorker  worker;
+    gray_PRaster  raster;
+    int           error;
 
-#ifndef FT_STATIC_RASTER
-    gray_TWorker  worker[1];
-#endif
+  } gray_TBand, *gray_PBand;
 
 
-    if ( !raster )
-      return FT_THROW( Invalid_Argument );
+  static void
+  gray_render_band( void*    band_data,
+                    FT_UInt  band_index )
+  {
+    gray_PBand  band = (gray_PBand)band_data + band_index;
 
-    /* this version does not support monochrome rendering */
-    if ( !( params->flags & FT_RASTER_FLAG_AA ) )
-      return FT_THROW( Invalid_Mode );
 
-    if ( !outline )
-      return FT_THROW( Invalid_Outline );
+    band->error = gray_convert_glyph( &band->worker, band->raster );
+  }
 
-    /* return immediately if the outline is empty */
-    if ( outline->n_points == 0 || outline->n_contours <= 0 )
-      return 0;
 
-    if ( !outline->contours || !outline->points )
-      return FT_THROW( Invalid_Outline );
+  /* return -1 if the glyph is to be rendered sequentially */
+  static int
+  gray_convert_glyph_parallel( RAS_ARG_ gray_PRaster  raster )
+  {
+    const FT_Prop_BandExecutor*  executor = &raster->executor;
+
+    FT_Memory   memory = (FT_Memory)raster->memory;
+    FT_Error    error;
+    gray_PBand  bands;
+    FT_UInt     height = (FT_UInt)( ras.max_ey - ras.min_ey );
+    FT_UInt     num_bands, n;
+    int         result = 0;
+
+
+    /* spans must be delivered in order, except to surfaces */
+    if ( !executor->execute                         ||
+         executor->max_bands < 2                    ||
+         height < executor->threshold               ||
+         height < 2                                 ||
+         ( ras.render_span && !ras.render_surface ) )
+      return -1;
+
+#ifdef GRAY_LCD_FILTER
+    /* so must rows to the vertical LCD filter */
+    if ( ras.lcd_weights && ras.lcd_vertical )
+      return -1;
+#endif
 
-    if ( outline->n_points !=
-           outline->contours[outline->n_contours - 1] + 1 )
-      return FT_THROW( Invalid_Outline );
+    num_bands = FT_MIN( executor->max_bands, height );
 
-    ras.outline = *outline;
+    if ( FT_QNEW_ARRAY( bands, num_bands ) )
+      return -1;
 
-    if ( params->flags & FT_RASTER_FLAG_DIRECT )
+    for ( n = 0; n < num_bands; n++ )
     {
-      if ( !params->gray_spans )
-        return 0;
+      gray_PBand  band = bands + n;
 
-      ras.render_span      = (FT_Raster_Span_Func)params->gray_spans;
-      ras.render_span_data = params->user;
-    }
-    else
-    {
-      /* if direct mode is not set, we must have a target bitmap */
-      if ( !target_map )
-        return FT_THROW( Invalid_Argument );
 
-      /* nothing to do */
-      if ( !target_map->width || !target_map->rows )
-        return 0;
+      /* `height' is at most 0xFFFF, so this can't overflow */
+      band->worker            = ras;
+      band->worker.min_ey     = ras.min_ey + (TCoord)( height * n /
+                                                         num_bands );
+      band->worker.max_ey     = ras.min_ey + (TCoord)( height * ( n + 1 ) /
+                                                         num_bands );
+      band->worker.accum_area = NULL;
 
-      if ( !target_map->buffer )
-        return FT_THROW( Invalid_Argument );
+      band->raster = raster;
+      band->error  = 0;
+    }
 
-      if ( target_map->pitch < 0 )
-        ras.target.origin = target_map->buffer;
-      else
-        ras.target.origin = target_map->buffer
-              + ( target_map->rows - 1 ) * (unsigned int)target_map->pitch;
+    FT_TRACE7(( "gray_convert_glyph_parallel: %d bands\n", num_bands ));
 
-      ras.target.pitch = target_map->pitch;
+    executor->execute( executor->data, gray_render_band, bands, num_bands );
 
-      ras.render_span      = (FT_Raster_Span_Func)NULL;
-      ras.render_span_data = NULL;
+    for ( n = 0; n < num_bands; n++ )
+    {
+      if ( bands[n].error )
+        result = bands[n].error;
     }
 
-    FT_Outline_Get_CBox( outline, &cbox );
+    FT_FREE( bands );
 
-    /* reject too large outline coordinates */
-    if ( cbox.xMin < -0x1000000L || cbox.xMax > 0x1000000L ||
-         cbox.yMin < -0x1000000L || cbox.yMax > 0x1000000L )
-      return FT_THROW( Invalid_Outline );
+    return result;
+  }
 
-    /* truncate the bounding box to integer pixels */
-    cbox.xMin = cbox.xMin >> 6;
-    cbox.yMin = cbox.yMin >> 6;
-    cbox.xMax = ( cbox.xMax + 63 ) >> 6;
-    cbox.yMax = ( cbox.yMax + 63 ) >> 6;
+#endif /* GRAY_PARALLEL */
 
-    /* reject too large glyphs */
-    if ( cbox.xMax - cbox.xMin > 0xFFFF ||
-         cbox.yMax - cbox.yMin > 0xFFFF )
+
+#ifndef STANDALONE_
+
+  /* the scalar version of `gray_Resolve_Func', for the SIMD loop tails */
+  static TArea
+  gray_resolve_scalar( const TArea*    area,
+                       const TCoord*   cover,
+                       unsigned char*  line,
+                       TCoord          count,
+                       TArea           acc,
+                       int             even_odd )
+  {
+    TCoord  i;
+
+
+    for ( i = 0; i < count; i++ )
+    {
+      TArea  c;
+
+
+      acc += (TArea)cover[i] * ( ONE_PIXEL * 2 );
+      c    = ( acc - area[i] ) >> ( PIXEL_BITS * 2 + 1 - 8 );
+      if ( c < 0 )
+        c = -c - 1;
+
+      if ( even_odd )
+      {
+        c &= 511;
+        if ( c >= 256 )
+          c = 511 - c;
+      }
+      else if ( c >= 256 )
+        c = 255;
+
+      line[i] = (unsigned char)c;
+    }
+
+    return acc;
+  }
+
+
+  /*
+   * The SIMD versions do the same in blocks of 16 pixels.  The running
+   * sum of covers is a prefix sum within a vector plus the carry of the
+   * previous vector.  Negative values are folded with `c ^ (c >> 31)',
+   * which equals `-c - 1'; the even-odd rule maps 256..511 to 255..0 by
+   * flipping the low nine bits if bit 8 is set.  Saturating packs clamp
+   * the non-zero winding values to 255.
+   */
+
+#ifdef GRAY_SSE2
+
+  static __m128i
+  gray_resolve_sse2_4( __m128i*        acc,
+                       const TArea*    area,
+                       const TCoord*   cover,
+                       int             even_odd )
+  {
+    __m128i  c = _mm_loadu_si128( (const __m128i*)cover );
+    __m128i  v;
+
+
+    c    = _mm_slli_epi32( c, PIXEL_BITS + 1 );
+    c    = _mm_add_epi32( c, _mm_slli_si128( c, 4 ) );
+    c    = _mm_add_epi32( c, _mm_slli_si128( c, 8 ) );
+    c    = _mm_add_epi32( c, *acc );
+    *acc = _mm_shuffle_epi32( c, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+    v = _mm_sub_epi32( c, _mm_loadu_si128( (const __m128i*)area ) );
+    v = _mm_srai_epi32( v, PIXEL_BITS * 2 + 1 - 8 );
+    v = _mm_xor_si128( v, _mm_srai_epi32( v, 31 ) );
+
+    if ( even_odd )
+    {
+      __m128i  m511 = _mm_set1_epi32( 511 );
+
+
+      v = _mm_and_si128( v, m511 );
+      v = _mm_xor_si128( v,
+                         _mm_and_si128( _mm_srai_epi32(
+                                          _mm_slli_epi32( v, 23 ), 31 ),
+                                        m511 ) );
+    }
+
+    return v;
+  }
+
+
+  static TArea
+  gray_resolve_sse2( const TArea*    area,
+                     const TCoord*   cover,
+                     unsigned char*  line,
+                     TCoord          count,
+                     TArea           acc,
+                     int             even_odd )
+  {
+    __m128i  vacc = _mm_set1_epi32( acc );
+
+
+    for ( ; count >= 16; count -= 16, area += 16, cover += 16, line += 16 )
+    {
+      __m128i  v0 = gray_resolve_sse2_4( &vacc, area,      cover,
+                                         even_odd );
+      __m128i  v1 = gray_resolve_sse2_4( &vacc, area + 4,  cover + 4,
+                                         even_odd );
+      __m128i  v2 = gray_resolve_sse2_4( &vacc, area + 8,  cover + 8,
+                                         even_odd );
+      __m128i  v3 = gray_resolve_sse2_4( &vacc, area + 12, cover + 12,
+                                         even_odd );
+
+
+      _mm_storeu_si128( (__m128i*)line,
+                        _mm_packus_epi16( _mm_packs_epi32( v0, v1 ),
+                                          _mm_packs_epi32( v2, v3 ) ) );
+    }
+
+    return gray_resolve_scalar( area, cover, line, count,
+                                _mm_cvtsi128_si32( vacc ), even_odd );
+  }
+
+#endif /* GRAY_SSE2 */
+
+
+#ifdef GRAY_AVX2
+
+  GRAY_TARGET_AVX2
+  static __m256i
+  gray_resolve_avx2_8( __m256i*        acc,
+                       const TArea*    area,
+                       const TCoord*   cover,
+                       int             even_odd )
+  {
+    __m256i  c = _mm256_loadu_si256( (const __m256i*)cover );
+    __m256i  v;
+
+
+    /* prefix sums within the two 128-bit lanes, ... */
+    c = _mm256_slli_epi32( c, PIXEL_BITS + 1 );
+    c = _mm256_add_epi32( c, _mm256_slli_si256( c, 4 ) );
+    c = _mm256_add_epi32( c, _mm256_slli_si256( c, 8 ) );
+
+    /* ... then add the last sum of the lower lane to the upper one */
+    c = _mm256_add_epi32(
+          c,
+          _mm256_blend_epi32( _mm256_setzero_si256(),
+                              _mm256_permutevar8x32_epi32(
+                                c, _mm256_set1_epi32( 3 ) ),
+                              0xF0 ) );
+
+    c    = _mm256_add_epi32( c, *acc );
+    *acc = _mm256_permutevar8x32_epi32( c, _mm256_set1_epi32( 7 ) );
+
+    v = _mm256_sub_epi32( c, _mm256_loadu_si256( (const __m256i*)area ) );
+    v = _mm256_srai_epi32( v, PIXEL_BITS * 2 + 1 - 8 );
+    v = _mm256_xor_si256( v, _mm256_srai_epi32( v, 31 ) );
+
+    if ( even_odd )
+    {
+      __m256i  m511 = _mm256_set1_epi32( 511 );
+
+
+      v = _mm256_and_si256( v, m511 );
+      v = _mm256_xor_si256( v,
+                            _mm256_and_si256( _mm256_srai_epi32(
+                                                _mm256_slli_epi32( v, 23 ),
+                                                31 ),
+                                              m511 ) );
+    }
+
+    return v;
+  }
+
+
+  GRAY_TARGET_AVX2
+  static TArea
+  gray_resolve_avx2( const TArea*    area,
+                     const TCoord*   cover,
+                     unsigned char*  line,
+                     TCoord          count,
+                     TArea           acc,
+                     int             even_odd )
+  {
+    __m256i  vacc = _mm256_set1_epi32( acc );
+
+
+    for ( ; count >= 16; count -= 16, area += 16, cover += 16, line += 16 )
+    {
+      __m256i  v0 = gray_resolve_avx2_8( &vacc, area,     cover,
+                                         even_odd );
+      __m256i  v1 = gray_resolve_avx2_8( &vacc, area + 8, cover + 8,
+                                         even_odd );
+      __m256i  p;
+
+
+      /* the packs work within lanes, giving pixels 0-3, 8-11, 4-7, */
+      /* and 12-15; reorder the 64-bit quarters                      */
+      p = _mm256_permute4x64_epi64( _mm256_packs_epi32( v0, v1 ),
+                                    _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+      _mm_storeu_si128( (__m128i*)line,
+                        _mm_packus_epi16(
+                          _mm256_castsi256_si128( p ),
+                          _mm256_extracti128_si256( p, 1 ) ) );
+    }
+
+    return gray_resolve_scalar( area, cover, line, count,
+                                _mm256_cvtsi256_si32( vacc ), even_odd );
+  }
+
+#endif /* GRAY_AVX2 */
+
+
+#ifdef GRAY_NEON
+
+  static int32x4_t
+  gray_resolve_neon_4( int32x4_t*      acc,
+                       const TArea*    area,
+                       const TCoord*   cover,
+                       int             even_odd )
+  {
+    int32x4_t  zero = vdupq_n_s32( 0 );
+    int32x4_t  c    = vld1q_s32( (const int32_t*)cover );
+    int32x4_t  v;
+
+
+    c    = vshlq_n_s32( c, PIXEL_BITS + 1 );
+    c    = vaddq_s32( c, vextq_s32( zero, c, 3 ) );
+    c    = vaddq_s32( c, vextq_s32( zero, c, 2 ) );
+    c    = vaddq_s32( c, *acc );
+    *acc = vdupq_n_s32( vgetq_lane_s32( c, 3 ) );
+
+    v = vsubq_s32( c, vld1q_s32( (const int32_t*)area ) );
+    v = vshrq_n_s32( v, PIXEL_BITS * 2 + 1 - 8 );
+    v = veorq_s32( v, vshrq_n_s32( v, 31 ) );
+
+    if ( even_odd )
+    {
+      int32x4_t  m511 = vdupq_n_s32( 511 );
+
+
+      v = vandq_s32( v, m511 );
+      v = veorq_s32( v,
+                     vandq_s32( vshrq_n_s32( vshlq_n_s32( v, 23 ), 31 ),
+                                m511 ) );
+    }
+
+    return v;
+  }
+
+
+  static TArea
+  gray_resolve_neon( const TArea*    area,
+                     const TCoord*   cover,
+                     unsigned char*  line,
+                     TCoord          count,
+                     TArea           acc,
+                     int             even_odd )
+  {
+    int32x4_t  vacc = vdupq_n_s32( acc );
+
+
+    for ( ; count >= 16; count -= 16, area += 16, cover += 16, line += 16 )
+    {
+      int32x4_t  v0 = gray_resolve_neon_4( &vacc, area,      cover,
+                                           even_odd );
+      int32x4_t  v1 = gray_resolve_neon_4( &vacc, area + 4,  cover + 4,
+                                           even_odd );
+      int32x4_t  v2 = gray_resolve_neon_4( &vacc, area + 8,  cover + 8,
+                                           even_odd );
+      int32x4_t  v3 = gray_resolve_neon_4( &vacc, area + 12, cover + 12,
+                                           even_odd );
+
+
+      vst1q_u8( line,
+                vcombine_u8(
+                  vqmovn_u16( vcombine_u16( vqmovun_s32( v0 ),
+                                            vqmovun_s32( v1 ) ) ),
+                  vqmovn_u16( vcombine_u16( vqmovun_s32( v2 ),
+                                            vqmovun_s32( v3 ) ) ) ) );
+    }
+
+    return gray_resolve_scalar( area, cover, line, count,
+                                vgetq_lane_s32( vacc, 0 ), even_odd );
+  }
+
+#endif /* GRAY_NEON */
+
+
+  /* select the fastest SIMD sweep for the CPU, if any */
+  static gray_Resolve_Func
+  gray_resolve_select( void )
+  {
+#ifndef FT_CONFIG_OPTION_NO_SIMD
+    FT_UInt32  features = ft_cpu_features();
+#endif
+
+
+#ifdef GRAY_AVX2
+    if ( features & FT_CPU_AVX2 )
+      return gray_resolve_avx2;
+#endif
+#ifdef GRAY_SSE2
+    if ( features & FT_CPU_SSE2 )
+      return gray_resolve_sse2;
+#endif
+#ifdef GRAY_NEON
+    if ( features & FT_CPU_NEON )
+      return gray_resolve_neon;
+#endif
+
+    return NULL;
+  }
+
+
+  /**************************************************************************
+   *
+   * Sweep the accumulation buffer.  The bit mask lists the touched cells
+   * of a scanline in order, just like a cell list; a running sum of
+   * their covers gives the winding of the pixels in between.  The buffer
+   * is cleared on the way for the next band.
+   */
+  static void
+  gray_sweep_accum( RAS_ARG )
+  {
+    TCoord  y;
+
+
+    for ( y = ras.min_ey; y < ras.max_ey; y++ )
+    {
+      FT_PtrDist  row   = y - ras.min_ey;
+      TArea*      area  = ras.accum_area  + row * ras.accum_pitch;
+      TCoord*     cover = ras.accum_cover + row * ras.accum_pitch;
+      TMask*      mask  = ras.accum_mask  + row * ras.accum_words;
+      TArea       acc   = 0;
+      TCoord      x     = 1;   /* next cell to be drawn */
+      TCoord      w;
+
+
+      for ( w = 0; w < ras.accum_words; w++ )
+      {
+        TMask   m = mask[w];
+        TMask   t;
+        TCoord  i = w * MASK_BITS;
+
+        unsigned char*  line;
+
+
+        if ( !m )
+          continue;
+
+        mask[w] = 0;
+
+        /* resolve words with at least four touched cells in one go */
+        t  = m & ( m - 1 );
+        t &= t - 1;
+        t &= t - 1;
+
+        if ( t && ras.resolve && !ras.render_span )
+        {
+          TCoord  end = FT_MIN( i + MASK_BITS, ras.accum_pitch );
+
+
+          if ( i == 0 )
+          {
+            acc     += (TArea)cover[0] * ( ONE_PIXEL * 2 );
+            cover[0] = 0;
+            area[0]  = 0;
+            i        = 1;
+          }
+
+          if ( acc != 0 && i > x )
+            gray_hline( RAS_VAR_ ras.min_ex + x - 1, y, acc, i - x );
+
+          line = ras.target.origin - ras.target.pitch * y +
+                   ras.min_ex + i - 1;
+
+          acc = ras.resolve( area + i, cover + i, line, end - i, acc,
+                             ras.outline.flags & FT_OUTLINE_EVEN_ODD_FILL );
+
+          if ( ras.coverage_table )
+            gray_map_coverage( ras.coverage_table, line, end - i );
+
+          FT_MEM_ZERO( area + i, ( end - i ) * sizeof ( TArea ) );
+          FT_MEM_ZERO( cover + i, ( end - i ) * sizeof ( TCoord ) );
+          x = end;
+          continue;
+        }
+
+        for ( ; m; m >>= 1, i++ )
+        {
+          TArea  value;
+
+
+          if ( !( m & 1 ) )
+            continue;
+
+          if ( acc != 0 && i > x )
+            gray_hline( RAS_VAR_ ras.min_ex + x - 1, y, acc, i - x );
+
+          acc  += (TArea)cover[i] * ( ONE_PIXEL * 2 );
+          value = acc - area[i];
+
+          /* cell 0 collects the cells left of the clip box */
+          if ( value != 0 && i > 0 )
+            gray_hline( RAS_VAR_ ras.min_ex + i - 1, y, value, 1 );
+
+          cover[i] = 0;
+          area[i]  = 0;
+          x        = i + 1;
+        }
+      }
+
+      if ( acc != 0 )
+        gray_hline( RAS_VAR_ ras.min_ex + x - 1, y, acc,
+                    ras.accum_pitch - x );
+
+#ifdef GRAY_LCD_FILTER
+      if ( ras.lcd_weights )
+        gray_lcd_filter( RAS_VAR_ y );
+#endif
+    }
+  }
+
+
+  /**************************************************************************
+   *
+   * Render the glyph with the accumulation backend: instead of sorting
+   * the cells into lists, they are added to a dense buffer covering the
+   * whole clip box width.  This makes recording a cell a constant-time
+   * operation independent of the number of cells already on the
+   * scanline; a bit mask of the touched cells keeps the sweep from
+   * visiting the empty ones.  Tall glyphs are rendered in bands that fit
+   * into FT_MAX_GRAY_ACCUM bytes.  The buffer is allocated for this
+   * rendering only, as the raster object is shared between threads.
+   *
+   * The dense buffer only pays off while it stays in the cache and the
+   * outline needn't be decomposed again for many bands, that is, for
+   * small glyphs; `ft_smooth_render' selects this backend accordingly.
+   *
+   * Return -1 if the buffer can't be allocated; the caller then falls
+   * back to the cell lists.  In stand-alone mode, which has no memory
+   * allocator, the cell lists are always used.
+   */
+  static int
+  gray_convert_glyph_accum( RAS_ARG_ gray_PRaster  raster )
+  {
+    const TCoord  yMin = ras.min_ey;
+    const TCoord  yMax = ras.max_ey;
+
+    FT_Memory      memory   = (FT_Memory)raster->memory;
+    TCoord         pitch    = ras.max_ex - ras.min_ex + 1;
+    TCoord         words    = ( pitch + MASK_BITS - 1 ) / MASK_BITS;
+    unsigned long  row_size = (unsigned long)pitch *
+                                ( sizeof ( TArea ) + sizeof ( TCoord ) ) +
+                              (unsigned long)words * sizeof ( TMask );
+    unsigned long  height   = (unsigned long)( yMax - yMin );
+    unsigned long  rows;
+    TCoord         y;
+    void*          accum;
+    FT_Error       error;
+    int            result   = 0;
+
+
+    rows = FT_MAX_GRAY_ACCUM / row_size;
+    if ( rows > height )
+      rows = height;
+    if ( rows == 0 )
+      rows = 1;
+
+    /* the sweep keeps the buffer zeroed between bands */
+    if ( FT_ALLOC( accum, rows * row_size ) )
+      return -1;
+
+    ras.accum_pitch = pitch;
+    ras.accum_words = words;
+    ras.resolve     = raster->resolve;
+    ras.accum_area  = (TArea*)accum;
+    ras.accum_cover = (TCoord*)( ras.accum_area + rows * (FT_ULong)pitch );
+    ras.accum_mask  = (TMask*)( ras.accum_cover + rows * (FT_ULong)pitch );
+
+    for ( y = yMin; y < yMax; y += (TCoord)rows )
+    {
+      ras.min_ey  = y;
+      ras.max_ey  = FT_MIN( y + (TCoord)rows, yMax );
+      ras.invalid = 1;
+
+      if ( gray_convert_glyph_inner( RAS_VAR ) )
+      {
+        result = 1;
+        break;
+      }
+
+      gray_sweep_accum( RAS_VAR );
+    }
+
+    ras.accum_area = NULL;
+    FT_FREE( accum );
+
+    return result;
+  }
+
+#endif /* !STANDALONE_ */
+
+
+  /**************************************************************************
+   *
+   * Span functions for FT_RASTER_FLAG_SURFACE.  Outline row `y' is
+   * surface row `y_offset - 1 - y'.  With `mul(a,b)' being `a*b/255',
+   * exactly rounded, the formats are composited as
+   *
+   *   A8:    dst = c + mul(dst, 255 - c)
+   *   BGRA:  src = mul(color, c);  dst = src + mul(dst, 255 - src.alpha)
+   *   R8:    dst = c
+   *
+   * Both blends are the same per byte: the destination is scaled by a
+   * common factor and a pattern that repeats every four bytes is added
+   * with saturation.
+   */
+
+#define GRAY_MUL255( a, b )                                     \
+          ( ( (a) * (b) + 128 + ( ( (a) * (b) + 128 ) >> 8 ) ) >> 8 )
+
+
+#ifdef GRAY_SSE2
+
+  static __m128i
+  gray_mul255_sse2( __m128i  a,
+                    __m128i  b )
+  {
+    __m128i  t = _mm_add_epi16( _mm_mullo_epi16( a, b ),
+                                _mm_set1_epi16( 128 ) );
+
+
+    return _mm_srli_epi16( _mm_add_epi16( t, _mm_srli_epi16( t, 8 ) ), 8 );
+  }
+
+#endif /* GRAY_SSE2 */
+
+
+  /* `pattern' holds 16 bytes; `count' is a multiple of its period */
+  static void
+  gray_blend_over( unsigned char*        q,
+                   FT_PtrDist            count,
+                   unsigned int          factor,
+                   const unsigned char*  pattern )
+  {
+    FT_PtrDist  i = 0;
+
+
+    if ( factor == 0 )
+    {
+#ifdef GRAY_SSE2
+      __m128i  p = _mm_loadu_si128( (const __m128i*)pattern );
+
+
+      for ( ; i + 16 <= count; i += 16 )
+        _mm_storeu_si128( (__m128i*)( q + i ), p );
+#elif defined( GRAY_NEON )
+      uint8x16_t  p = vld1q_u8( pattern );
+
+
+      for ( ; i + 16 <= count; i += 16 )
+        vst1q_u8( q + i, p );
+#endif
+
+      for ( ; i < count; i++ )
+        q[i] = pattern[i & 15];
+
+      return;
+    }
+
+#ifdef GRAY_SSE2
+    if ( count >= 16 )
+    {
+      __m128i  zero = _mm_setzero_si128();
+      __m128i  f    = _mm_set1_epi16( (short)factor );
+      __m128i  p    = _mm_loadu_si128( (const __m128i*)pattern );
+
+
+      for ( ; i + 16 <= count; i += 16 )
+      {
+        __m128i  d  = _mm_loadu_si128( (const __m128i*)( q + i ) );
+        __m128i  lo = gray_mul255_sse2( _mm_unpacklo_epi8( d, zero ), f );
+        __m128i  hi = gray_mul255_sse2( _mm_unpackhi_epi8( d, zero ), f );
+
+
+        d = _mm_adds_epu8( _mm_packus_epi16( lo, hi ), p );
+        _mm_storeu_si128( (__m128i*)( q + i ), d );
+      }
+    }
+#elif defined( GRAY_NEON )
+    if ( count >= 16 )
+    {
+      uint8x8_t   f = vdup_n_u8( (uint8_t)factor );
+      uint8x16_t  p = vld1q_u8( pattern );
+
+
+      /* `vraddhn(t, t >> 8)' with rounding shift is `mul(a,b)' */
+      for ( ; i + 16 <= count; i += 16 )
+      {
+        uint8x16_t  d  = vld1q_u8( q + i );
+        uint16x8_t  lo = vmull_u8( vget_low_u8( d ), f );
+        uint16x8_t  hi = vmull_u8( vget_high_u8( d ), f );
+
+
+        d = vcombine_u8( vraddhn_u16( lo, vrshrq_n_u16( lo, 8 ) ),
+                         vraddhn_u16( hi, vrshrq_n_u16( hi, 8 ) ) );
+        vst1q_u8( q + i, vqaddq_u8( d, p ) );
+      }
+    }
+#endif
+
+    for ( ; i < count; i++ )
+    {
+      unsigned int  v = pattern[i & 15] + GRAY_MUL255( q[i], factor );
+
+
+      q[i] = (unsigned char)( v > 255 ? 255 : v );
+    }
+  }
+
+
+  static void
+  gray_surface_span_a8( int             y,
+                        int             count,
+                        const FT_Span*  spans,
+                        void*           user )
+  {
+    const FT_Raster_Surface*  surface = (const FT_Raster_Surface*)user;
+    unsigned char*            row     = surface->buffer +
+                                          ( surface->y_offset - 1 - y ) *
+                                            (FT_PtrDist)surface->pitch +
+                                          surface->x_offset;
+    unsigned char             pattern[16];
+
+
+    for ( ; count > 0; count--, spans++ )
+    {
+      if ( spans->coverage == 255 )
+        FT_MEM_SET( row + spans->x, 255, spans->len );
+      else
+      {
+        FT_MEM_SET( pattern, spans->coverage, 16 );
+        gray_blend_over( row + spans->x, spans->len,
+                         255U - spans->coverage, pattern );
+      }
+    }
+  }
+
+
+  static void
+  gray_surface_span_r8( int             y,
+                        int             count,
+                        const FT_Span*  spans,
+                        void*           user )
+  {
+    const FT_Raster_Surface*  surface = (const FT_Raster_Surface*)user;
+    unsigned char*            row     = surface->buffer +
+                                          ( surface->y_offset - 1 - y ) *
+                                            (FT_PtrDist)surface->pitch +
+                                          surface->x_offset;
+
+
+    for ( ; count > 0; count--, spans++ )
+      FT_MEM_SET( row + spans->x, spans->coverage, spans->len );
+  }
+
+
+  static void
+  gray_surface_span_bgra( int             y,
+                          int             count,
+                          const FT_Span*  spans,
+                          void*           user )
+  {
+    const FT_Raster_Surface*  surface = (const FT_Raster_Surface*)user;
+    unsigned char*            row     = surface->buffer +
+                                          ( surface->y_offset - 1 - y ) *
+                                            (FT_PtrDist)surface->pitch +
+                                          surface->x_offset * 4;
+    unsigned char             pattern[16];
+    int                       i;
+
+
+    for ( ; count > 0; count--, spans++ )
+    {
+      unsigned int  c = spans->coverage;
+
+
+      for ( i = 0; i < 4; i++ )
+        pattern[i] = (unsigned char)GRAY_MUL255( surface->color[i], c );
+      for ( ; i < 16; i++ )
+        pattern[i] = pattern[i - 4];
+
+      gray_blend_over( row + spans->x * 4, spans->len * 4,
+                       255U - pattern[3], pattern );
+    }
+  }
+
+
+  static int
+  gray_raster_render( FT_Raster                raster,
+                      const FT_Raster_Params*  params )
+  {
+    const FT_Outline*  outline    = (const FT_Outline*)params->source;
+    const FT_Bitmap*   target_map = params->target;
+    FT_BBox            cbox, clip;
+    int                error;
+
+    const FT_Raster_Surface*  surface = NULL;
+
+#ifndef FT_STATIC_RASTER
+    gray_TWorker  worker[1];
+#endif
+
+
+    if ( !raster )
+      return FT_THROW( Invalid_Argument );
+
+    /* this version does not support monochrome rendering */
+    if ( !( params->flags & FT_RASTER_FLAG_AA ) )
+      return FT_THROW( Invalid_Mode );
+
+    if ( !outline )
+      return FT_THROW( Invalid_Outline );
+
+    /* return immediately if the outline is empty */
+    if ( outline->n_points == 0 || outline->n_contours <= 0 )
+      return 0;
+
+    if ( !outline->contours || !outline->points )
+      return FT_THROW( Invalid_Outline );
+
+    if ( outline->n_points !=
+           outline->contours[outline->n_contours - 1] + 1 )
+      return FT_THROW( Invalid_Outline );
+
+    ras.outline        = *outline;
+    ras.render_surface = 0;
+
+    if ( params->flags & FT_GRAY_FLAG_LINEAR )
+      ras.coverage_table = NULL;
+    else
+      ras.coverage_table = ( (gray_PRaster)raster )->coverage_table;
+
+    if ( params->flags & FT_RASTER_FLAG_SURFACE )
+    {
+      surface = (const FT_Raster_Surface*)params->user;
+
+      if ( !surface )
+        return FT_THROW( Invalid_Argument );
+
+      /* nothing to do */
+      if ( !surface->width || !surface->rows )
+        return 0;
+
+      if ( !surface->buffer )
+        return FT_THROW( Invalid_Argument );
+
+      switch ( surface->format )
+      {
+      case FT_SURFACE_FORMAT_A8:
+        ras.render_span = gray_surface_span_a8;
+        break;
+      case FT_SURFACE_FORMAT_R8:
+        ras.render_span = gray_surface_span_r8;
+        break;
+      case FT_SURFACE_FORMAT_BGRA:
+        ras.render_span = gray_surface_span_bgra;
+        break;
+      default:
+        return FT_THROW( Invalid_Argument );
+      }
+
+      ras.render_span_data = params->user;
+      ras.render_surface   = 1;
+    }
+    else if ( params->flags & FT_RASTER_FLAG_DIRECT )
+    {
+      if ( !params->gray_spans )
+        return 0;
+
+      ras.render_span      = (FT_Raster_Span_Func)params->gray_spans;
+      ras.render_span_data = params->user;
+    }
+    else
+    {
+      /* if direct mode is not set, we must have a target bitmap */
+      if ( !target_map )
+        return FT_THROW( Invalid_Argument );
+
+      /* nothing to do */
+      if ( !target_map->width || !target_map->rows )
+        return 0;
+
+      if ( !target_map->buffer )
+        return FT_THROW( Invalid_Argument );
+
+      if ( target_map->pitch < 0 )
+        ras.target.origin = target_map->buffer;
+      else
+        ras.target.origin = target_map->buffer
+              + ( target_map->rows - 1 ) * (unsigned int)target_map->pitch;
+
+      ras.target.pitch = target_map->pitch;
+
+      ras.render_span      = (FT_Raster_Span_Func)NULL;
+      ras.render_span_data = NULL;
+    }
+
+    FT_Outline_Get_CBox( outline, &cbox );
+
+    /* reject too large outline coordinates */
+    if ( cbox.xMin < -0x1000000L || cbox.xMax > 0x1000000L ||
+         cbox.yMin < -0x1000000L || cbox.yMax > 0x1000000L )
+      return FT_THROW( Invalid_Outline );
+
+    /* truncate the bounding box to integer pixels */
+    cbox.xMin = cbox.xMin >> 6;
+    cbox.yMin = cbox.yMin >> 6;
+    cbox.xMax = ( cbox.xMax + 63 ) >> 6;
+    cbox.yMax = ( cbox.yMax + 63 ) >> 6;
+
+    /* reject too large glyphs */
+    if ( cbox.xMax - cbox.xMin > 0xFFFF ||
+         cbox.yMax - cbox.yMin > 0xFFFF )
       return FT_THROW( Invalid_Outline );
 
     /* compute clipping box */
-    if ( !( params->flags & FT_RASTER_FLAG_DIRECT ) )
+    if ( surface )
+    {
+      /* move the surface's clip box to outline coordinates */
+      clip.xMin = FT_MAX( surface->clip_box.xMin, 0 ) - surface->x_offset;
+      clip.xMax = FT_MIN( surface->clip_box.xMax, (FT_Pos)surface->width ) -
+                    surface->x_offset;
+      clip.yMin = surface->y_offset -
+                    FT_MIN( surface->clip_box.yMax, (FT_Pos)surface->rows );
+      clip.yMax = surface->y_offset - FT_MAX( surface->clip_box.yMin, 0 );
+    }
+    else if ( !( params->flags & FT_RASTER_FLAG_DIRECT ) )
     {
       /* compute clip box from target pixmap */
       clip.xMin = 0;
@@ -1932,7 +3582,55 @@ typedef ptrdiff_t  FT_PtrDist;
     if ( ras.max_ex <= ras.min_ex || ras.max_ey <= ras.min_ey )
       return 0;
 
-    return gray_convert_glyph( RAS_VAR );
+#ifdef GRAY_LCD_FILTER
+    ras.lcd_weights = NULL;
+    ras.lcd_save    = NULL;
+
+    if ( ( params->flags & FT_GRAY_FLAG_LCD_FILTER )  &&
+         !( params->flags & ( FT_RASTER_FLAG_DIRECT |
+                              FT_RASTER_FLAG_SURFACE )  ) )
+    {
+      error = gray_lcd_filter_init( RAS_VAR_ (gray_PRaster)raster,
+                                    (const gray_TLcdParams*)params );
+      if ( error )
+        return error;
+    }
+#endif
+
+    error = gray_convert_glyph_rect( RAS_VAR );
+
+#ifdef GRAY_PARALLEL
+    if ( error < 0 )
+      error = gray_convert_glyph_parallel( RAS_VAR_ (gray_PRaster)raster );
+#endif
+
+#ifndef STANDALONE_
+    if ( error < 0 && ( params->flags & FT_RASTER_FLAG_ACCUMULATE ) )
+      error = gray_convert_glyph_accum( RAS_VAR_ (gray_PRaster)raster );
+#endif
+
+    if ( error < 0 )
+    {
+      ras.accum_area = NULL;
+
+      error = gray_convert_glyph( RAS_VAR_ (gray_PRaster)raster );
+    }
+
+#ifdef GRAY_LCD_FILTER
+    /* filter the remaining rows */
+    if ( !error && ras.lcd_weights && ras.lcd_vertical )
+      gray_lcd_filter_v( RAS_VAR_ ras.lcd_end );
+
+    if ( ras.lcd_save )
+    {
+      FT_Memory  memory = (FT_Memory)((gray_PRaster)raster)->memory;
+
+
+      FT_FREE( ras.lcd_save );
+    }
+#endif
+
+    return error;
   }
 
 
@@ -1977,8 +3675,9 @@ typedef ptrdiff_t  FT_PtrDist;
     *araster = 0;
     if ( !FT_ALLOC( raster, sizeof ( gray_TRaster ) ) )
     {
-      raster->memory = memory;
-      *araster       = (FT_Raster)raster;
+      raster->memory  = memory;
+      raster->resolve = gray_resolve_select();
+      *araster        = (FT_Raster)raster;
     }
 
     return error;
@@ -2013,12 +3712,33 @@ typedef ptrdiff_t  FT_PtrDist;
                         unsigned long  mode,
                         void*          args )
   {
-    FT_UNUSED( raster );
-    FT_UNUSED( mode );
-    FT_UNUSED( args );
+    gray_PRaster  rast = (gray_PRaster)raster;
+
+
+    if ( mode == FT_GRAY_MODE_COVERAGE_TABLE )
+    {
+      const unsigned char*  table = (const unsigned char*)args;
 
 
-    return 0; /* nothing to do */
+      if ( table && table[0] )
+        return FT_THROW( Invalid_Argument );
+
+      rast->coverage_table = table;
+    }
+
+#ifdef GRAY_PARALLEL
+
+    if ( mode == FT_GRAY_MODE_BAND_EXECUTOR )
+    {
+      if ( args )
+        rast->executor = *(const FT_Prop_BandExecutor*)args;
+      else
+        FT_ZERO( &rast->executor );
+    }
+
+#endif
+
+    return 0;
   }
 
 
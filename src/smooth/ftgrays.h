@@ -47,6 +47,53 @@
   FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_grays_raster;
 
 
+  /**************************************************************************
+   *
+   * The smooth renderer can ask the rasterizer to apply the five-tap FIR
+   * filter of `ft_lcd_filter_fir' to an FT_PIXEL_MODE_LCD or
+   * FT_PIXEL_MODE_LCD_V target bitmap while sweeping, instead of in a
+   * separate pass over the finished bitmap.  To do so, it passes a
+   * `gray_TLcdParams' structure with FT_GRAY_FLAG_LCD_FILTER set in the
+   * flags of its root.  The flag is ignored in direct mode.
+   */
+#define FT_GRAY_FLAG_LCD_FILTER  0x10000L
+
+  typedef struct  gray_TLcdParams_
+  {
+    FT_Raster_Params      root;
+    const unsigned char*  weights;  /* the five filter weights */
+
+  } gray_TLcdParams;
+
+
+  /**************************************************************************
+   *
+   * The smooth renderer passes the value of its `band-executor' property,
+   * an `FT_Prop_BandExecutor' structure, to the rasterizer by calling
+   * `raster_set_mode' with this tag.  A NULL argument removes the
+   * executor.  The stand-alone rasterizer ignores it.
+   */
+#define FT_GRAY_MODE_BAND_EXECUTOR  0x62616E64UL  /* `band' */
+
+
+  /**************************************************************************
+   *
+   * The value of the `coverage-table' property, 256 bytes mapping each
+   * coverage value to the one to be output, is passed with this tag.  The
+   * rasterizer only keeps a pointer to the table; a NULL argument removes
+   * it.  The table must map 0 to 0, since pixels not touched by the
+   * outline are never written.
+   *
+   * With an LCD filter, the table is applied to the filtered values.  If
+   * the smooth renderer filters the bitmap itself, it sets
+   * FT_GRAY_FLAG_LINEAR in the flags of the raster parameters to get
+   * unmapped coverage values and applies the table afterwards.
+   */
+#define FT_GRAY_MODE_COVERAGE_TABLE  0x636F7672UL  /* `covr' */
+
+#define FT_GRAY_FLAG_LINEAR  0x20000L
+
+
 #ifdef __cplusplus
   }
 #endif
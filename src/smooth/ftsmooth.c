@@ -20,6 +20,8 @@
 #include FT_INTERNAL_DEBUG_H
 #include FT_INTERNAL_OBJECTS_H
 #include FT_OUTLINE_H
+#include FT_SERVICE_PROPERTIES_H
+#include FT_DRIVER_H
 #include "ftsmooth.h"
 #include "ftgrays.h"
 
@@ -30,6 +32,9 @@
   static FT_Error
   ft_smooth_init( FT_Renderer  render )
   {
+    FT_Smooth_Renderer  smooth = (FT_Smooth_Renderer)render;
+    FT_UInt             i;
+
 
 #ifndef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
 
@@ -46,6 +51,13 @@
 
 #endif
 
+    smooth->accumulation_threshold = FT_SMOOTH_ACCUMULATION_THRESHOLD;
+    FT_ZERO( &smooth->band_executor );
+
+    for ( i = 0; i < 256; i++ )
+      smooth->coverage_table[i] = (FT_Byte)i;
+    smooth->use_coverage_table = FALSE;
+
     render->clazz->raster_class->raster_reset( render->raster, NULL, 0 );
 
     return 0;
@@ -120,9 +132,15 @@
     FT_Pos       y_shift = 0;
     FT_Int       hmul    = ( mode == FT_RENDER_MODE_LCD );
     FT_Int       vmul    = ( mode == FT_RENDER_MODE_LCD_V );
+    FT_UInt      threshold;
 
     FT_Raster_Params  params;
 
+#ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
+    FT_Byte*                 lcd_weights     = NULL;
+    FT_Bitmap_LcdFilterFunc  lcd_filter_func = NULL;
+#endif
+
 
     /* check glyph image format */
     if ( slot->format != render->glyph_format )
@@ -175,8 +193,27 @@
     params.source = outline;
     params.flags  = FT_RASTER_FLAG_AA;
 
+    threshold = ( (FT_Smooth_Renderer)render )->accumulation_threshold;
+    if ( threshold && bitmap->rows <= threshold )
+      params.flags |= FT_RASTER_FLAG_ACCUMULATE;
+
 #ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
 
+    if ( hmul || vmul )
+    {
+      /* Per-face LCD filtering takes priority if set up. */
+      if ( slot->face && slot->face->internal->lcd_filter_func )
+      {
+        lcd_weights     = slot->face->internal->lcd_weights;
+        lcd_filter_func = slot->face->internal->lcd_filter_func;
+      }
+      else
+      {
+        lcd_weights     = slot->library->lcd_weights;
+        lcd_filter_func = slot->library->lcd_filter_func;
+      }
+    }
+
     /* implode outline if needed */
     {
       FT_Vector*  points     = outline->points;
@@ -193,8 +230,29 @@
           vec->y *= 3;
     }
 
-    /* render outline into the bitmap */
-    error = render->raster_render( render->raster, &params );
+    /* render outline into the bitmap; the rasterizer */
+    /* can apply the default and light filters itself */
+    if ( lcd_filter_func == ft_lcd_filter_fir )
+    {
+      gray_TLcdParams  lcd_params;
+
+
+      lcd_params.root        = params;
+      lcd_params.root.flags |= FT_GRAY_FLAG_LCD_FILTER;
+      lcd_params.weights     = lcd_weights;
+
+      error = render->raster_render( render->raster, &lcd_params.root );
+
+      lcd_filter_func = NULL;
+    }
+    else
+    {
+      /* the coverage table must come after the filter */
+      if ( lcd_filter_func )
+        params.flags |= FT_GRAY_FLAG_LINEAR;
+
+      error = render->raster_render( render->raster, &params );
+    }
 
     /* deflate outline if needed */
     {
@@ -216,26 +274,23 @@
       goto Exit;
 
     /* finally apply filtering */
-    if ( hmul || vmul )
+    if ( lcd_filter_func )
     {
-      FT_Byte*                 lcd_weights;
-      FT_Bitmap_LcdFilterFunc  lcd_filter_func;
+      FT_Smooth_Renderer  smooth = (FT_Smooth_Renderer)render;
 
 
-      /* Per-face LCD filtering takes priority if set up. */
-      if ( slot->face && slot->face->internal->lcd_filter_func )
-      {
-        lcd_weights     = slot->face->internal->lcd_weights;
-        lcd_filter_func = slot->face->internal->lcd_filter_func;
-      }
-      else
+      lcd_filter_func( bitmap, mode, lcd_weights );
+
+      if ( smooth->use_coverage_table )
       {
-        lcd_weights     = slot->library->lcd_weights;
-        lcd_filter_func = slot->library->lcd_filter_func;
-      }
+        FT_Byte*  line = bitmap->buffer;
+        FT_UInt   i, j;
 
-      if ( lcd_filter_func )
-        lcd_filter_func( bitmap, mode, lcd_weights );
+
+        for ( i = 0; i < bitmap->rows; i++, line += bitmap->pitch )
+          for ( j = 0; j < bitmap->width; j++ )
+            line[j] = smooth->coverage_table[line[j]];
+      }
     }
 
 #else /* !FT_CONFIG_OPTION_SUBPIXEL_RENDERING */
@@ -399,11 +454,170 @@
   }
 
 
+  static FT_Error
+  ft_smooth_property_set( FT_Module    module,   /* FT_Smooth_Renderer */
+                          const char*  property_name,
+                          const void*  value,
+                          FT_Bool      value_is_string )
+  {
+    FT_Smooth_Renderer  smooth = (FT_Smooth_Renderer)module;
+
+#ifndef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+    FT_UNUSED( value_is_string );
+#endif
+
+
+    if ( !ft_strcmp( property_name, "accumulation-threshold" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+        long         t = ft_strtol( s, NULL, 10 );
+
+
+        if ( t < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        smooth->accumulation_threshold = (FT_UInt)t;
+      }
+      else
+#endif
+      {
+        FT_UInt*  t = (FT_UInt*)value;
+
+
+        smooth->accumulation_threshold = *t;
+      }
+
+      return FT_Err_Ok;
+    }
+    else if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+      FT_Renderer  render = &smooth->root;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      /* a function pointer can't be given as a string */
+      if ( value_is_string )
+        return FT_THROW( Invalid_Argument );
+#endif
+
+      smooth->band_executor = *(const FT_Prop_BandExecutor*)value;
+
+      return render->clazz->raster_class->raster_set_mode(
+                                            render->raster,
+                                            FT_GRAY_MODE_BAND_EXECUTOR,
+                                            &smooth->band_executor );
+    }
+    else if ( !ft_strcmp( property_name, "coverage-table" ) )
+    {
+      FT_Renderer     render = &smooth->root;
+      const FT_Byte*  table  = (const FT_Byte*)value;
+      FT_UInt         i;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      /* 256 bytes can't be given as a string */
+      if ( value_is_string )
+        return FT_THROW( Invalid_Argument );
+#endif
+
+      /* untouched pixels are never written */
+      if ( table[0] != 0 )
+        return FT_THROW( Invalid_Argument );
+
+      FT_MEM_COPY( smooth->coverage_table, table, 256 );
+
+      for ( i = 0; i < 256; i++ )
+        if ( table[i] != i )
+          break;
+
+      smooth->use_coverage_table = FT_BOOL( i < 256 );
+
+      return render->clazz->raster_class->raster_set_mode(
+                                            render->raster,
+                                            FT_GRAY_MODE_COVERAGE_TABLE,
+                                            smooth->use_coverage_table
+                                              ? smooth->coverage_table
+                                              : NULL );
+    }
+
+    FT_TRACE0(( "ft_smooth_property_set: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  static FT_Error
+  ft_smooth_property_get( FT_Module    module,   /* FT_Smooth_Renderer */
+                          const char*  property_name,
+                          const void*  value )
+  {
+    FT_Smooth_Renderer  smooth = (FT_Smooth_Renderer)module;
+
+
+    if ( !ft_strcmp( property_name, "accumulation-threshold" ) )
+    {
+      FT_UInt*  val = (FT_UInt*)value;
+
+
+      *val = smooth->accumulation_threshold;
+
+      return FT_Err_Ok;
+    }
+    else if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+      FT_Prop_BandExecutor*  val = (FT_Prop_BandExecutor*)value;
+
+
+      *val = smooth->band_executor;
+
+      return FT_Err_Ok;
+    }
+    else if ( !ft_strcmp( property_name, "coverage-table" ) )
+    {
+      FT_MEM_COPY( (FT_Byte*)value, smooth->coverage_table, 256 );
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_smooth_property_get: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  FT_DEFINE_SERVICE_PROPERTIESREC(
+    ft_smooth_service_properties,
+
+    (FT_Properties_SetFunc)ft_smooth_property_set,     /* set_property */
+    (FT_Properties_GetFunc)ft_smooth_property_get      /* get_property */
+  )
+
+
+  static const FT_ServiceDescRec  ft_smooth_services[] =
+  {
+    { FT_SERVICE_ID_PROPERTIES, &ft_smooth_service_properties },
+    { NULL, NULL }
+  };
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  ft_smooth_get_interface( FT_Module    module,
+                           const char*  smooth_interface )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( ft_smooth_services, smooth_interface );
+  }
+
+
   FT_DEFINE_RENDERER(
     ft_smooth_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth",
       0x10000L,
@@ -411,9 +625,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,          /* module_init   */
+      (FT_Module_Destructor) NULL,                    /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface, /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
@@ -430,7 +644,7 @@
     ft_smooth_lcd_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth-lcd",
       0x10000L,
@@ -438,9 +652,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,          /* module_init   */
+      (FT_Module_Destructor) NULL,                    /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface, /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
@@ -457,7 +671,7 @@
     ft_smooth_lcdv_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth-lcdv",
       0x10000L,
@@ -465,9 +679,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,          /* module_init   */
+      (FT_Module_Destructor) NULL,                    /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface, /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
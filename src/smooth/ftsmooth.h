@@ -22,11 +22,31 @@
 
 #include <ft2build.h>
 #include FT_RENDER_H
+#include FT_DRIVER_H
 
 
 FT_BEGIN_HEADER
 
 
+  /* default value of the `accumulation-threshold' property */
+#ifndef FT_SMOOTH_ACCUMULATION_THRESHOLD
+#define FT_SMOOTH_ACCUMULATION_THRESHOLD  64
+#endif
+
+
+  typedef struct  FT_Smooth_RendererRec_
+  {
+    FT_RendererRec        root;
+
+    FT_UInt               accumulation_threshold;
+    FT_Prop_BandExecutor  band_executor;
+
+    FT_Byte               coverage_table[256];
+    FT_Bool               use_coverage_table;  /* FALSE for the identity */
+
+  } FT_Smooth_RendererRec, *FT_Smooth_Renderer;
+
+
   FT_DECLARE_RENDERER( ft_smooth_renderer_class )
 
   FT_DECLARE_RENDERER( ft_smooth_lcd_renderer_class )
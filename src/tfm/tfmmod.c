@@ -29,26 +29,34 @@
     tfm_close,          /* done          */
   };
 
+  FT_CALLBACK_TABLE_DEF
+  const TFM_Metrics_FuncsRec  tfm_metrics_funcs =
+  {
+    tfm_metrics_acquire,  /* acquire */
+    tfm_metrics_release,  /* release */
+  };
+
   static
   const TFM_Interface  tfm_interface =
   {
     &tfm_parser_funcs,
+    &tfm_metrics_funcs,
   };
 
   FT_CALLBACK_TABLE_DEF
   const FT_Module_Class  tfm_module_class =
   {
     0,
-    sizeof ( FT_ModuleRec ),
+    sizeof ( TFM_ModuleRec ),
     "tfm",
     0x20000L,
     0x20000L,
 
     &tfm_interface,   /* module-specific interface */
 
-    (FT_Module_Constructor)NULL,  /* module_init   */
-    (FT_Module_Destructor) NULL,  /* module_done   */
-    (FT_Module_Requester)  NULL   /* get_interface */
+    (FT_Module_Constructor)tfm_module_init,  /* module_init   */
+    (FT_Module_Destructor) tfm_module_done,  /* module_done   */
+    (FT_Module_Requester)  NULL              /* get_interface */
   };
 
 
@@ -22,12 +22,29 @@
 
 #include <ft2build.h>
 #include FT_MODULE_H
+#include FT_LIST_H
 
 #include FT_INTERNAL_TFM_H
 
 FT_BEGIN_HEADER
 
 
+  typedef struct TFM_LockRec_*  TFM_Lock;
+
+
+  /* the `tfm' module object; it owns the cache of parsed metrics */
+  typedef struct  TFM_ModuleRec_
+  {
+    FT_ModuleRec  root;
+
+    FT_ListRec    metrics;       /* MRU list of `TFM_CacheNode' objects */
+    FT_UInt       num_metrics;
+
+    TFM_Lock      lock;          /* protects the above; can be NULL */
+
+  } TFM_ModuleRec, *TFM_Module;
+
+
   FT_EXPORT_VAR( const FT_Module_Class )  tfm_driver_class;
 
 
@@ -47,6 +47,7 @@
 #define tfm_size  30000 /* maximum length of tfm data, in bytes */
 #define lig_size  5000  /* maximum length of lig kern program, in words */
 #define hash_size 5003
+#define cache_max 16    /* maximum number of parsed tfm files kept */
 
   /**************************************************************************
    *
@@ -274,16 +275,11 @@
     nc  = fi->end_char - fi->begin_char + 1;
     nci = nc;
 
-    ci = (FT_ULong*)calloc(nci, sizeof(FT_ULong));
-    w  = (FT_Long*)calloc(nw,  sizeof(FT_ULong));
-    h  = (FT_Long*)calloc(nh,  sizeof(FT_ULong));
-    d  = (FT_Long*)calloc(nd,  sizeof(FT_ULong));
-
-    if ((ci == NULL) || (w == NULL) || (h == NULL) || (d == NULL))
-    {
-      error = FT_THROW( Invalid_Argument );
+    if ( FT_NEW_ARRAY( ci, nci ) ||
+         FT_NEW_ARRAY( w,  nw )  ||
+         FT_NEW_ARRAY( h,  nh )  ||
+         FT_NEW_ARRAY( d,  nd )  )
       goto Exit;
-    }
 
     offset_char_info = 4*(6+lh);
     if( FT_STREAM_SEEK( offset_char_info ) ) /* Skip over coding scheme and font family name */
@@ -301,15 +297,10 @@
     for (i = 0; i < nd; i++)
       d[i] = READ_INT4( stream );
 
-    fi->width  = (FT_Long*)calloc(nc, sizeof(FT_Long));
-    fi->height = (FT_Long*)calloc(nc, sizeof(FT_Long));
-    fi->depth  = (FT_Long*)calloc(nc, sizeof(FT_Long));
-
-    if ((fi->width == NULL) || (fi->height == NULL) || (fi->depth == NULL))
-    {
-      error = FT_THROW( Invalid_Argument );
+    if ( FT_NEW_ARRAY( fi->width,  nc ) ||
+         FT_NEW_ARRAY( fi->height, nc ) ||
+         FT_NEW_ARRAY( fi->depth,  nc ) )
       goto Exit;
-    }
 
     bbxw = 0;
     bbxh = 0;
@@ -353,4 +344,381 @@
   }
 
 
+  /**************************************************************************
+   *
+   * Metrics cache.
+   *
+   * The same TFM files tend to get attached to many faces.  The module
+   * therefore keeps parsed metrics in an MRU list, together with the TFM
+   * data they were parsed from.  Entries are looked up by the size and
+   * the first `tfm_key_size' bytes of the data, which hold the table
+   * lengths, the checksum, and the design size; only for a matching entry
+   * is the rest of the stream read and compared.  Entries still in use by
+   * a face are never discarded.
+   *
+   * The cache lives as long as the library and is not saved anywhere.  A
+   * saved entry would have to be verified against its TFM file like any
+   * cached one, so it could only save parsing, not reading, the file.
+   *
+   * With TFM_CONFIG_OPTION_CONCURRENT, a lock makes the cache safe to use
+   * from several threads.  It is held during the whole lookup, including
+   * the parsing of a new entry, so that a TFM file never gets parsed
+   * twice.
+   *
+   */
+
+#define tfm_key_size  32  /* lf, ..., np, checksum, design size */
+
+
+#ifdef TFM_CONFIG_OPTION_CONCURRENT
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+  typedef struct  TFM_LockRec_
+  {
+    CRITICAL_SECTION  section;
+
+  } TFM_LockRec;
+
+#define TFM_LOCK_INIT( l )  ( InitializeCriticalSection( &(l)->section ), \
+                              0 )
+#define TFM_LOCK_DONE( l )  DeleteCriticalSection( &(l)->section )
+#define TFM_LOCK( l )       EnterCriticalSection( &(l)->section )
+#define TFM_UNLOCK( l )     LeaveCriticalSection( &(l)->section )
+
+#else /* !_WIN32 */
+
+#include <pthread.h>
+
+  typedef struct  TFM_LockRec_
+  {
+    pthread_mutex_t  mutex;
+
+  } TFM_LockRec;
+
+#define TFM_LOCK_INIT( l )  pthread_mutex_init( &(l)->mutex, NULL )
+#define TFM_LOCK_DONE( l )  pthread_mutex_destroy( &(l)->mutex )
+#define TFM_LOCK( l )       pthread_mutex_lock( &(l)->mutex )
+#define TFM_UNLOCK( l )     pthread_mutex_unlock( &(l)->mutex )
+
+#endif /* !_WIN32 */
+
+#else /* !TFM_CONFIG_OPTION_CONCURRENT */
+
+#define TFM_LOCK( l )    do { } while ( 0 )
+#define TFM_UNLOCK( l )  do { } while ( 0 )
+
+#endif /* !TFM_CONFIG_OPTION_CONCURRENT */
+
+
+  typedef struct  TFM_CacheNodeRec_
+  {
+    TFM_FontInfoRec  info;       /* must be first */
+
+    FT_ULong         size;
+    FT_Byte*         data;       /* the complete TFM data */
+    FT_Int           ref_count;
+
+  } TFM_CacheNodeRec, *TFM_CacheNode;
+
+
+  /* load the complete TFM data */
+  static FT_Error
+  tfm_load_stream( FT_Stream   stream,
+                   FT_Memory   memory,
+                   FT_Byte*   *adata )
+  {
+    FT_Error  error;
+    FT_Byte*  data = NULL;
+
+
+    *adata = NULL;
+
+    if ( FT_QALLOC( data, stream->size )              ||
+         FT_STREAM_READ_AT( 0, data, stream->size ) )
+    {
+      FT_FREE( data );
+      return error;
+    }
+
+    *adata = data;
+
+    return FT_Err_Ok;
+  }
+
+
+  /* compare the stream's data from `offset' on with `data' */
+  static FT_Error
+  tfm_compare_stream( FT_Stream       stream,
+                      const FT_Byte*  data,
+                      FT_ULong        offset,
+                      FT_Bool        *aequal )
+  {
+    FT_Error  error;
+    FT_Byte   buffer[256];
+
+
+    *aequal = 0;
+
+    if ( !stream->read )
+    {
+      *aequal = FT_BOOL( !ft_memcmp( stream->base + offset,
+                                     data + offset,
+                                     stream->size - offset ) );
+      return FT_Err_Ok;
+    }
+
+    if ( FT_STREAM_SEEK( offset ) )
+      return error;
+
+    while ( offset < stream->size )
+    {
+      FT_ULong  count = stream->size - offset;
+
+
+      if ( count > sizeof ( buffer ) )
+        count = sizeof ( buffer );
+
+      if ( FT_STREAM_READ( buffer, count ) )
+        return error;
+
+      if ( ft_memcmp( buffer, data + offset, count ) )
+        return FT_Err_Ok;
+
+      offset += count;
+    }
+
+    *aequal = 1;
+
+    return FT_Err_Ok;
+  }
+
+
+  static void
+  tfm_cache_node_free( FT_Memory      memory,
+                       TFM_CacheNode  node )
+  {
+    FT_FREE( node->info.width );
+    FT_FREE( node->info.height );
+    FT_FREE( node->info.depth );
+    FT_FREE( node->data );
+    FT_FREE( node );
+  }
+
+
+  /* discard least recently used, unreferenced entries */
+  static void
+  tfm_cache_trim( TFM_Module  module )
+  {
+    FT_Memory    memory = module->root.memory;
+    FT_ListNode  lnode  = module->metrics.tail;
+
+
+    while ( lnode && module->num_metrics > cache_max )
+    {
+      FT_ListNode    prev = lnode->prev;
+      TFM_CacheNode  node = (TFM_CacheNode)lnode->data;
+
+
+      if ( node->ref_count == 0 )
+      {
+        FT_List_Remove( &module->metrics, lnode );
+        FT_FREE( lnode );
+        tfm_cache_node_free( memory, node );
+        module->num_metrics--;
+      }
+
+      lnode = prev;
+    }
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  tfm_metrics_acquire( FT_Module      tfmmodule,
+                       FT_Stream      stream,
+                       TFM_FontInfo  *afi )
+  {
+    TFM_Module     module = (TFM_Module)tfmmodule;
+    FT_Memory      memory = tfmmodule->memory;
+    FT_Error       error;
+    FT_Byte        key[tfm_key_size];
+    FT_ULong       key_size;
+    FT_ListNode    lnode;
+    TFM_CacheNode  node  = NULL;
+    TFM_ParserRec  parser;
+
+
+    *afi = NULL;
+
+    if ( stream->size == 0 || stream->size > tfm_size )
+      return FT_THROW( Unknown_File_Format );
+
+    key_size = stream->size < tfm_key_size ? stream->size : tfm_key_size;
+    if ( FT_STREAM_READ_AT( 0, key, key_size ) )
+      return error;
+
+    TFM_LOCK( module->lock );
+
+    for ( lnode = module->metrics.head; lnode; lnode = lnode->next )
+    {
+      FT_Bool  equal;
+
+
+      node = (TFM_CacheNode)lnode->data;
+
+      if ( node->size != stream->size             ||
+           ft_memcmp( node->data, key, key_size ) )
+        continue;
+
+      error = tfm_compare_stream( stream, node->data, key_size, &equal );
+      if ( error )
+        goto Exit;
+
+      if ( equal )
+      {
+        FT_TRACE4(( "tfm_metrics_acquire: reusing cached metrics\n" ));
+
+        node->ref_count++;
+        FT_List_Up( &module->metrics, lnode );
+
+        *afi = &node->info;
+        goto Exit;
+      }
+    }
+
+    if ( FT_NEW( node ) )
+      goto Exit;
+
+    error = tfm_load_stream( stream, memory, &node->data );
+    if ( error )
+      goto Fail;
+
+    tfm_init( &parser, memory, stream );
+    parser.FontInfo = &node->info;
+
+    error = tfm_parse_metrics( &parser );
+    tfm_close( &parser );
+    if ( error )
+      goto Fail;
+
+    if ( FT_NEW( lnode ) )
+      goto Fail;
+
+    node->size      = stream->size;
+    node->ref_count = 1;
+
+    lnode->data = node;
+    FT_List_Insert( &module->metrics, lnode );
+    module->num_metrics++;
+
+    tfm_cache_trim( module );
+
+    *afi = &node->info;
+    goto Exit;
+
+  Fail:
+    tfm_cache_node_free( memory, node );
+
+  Exit:
+    TFM_UNLOCK( module->lock );
+
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  tfm_metrics_release( FT_Module     tfmmodule,
+                       TFM_FontInfo  fi )
+  {
+    TFM_Module     module = (TFM_Module)tfmmodule;
+    TFM_CacheNode  node   = (TFM_CacheNode)fi;
+
+
+    if ( !fi )
+      return;
+
+    TFM_LOCK( module->lock );
+
+    if ( !FT_List_Find( &module->metrics, node ) )
+      FT_ERROR(( "tfm_metrics_release: unknown metrics object\n" ));
+    else
+    {
+      if ( node->ref_count > 0 )
+        node->ref_count--;
+
+      tfm_cache_trim( module );
+    }
+
+    TFM_UNLOCK( module->lock );
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  tfm_module_init( FT_Module  tfmmodule )
+  {
+#ifdef TFM_CONFIG_OPTION_CONCURRENT
+
+    TFM_Module  module = (TFM_Module)tfmmodule;
+    FT_Memory   memory = tfmmodule->memory;
+    FT_Error    error;
+    TFM_Lock    lock;
+
+
+    if ( FT_NEW( lock ) )
+      return error;
+
+    if ( TFM_LOCK_INIT( lock ) )
+    {
+      FT_FREE( lock );
+      return FT_THROW( Out_Of_Memory );
+    }
+
+    module->lock = lock;
+
+#else
+
+    FT_UNUSED( tfmmodule );
+
+#endif
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  tfm_module_done( FT_Module  tfmmodule )
+  {
+    TFM_Module   module = (TFM_Module)tfmmodule;
+    FT_Memory    memory = tfmmodule->memory;
+    FT_ListNode  lnode  = module->metrics.head;
+
+
+    while ( lnode )
+    {
+      FT_ListNode  next = lnode->next;
+
+
+      tfm_cache_node_free( memory, (TFM_CacheNode)lnode->data );
+      FT_FREE( lnode );
+
+      lnode = next;
+    }
+
+    module->metrics.head = NULL;
+    module->metrics.tail = NULL;
+    module->num_metrics  = 0;
+
+#ifdef TFM_CONFIG_OPTION_CONCURRENT
+    if ( module->lock )
+    {
+      TFM_LOCK_DONE( module->lock );
+      FT_FREE( module->lock );
+    }
+#endif
+  }
+
+
 /* END */
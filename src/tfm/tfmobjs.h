@@ -44,6 +44,22 @@ FT_BEGIN_HEADER
   FT_LOCAL( void )
   tfm_close( TFM_Parser  parser );
 
+  /* Get shared metrics from the module's cache */
+  FT_LOCAL( FT_Error )
+  tfm_metrics_acquire( FT_Module      module,
+                       FT_Stream      stream,
+                       TFM_FontInfo  *afi );
+
+  FT_LOCAL( void )
+  tfm_metrics_release( FT_Module     module,
+                       TFM_FontInfo  fi );
+
+  FT_LOCAL( FT_Error )
+  tfm_module_init( FT_Module  module );
+
+  FT_LOCAL( void )
+  tfm_module_done( FT_Module  module );
+
 
 FT_END_HEADER
 
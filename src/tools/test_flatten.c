@@ -0,0 +1,555 @@
+/*
+ * Compare the curve flattening of the smooth rasterizer, which computes
+ * the number of lines from the flatness of each curve and traces them
+ * with forward differences, to the recursive bisection it used before.
+ * For each method, the number of emitted line segments and the
+ * flattening time per glyph are printed, followed by the time to render
+ * a glyph with the library.
+ *
+ *   test_flatten fontfile [pixel_size [repeat]]
+ *
+ * The flatteners below are copies of the ones in `src/smooth/ftgrays.c',
+ * working in 1/256 pixels like the rasterizer.  A 64-bit integer type
+ * is needed.
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>    /* for clock() */
+
+/* SunOS 4.1.* does not define CLOCKS_PER_SEC, so include <sys/param.h> */
+/* to get the HZ macro which is the equivalent.                         */
+#if defined(__sun__) && !defined(SVR4) && !defined(__SVR4)
+#include <sys/param.h>
+#define CLOCKS_PER_SEC HZ
+#endif
+
+
+#define ONE_PIXEL       256
+#define UPSCALE( x )    ( (x) * ( ONE_PIXEL >> 6 ) )
+
+#define ABS( a )        ( (a) < 0 ? -(a) : (a) )
+#define HYPOT( x, y )                    \
+          ( x = ABS( x ),                \
+            y = ABS( y ),                \
+            x > y ? x + ( 3 * y >> 3 )   \
+                  : y + ( 3 * x >> 3 ) )
+
+
+  typedef struct  Flattener_
+  {
+    int     forward;   /* forward differences instead of bisection */
+    FT_Pos  x, y;      /* the current point                        */
+    long    segments;
+    FT_Pos  sink;      /* keeps the compiler from dropping points  */
+
+  } Flattener;
+
+
+  static double
+  get_time( void )
+  {
+    return (double)clock() / CLOCKS_PER_SEC;
+  }
+
+
+  static void
+  line( Flattener*  f,
+        FT_Pos      x,
+        FT_Pos      y )
+  {
+    f->segments += 1;
+    f->sink     ^= x + y;
+    f->x         = x;
+    f->y         = y;
+  }
+
+
+  /* the previous flatteners */
+
+  static void
+  split_conic( FT_Vector*  base )
+  {
+    FT_Pos  a, b;
+
+
+    base[4].x = base[2].x;
+    b = base[1].x;
+    a = base[3].x = ( base[2].x + b ) / 2;
+    b = base[1].x = ( base[0].x + b ) / 2;
+    base[2].x = ( a + b ) / 2;
+
+    base[4].y = base[2].y;
+    b = base[1].y;
+    a = base[3].y = ( base[2].y + b ) / 2;
+    b = base[1].y = ( base[0].y + b ) / 2;
+    base[2].y = ( a + b ) / 2;
+  }
+
+
+  static void
+  bisect_conic( Flattener*  f,
+                FT_Pos      x1,
+                FT_Pos      y1,
+                FT_Pos      x2,
+                FT_Pos      y2 )
+  {
+    FT_Vector   bez_stack[16 * 2 + 1];
+    FT_Vector*  arc = bez_stack;
+    FT_Pos      dx, dy;
+    int         draw, split;
+
+
+    arc[0].x = x2;
+    arc[0].y = y2;
+    arc[1].x = x1;
+    arc[1].y = y1;
+    arc[2].x = f->x;
+    arc[2].y = f->y;
+
+    dx = ABS( arc[2].x + arc[0].x - 2 * arc[1].x );
+    dy = ABS( arc[2].y + arc[0].y - 2 * arc[1].y );
+    if ( dx < dy )
+      dx = dy;
+
+    draw = 1;
+    while ( dx > ONE_PIXEL / 4 )
+    {
+      dx   >>= 2;
+      draw <<= 1;
+    }
+
+    do
+    {
+      split = 1;
+      while ( ( draw & split ) == 0 )
+      {
+        split_conic( arc );
+        arc += 2;
+        split <<= 1;
+      }
+
+      line( f, arc[0].x, arc[0].y );
+      arc -= 2;
+
+    } while ( --draw );
+  }
+
+
+  static void
+  split_cubic( FT_Vector*  base )
+  {
+    FT_Pos  a, b, c, d;
+
+
+    base[6].x = base[3].x;
+    c = base[1].x;
+    d = base[2].x;
+    base[1].x = a = ( base[0].x + c ) / 2;
+    base[5].x = b = ( base[3].x + d ) / 2;
+    c = ( c + d ) / 2;
+    base[2].x = a = ( a + c ) / 2;
+    base[4].x = b = ( b + c ) / 2;
+    base[3].x = ( a + b ) / 2;
+
+    base[6].y = base[3].y;
+    c = base[1].y;
+    d = base[2].y;
+    base[1].y = a = ( base[0].y + c ) / 2;
+    base[5].y = b = ( base[3].y + d ) / 2;
+    c = ( c + d ) / 2;
+    base[2].y = a = ( a + c ) / 2;
+    base[4].y = b = ( b + c ) / 2;
+    base[3].y = ( a + b ) / 2;
+  }
+
+
+  static void
+  bisect_cubic( Flattener*  f,
+                FT_Pos      x1,
+                FT_Pos      y1,
+                FT_Pos      x2,
+                FT_Pos      y2,
+                FT_Pos      x3,
+                FT_Pos      y3 )
+  {
+    FT_Vector   bez_stack[16 * 3 + 1];
+    FT_Vector*  arc = bez_stack;
+    FT_Pos      dx, dy, dx_, dy_;
+    FT_Pos      dx1, dy1, dx2, dy2;
+    FT_Pos      L, s, s_limit;
+
+
+    arc[0].x = x3;
+    arc[0].y = y3;
+    arc[1].x = x2;
+    arc[1].y = y2;
+    arc[2].x = x1;
+    arc[2].y = y1;
+    arc[3].x = f->x;
+    arc[3].y = f->y;
+
+    for (;;)
+    {
+      dx = dx_ = arc[3].x - arc[0].x;
+      dy = dy_ = arc[3].y - arc[0].y;
+
+      L = HYPOT( dx_, dy_ );
+
+      if ( L > 32767 )
+        goto Split;
+
+      s_limit = L * (FT_Pos)( ONE_PIXEL / 6 );
+
+      dx1 = arc[1].x - arc[0].x;
+      dy1 = arc[1].y - arc[0].y;
+      s   = ABS( dy * dx1 - dx * dy1 );
+
+      if ( s > s_limit )
+        goto Split;
+
+      dx2 = arc[2].x - arc[0].x;
+      dy2 = arc[2].y - arc[0].y;
+      s   = ABS( dy * dx2 - dx * dy2 );
+
+      if ( s > s_limit )
+        goto Split;
+
+      if ( dx1 * ( dx1 - dx ) + dy1 * ( dy1 - dy ) > 0 ||
+           dx2 * ( dx2 - dx ) + dy2 * ( dy2 - dy ) > 0 )
+        goto Split;
+
+      line( f, arc[0].x, arc[0].y );
+
+      if ( arc == bez_stack )
+        return;
+
+      arc -= 3;
+      continue;
+
+    Split:
+      split_cubic( arc );
+      arc += 3;
+    }
+  }
+
+
+  /* the current flatteners */
+
+  static void
+  forward_conic( Flattener*  f,
+                 FT_Pos      x1,
+                 FT_Pos      y1,
+                 FT_Pos      x2,
+                 FT_Pos      y2 )
+  {
+    FT_Pos    x0 = f->x, y0 = f->y;
+    FT_Pos    ax, ay, bx, by, dx, dy;
+    FT_Int64  px, py, qx, qy, rx, ry;
+    FT_UInt   count;
+    int       shift;
+
+
+    bx = x1 - x0;
+    by = y1 - y0;
+    ax = x2 - x0 - 2 * bx;
+    ay = y2 - y0 - 2 * by;
+
+    dx = ABS( ax );
+    dy = ABS( ay );
+    if ( dx < dy )
+      dx = dy;
+
+    shift = 0;
+    while ( dx > ONE_PIXEL / 4 && shift < 11 )
+    {
+      dx   >>= 2;
+      shift += 1;
+    }
+
+    if ( shift > 0 )
+    {
+      rx = (FT_Int64)ax * 2;
+      ry = (FT_Int64)ay * 2;
+      qx = (FT_Int64)bx * ( (FT_Int64)2 << shift ) + ax;
+      qy = (FT_Int64)by * ( (FT_Int64)2 << shift ) + ay;
+      px = 0;
+      py = 0;
+
+      for ( count = ( 1U << shift ) - 1; count > 0; count-- )
+      {
+        px += qx;
+        py += qy;
+        qx += rx;
+        qy += ry;
+
+        line( f, x0 + (FT_Pos)( px >> ( 2 * shift ) ),
+                 y0 + (FT_Pos)( py >> ( 2 * shift ) ) );
+      }
+    }
+
+    line( f, x2, y2 );
+  }
+
+
+  static void
+  forward_cubic( Flattener*  f,
+                 FT_Pos      x1,
+                 FT_Pos      y1,
+                 FT_Pos      x2,
+                 FT_Pos      y2,
+                 FT_Pos      x3,
+                 FT_Pos      y3 )
+  {
+    FT_Pos    x0 = f->x, y0 = f->y;
+    FT_Pos    ax, ay, bx, by, cx, cy, dx, dy;
+    FT_Int64  px, py, qx, qy, rx, ry, sx, sy;
+    FT_UInt   count;
+    int       shift;
+
+
+    bx = x1 - x0;
+    by = y1 - y0;
+    ax = x2 - 2 * x1 + x0;
+    ay = y2 - 2 * y1 + y0;
+    cx = x3 - 2 * x2 + x1 - ax;
+    cy = y3 - 2 * y2 + y1 - ay;
+
+    dx = ABS( ax ) > ABS( ax + cx ) ? ABS( ax ) : ABS( ax + cx );
+    dy = ABS( ay ) > ABS( ay + cy ) ? ABS( ay ) : ABS( ay + cy );
+    if ( dx < dy )
+      dx = dy;
+    dx *= 3;
+
+    shift = 0;
+    while ( dx > ONE_PIXEL / 4 && shift < 11 )
+    {
+      dx   >>= 2;
+      shift += 1;
+    }
+
+    if ( shift > 0 )
+    {
+      sx = (FT_Int64)cx * 6;
+      sy = (FT_Int64)cy * 6;
+      rx = (FT_Int64)ax * ( (FT_Int64)6 << shift ) + sx;
+      ry = (FT_Int64)ay * ( (FT_Int64)6 << shift ) + sy;
+      qx = (FT_Int64)bx * ( (FT_Int64)3 << ( 2 * shift ) ) +
+           (FT_Int64)ax * ( (FT_Int64)3 << shift ) + cx;
+      qy = (FT_Int64)by * ( (FT_Int64)3 << ( 2 * shift ) ) +
+           (FT_Int64)ay * ( (FT_Int64)3 << shift ) + cy;
+      px = 0;
+      py = 0;
+
+      for ( count = ( 1U << shift ) - 1; count > 0; count-- )
+      {
+        px += qx;
+        py += qy;
+        qx += rx;
+        qy += ry;
+        rx += sx;
+        ry += sy;
+
+        line( f, x0 + (FT_Pos)( px >> ( 3 * shift ) ),
+                 y0 + (FT_Pos)( py >> ( 3 * shift ) ) );
+      }
+    }
+
+    line( f, x3, y3 );
+  }
+
+
+  /* outline decomposition callbacks */
+
+  static int
+  move_to( const FT_Vector*  to,
+           void*             user )
+  {
+    Flattener*  f = (Flattener*)user;
+
+
+    f->x = UPSCALE( to->x );
+    f->y = UPSCALE( to->y );
+
+    return 0;
+  }
+
+
+  static int
+  line_to( const FT_Vector*  to,
+           void*             user )
+  {
+    line( (Flattener*)user, UPSCALE( to->x ), UPSCALE( to->y ) );
+
+    return 0;
+  }
+
+
+  static int
+  conic_to( const FT_Vector*  control,
+            const FT_Vector*  to,
+            void*             user )
+  {
+    Flattener*  f = (Flattener*)user;
+
+
+    if ( f->forward )
+      forward_conic( f, UPSCALE( control->x ), UPSCALE( control->y ),
+                        UPSCALE( to->x ), UPSCALE( to->y ) );
+    else
+      bisect_conic( f, UPSCALE( control->x ), UPSCALE( control->y ),
+                       UPSCALE( to->x ), UPSCALE( to->y ) );
+
+    return 0;
+  }
+
+
+  static int
+  cubic_to( const FT_Vector*  control1,
+            const FT_Vector*  control2,
+            const FT_Vector*  to,
+            void*             user )
+  {
+    Flattener*  f = (Flattener*)user;
+
+
+    if ( f->forward )
+      forward_cubic( f, UPSCALE( control1->x ), UPSCALE( control1->y ),
+                        UPSCALE( control2->x ), UPSCALE( control2->y ),
+                        UPSCALE( to->x ), UPSCALE( to->y ) );
+    else
+      bisect_cubic( f, UPSCALE( control1->x ), UPSCALE( control1->y ),
+                       UPSCALE( control2->x ), UPSCALE( control2->y ),
+                       UPSCALE( to->x ), UPSCALE( to->y ) );
+
+    return 0;
+  }
+
+
+  static const FT_Outline_Funcs  flatten_funcs =
+  {
+    move_to,
+    line_to,
+    conic_to,
+    cubic_to,
+    0,
+    0
+  };
+
+
+  static void
+  dummy_spans( int             y,
+               int             count,
+               const FT_Span*  spans,
+               void*           user )
+  {
+    (void)y;
+    (void)count;
+    (void)spans;
+    (void)user;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library  library;
+    FT_Face     face;
+    FT_UInt     size   = 16;
+    long        repeat = 100;
+    long        glyphs = 0;
+    long        gindex, count;
+    Flattener   flat[2];
+    double      time[3] = { 0, 0, 0 };
+    double      time0;
+    int         n;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr, "usage: test_flatten fontfile"
+                       " [pixel_size [repeat]]\n" );
+      return 1;
+    }
+    if ( argc > 2 )
+      size = (FT_UInt)atoi( argv[2] );
+    if ( argc > 3 )
+      repeat = atol( argv[3] );
+
+    if ( FT_Init_FreeType( &library )              ||
+         FT_New_Face( library, argv[1], 0, &face ) ||
+         FT_Set_Pixel_Sizes( face, 0, size )       )
+    {
+      fprintf( stderr, "cannot open `%s'\n", argv[1] );
+      return 1;
+    }
+
+    memset( flat, 0, sizeof ( flat ) );
+    flat[1].forward = 1;
+
+    for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+    {
+      FT_Outline*       outline = &face->glyph->outline;
+      FT_Raster_Params  params;
+
+
+      if ( FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_NO_HINTING ) ||
+           face->glyph->format != FT_GLYPH_FORMAT_OUTLINE             )
+        continue;
+
+      for ( n = 0; n < 2; n++ )
+      {
+        long  segments = flat[n].segments;
+
+
+        time0 = get_time();
+        for ( count = repeat; count > 0; count-- )
+          FT_Outline_Decompose( outline, &flatten_funcs, &flat[n] );
+        time[n] += get_time() - time0;
+
+        flat[n].segments = segments +
+                           ( flat[n].segments - segments ) / repeat;
+      }
+
+      memset( &params, 0, sizeof ( params ) );
+      params.source     = outline;
+      params.flags      = FT_RASTER_FLAG_AA | FT_RASTER_FLAG_DIRECT;
+      params.gray_spans = dummy_spans;
+
+      time0 = get_time();
+      for ( count = repeat; count > 0; count-- )
+        FT_Outline_Render( library, outline, &params );
+      time[2] += get_time() - time0;
+
+      glyphs++;
+    }
+
+    if ( !glyphs )
+    {
+      fprintf( stderr, "no outline glyphs\n" );
+      return 1;
+    }
+
+    printf( "%ld glyphs at %u pixels\n", glyphs, size );
+    printf( "bisection:    %8.2f segments  %8.3f us per glyph\n",
+            (double)flat[0].segments / glyphs,
+            time[0] * 1e6 / repeat / glyphs );
+    printf( "forward diff: %8.2f segments  %8.3f us per glyph\n",
+            (double)flat[1].segments / glyphs,
+            time[1] * 1e6 / repeat / glyphs );
+    printf( "rendering:                      %8.3f us per glyph\n",
+            time[2] * 1e6 / repeat / glyphs );
+
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+
+    return 0;
+  }
+
+/* END */
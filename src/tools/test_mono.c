@@ -0,0 +1,234 @@
+/*
+ * Time monochrome rendering at small pixel sizes, where hinted text and
+ * bitmap fonts are used the most.
+ *
+ *   test_mono fontfile [pixel_size [repeat]]
+ *
+ * For an outline font, each glyph is loaded with `FT_LOAD_TARGET_MONO'
+ * and its outline rendered into a monochrome bitmap, both with the
+ * horizontal drop-out pass of the rasterizer (the default) and without
+ * it (`FT_OUTLINE_SINGLE_PASS').  For a font without outlines (PCF, BDF,
+ * PFR or bitmap-only SFNT), the strike closest to `pixel_size' is
+ * selected and the time to load and render each glyph is printed.
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>    /* for clock() */
+
+/* SunOS 4.1.* does not define CLOCKS_PER_SEC, so include <sys/param.h> */
+/* to get the HZ macro which is the equivalent.                         */
+#if defined(__sun__) && !defined(SVR4) && !defined(__SVR4)
+#include <sys/param.h>
+#define CLOCKS_PER_SEC HZ
+#endif
+
+
+  static double
+  get_time( void )
+  {
+    return (double)clock() / CLOCKS_PER_SEC;
+  }
+
+
+  /* select the strike whose height is closest to `size' */
+  static FT_Error
+  select_strike( FT_Face  face,
+                 FT_UInt  size )
+  {
+    FT_Int  best = 0;
+    FT_Int  i;
+
+
+    for ( i = 1; i < face->num_fixed_sizes; i++ )
+      if ( abs( face->available_sizes[i].height - (FT_Int)size ) <
+           abs( face->available_sizes[best].height - (FT_Int)size ) )
+        best = i;
+
+    return FT_Select_Size( face, best );
+  }
+
+
+  static int
+  test_bitmaps( FT_Face  face,
+                long     repeat )
+  {
+    long    glyphs = 0;
+    long    gindex, count;
+    double  time   = 0;
+    double  time0;
+
+
+    for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+    {
+      if ( FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_TARGET_MONO ) )
+        continue;
+
+      time0 = get_time();
+      for ( count = repeat; count > 0; count-- )
+        FT_Load_Glyph( face, (FT_UInt)gindex,
+                       FT_LOAD_RENDER | FT_LOAD_TARGET_MONO );
+      time += get_time() - time0;
+
+      glyphs++;
+    }
+
+    if ( !glyphs )
+    {
+      fprintf( stderr, "no glyphs\n" );
+      return 1;
+    }
+
+    printf( "%ld bitmap glyphs at %u pixels\n",
+            glyphs, face->size->metrics.y_ppem );
+    printf( "loading:    %8.3f us per glyph\n",
+            time * 1e6 / repeat / glyphs );
+
+    return 0;
+  }
+
+
+  static int
+  test_outlines( FT_Library  library,
+                 FT_Face     face,
+                 long        repeat )
+  {
+    FT_Outline*  outline = &face->glyph->outline;
+    long         glyphs  = 0;
+    long         gindex, count;
+    double       time[3] = { 0, 0, 0 };
+    double       time0;
+    int          n;
+
+
+    for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+    {
+      FT_BBox    cbox;
+      FT_Bitmap  bitmap;
+
+
+      time0 = get_time();
+      for ( count = repeat; count > 0; count-- )
+        FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_TARGET_MONO );
+      time[0] += get_time() - time0;
+
+      if ( face->glyph->format != FT_GLYPH_FORMAT_OUTLINE )
+        continue;
+
+      /* the bitmap covering the outline, as the renderer would compute */
+      FT_Outline_Get_CBox( outline, &cbox );
+      cbox.xMin &= ~63;
+      cbox.yMin &= ~63;
+      cbox.xMax  = ( cbox.xMax + 63 ) & ~63;
+      cbox.yMax  = ( cbox.yMax + 63 ) & ~63;
+
+      FT_Outline_Translate( outline, -cbox.xMin, -cbox.yMin );
+
+      memset( &bitmap, 0, sizeof ( bitmap ) );
+      bitmap.width      = (unsigned int)( ( cbox.xMax - cbox.xMin ) >> 6 );
+      bitmap.rows       = (unsigned int)( ( cbox.yMax - cbox.yMin ) >> 6 );
+      bitmap.pitch      = (int)( ( bitmap.width + 15 ) >> 3 );
+      bitmap.pixel_mode = FT_PIXEL_MODE_MONO;
+      bitmap.num_grays  = 2;
+      bitmap.buffer     = (unsigned char*)malloc(
+                            (size_t)bitmap.pitch * bitmap.rows + 1 );
+      if ( !bitmap.buffer )
+        return 1;
+
+      for ( n = 1; n < 3; n++ )
+      {
+        if ( n == 2 )
+          outline->flags |= FT_OUTLINE_SINGLE_PASS;
+
+        time0 = get_time();
+        for ( count = repeat; count > 0; count-- )
+        {
+          memset( bitmap.buffer, 0, (size_t)bitmap.pitch * bitmap.rows );
+          FT_Outline_Get_Bitmap( library, outline, &bitmap );
+        }
+        time[n] += get_time() - time0;
+      }
+
+      free( bitmap.buffer );
+      glyphs++;
+    }
+
+    if ( !glyphs )
+    {
+      fprintf( stderr, "no outline glyphs\n" );
+      return 1;
+    }
+
+    printf( "%ld outline glyphs at %u pixels\n",
+            glyphs, face->size->metrics.y_ppem );
+    printf( "loading:    %8.3f us per glyph\n",
+            time[0] * 1e6 / repeat / face->num_glyphs );
+    printf( "two passes: %8.3f us per glyph\n",
+            time[1] * 1e6 / repeat / glyphs );
+    printf( "one pass:   %8.3f us per glyph\n",
+            time[2] * 1e6 / repeat / glyphs );
+
+    return 0;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library  library;
+    FT_Face     face;
+    FT_UInt     size   = 12;
+    long        repeat = 100;
+    int         result;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr, "usage: test_mono fontfile"
+                       " [pixel_size [repeat]]\n" );
+      return 1;
+    }
+    if ( argc > 2 )
+      size = (FT_UInt)atoi( argv[2] );
+    if ( argc > 3 )
+      repeat = atol( argv[3] );
+
+    if ( FT_Init_FreeType( &library )              ||
+         FT_New_Face( library, argv[1], 0, &face ) )
+    {
+      fprintf( stderr, "cannot open `%s'\n", argv[1] );
+      return 1;
+    }
+
+    if ( FT_IS_SCALABLE( face ) )
+    {
+      if ( FT_Set_Pixel_Sizes( face, 0, size ) )
+      {
+        fprintf( stderr, "cannot set size %u\n", size );
+        return 1;
+      }
+      result = test_outlines( library, face, repeat );
+    }
+    else
+    {
+      if ( select_strike( face, size ) )
+      {
+        fprintf( stderr, "cannot select a strike\n" );
+        return 1;
+      }
+      result = test_bitmaps( face, repeat );
+    }
+
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+
+    return result;
+  }
+
+/* END */
@@ -109,6 +109,37 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "hinted-outline-cache" ) )
+    {
+      FT_ULong  hinted_cache_size;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+        long         t = ft_strtol( s, NULL, 10 );
+
+
+        if ( t < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        hinted_cache_size = (FT_ULong)t;
+      }
+      else
+#endif
+      {
+        FT_ULong*  hcs = (FT_ULong*)value;
+
+
+        hinted_cache_size = *hcs;
+      }
+
+      driver->hinted_cache_size = hinted_cache_size;
+
+      return error;
+    }
+
     FT_TRACE0(( "tt_property_set: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
@@ -136,6 +167,16 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "hinted-outline-cache" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = driver->hinted_cache_size;
+
+      return error;
+    }
+
     FT_TRACE0(( "tt_property_get: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
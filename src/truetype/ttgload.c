@@ -784,13 +784,16 @@
    * @Description:
    *   Hint the glyph using the zone prepared by the caller.  Note that
    *   the zone is supposed to include four phantom points.
+   *
+   *   If the `hinted-outline-cache' property is set, the hinted points of
+   *   simple glyphs are cached in the size object, and the glyph program
+   *   is only run again if it isn't in the cache.
    */
   static FT_Error
   TT_Hint_Glyph( TT_Loader  loader,
                  FT_Bool    is_composite )
   {
-#if defined TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY || \
-    defined TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+#ifdef TT_USE_BYTECODE_INTERPRETER
     TT_Face    face   = loader->face;
     TT_Driver  driver = (TT_Driver)FT_FACE_DRIVER( face );
 #endif
@@ -855,20 +858,140 @@
       FT_GlyphLoader  gloader         = loader->gloader;
       FT_Outline      current_outline = gloader->current.outline;
 
+      TT_ExecContext  exec   = loader->exec;
+      TT_Size         size   = loader->size;
+      TT_HintedGlyph  hinted = NULL;
+      FT_UInt         mode   = 0;
+      FT_Bool         cache  = FALSE;
 
-      TT_Set_CodeRange( loader->exec, tt_coderange_glyph,
-                        loader->exec->glyphIns, n_ins );
 
-      loader->exec->is_composite = is_composite;
-      loader->exec->pts          = *zone;
+      if ( !driver->hinted_cache_size )
+      {
+        if ( size->hinted.buckets )
+          tt_size_done_hinted( size );
+      }
+      else if ( !size->hinted.buckets )
+        (void)tt_size_init_hinted( size );
 
-      error = TT_Run_Context( loader->exec );
-      if ( error && loader->exec->pedantic_hinting )
-        return error;
+      /* while the cache is active, all glyph programs must be tracked */
+      if ( size->hinted.buckets )
+      {
+        TT_HintedCache  hc = &size->hinted;
+
+
+        if ( hc->serial >= ( FT_ULONG_MAX >> 1 ) )
+        {
+          tt_size_flush_hinted( size );
+
+          FT_ARRAY_ZERO( hc->storage_stamps, size->storage_size );
+          FT_ARRAY_ZERO( hc->cvt_stamps, size->cvt_size );
+          hc->serial = 0;
+        }
+
+        exec->storage_stamps = hc->storage_stamps;
+        exec->cvt_stamps     = hc->cvt_stamps;
+        exec->stamp          = ++hc->serial << 1;
+        exec->shared_input   = FALSE;
+        exec->shared_output  = FALSE;
+        exec->twilight_used  = FALSE;
+
+        cache = !is_composite;
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+        /* the tweaks of the v38 interpreter depend on too many things */
+        if ( driver->interpreter_version == TT_INTERPRETER_VERSION_38 )
+          cache = FALSE;
+#endif
+      }
+
+      if ( cache )
+      {
+        mode   = tt_size_hinting_mode( size, exec->pedantic_hinting );
+        hinted = tt_size_lookup_hinted( size, loader->glyph_index, mode );
+
+        if ( hinted && hinted->n_points != zone->n_points )
+          hinted = NULL;
+      }
+
+      if ( hinted )
+      {
+        FT_TRACE5(( "TT_Hint_Glyph: using cached outline\n" ));
+
+        /* this includes the drop-out mode */
+        FT_ARRAY_COPY( zone->cur, hinted->points, zone->n_points );
+        FT_ARRAY_COPY( zone->tags, hinted->tags, zone->n_points );
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+        exec->backward_compatibility = hinted->backward_compatibility;
+#endif
+      }
+      else
+      {
+        TT_Set_CodeRange( exec, tt_coderange_glyph,
+                          exec->glyphIns, n_ins, NULL );
+
+        exec->is_composite = is_composite;
+        exec->pts          = *zone;
+
+        /* the state is no longer the one computed by `prep' */
+        size->prep_id = 0;
+
+        error = TT_Run_Context( exec );
+
+        if ( size->hinted.buckets )
+        {
+          TT_HintedCache  hc = &size->hinted;
+
+
+          if ( exec->twilight_used )
+          {
+            FT_Bool  was_dirty = hc->twilight_dirty;
+
+
+            hc->twilight_dirty = tt_size_check_hinted_twilight( size );
+
+            /* the result depends on (or the run changes) twilight */
+            /* points that differ from the ones computed by `prep' */
+            if ( was_dirty || hc->twilight_dirty )
+              exec->shared_input = TRUE;
+
+            if ( !was_dirty && hc->twilight_dirty && hc->twilight_read )
+              exec->shared_output = TRUE;
+          }
 
-      /* store drop-out mode in bits 5-7; set bit 2 also as a marker */
-      current_outline.tags[0] |=
-        ( loader->exec->GS.scan_type << 5 ) | FT_CURVE_TAG_HAS_SCANMODE;
+          if ( exec->shared_output )
+            tt_size_flush_hinted( size );
+          else if ( exec->shared_input )
+            cache = FALSE;
+
+          exec->storage_stamps = NULL;
+          exec->cvt_stamps     = NULL;
+        }
+
+        if ( error && exec->pedantic_hinting )
+          return error;
+
+        /* store drop-out mode in bits 5-7; set bit 2 also as a marker */
+        current_outline.tags[0] |=
+          ( exec->GS.scan_type << 5 ) | FT_CURVE_TAG_HAS_SCANMODE;
+
+        if ( cache && !error && !exec->shared_output )
+        {
+          if ( exec->twilight_used )
+            size->hinted.twilight_read = TRUE;
+
+          tt_size_store_hinted( size,
+                                loader->glyph_index,
+                                mode,
+                                zone,
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+                                exec->backward_compatibility,
+#else
+                                FALSE,
+#endif
+                                driver->hinted_cache_size );
+        }
+      }
     }
 
 #endif
@@ -2597,12 +2720,7 @@
 
       if ( reexecute )
       {
-        FT_UInt  i;
-
-
-        for ( i = 0; i < size->cvt_size; i++ )
-          size->cvt[i] = FT_MulFix( face->cvt[i], size->ttmetrics.scale );
-        error = tt_size_run_prep( size, pedantic );
+        error = tt_size_rerun_prep( size, pedantic );
         if ( error )
           return error;
       }
@@ -1314,6 +1314,25 @@
   }
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  static FT_Error
+  tt_size_flush_hinted_iterator( FT_ListNode  node,
+                                 void*        user )
+  {
+    TT_Size  size = (TT_Size)node->data;
+
+    FT_UNUSED( user );
+
+
+    tt_size_flush_hinted( size );
+
+    return FT_Err_Ok;
+  }
+
+#endif
+
+
   /**************************************************************************
    *
    * @Function:
@@ -2614,6 +2633,13 @@
       }
     }
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    /* the glyph outlines have changed */
+    FT_List_Iterate( &face->root.sizes_list,
+                     tt_size_flush_hinted_iterator,
+                     NULL );
+#endif
+
     /* enforce recomputation of the PostScript name; */
     FT_FREE( face->postscript_name );
     face->postscript_name = NULL;
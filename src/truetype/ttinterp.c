@@ -146,6 +146,7 @@
 
     exec->code     = coderange->base;
     exec->codeSize = coderange->size;
+    exec->codeMap  = coderange->map;
     exec->IP       = IP;
     exec->curRange = range;
   }
@@ -169,6 +170,10 @@
    *   length ::
    *     The range size in bytes.
    *
+   *   map ::
+   *     The jump map of the code, created with `TT_New_CodeMap'.  Can be
+   *     NULL.
+   *
    * @InOut:
    *   exec ::
    *     The target execution context.
@@ -177,12 +182,14 @@
   TT_Set_CodeRange( TT_ExecContext  exec,
                     FT_Int          range,
                     void*           base,
-                    FT_Long         length )
+                    FT_Long         length,
+                    FT_UShort*      map )
   {
     FT_ASSERT( range >= 1 && range <= 3 );
 
     exec->codeRangeTable[range - 1].base = (FT_Byte*)base;
     exec->codeRangeTable[range - 1].size = length;
+    exec->codeRangeTable[range - 1].map  = map;
   }
 
 
@@ -210,6 +217,7 @@
 
     exec->codeRangeTable[range - 1].base = NULL;
     exec->codeRangeTable[range - 1].size = 0;
+    exec->codeRangeTable[range - 1].map  = NULL;
   }
 
 
@@ -446,6 +454,10 @@
 
       exec->twilight  = size->twilight;
 
+      /* only glyph programs get tracked */
+      exec->storage_stamps = NULL;
+      exec->cvt_stamps     = NULL;
+
       /* In case of multi-threading it can happen that the old size object */
       /* no longer exists, thus we must clear all glyph zone references.   */
       FT_ZERO( &exec->zp0 );
@@ -1526,6 +1538,50 @@
   }
 
 
+  /**************************************************************************
+   *
+   * Functions tracking the accesses of glyph programs to the storage area
+   * and the CVT for the cache of hinted outlines.  See `TT_HintedCache'
+   * for the meaning of the stamps.
+   *
+   */
+
+
+  static void
+  Stamp_Read( TT_ExecContext  exc,
+              FT_ULong*       stamps,
+              FT_ULong        idx )
+  {
+    FT_ULong  stamp = stamps[idx] & ~1UL;
+
+
+    if ( !stamp )
+      stamps[idx] |= 1;
+    else if ( stamp != exc->stamp )
+      exc->shared_input = TRUE;
+  }
+
+
+  static void
+  Stamp_Write( TT_ExecContext  exc,
+               FT_ULong*       stamps,
+               FT_ULong        idx,
+               FT_Bool         changed )
+  {
+    FT_ULong  read = stamps[idx] & 1;
+
+
+    /* outlines computed from the old value are stale now */
+    if ( changed && read )
+    {
+      exc->shared_output = TRUE;
+      read               = 0;
+    }
+
+    stamps[idx] = exc->stamp | read;
+  }
+
+
   /**************************************************************************
    *
    * Functions related to the control value table (CVT).
@@ -1537,6 +1593,9 @@
   Read_CVT( TT_ExecContext  exc,
             FT_ULong        idx )
   {
+    if ( exc->cvt_stamps )
+      Stamp_Read( exc, exc->cvt_stamps, idx );
+
     return exc->cvt[idx];
   }
 
@@ -1545,6 +1604,9 @@
   Read_CVT_Stretched( TT_ExecContext  exc,
                       FT_ULong        idx )
   {
+    if ( exc->cvt_stamps )
+      Stamp_Read( exc, exc->cvt_stamps, idx );
+
     return FT_MulFix( exc->cvt[idx], Current_Ratio( exc ) );
   }
 
@@ -1554,6 +1616,9 @@
              FT_ULong        idx,
              FT_F26Dot6      value )
   {
+    if ( exc->cvt_stamps )
+      Stamp_Write( exc, exc->cvt_stamps, idx, exc->cvt[idx] != value );
+
     exc->cvt[idx] = value;
   }
 
@@ -1563,7 +1628,12 @@
                        FT_ULong        idx,
                        FT_F26Dot6      value )
   {
-    exc->cvt[idx] = FT_DivFix( value, Current_Ratio( exc ) );
+    value = FT_DivFix( value, Current_Ratio( exc ) );
+
+    if ( exc->cvt_stamps )
+      Stamp_Write( exc, exc->cvt_stamps, idx, exc->cvt[idx] != value );
+
+    exc->cvt[idx] = value;
   }
 
 
@@ -1572,6 +1642,9 @@
             FT_ULong        idx,
             FT_F26Dot6      value )
   {
+    if ( exc->cvt_stamps )
+      Stamp_Write( exc, exc->cvt_stamps, idx, value != 0 );
+
     exc->cvt[idx] += value;
   }
 
@@ -1581,7 +1654,12 @@
                       FT_ULong        idx,
                       FT_F26Dot6      value )
   {
-    exc->cvt[idx] += FT_DivFix( value, Current_Ratio( exc ) );
+    value = FT_DivFix( value, Current_Ratio( exc ) );
+
+    if ( exc->cvt_stamps )
+      Stamp_Write( exc, exc->cvt_stamps, idx, value != 0 );
+
+    exc->cvt[idx] += value;
   }
 
 
@@ -1662,6 +1740,7 @@
 
     exc->code     = range->base;
     exc->codeSize = range->size;
+    exc->codeMap  = range->map;
     exc->IP       = aIP;
     exc->curRange = aRange;
 
@@ -3062,7 +3141,12 @@
         args[0] = 0;
       else
 #endif /* TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY */
+      {
+        if ( exc->storage_stamps )
+          Stamp_Read( exc, exc->storage_stamps, I );
+
         args[0] = exc->storage[I];
+      }
     }
   }
 
@@ -3086,7 +3170,13 @@
         ARRAY_BOUND_ERROR;
     }
     else
+    {
+      if ( exc->storage_stamps )
+        Stamp_Write( exc, exc->storage_stamps, I,
+                     exc->storage[I] != args[1] );
+
       exc->storage[I] = args[1];
+    }
   }
 
 
@@ -3132,7 +3222,15 @@
         ARRAY_BOUND_ERROR;
     }
     else
-      exc->cvt[I] = FT_MulFix( args[1], exc->tt_metrics.scale );
+    {
+      FT_F26Dot6  value = FT_MulFix( args[1], exc->tt_metrics.scale );
+
+
+      if ( exc->cvt_stamps )
+        Stamp_Write( exc, exc->cvt_stamps, I, exc->cvt[I] != value );
+
+      exc->cvt[I] = value;
+    }
   }
 
 
@@ -3386,6 +3484,182 @@
   }
 
 
+  /* Skip from an IF, ELSE, FDEF, or IDEF to its end in one step if */
+  /* the code range has a jump map; return FAILURE otherwise.       */
+  static FT_Bool
+  JumpCode( TT_ExecContext  exc )
+  {
+    FT_UShort  delta;
+
+
+    if ( !exc->codeMap )
+      return FAILURE;
+
+    delta = exc->codeMap[exc->IP];
+    if ( !delta )
+      return FAILURE;
+
+    exc->IP    += delta;
+    exc->opcode = exc->code[exc->IP];
+    exc->length = 1;
+
+    return SUCCESS;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   TT_New_CodeMap
+   *
+   * @Description:
+   *   Decodes a code range once to resolve its structured control flow.
+   *   Without a map, skipping the untaken branch of an IF or the body of
+   *   a definition means decoding every instruction up to its end, each
+   *   time it is executed.
+   *
+   *   For each IF, ELSE, FDEF, and IDEF, the map holds the distance in
+   *   bytes to the instruction where skipping it stops: the matching ELSE
+   *   or EIF, the matching EIF, and the ENDF, respectively.  All other
+   *   entries are zero, as are those of instructions without such a
+   *   target (in malformed code) or with one farther than 0xFFFF bytes,
+   *   for which the interpreter still scans the code.
+   *
+   *   Since the map follows the instruction boundaries from the start of
+   *   the range, a jump into the data of a push instruction finds a zero
+   *   entry as well.
+   *
+   * @Input:
+   *   memory ::
+   *     A handle to the memory object for the map.
+   *
+   *   code ::
+   *     The bytecode.
+   *
+   *   size ::
+   *     The size of the code in bytes.
+   *
+   * @Output:
+   *   amap ::
+   *     The map, one entry per code byte.  NULL if `size' is zero.
+   *
+   * @Return:
+   *   FreeType error code.  0 means success.
+   */
+  FT_LOCAL_DEF( FT_Error )
+  TT_New_CodeMap( FT_Memory       memory,
+                  const FT_Byte*  code,
+                  FT_Long         size,
+                  FT_UShort*     *amap )
+  {
+    FT_Error    error;
+    FT_UShort*  map   = NULL;
+    FT_Long*    stack = NULL;  /* open IFs, each followed by its ELSEs */
+    FT_Long     top   = 0;
+    FT_Long     def   = -1;    /* an open FDEF or IDEF                 */
+    FT_Long     IP, length;
+
+
+#define TT_MAP_JUMP( from, to )                       \
+          do                                          \
+          {                                           \
+            if ( (to) - (from) <= 0xFFFFL )           \
+              map[from] = (FT_UShort)( (to) - (from) ); \
+          } while ( 0 )
+
+    *amap = NULL;
+
+    if ( size <= 0 )
+      return FT_Err_Ok;
+
+    if ( FT_NEW_ARRAY( map, size )    ||
+         FT_QNEW_ARRAY( stack, size ) )
+      goto Exit;
+
+    /* this decodes the code the same way as `SkipCode' does */
+    for ( IP = 0; IP < size; IP += length )
+    {
+      FT_Byte  opcode = code[IP];
+
+
+      length = opcode_length[opcode];
+      if ( length < 0 )
+      {
+        if ( IP + 1 >= size )
+          break;
+        length = 2 - length * code[IP + 1];
+      }
+
+      if ( IP + length > size )
+        break;
+
+      switch ( opcode )
+      {
+      case 0x58:    /* IF */
+        stack[top++] = IP;
+        break;
+
+      case 0x1B:    /* ELSE */
+        if ( top > 0 )
+        {
+          /* the first ELSE ends the untaken branch of the IF */
+          if ( code[stack[top - 1]] == 0x58 )
+            TT_MAP_JUMP( stack[top - 1], IP );
+
+          stack[top++] = IP;
+        }
+        break;
+
+      case 0x59:    /* EIF */
+        if ( top > 0 )
+        {
+          FT_Bool  has_else = FALSE;
+
+
+          /* resolve the ELSEs, then the IF if it has none */
+          while ( code[stack[top - 1]] != 0x58 )
+          {
+            top--;
+            TT_MAP_JUMP( stack[top], IP );
+            has_else = TRUE;
+          }
+
+          top--;
+          if ( !has_else )
+            TT_MAP_JUMP( stack[top], IP );
+        }
+        break;
+
+      case 0x2C:    /* FDEF */
+      case 0x89:    /* IDEF */
+        /* a definition containing another one stays unresolved, */
+        /* so that the interpreter reports the error             */
+        def = IP;
+        break;
+
+      case 0x2D:    /* ENDF */
+        if ( def >= 0 )
+        {
+          TT_MAP_JUMP( def, IP );
+          def = -1;
+        }
+        break;
+      }
+    }
+
+#undef TT_MAP_JUMP
+
+    *amap = map;
+    map   = NULL;
+
+  Exit:
+    FT_FREE( map );
+    FT_FREE( stack );
+
+    return error;
+  }
+
+
   /**************************************************************************
    *
    * IF[]:         IF test
@@ -3403,6 +3677,9 @@
     if ( args[0] != 0 )
       return;
 
+    if ( JumpCode( exc ) == SUCCESS )
+      return;
+
     nIfs = 1;
     Out = 0;
 
@@ -3442,6 +3719,9 @@
     FT_Int  nIfs;
 
 
+    if ( JumpCode( exc ) == SUCCESS )
+      return;
+
     nIfs = 1;
 
     do
@@ -3722,6 +4002,18 @@
     /* Now skip the whole function definition. */
     /* We don't allow nested IDEFS & FDEFs.    */
 
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+    /* the patterns below must see the whole definition */
+    if ( !SUBPIXEL_HINTING_INFINALITY )
+#endif
+    {
+      if ( JumpCode( exc ) == SUCCESS )
+      {
+        rec->end = exc->IP;
+        return;
+      }
+    }
+
     while ( SkipCode( exc ) == SUCCESS )
     {
 
@@ -4141,6 +4433,12 @@
     /* Now skip the whole function definition. */
     /* We don't allow nested IDEFs & FDEFs.    */
 
+    if ( JumpCode( exc ) == SUCCESS )
+    {
+      def->end = exc->IP;
+      return;
+    }
+
     while ( SkipCode( exc ) == SUCCESS )
     {
       switch ( exc->opcode )
@@ -5062,6 +5360,7 @@
     {
     case 0:
       exc->zp0 = exc->twilight;
+      exc->twilight_used = TRUE;
       break;
 
     case 1:
@@ -5092,6 +5391,7 @@
     {
     case 0:
       exc->zp1 = exc->twilight;
+      exc->twilight_used = TRUE;
       break;
 
     case 1:
@@ -5122,6 +5422,7 @@
     {
     case 0:
       exc->zp2 = exc->twilight;
+      exc->twilight_used = TRUE;
       break;
 
     case 1:
@@ -5152,6 +5453,7 @@
     {
     case 0:
       exc->zp0 = exc->twilight;
+      exc->twilight_used = TRUE;
       break;
 
     case 1:
@@ -7865,6 +8167,8 @@
       exc->opcode = exc->code[exc->IP];
 
 #ifdef FT_DEBUG_LEVEL_TRACE
+      /* test the level once; this runs for every instruction */
+      if ( ft_trace_levels[FT_COMPONENT] >= 6 )
       {
         FT_Long  cnt = FT_MIN( 8, exc->top );
         FT_Long  n;
@@ -180,6 +180,7 @@ FT_BEGIN_HEADER
     FT_Byte*           code;      /* current code range          */
     FT_Long            IP;        /* current instruction pointer */
     FT_Long            codeSize;  /* size of current range       */
+    FT_UShort*         codeMap;   /* its jump map, or NULL       */
 
     FT_Byte            opcode;    /* current opcode              */
     FT_Int             length;    /* length of current opcode    */
@@ -432,6 +433,18 @@ FT_BEGIN_HEADER
     FT_ULong           neg_jump_counter;
     FT_ULong           neg_jump_counter_max;
 
+    /* While the size's cache of hinted outlines is active, the glyph */
+    /* loader sets these fields to track the accesses of the glyph    */
+    /* program to the storage area, the CVT, and the twilight zone;   */
+    /* see `TT_HintedCache'.                                          */
+    FT_ULong*          storage_stamps;  /* NULL if not tracked         */
+    FT_ULong*          cvt_stamps;      /* NULL if not tracked         */
+    FT_ULong           stamp;           /* of the current glyph run    */
+    FT_Bool            shared_input;    /* read another glyph's result */
+    FT_Bool            shared_output;   /* changed a location read by  */
+                                        /* another glyph               */
+    FT_Bool            twilight_used;   /* selected the twilight zone  */
+
   } TT_ExecContextRec;
 
 
@@ -448,12 +461,19 @@ FT_BEGIN_HEADER
   TT_Set_CodeRange( TT_ExecContext  exec,
                     FT_Int          range,
                     void*           base,
-                    FT_Long         length );
+                    FT_Long         length,
+                    FT_UShort*      map );
 
   FT_LOCAL( void )
   TT_Clear_CodeRange( TT_ExecContext  exec,
                       FT_Int          range );
 
+  FT_LOCAL( FT_Error )
+  TT_New_CodeMap( FT_Memory       memory,
+                  const FT_Byte*  code,
+                  FT_Long         size,
+                  FT_UShort*     *amap );
+
 
   FT_LOCAL( FT_Error )
   Update_Max( FT_Memory  memory,
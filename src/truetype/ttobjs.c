@@ -22,6 +22,7 @@
 #include FT_TRUETYPE_TAGS_H
 #include FT_INTERNAL_SFNT_H
 #include FT_DRIVER_H
+#include FT_LIST_H
 
 #include "ttgload.h"
 #include "ttpload.h"
@@ -753,6 +754,22 @@
   }
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  /* destructor for the items of `face->prep_results' */
+  static void
+  tt_face_done_prep_result( FT_Memory  memory,
+                            void*      data,
+                            void*      user )
+  {
+    FT_UNUSED( user );
+
+    FT_FREE( data );
+  }
+
+#endif
+
+
   /**************************************************************************
    *
    * @Function:
@@ -803,6 +820,17 @@
     face->font_program_size = 0;
     face->cvt_program_size  = 0;
 
+    FT_FREE( face->font_program_map );
+    FT_FREE( face->cvt_program_map );
+
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    FT_List_Finalize( &face->prep_results,
+                      tt_face_done_prep_result,
+                      memory,
+                      NULL );
+    face->prep_results_id = 0;
+#endif
+
 #ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
     tt_done_blend( face );
     face->blend = NULL;
@@ -878,11 +906,23 @@
       tt_metrics->ratio = 0x10000L;
     }
 
+    /* the jump map is shared by all sizes */
+    if ( face->font_program_size > 0 && !face->font_program_map )
+    {
+      error = TT_New_CodeMap( face->root.memory,
+                              face->font_program,
+                              (FT_Long)face->font_program_size,
+                              &face->font_program_map );
+      if ( error )
+        return error;
+    }
+
     /* allow font program execution */
     TT_Set_CodeRange( exec,
                       tt_coderange_font,
                       face->font_program,
-                      (FT_Long)face->font_program_size );
+                      (FT_Long)face->font_program_size,
+                      face->font_program_map );
 
     /* disable CVT and glyph programs coderange */
     TT_Clear_CodeRange( exec, tt_coderange_cvt );
@@ -952,10 +992,21 @@
 
     exec->pedantic_hinting = pedantic;
 
+    if ( face->cvt_program_size > 0 && !face->cvt_program_map )
+    {
+      error = TT_New_CodeMap( face->root.memory,
+                              face->cvt_program,
+                              (FT_Long)face->cvt_program_size,
+                              &face->cvt_program_map );
+      if ( error )
+        return error;
+    }
+
     TT_Set_CodeRange( exec,
                       tt_coderange_cvt,
                       face->cvt_program,
-                      (FT_Long)face->cvt_program_size );
+                      (FT_Long)face->cvt_program_size,
+                      face->cvt_program_map );
 
     TT_Clear_CodeRange( exec, tt_coderange_glyph );
 
@@ -1005,6 +1056,432 @@
   }
 
 
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_hinting_mode
+   *
+   * @Description:
+   *   Return the settings of the interpreter that bytecode can query (or
+   *   that change its execution) but that don't depend on the size
+   *   object.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   pedantic ::
+   *     Set if bytecode execution is pedantic.
+   *
+   * @Return:
+   *   A bit field.  It is part of the key of cached hinted glyphs and of
+   *   shared `prep' results.
+   */
+  FT_LOCAL_DEF( FT_UInt )
+  tt_size_hinting_mode( TT_Size  size,
+                        FT_Bool  pedantic )
+  {
+    TT_Driver       driver = (TT_Driver)size->root.face->driver;
+    TT_ExecContext  exec   = size->context;
+    FT_UInt         mode;
+
+
+    mode = driver->interpreter_version << 8;
+
+    if ( pedantic )
+      mode |= 2;
+
+    /* a new execution context has all flags unset */
+    if ( !exec )
+      return mode;
+
+    if ( exec->grayscale )
+      mode |= 1;
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    if ( exec->subpixel_hinting_lean )
+      mode |= 4;
+    if ( exec->grayscale_cleartype )
+      mode |= 8;
+    if ( exec->vertical_lcd_lean )
+      mode |= 16;
+#endif
+
+    return mode;
+  }
+
+
+  /* Results of `prep' are only shared if `fpgm' is the only source of  */
+  /* function and instruction definitions (that is, the definitions     */
+  /* are the same for all size objects), and if no debugger wants to    */
+  /* see the bytecode being executed.                                   */
+  static FT_Bool
+  tt_size_can_share_prep( TT_Size  size )
+  {
+    TT_Face     face    = (TT_Face)size->root.face;
+    FT_Library  library = face->root.driver->root.library;
+    FT_UInt     n;
+
+
+    if ( library->debug_hooks[FT_DEBUG_HOOK_TRUETYPE] )
+      return FALSE;
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+    {
+      TT_Driver  driver = (TT_Driver)face->root.driver;
+
+
+      /* the tweaks of the v38 interpreter depend on too many things */
+      if ( driver->interpreter_version == TT_INTERPRETER_VERSION_38 )
+        return FALSE;
+    }
+#endif
+
+    for ( n = 0; n < size->num_function_defs; n++ )
+      if ( size->function_defs[n].range == tt_coderange_cvt )
+        return FALSE;
+
+    for ( n = 0; n < size->num_instruction_defs; n++ )
+      if ( size->instruction_defs[n].range == tt_coderange_cvt )
+        return FALSE;
+
+    return TRUE;
+  }
+
+
+  /* Return the normalized design coordinates the CVT depends on. */
+  static FT_UInt
+  tt_face_get_prep_coords( TT_Face     face,
+                           FT_Fixed*  *acoords )
+  {
+#ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
+    if ( face->doblend && face->blend )
+    {
+      *acoords = face->blend->normalizedcoords;
+      return face->blend->num_axis;
+    }
+#else
+    FT_UNUSED( face );
+#endif
+
+    *acoords = NULL;
+    return 0;
+  }
+
+
+  static FT_Bool
+  tt_prep_result_match( TT_PrepResult  result,
+                        TT_Size        size,
+                        FT_UInt        mode,
+                        FT_ULong       parent,
+                        FT_UInt        num_coords,
+                        FT_Fixed*      coords )
+  {
+    FT_Size_Metrics*  metrics   = size->metrics;
+    TT_Size_Metrics*  ttmetrics = &size->ttmetrics;
+    FT_UInt           n;
+
+
+    if ( result->parent     != parent           ||
+         result->mode       != mode             ||
+         result->fpgm_mode  != size->fpgm_mode  ||
+         result->point_size != size->point_size ||
+         result->num_coords != num_coords       )
+      return FALSE;
+
+    if ( result->metrics.x_ppem  != metrics->x_ppem  ||
+         result->metrics.y_ppem  != metrics->y_ppem  ||
+         result->metrics.x_scale != metrics->x_scale ||
+         result->metrics.y_scale != metrics->y_scale )
+      return FALSE;
+
+    if ( result->ttmetrics.ppem      != ttmetrics->ppem      ||
+         result->ttmetrics.scale     != ttmetrics->scale     ||
+         result->ttmetrics.ratio     != ttmetrics->ratio     ||
+         result->ttmetrics.x_ratio   != ttmetrics->x_ratio   ||
+         result->ttmetrics.y_ratio   != ttmetrics->y_ratio   ||
+         result->ttmetrics.rotated   != ttmetrics->rotated   ||
+         result->ttmetrics.stretched != ttmetrics->stretched )
+      return FALSE;
+
+    for ( n = 0; n < num_coords; n++ )
+      if ( result->coords[n] != coords[n] )
+        return FALSE;
+
+    return TRUE;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_find_prep
+   *
+   * @Description:
+   *   Look up the state of the bytecode interpreter that running `prep'
+   *   would result in, as computed earlier by another size object (or by
+   *   the same one).
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   pedantic ::
+   *     Set if bytecode execution is pedantic.
+   *
+   *   parent ::
+   *     The identifier of the shared result the state of `size' is equal
+   *     to, or zero if `prep' starts with a cleared state.
+   *
+   * @Return:
+   *   The shared result, or NULL if there is none.
+   */
+  static TT_PrepResult
+  tt_size_find_prep( TT_Size   size,
+                     FT_Bool   pedantic,
+                     FT_ULong  parent )
+  {
+    TT_Face      face = (TT_Face)size->root.face;
+    FT_ListNode  node;
+    FT_UInt      mode;
+    FT_UInt      num_coords;
+    FT_Fixed*    coords;
+
+
+    if ( !tt_size_can_share_prep( size ) )
+      return NULL;
+
+    mode       = tt_size_hinting_mode( size, pedantic );
+    num_coords = tt_face_get_prep_coords( face, &coords );
+
+    for ( node = face->prep_results.head; node; node = node->next )
+    {
+      TT_PrepResult  result = (TT_PrepResult)node->data;
+
+
+      if ( tt_prep_result_match( result, size, mode, parent,
+                                 num_coords, coords ) )
+      {
+        FT_List_Up( &face->prep_results, node );
+        return result;
+      }
+    }
+
+    return NULL;
+  }
+
+
+  /* Copy a shared `prep' result into the size object. */
+  static void
+  tt_size_apply_prep( TT_Size        size,
+                      TT_PrepResult  result )
+  {
+    FT_Int  i;
+
+
+    size->num_function_defs    = result->num_function_defs;
+    size->num_instruction_defs = result->num_instruction_defs;
+
+    /* some of the arrays might be empty (and thus NULL) */
+    if ( result->num_function_defs )
+      FT_ARRAY_COPY( size->function_defs,
+                     result->function_defs,
+                     result->num_function_defs );
+    if ( result->num_instruction_defs )
+      FT_ARRAY_COPY( size->instruction_defs,
+                     result->instruction_defs,
+                     result->num_instruction_defs );
+
+    size->max_func = result->max_func;
+    size->max_ins  = result->max_ins;
+
+    for ( i = 0; i < TT_MAX_CODE_RANGES; i++ )
+      size->codeRangeTable[i] = result->codeRangeTable[i];
+
+    size->GS = result->GS;
+
+    if ( size->cvt_size )
+      FT_ARRAY_COPY( size->cvt, result->cvt, size->cvt_size );
+    if ( size->storage_size )
+      FT_ARRAY_COPY( size->storage, result->storage, size->storage_size );
+
+    FT_ARRAY_COPY( size->twilight.org,
+                   result->twilight_org,
+                   size->twilight.n_points );
+    FT_ARRAY_COPY( size->twilight.cur,
+                   result->twilight_cur,
+                   size->twilight.n_points );
+    FT_ARRAY_COPY( size->twilight.tags,
+                   result->twilight_tags,
+                   size->twilight.n_points );
+
+    /* all hinted outlines are stale now */
+    if ( size->hinted.buckets )
+    {
+      tt_size_flush_hinted( size );
+
+      FT_ARRAY_ZERO( size->hinted.storage_stamps, size->storage_size );
+      FT_ARRAY_ZERO( size->hinted.cvt_stamps, size->cvt_size );
+
+      tt_size_save_hinted_twilight( size );
+    }
+
+    size->bytecode_ready = 0;
+    size->cvt_ready      = 0;
+    size->prep_id        = result->id;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_store_prep
+   *
+   * @Description:
+   *   Make the state of the bytecode interpreter after a successful run
+   *   of `prep' available to other size objects.  The least recently
+   *   used result gets discarded if there are already
+   *   TT_MAX_PREP_RESULTS of them.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   pedantic ::
+   *     Set if bytecode execution was pedantic.
+   *
+   *   parent ::
+   *     The identifier of the shared result `prep' started from, or zero
+   *     if it started with a cleared state.
+   *
+   * @Note:
+   *   Errors are ignored; the result is simply not shared then.
+   */
+  static void
+  tt_size_store_prep( TT_Size   size,
+                      FT_Bool   pedantic,
+                      FT_ULong  parent )
+  {
+    TT_Face        face       = (TT_Face)size->root.face;
+    FT_Memory      memory     = face->root.memory;
+    FT_ListNode    node       = NULL;
+    TT_PrepResult  result     = NULL;
+    FT_UInt        n_twilight = size->twilight.n_points;
+    FT_UInt        num_coords;
+    FT_Fixed*      coords;
+    FT_UInt        count;
+    FT_Int         i;
+    FT_Byte*       p;
+    FT_Error       error;
+
+
+    size->prep_id = 0;
+
+    if ( !tt_size_can_share_prep( size ) )
+      return;
+
+    num_coords = tt_face_get_prep_coords( face, &coords );
+
+    /* recycle the node of the least recently used result if necessary */
+    count = 0;
+    for ( node = face->prep_results.head; node; node = node->next )
+      count++;
+
+    if ( count >= TT_MAX_PREP_RESULTS )
+    {
+      node = face->prep_results.tail;
+      FT_List_Remove( &face->prep_results, node );
+      FT_FREE( node->data );
+    }
+    else if ( FT_QNEW( node ) )
+      return;
+
+    /* all array elements but the tags are `long'-aligned */
+    if ( FT_QALLOC( result,
+                    sizeof ( TT_PrepResultRec )                           +
+                      ( size->num_function_defs                 +
+                        size->num_instruction_defs )    *
+                        sizeof ( TT_DefRecord )                           +
+                      ( size->cvt_size + size->storage_size ) *
+                        sizeof ( FT_Long )                                +
+                      num_coords * sizeof ( FT_Fixed )                    +
+                      2 * n_twilight * sizeof ( FT_Vector )               +
+                      n_twilight                                          ) )
+    {
+      FT_FREE( node );
+      return;
+    }
+
+    if ( !++face->prep_results_id )
+      face->prep_results_id = 1;
+
+    result->id        = face->prep_results_id;
+    result->parent    = parent;
+    result->metrics   = *size->metrics;
+    result->ttmetrics = size->ttmetrics;
+
+    result->point_size = size->point_size;
+    result->fpgm_mode  = size->fpgm_mode;
+    result->mode       = tt_size_hinting_mode( size, pedantic );
+    result->num_coords = num_coords;
+
+    result->num_function_defs    = size->num_function_defs;
+    result->num_instruction_defs = size->num_instruction_defs;
+
+    result->max_func = size->max_func;
+    result->max_ins  = size->max_ins;
+
+    for ( i = 0; i < TT_MAX_CODE_RANGES; i++ )
+      result->codeRangeTable[i] = size->codeRangeTable[i];
+
+    result->GS = size->GS;
+
+    p = (FT_Byte*)( result + 1 );
+
+    result->function_defs = (TT_DefArray)p;
+    p += size->num_function_defs * sizeof ( TT_DefRecord );
+    result->instruction_defs = (TT_DefArray)p;
+    p += size->num_instruction_defs * sizeof ( TT_DefRecord );
+    result->cvt = (FT_Long*)p;
+    p += size->cvt_size * sizeof ( FT_Long );
+    result->storage = (FT_Long*)p;
+    p += size->storage_size * sizeof ( FT_Long );
+    result->coords = (FT_Fixed*)p;
+    p += num_coords * sizeof ( FT_Fixed );
+    result->twilight_org = (FT_Vector*)p;
+    p += n_twilight * sizeof ( FT_Vector );
+    result->twilight_cur = (FT_Vector*)p;
+    p += n_twilight * sizeof ( FT_Vector );
+    result->twilight_tags = p;
+
+    /* some of the arrays might be empty (and thus NULL) */
+    if ( size->num_function_defs )
+      FT_ARRAY_COPY( result->function_defs,
+                     size->function_defs,
+                     size->num_function_defs );
+    if ( size->num_instruction_defs )
+      FT_ARRAY_COPY( result->instruction_defs,
+                     size->instruction_defs,
+                     size->num_instruction_defs );
+
+    if ( size->cvt_size )
+      FT_ARRAY_COPY( result->cvt, size->cvt, size->cvt_size );
+    if ( size->storage_size )
+      FT_ARRAY_COPY( result->storage, size->storage, size->storage_size );
+    if ( num_coords )
+      FT_ARRAY_COPY( result->coords, coords, num_coords );
+
+    FT_ARRAY_COPY( result->twilight_org, size->twilight.org, n_twilight );
+    FT_ARRAY_COPY( result->twilight_cur, size->twilight.cur, n_twilight );
+    FT_ARRAY_COPY( result->twilight_tags, size->twilight.tags, n_twilight );
+
+    node->data = result;
+    FT_List_Insert( &face->prep_results, node );
+
+    size->prep_id = result->id;
+  }
+
+
   static void
   tt_size_done_bytecode( FT_Size  ftsize )
   {
@@ -1018,6 +1495,8 @@
       size->context = NULL;
     }
 
+    tt_size_done_hinted( size );
+
     FT_FREE( size->cvt );
     size->cvt_size = 0;
 
@@ -1041,6 +1520,7 @@
 
     size->bytecode_ready = -1;
     size->cvt_ready      = -1;
+    size->prep_id        = 0;
   }
 
 
@@ -1060,6 +1540,8 @@
 
 
     /* clean up bytecode related data */
+    tt_size_done_hinted( size );
+
     FT_FREE( size->function_defs );
     FT_FREE( size->instruction_defs );
     FT_FREE( size->cvt );
@@ -1071,6 +1553,7 @@
 
     size->bytecode_ready = -1;
     size->cvt_ready      = -1;
+    size->prep_id        = 0;
 
     size->context = TT_New_Context( (TT_Driver)face->root.driver );
 
@@ -1133,6 +1616,24 @@
         face->interpreter = (TT_Interpreter)TT_RunIns;
     }
 
+    size->fpgm_mode = tt_size_hinting_mode( size, pedantic );
+
+    /* If another size object with the same scaling has already run   */
+    /* `prep', use its result; this includes the function definitions */
+    /* of `fpgm', which don't depend on the size.                      */
+    {
+      TT_PrepResult  result = tt_size_find_prep( size, pedantic, 0 );
+
+
+      if ( result )
+      {
+        FT_TRACE4(( "Using shared `fpgm' and `prep' results.\n" ));
+
+        tt_size_apply_prep( size, result );
+        return FT_Err_Ok;
+      }
+    }
+
     /* Fine, now run the font program! */
 
     /* In case of an error while executing `fpgm', we intentionally don't */
@@ -1170,9 +1671,18 @@
     /* rescale CVT when needed */
     if ( size->cvt_ready < 0 )
     {
-      FT_UInt  i;
-      TT_Face  face = (TT_Face)size->root.face;
+      FT_UInt        i;
+      TT_Face        face   = (TT_Face)size->root.face;
+      TT_PrepResult  result = tt_size_find_prep( size, pedantic, 0 );
+
 
+      if ( result )
+      {
+        FT_TRACE4(( "Using shared `prep' result.\n" ));
+
+        tt_size_apply_prep( size, result );
+        goto Exit;
+      }
 
       /* Scale the cvt values to the new ppem.          */
       /* We use by default the y ppem to scale the CVT. */
@@ -1192,9 +1702,23 @@
       for ( i = 0; i < (FT_UInt)size->storage_size; i++ )
         size->storage[i] = 0;
 
+      /* all hinted outlines are stale now */
+      if ( size->hinted.buckets )
+      {
+        tt_size_flush_hinted( size );
+
+        FT_ARRAY_ZERO( size->hinted.storage_stamps, size->storage_size );
+        FT_ARRAY_ZERO( size->hinted.cvt_stamps, size->cvt_size );
+      }
+
       size->GS = tt_default_graphics_state;
 
       error = tt_size_run_prep( size, pedantic );
+      if ( !error )
+        tt_size_store_prep( size, pedantic, 0 );
+
+      if ( size->hinted.buckets )
+        tt_size_save_hinted_twilight( size );
     }
     else
       error = size->cvt_ready;
@@ -1203,6 +1727,413 @@
     return error;
   }
 
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_rerun_prep
+   *
+   * @Description:
+   *   Run the control value program again after a change of the rendering
+   *   mode.  Unlike `tt_size_ready_bytecode', the storage area, the
+   *   twilight zone, and the graphics state are not reset.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   pedantic ::
+   *     Set if bytecode execution should be pedantic.
+   *
+   * @Return:
+   *   FreeType error code.  0 means success.
+   *
+   * @Note:
+   *   The execution context of `size' must be loaded; it is updated with
+   *   the new state.
+   */
+  FT_LOCAL_DEF( FT_Error )
+  tt_size_rerun_prep( TT_Size  size,
+                      FT_Bool  pedantic )
+  {
+    TT_Face        face   = (TT_Face)size->root.face;
+    FT_ULong       parent = size->prep_id;
+    TT_PrepResult  result = NULL;
+    FT_UInt        i;
+    FT_Error       error;
+
+
+    /* a shared result can only be used if no glyph program has */
+    /* modified the state computed by `prep' in the meantime    */
+    if ( parent )
+      result = tt_size_find_prep( size, pedantic, parent );
+
+    if ( result )
+    {
+      FT_TRACE4(( "Using shared `prep' result.\n" ));
+
+      tt_size_apply_prep( size, result );
+
+      return TT_Load_Context( size->context, face, size );
+    }
+
+    for ( i = 0; i < size->cvt_size; i++ )
+      size->cvt[i] = FT_MulFix( face->cvt[i], size->ttmetrics.scale );
+
+    /* the CVT is back to the values computed by `prep'; we assume */
+    /* that they only depend on the rendering mode, which is part  */
+    /* of the key of cached hinted glyphs                          */
+    if ( size->hinted.cvt_stamps )
+      for ( i = 0; i < size->cvt_size; i++ )
+        size->hinted.cvt_stamps[i] &= 1;
+
+    error = tt_size_run_prep( size, pedantic );
+
+    /* as with the CVT, we assume that the twilight zone computed by */
+    /* `prep' only depends on the rendering mode                     */
+    if ( size->hinted.buckets )
+      tt_size_save_hinted_twilight( size );
+
+    if ( error )
+      return error;
+
+    if ( parent )
+      tt_size_store_prep( size, pedantic, parent );
+
+    return FT_Err_Ok;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_init_hinted
+   *
+   * @Description:
+   *   Activate the cache of hinted glyph outlines for a size object.  From
+   *   now on, the glyph loader tracks the accesses of glyph programs to
+   *   the storage area and the CVT.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   * @Return:
+   *   FreeType error code.  0 means success.
+   */
+  FT_LOCAL_DEF( FT_Error )
+  tt_size_init_hinted( TT_Size  size )
+  {
+    TT_HintedCache  cache  = &size->hinted;
+    FT_Memory       memory = size->root.face->memory;
+    FT_Error        error;
+
+
+    if ( FT_NEW_ARRAY( cache->buckets, TT_HINTED_BUCKETS )           ||
+         FT_NEW_ARRAY( cache->storage_stamps, size->storage_size )    ||
+         FT_NEW_ARRAY( cache->cvt_stamps, size->cvt_size )            ||
+         FT_NEW_ARRAY( cache->twilight_org, size->twilight.n_points ) ||
+         FT_NEW_ARRAY( cache->twilight_cur, size->twilight.n_points ) )
+    {
+      tt_size_done_hinted( size );
+      return error;
+    }
+
+    tt_size_save_hinted_twilight( size );
+
+    return FT_Err_Ok;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_done_hinted
+   *
+   * @Description:
+   *   Deactivate the cache of hinted glyph outlines for a size object and
+   *   release its memory.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_size_done_hinted( TT_Size  size )
+  {
+    TT_HintedCache  cache  = &size->hinted;
+    FT_Memory       memory = size->root.face->memory;
+
+
+    if ( cache->buckets )
+      tt_size_flush_hinted( size );
+
+    FT_FREE( cache->buckets );
+    FT_FREE( cache->storage_stamps );
+    FT_FREE( cache->cvt_stamps );
+    FT_FREE( cache->twilight_org );
+    FT_FREE( cache->twilight_cur );
+
+    cache->serial = 0;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_flush_hinted
+   *
+   * @Description:
+   *   Remove all hinted glyph outlines from the cache of a size object.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_size_flush_hinted( TT_Size  size )
+  {
+    TT_HintedCache  cache  = &size->hinted;
+    FT_Memory       memory = size->root.face->memory;
+    TT_HintedGlyph  entry  = cache->oldest;
+
+
+    cache->twilight_read = FALSE;
+
+    if ( !entry )
+      return;
+
+    FT_TRACE5(( "tt_size_flush_hinted: flushing %ld bytes\n",
+                cache->size ));
+
+    while ( entry )
+    {
+      TT_HintedGlyph  newer = entry->newer;
+
+
+      FT_FREE( entry );
+      entry = newer;
+    }
+
+    FT_ARRAY_ZERO( cache->buckets, TT_HINTED_BUCKETS );
+
+    cache->oldest = NULL;
+    cache->newest = NULL;
+    cache->size   = 0;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_save_hinted_twilight
+   *
+   * @Description:
+   *   Copy the twilight zone of a size object, as computed by `prep', to
+   *   its cache of hinted glyph outlines.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_size_save_hinted_twilight( TT_Size  size )
+  {
+    TT_HintedCache  cache = &size->hinted;
+
+
+    FT_ARRAY_COPY( cache->twilight_org,
+                   size->twilight.org,
+                   size->twilight.n_points );
+    FT_ARRAY_COPY( cache->twilight_cur,
+                   size->twilight.cur,
+                   size->twilight.n_points );
+
+    cache->twilight_dirty = FALSE;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_check_hinted_twilight
+   *
+   * @Description:
+   *   Compare the twilight zone of a size object to the copy saved by
+   *   `tt_size_save_hinted_twilight'.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   * @Return:
+   *   TRUE if the twilight zone has changed.
+   */
+  FT_LOCAL_DEF( FT_Bool )
+  tt_size_check_hinted_twilight( TT_Size  size )
+  {
+    TT_HintedCache  cache = &size->hinted;
+    FT_UInt         n;
+
+
+    for ( n = 0; n < size->twilight.n_points; n++ )
+      if ( cache->twilight_org[n].x != size->twilight.org[n].x ||
+           cache->twilight_org[n].y != size->twilight.org[n].y ||
+           cache->twilight_cur[n].x != size->twilight.cur[n].x ||
+           cache->twilight_cur[n].y != size->twilight.cur[n].y )
+        return TRUE;
+
+    return FALSE;
+  }
+
+
+  /* remove the oldest record from the cache */
+  static void
+  tt_size_evict_hinted( TT_Size  size )
+  {
+    TT_HintedCache   cache  = &size->hinted;
+    FT_Memory        memory = size->root.face->memory;
+    TT_HintedGlyph   entry  = cache->oldest;
+    TT_HintedGlyph*  pentry;
+
+
+    pentry = cache->buckets + entry->glyph_index % TT_HINTED_BUCKETS;
+    while ( *pentry != entry )
+      pentry = &(*pentry)->link;
+    *pentry = entry->link;
+
+    cache->oldest = entry->newer;
+    if ( !cache->oldest )
+      cache->newest = NULL;
+
+    cache->size -= sizeof ( TT_HintedGlyphRec ) +
+                   entry->n_points * ( sizeof ( FT_Vector ) + 1 );
+
+    FT_FREE( entry );
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_lookup_hinted
+   *
+   * @Description:
+   *   Look up a hinted glyph outline in the cache of a size object.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   glyph_index ::
+   *     The glyph index.
+   *
+   *   mode ::
+   *     The rendering mode the outline was hinted for, as computed by the
+   *     glyph loader.
+   *
+   * @Return:
+   *   The cached outline, or NULL if there is none.
+   */
+  FT_LOCAL_DEF( TT_HintedGlyph )
+  tt_size_lookup_hinted( TT_Size  size,
+                         FT_UInt  glyph_index,
+                         FT_UInt  mode )
+  {
+    TT_HintedGlyph  entry;
+
+
+    entry = size->hinted.buckets[glyph_index % TT_HINTED_BUCKETS];
+    for ( ; entry; entry = entry->link )
+      if ( entry->glyph_index == glyph_index && entry->mode == mode )
+        break;
+
+    return entry;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_store_hinted
+   *
+   * @Description:
+   *   Add a hinted glyph outline to the cache of a size object.  The
+   *   oldest records are removed if the cache would otherwise grow beyond
+   *   `max_size' bytes.  Failures are silently ignored.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the size object.
+   *
+   *   glyph_index ::
+   *     The glyph index.
+   *
+   *   mode ::
+   *     The rendering mode the outline was hinted for.
+   *
+   *   zone ::
+   *     The glyph zone holding the hinted points, including the phantom
+   *     points.
+   *
+   *   backward_compatibility ::
+   *     The value of the execution context's `backward_compatibility'
+   *     field after running the glyph program.
+   *
+   *   max_size ::
+   *     The maximum size of the cache in bytes.
+   */
+  FT_LOCAL_DEF( void )
+  tt_size_store_hinted( TT_Size       size,
+                        FT_UInt       glyph_index,
+                        FT_UInt       mode,
+                        TT_GlyphZone  zone,
+                        FT_Bool       backward_compatibility,
+                        FT_ULong      max_size )
+  {
+    TT_HintedCache   cache  = &size->hinted;
+    FT_Memory        memory = size->root.face->memory;
+    FT_Error         error;
+    TT_HintedGlyph   entry;
+    TT_HintedGlyph*  bucket;
+    FT_ULong         entry_size;
+
+
+    entry_size = sizeof ( TT_HintedGlyphRec ) +
+                 zone->n_points * ( sizeof ( FT_Vector ) + 1 );
+    if ( entry_size > max_size )
+      return;
+
+    while ( cache->oldest && cache->size + entry_size > max_size )
+      tt_size_evict_hinted( size );
+
+    if ( FT_ALLOC( entry, entry_size ) )
+      return;
+
+    entry->glyph_index            = glyph_index;
+    entry->mode                   = mode;
+    entry->n_points               = zone->n_points;
+    entry->backward_compatibility = backward_compatibility;
+
+    entry->points = (FT_Vector*)( entry + 1 );
+    entry->tags   = (FT_Byte*)( entry->points + zone->n_points );
+
+    FT_ARRAY_COPY( entry->points, zone->cur, zone->n_points );
+    FT_ARRAY_COPY( entry->tags, zone->tags, zone->n_points );
+
+    bucket      = cache->buckets + glyph_index % TT_HINTED_BUCKETS;
+    entry->link = *bucket;
+    *bucket     = entry;
+
+    if ( cache->newest )
+      cache->newest->newer = entry;
+    else
+      cache->oldest = entry;
+    cache->newest = entry;
+
+    cache->size += entry_size;
+  }
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
 
@@ -1408,6 +2339,8 @@
     driver->interpreter_version = TT_INTERPRETER_VERSION_40;
 #endif
 
+    driver->hinted_cache_size = 0;
+
 #else /* !TT_USE_BYTECODE_INTERPRETER */
 
     FT_UNUSED( ttdriver );
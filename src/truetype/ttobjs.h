@@ -144,8 +144,9 @@ FT_BEGIN_HEADER
 
   typedef struct  TT_CodeRange_
   {
-    FT_Byte*  base;
-    FT_Long   size;
+    FT_Byte*    base;
+    FT_Long     size;
+    FT_UShort*  map;   /* see `TT_New_CodeMap'; can be NULL */
 
   } TT_CodeRange;
 
@@ -268,6 +269,126 @@ FT_BEGIN_HEADER
   } TT_Size_Metrics;
 
 
+  /**************************************************************************
+   *
+   * A hinted glyph outline, as cached by `tt_size_store_hinted'.  The
+   * `points' and `tags' arrays follow the record in the same memory
+   * block; they hold `n_points' entries, including the four phantom
+   * points.
+   */
+  typedef struct TT_HintedGlyphRec_*  TT_HintedGlyph;
+
+  typedef struct  TT_HintedGlyphRec_
+  {
+    TT_HintedGlyph  link;         /* next record in hash bucket     */
+    TT_HintedGlyph  newer;        /* next record in insertion order */
+
+    FT_UInt         glyph_index;
+    FT_UInt         mode;         /* rendering mode of the hints    */
+    FT_UShort       n_points;
+    FT_Bool         backward_compatibility;
+
+    FT_Vector*      points;
+    FT_Byte*        tags;
+
+  } TT_HintedGlyphRec;
+
+
+#define TT_HINTED_BUCKETS  64
+
+
+  /**************************************************************************
+   *
+   * The cache of hinted glyph outlines of a size object.
+   *
+   * A cached outline is only valid as long as the glyph program would
+   * compute the same result again.  For this reason, all accesses of
+   * glyph programs to the storage area and the CVT are tracked while the
+   * cache is active: `storage_stamps' and `cvt_stamps' hold for each
+   * location the serial number of the last glyph program run that wrote
+   * it (or zero if it still has the value computed by `prep'), shifted
+   * left by one bit.  Bit~0 is set if a glyph program has read the value
+   * computed by `prep', and cached outlines might thus depend on it.
+   *
+   * A glyph program that reads a location last written by another glyph
+   * program is not cached, and a glyph program that changes a location
+   * with bit~0 set flushes the cache.
+   *
+   * The twilight zone is tracked as a whole, comparing it to a copy made
+   * after running `prep' (`twilight_org' and `twilight_cur').  A glyph
+   * program that selects the twilight zone is only cached if the zone
+   * equals the copy both before and after the run.  A glyph program that
+   * leaves the zone changed flushes the cache if any cached outline
+   * depends on the copy (`twilight_read').
+   */
+  typedef struct  TT_HintedCacheRec_
+  {
+    TT_HintedGlyph*  buckets;
+    TT_HintedGlyph   oldest;
+    TT_HintedGlyph   newest;
+    FT_ULong         size;          /* memory used by the records */
+
+    FT_ULong         serial;        /* of the last glyph program run */
+    FT_ULong*        storage_stamps;
+    FT_ULong*        cvt_stamps;
+
+    FT_Vector*       twilight_org;
+    FT_Vector*       twilight_cur;
+    FT_Bool          twilight_read;
+    FT_Bool          twilight_dirty;  /* zone differs from the copy */
+
+  } TT_HintedCacheRec, *TT_HintedCache;
+
+
+  /**************************************************************************
+   *
+   * The state of the bytecode interpreter after running `prep', as shared
+   * between the size objects of a face by `tt_size_store_prep'.  It
+   * depends on everything `prep' can query: the scaling, the rendering
+   * mode, the settings used for running `fpgm', the design coordinates
+   * of a variation font, and the state `prep' starts from -- either a
+   * cleared one (`parent' is zero), or the result of running `prep' with
+   * a different rendering mode.
+   *
+   * The arrays follow the record in the same memory block.
+   */
+  typedef struct  TT_PrepResultRec_
+  {
+    FT_ULong           id;
+    FT_ULong           parent;
+
+    FT_Size_Metrics    metrics;
+    TT_Size_Metrics    ttmetrics;
+    FT_Long            point_size;
+    FT_UInt            fpgm_mode;
+    FT_UInt            mode;
+    FT_UInt            num_coords;
+    FT_Fixed*          coords;
+
+    FT_UInt            num_function_defs;
+    FT_UInt            num_instruction_defs;
+    TT_DefArray        function_defs;
+    TT_DefArray        instruction_defs;
+
+    FT_UInt            max_func;
+    FT_UInt            max_ins;
+
+    TT_CodeRangeTable  codeRangeTable;
+    TT_GraphicsState   GS;
+
+    FT_Long*           cvt;
+    FT_Long*           storage;
+
+    FT_Vector*         twilight_org;
+    FT_Vector*         twilight_cur;
+    FT_Byte*           twilight_tags;
+
+  } TT_PrepResultRec, *TT_PrepResult;
+
+
+#define TT_MAX_PREP_RESULTS  16
+
+
   /**************************************************************************
    *
    * TrueType size class.
@@ -319,6 +440,12 @@ FT_BEGIN_HEADER
     FT_Error           bytecode_ready;
     FT_Error           cvt_ready;
 
+    TT_HintedCacheRec  hinted;
+
+    FT_UInt            fpgm_mode;     /* see `tt_size_hinting_mode'     */
+    FT_ULong           prep_id;       /* if nonzero, the shared `prep'  */
+                                      /* result the state is equal to   */
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
   } TT_SizeRec;
@@ -335,6 +462,7 @@ FT_BEGIN_HEADER
     TT_GlyphZoneRec  zone;     /* glyph loader points zone */
 
     FT_UInt  interpreter_version;
+    FT_ULong hinted_cache_size;  /* per size object, in bytes */
 
   } TT_DriverRec;
 
@@ -387,6 +515,42 @@ FT_BEGIN_HEADER
   tt_size_ready_bytecode( TT_Size  size,
                           FT_Bool  pedantic );
 
+  FT_LOCAL( FT_Error )
+  tt_size_rerun_prep( TT_Size  size,
+                      FT_Bool  pedantic );
+
+  FT_LOCAL( FT_UInt )
+  tt_size_hinting_mode( TT_Size  size,
+                        FT_Bool  pedantic );
+
+  FT_LOCAL( FT_Error )
+  tt_size_init_hinted( TT_Size  size );
+
+  FT_LOCAL( void )
+  tt_size_done_hinted( TT_Size  size );
+
+  FT_LOCAL( void )
+  tt_size_flush_hinted( TT_Size  size );
+
+  FT_LOCAL( void )
+  tt_size_save_hinted_twilight( TT_Size  size );
+
+  FT_LOCAL( FT_Bool )
+  tt_size_check_hinted_twilight( TT_Size  size );
+
+  FT_LOCAL( TT_HintedGlyph )
+  tt_size_lookup_hinted( TT_Size  size,
+                         FT_UInt  glyph_index,
+                         FT_UInt  mode );
+
+  FT_LOCAL( void )
+  tt_size_store_hinted( TT_Size       size,
+                        FT_UInt       glyph_index,
+                        FT_UInt       mode,
+                        TT_GlyphZone  zone,
+                        FT_Bool       backward_compatibility,
+                        FT_ULong      max_size );
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
   FT_LOCAL( FT_Error )
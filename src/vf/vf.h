@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * vf.h
+ *
+ *   FreeType font driver for TeX's VF FONT files.
+ *
+ * Copyright 1996-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef VF_H_
+#define VF_H_
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_STREAM_H
+#include FT_SYSTEM_H
+
+
+FT_BEGIN_HEADER
+
+#define  FONT_DRIVER_VF   1
+
+  /* file structure */
+#define  VF_LONG_CHAR    242
+#define  VF_FNT_DEF1     243
+#define  VF_FNT_DEF4     246
+#define  VF_PRE          247
+#define  VF_POST         248
+#define  VF_ID           202
+
+  /* DVI commands allowed in character packets */
+#define  VF_SET_CHAR_0     0
+#define  VF_SET_CHAR_127 127
+#define  VF_SET1         128
+#define  VF_SET4         131
+#define  VF_SET_RULE     132
+#define  VF_PUT1         133
+#define  VF_PUT4         136
+#define  VF_PUT_RULE     137
+#define  VF_NOP          138
+#define  VF_PUSH         141
+#define  VF_POP          142
+#define  VF_RIGHT1       143
+#define  VF_RIGHT4       146
+#define  VF_W0           147
+#define  VF_W1           148
+#define  VF_W4           151
+#define  VF_X0           152
+#define  VF_X1           153
+#define  VF_X4           156
+#define  VF_DOWN1        157
+#define  VF_DOWN4        160
+#define  VF_Y0           161
+#define  VF_Y1           162
+#define  VF_Y4           165
+#define  VF_Z0           166
+#define  VF_Z1           167
+#define  VF_Z4           170
+#define  VF_FNT_NUM_0    171
+#define  VF_FNT_NUM_63   234
+#define  VF_FNT1         235
+#define  VF_FNT4         238
+#define  VF_XXX1         239
+#define  VF_XXX4         242
+
+  /* maximum nesting of push commands within a packet */
+#define  VF_MAX_STACK    64
+
+FT_END_HEADER
+
+
+#endif /* VF_H_ */
+
+
+/* END */
@@ -0,0 +1,1096 @@
+/****************************************************************************
+ *
+ * vfdrivr.c
+ *
+ *   FreeType font driver for TeX's VF FONT files.
+ *
+ * Copyright 1996-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+#include <ft2build.h>
+
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_STREAM_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_TRUETYPE_IDS_H
+
+#include FT_SERVICE_VF_H
+#include FT_SERVICE_FONT_FORMAT_H
+
+#include "vf.h"
+#include "vfdrivr.h"
+#include "vferror.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  trace_vfdriver
+
+
+  /* convert a `fix_word' dimension to 26.6 pixels */
+#define VF_SCALE( face, d )  FT_MulDiv( (d), (face)->ds_pixels, 0x100000L )
+
+
+  /**************************************************************************
+   *
+   * Base font pool.
+   *
+   * Virtual fonts usually refer to a handful of base fonts, and many
+   * virtual fonts refer to the same ones (e.g., all faces of a family
+   * re-encoding `cmr10').  The driver object therefore unpacks each base
+   * font only once and hands out references to it.
+   *
+   */
+
+  static const char*  vf_base_font_extensions[] =
+  {
+    ".pk",
+    ".gf",
+    NULL
+  };
+
+
+  /* copy all glyphs of a base face into a pool entry */
+  static FT_Error
+  vf_pool_load_glyphs( VF_PoolEntry  entry,
+                       FT_Memory     memory )
+  {
+    FT_Face   face  = entry->face;
+    FT_UInt   count = (FT_UInt)face->num_glyphs;
+    FT_Error  error;
+
+
+    if ( FT_NEW_ARRAY( entry->glyphs, count ) )
+      return error;
+
+    for ( ; entry->num_glyphs < count; entry->num_glyphs++ )
+    {
+      FT_GlyphSlot  slot  = face->glyph;
+      VF_BaseGlyph  glyph = entry->glyphs + entry->num_glyphs;
+      FT_Byte*      src;
+      FT_UInt       pitch, r;
+
+
+      error = FT_Load_Glyph( face, entry->num_glyphs, FT_LOAD_DEFAULT );
+      if ( error )
+        return error;
+
+      if ( slot->format != FT_GLYPH_FORMAT_BITMAP        ||
+           slot->bitmap.pixel_mode != FT_PIXEL_MODE_MONO )
+        return FT_THROW( Unimplemented_Feature );
+
+      pitch = ( slot->bitmap.width + 7 ) >> 3;
+
+      glyph->left          = slot->bitmap_left;
+      glyph->top           = slot->bitmap_top;
+      glyph->advance       = slot->metrics.horiAdvance;
+      glyph->bitmap        = slot->bitmap;
+      glyph->bitmap.pitch  = (int)pitch;
+      glyph->bitmap.buffer = NULL;
+
+      if ( !pitch || !slot->bitmap.rows )
+        continue;
+
+      if ( FT_QALLOC_MULT( glyph->bitmap.buffer, slot->bitmap.rows, pitch ) )
+        return error;
+
+      src = slot->bitmap.buffer;
+      if ( slot->bitmap.pitch < 0 )
+        src -= slot->bitmap.pitch * (FT_Int)( slot->bitmap.rows - 1 );
+
+      for ( r = 0; r < slot->bitmap.rows; r++ )
+      {
+        FT_MEM_COPY( glyph->bitmap.buffer + r * pitch, src, pitch );
+        src += slot->bitmap.pitch;
+      }
+    }
+
+    return FT_Err_Ok;
+  }
+
+
+  static void
+  vf_pool_free_entry( VF_PoolEntry  entry,
+                      FT_Memory     memory )
+  {
+    FT_UInt  n;
+
+
+    for ( n = 0; n < entry->num_glyphs; n++ )
+      FT_FREE( entry->glyphs[n].bitmap.buffer );
+
+    FT_FREE( entry->glyphs );
+    FT_Done_Face( entry->face );
+    FT_FREE( entry->pathname );
+    FT_FREE( entry );
+  }
+
+
+  static FT_Error
+  vf_pool_acquire( VF_Driver      driver,
+                   const char*    pathname,
+                   VF_PoolEntry  *aentry )
+  {
+    FT_Library    library = driver->root.root.library;
+    FT_Memory     memory  = driver->root.root.memory;
+    FT_ListNode   node;
+    VF_PoolEntry  entry   = NULL;
+    FT_Face       face    = NULL;
+    FT_Error      error;
+
+
+    for ( node = driver->pool.head; node; node = node->next )
+    {
+      entry = (VF_PoolEntry)node->data;
+
+      if ( !ft_strcmp( entry->pathname, pathname ) )
+      {
+        FT_TRACE3(( "vf_pool_acquire: reusing `%s'\n", pathname ));
+
+        entry->ref_count++;
+        *aentry = entry;
+        return FT_Err_Ok;
+      }
+    }
+
+    entry = NULL;
+
+    error = FT_New_Face( library, pathname, 0, &face );
+    if ( error )
+      return error;
+
+    if ( face->face_flags & FT_FACE_FLAG_SCALABLE  ||
+         face->num_fixed_sizes < 1                 )
+    {
+      FT_TRACE2(( "vf_pool_acquire: `%s' is not a bitmap font\n",
+                  pathname ));
+      error = FT_THROW( Invalid_File_Format );
+      goto Fail;
+    }
+
+    error = FT_Select_Size( face, 0 );
+    if ( error )
+      goto Fail;
+
+    /* base fonts are addressed by character code */
+    if ( !face->charmap && face->num_charmaps > 0 )
+    {
+      error = FT_Set_Charmap( face, face->charmaps[0] );
+      if ( error )
+        goto Fail;
+    }
+
+    if ( FT_NEW( entry )                                   ||
+         FT_ALLOC( entry->pathname, ft_strlen( pathname ) + 1 ) )
+      goto Fail;
+
+    ft_strcpy( entry->pathname, pathname );
+    entry->face      = face;
+    entry->ref_count = 1;
+
+    error = vf_pool_load_glyphs( entry, memory );
+    if ( error )
+      goto Fail;
+
+    if ( FT_NEW( node ) )
+      goto Fail;
+
+    node->data = entry;
+    FT_List_Add( &driver->pool, node );
+
+    FT_TRACE3(( "vf_pool_acquire: unpacked %d glyphs of `%s'\n",
+                entry->num_glyphs, pathname ));
+
+    *aentry = entry;
+    return FT_Err_Ok;
+
+  Fail:
+    if ( entry )
+    {
+      entry->face = face;  /* closed with the entry */
+      vf_pool_free_entry( entry, memory );
+    }
+    else
+      FT_Done_Face( face );
+    return error;
+  }
+
+
+  static void
+  vf_pool_release( VF_Driver     driver,
+                   VF_PoolEntry  entry )
+  {
+    FT_Memory    memory = driver->root.root.memory;
+    FT_ListNode  node;
+
+
+    for ( node = driver->pool.head; node; node = node->next )
+    {
+      if ( node->data != entry )
+        continue;
+
+      if ( --entry->ref_count > 0 )
+        return;
+
+      FT_TRACE3(( "vf_pool_release: dropping `%s'\n", entry->pathname ));
+
+      FT_List_Remove( &driver->pool, node );
+      FT_FREE( node );
+
+      vf_pool_free_entry( entry, memory );
+      return;
+    }
+  }
+
+
+  /* find the glyph of a base font for a character code */
+  static VF_BaseGlyph
+  vf_pool_find_glyph( VF_PoolEntry  entry,
+                      FT_ULong      code )
+  {
+    /* a read-only look-up in the base font's cmap */
+    FT_UInt  gindex = FT_Get_Char_Index( entry->face, code );
+
+
+    if ( !gindex || gindex >= entry->num_glyphs )
+      return NULL;
+
+    return entry->glyphs + gindex;
+  }
+
+
+  /* open the base font of a font definition */
+  static FT_Error
+  vf_resolve_font( VF_Face     face,
+                   VF_FontDef  fd )
+  {
+    VF_Driver    driver = (VF_Driver)FT_FACE_DRIVER( face );
+    FT_Memory    memory = FT_FACE_MEMORY( face );
+    FT_String*   pathname;
+    FT_ULong     len;
+    const char*  *ext;
+    FT_Error     error;
+
+
+    /* we don't have any search path; base fonts are expected */
+    /* to live next to the virtual font itself                */
+    len = ft_strlen( face->dirname ) + ft_strlen( fd->name ) + 4;
+    if ( FT_ALLOC( pathname, len ) )
+      return error;
+
+    error = FT_THROW( Cannot_Open_Resource );
+    for ( ext = vf_base_font_extensions; *ext; ext++ )
+    {
+      ft_strcpy( pathname, face->dirname );
+      ft_strcat( pathname, fd->name );
+      ft_strcat( pathname, *ext );
+
+      error = vf_pool_acquire( driver, pathname, &fd->base );
+      if ( !error )
+        break;
+    }
+
+    if ( error )
+      FT_ERROR(( "vf_resolve_font: cannot open base font `%s'\n",
+                 fd->name ));
+
+    FT_FREE( pathname );
+    return error;
+  }
+
+
+  /**************************************************************************
+   *
+   * Character map.
+   *
+   */
+
+  typedef struct  VF_CMapRec_
+  {
+    FT_CMapRec  cmap;
+    FT_UInt     num_chars;
+    VF_Char     chars;
+
+  } VF_CMapRec, *VF_CMap;
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  vf_cmap_init( FT_CMap     vfcmap,
+                FT_Pointer  init_data )
+  {
+    VF_CMap  cmap = (VF_CMap)vfcmap;
+    VF_Face  face = (VF_Face)FT_CMAP_FACE( cmap );
+
+    FT_UNUSED( init_data );
+
+
+    cmap->num_chars = face->num_chars;
+    cmap->chars     = face->chars;
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_CALLBACK_DEF( void )
+  vf_cmap_done( FT_CMap  vfcmap )
+  {
+    VF_CMap  cmap = (VF_CMap)vfcmap;
+
+
+    cmap->num_chars = 0;
+    cmap->chars     = NULL;
+  }
+
+
+  /* return the index of the first character with code >= `charcode' */
+  static FT_UInt
+  vf_cmap_search( VF_CMap   cmap,
+                  FT_ULong  charcode )
+  {
+    FT_UInt  min = 0;
+    FT_UInt  max = cmap->num_chars;
+    FT_UInt  mid;
+
+
+    while ( min < max )
+    {
+      mid = min + ( max - min ) / 2;
+
+      if ( cmap->chars[mid].code < charcode )
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+    return min;
+  }
+
+
+  FT_CALLBACK_DEF( FT_UInt )
+  vf_cmap_char_index( FT_CMap    vfcmap,
+                      FT_UInt32  charcode )
+  {
+    VF_CMap  cmap = (VF_CMap)vfcmap;
+    FT_UInt  idx  = vf_cmap_search( cmap, charcode );
+
+
+    if ( idx < cmap->num_chars && cmap->chars[idx].code == charcode )
+      return idx + 1;
+
+    return 0;
+  }
+
+
+  FT_CALLBACK_DEF( FT_UInt )
+  vf_cmap_char_next( FT_CMap     vfcmap,
+                     FT_UInt32  *acharcode )
+  {
+    VF_CMap   cmap     = (VF_CMap)vfcmap;
+    FT_ULong  charcode = (FT_ULong)*acharcode + 1;
+    FT_UInt   idx      = vf_cmap_search( cmap, charcode );
+
+
+    if ( idx >= cmap->num_chars || cmap->chars[idx].code > 0xFFFFFFFFUL )
+    {
+      *acharcode = 0;
+      return 0;
+    }
+
+    *acharcode = (FT_UInt32)cmap->chars[idx].code;
+    return idx + 1;
+  }
+
+
+  static
+  const FT_CMap_ClassRec  vf_cmap_class =
+  {
+    sizeof ( VF_CMapRec ),
+    vf_cmap_init,
+    vf_cmap_done,
+    vf_cmap_char_index,
+    vf_cmap_char_next,
+
+    NULL, NULL, NULL, NULL, NULL
+  };
+
+
+  /**************************************************************************
+   *
+   * Faces.
+   *
+   */
+
+  FT_CALLBACK_DEF( void )
+  VF_Face_Done( FT_Face  vfface )           /* VF_Face */
+  {
+    VF_Face    face = (VF_Face)vfface;
+    FT_Memory  memory;
+    FT_UInt    i;
+
+
+    if ( !face )
+      return;
+
+    memory = FT_FACE_MEMORY( face );
+
+    for ( i = 0; i < face->num_fonts; i++ )
+    {
+      if ( face->fonts[i].base )
+      {
+        vf_pool_release( (VF_Driver)FT_FACE_DRIVER( face ),
+                         face->fonts[i].base );
+        face->fonts[i].base = NULL;
+      }
+    }
+
+    vf_free_font( face );
+
+    FT_FREE( vfface->available_sizes );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  VF_Face_Init( FT_Stream      stream,
+                FT_Face        vfface,          /* VF_Face */
+                FT_Int         face_index,
+                FT_Int         num_params,
+                FT_Parameter*  params )
+  {
+    VF_Face     face   = (VF_Face)vfface;
+    FT_Error    error  = FT_Err_Ok;
+    FT_Memory   memory = FT_FACE_MEMORY( face );
+    VF_FontDef    fd;
+    VF_PoolEntry  base;
+    FT_UInt       i;
+
+    FT_UNUSED( num_params );
+    FT_UNUSED( params );
+
+
+    FT_TRACE2(( "VF driver\n" ));
+
+    /* load font */
+    error = vf_load_font( stream, memory, face );
+    if ( FT_ERR_EQ( error, Unknown_File_Format ) )
+    {
+      FT_TRACE2(( "  not a VF file\n" ));
+      goto Exit;
+    }
+    else if ( error )
+      goto Exit;
+
+    /* VF cannot have multiple faces in a single font file. */
+    if ( face_index > 0 && ( face_index & 0xFFFF ) > 0 )
+    {
+      FT_ERROR(( "VF_Face_Init: invalid face index\n" ));
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    /* base fonts are looked up in the directory of the virtual font */
+    {
+      const char*  pathname = (const char*)stream->pathname.pointer;
+      const char*  slash    = pathname ? ft_strrchr( pathname, '/' )
+                                       : NULL;
+      FT_ULong     len      = slash ? (FT_ULong)( slash - pathname + 1 )
+                                    : 0;
+
+
+      if ( FT_ALLOC( face->dirname, len + 1 ) )
+        goto Exit;
+
+      if ( len )
+        FT_MEM_COPY( face->dirname, pathname, len );
+    }
+
+    /*
+     * The first base font determines the resolution: we assume that its
+     * bitmaps have been generated for the size the virtual font asks
+     * for.  All base fonts are opened here, while FT_New_Face has the
+     * library to itself, and not while loading glyphs; a missing one
+     * other than the first only makes the characters using it fail.
+     */
+    fd    = face->fonts;
+    error = vf_resolve_font( face, fd );
+    if ( error )
+      goto Exit;
+
+    for ( i = 1; i < face->num_fonts; i++ )
+      (void)vf_resolve_font( face, face->fonts + i );
+
+    base = fd->base;
+    if ( fd->scaled_size <= 0 )
+    {
+      error = FT_THROW( Invalid_File_Format );
+      goto Exit;
+    }
+
+    face->ds_pixels = FT_MulDiv( base->face->available_sizes->y_ppem,
+                                 0x100000L,
+                                 fd->scaled_size );
+    if ( face->ds_pixels <= 0 )
+    {
+      error = FT_THROW( Invalid_File_Format );
+      goto Exit;
+    }
+
+    face->ascender  = FT_MulDiv( base->face->size->metrics.ascender,
+                                 0x100000L,
+                                 fd->scaled_size );
+    face->descender = FT_MulDiv( base->face->size->metrics.descender,
+                                 0x100000L,
+                                 fd->scaled_size );
+
+    face->max_advance = 0;
+    for ( i = 0; i < face->num_chars; i++ )
+    {
+      FT_Pos  advance = FT_PIX_ROUND( VF_SCALE( face,
+                                                face->chars[i].tfm_width ) );
+
+
+      if ( advance > face->max_advance )
+        face->max_advance = advance;
+    }
+
+    /* we now need to fill the root FT_Face fields */
+    /* with relevant information                   */
+
+    vfface->num_faces   = 1;
+    vfface->face_index  = 0;
+    vfface->face_flags |= FT_FACE_FLAG_FIXED_SIZES |
+                          FT_FACE_FLAG_HORIZONTAL;
+
+    vfface->family_name = NULL;
+    /* glyph index 0 is an alias of the first glyph, as with BDF */
+    vfface->num_glyphs  = (FT_Long)face->num_chars + 1;
+
+    FT_TRACE4(( "  number of glyphs: %d\n", vfface->num_glyphs ));
+
+    vfface->num_fixed_sizes = 1;
+    if ( FT_NEW_ARRAY( vfface->available_sizes, 1 ) )
+      goto Exit;
+
+    {
+      FT_Bitmap_Size*  bsize = vfface->available_sizes;
+
+
+      bsize->height = (FT_Short)( ( face->ascender - face->descender +
+                                    32 ) >> 6 );
+      bsize->width  = (FT_Short)( ( face->max_advance + 32 ) >> 6 );
+      bsize->size   = FT_MulDiv( face->design_size,
+                                 7200,
+                                 72270L ) >> 14;
+      bsize->y_ppem = FT_PIX_ROUND( face->ds_pixels );
+      bsize->x_ppem = bsize->y_ppem;
+    }
+
+    /* Charmaps */
+    {
+      FT_CharMapRec  charmap;
+
+
+      charmap.face        = FT_FACE( face );
+      charmap.encoding    = FT_ENCODING_NONE;
+      charmap.platform_id = TT_PLATFORM_APPLE_UNICODE;
+      charmap.encoding_id = TT_APPLE_ID_DEFAULT;
+
+      error = FT_CMap_New( &vf_cmap_class, NULL, &charmap, NULL );
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  VF_Size_Select( FT_Size   size,
+                  FT_ULong  strike_index )
+  {
+    VF_Face  face = (VF_Face)size->face;
+
+    FT_UNUSED( strike_index );
+
+
+    FT_Select_Metrics( size->face, 0 );
+
+    size->metrics.ascender    = FT_PIX_CEIL( face->ascender );
+    size->metrics.descender   = FT_PIX_FLOOR( face->descender );
+    size->metrics.max_advance = face->max_advance;
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  VF_Size_Request( FT_Size          size,
+                   FT_Size_Request  req )
+  {
+    FT_Bitmap_Size*  bsize = size->face->available_sizes;
+    FT_Error         error = FT_ERR( Invalid_Pixel_Size );
+    FT_Long          height;
+
+
+    height = FT_REQUEST_HEIGHT( req );
+    height = ( height + 32 ) >> 6;
+
+    switch ( req->type )
+    {
+    case FT_SIZE_REQUEST_TYPE_NOMINAL:
+      if ( height == ( ( bsize->y_ppem + 32 ) >> 6 ) )
+        error = FT_Err_Ok;
+      break;
+
+    case FT_SIZE_REQUEST_TYPE_REAL_DIM:
+      if ( height == bsize->height )
+        error = FT_Err_Ok;
+      break;
+
+    default:
+      error = FT_THROW( Unimplemented_Feature );
+      break;
+    }
+
+    if ( error )
+      return error;
+    else
+      return VF_Size_Select( size, 0 );
+  }
+
+
+  /**************************************************************************
+   *
+   * Glyph composition.
+   *
+   * Character packets are interpreted twice: the first pass collects the
+   * bounding box of all pieces, the second one copies base glyph bitmaps
+   * and draws rules into the composed bitmap.  Reference points are
+   * rounded to integer pixels, as DVI drivers do.
+   *
+   */
+
+  typedef struct  VF_ComposerRec_
+  {
+    FT_Int          x_min, x_max;    /* pixel box, y axis pointing up */
+    FT_Int          y_min, y_max;
+    FT_Bool         empty;
+
+    FT_Bitmap*      target;          /* NULL during the first pass    */
+
+  } VF_ComposerRec, *VF_Composer;
+
+
+  static void
+  vf_composer_add_box( VF_Composer  comp,
+                       FT_Int       x_min,
+                       FT_Int       y_min,
+                       FT_Int       x_max,
+                       FT_Int       y_max )
+  {
+    if ( x_min >= x_max || y_min >= y_max )
+      return;
+
+    if ( comp->empty )
+    {
+      comp->x_min = x_min;
+      comp->y_min = y_min;
+      comp->x_max = x_max;
+      comp->y_max = y_max;
+      comp->empty = 0;
+      return;
+    }
+
+    if ( x_min < comp->x_min )
+      comp->x_min = x_min;
+    if ( y_min < comp->y_min )
+      comp->y_min = y_min;
+    if ( x_max > comp->x_max )
+      comp->x_max = x_max;
+    if ( y_max > comp->y_max )
+      comp->y_max = y_max;
+  }
+
+
+  /* OR a monochrome bitmap into the target, top left corner at (x,y) */
+  static void
+  vf_composer_blit( VF_Composer  comp,
+                    FT_Bitmap*   source,
+                    FT_Int       x,
+                    FT_Int       y )
+  {
+    FT_Bitmap*  target = comp->target;
+    FT_Int      col    = x - comp->x_min;
+    FT_Int      row    = comp->y_max - y;
+    FT_Int      shift  = col & 7;
+    FT_UInt     r, i;
+    FT_UInt     src_bytes;
+    FT_Byte*    src;
+    FT_Byte*    dst;
+
+
+    src       = source->buffer;
+    src_bytes = ( source->width + 7 ) >> 3;
+
+    if ( source->pitch < 0 )
+      src -= source->pitch * (FT_Int)( source->rows - 1 );
+
+    for ( r = 0; r < source->rows; r++ )
+    {
+      dst = target->buffer + ( row + (FT_Int)r ) * target->pitch + ( col >> 3 );
+
+      for ( i = 0; i < src_bytes; i++ )
+      {
+        FT_Byte  b = src[i];
+
+
+        /* mask off padding bits of the last byte */
+        if ( i == src_bytes - 1 && ( source->width & 7 ) )
+          b &= (FT_Byte)( 0xFF00U >> ( source->width & 7 ) );
+
+        dst[i] |= (FT_Byte)( b >> shift );
+        if ( shift && ( b << ( 8 - shift ) ) & 0xFF )
+          dst[i + 1] |= (FT_Byte)( b << ( 8 - shift ) );
+      }
+
+      src += source->pitch;
+    }
+  }
+
+
+  static void
+  vf_composer_fill( VF_Composer  comp,
+                    FT_Int       x_min,
+                    FT_Int       y_min,
+                    FT_Int       x_max,
+                    FT_Int       y_max )
+  {
+    FT_Bitmap*  target = comp->target;
+    FT_Int      x, y;
+
+
+    for ( y = y_min; y < y_max; y++ )
+    {
+      FT_Byte*  line = target->buffer +
+                       ( comp->y_max - 1 - y ) * target->pitch;
+
+
+      for ( x = x_min; x < x_max; x++ )
+      {
+        FT_Int  col = x - comp->x_min;
+
+
+        line[col >> 3] |= (FT_Byte)( 0x80 >> ( col & 7 ) );
+      }
+    }
+  }
+
+
+  /* interpret the commands of a character */
+  static FT_Error
+  vf_compose( VF_Face      face,
+              VF_Char      ch,
+              VF_Composer  comp )
+  {
+    FT_Error    error = FT_Err_Ok;
+    VF_Command  cmd   = face->commands + ch->first;
+    VF_Command  limit = cmd + ch->count;
+    VF_FontDef  fd    = face->fonts;
+    FT_Pos      h     = 0;
+    FT_Pos      v     = 0;
+    FT_Pos      stack[VF_MAX_STACK][2];
+    FT_Int      top   = 0;
+
+
+    for ( ; cmd < limit; cmd++ )
+    {
+      switch ( cmd->op )
+      {
+      case VF_OP_SET_CHAR:
+      case VF_OP_PUT_CHAR:
+        {
+          VF_BaseGlyph  glyph;
+          FT_Int        x, y;
+
+
+          if ( !fd->base )
+          {
+            error = FT_THROW( Cannot_Open_Resource );
+            goto Exit;
+          }
+
+          glyph = vf_pool_find_glyph( fd->base, (FT_ULong)cmd->a );
+          if ( !glyph )
+          {
+            FT_TRACE2(( "vf_compose: character %ld missing in `%s'\n",
+                        cmd->a, fd->name ));
+            break;
+          }
+
+          x = (FT_Int)( FT_PIX_ROUND( h ) >> 6 ) + glyph->left;
+          y = glyph->top - (FT_Int)( FT_PIX_ROUND( v ) >> 6 );
+
+          if ( comp->target )
+          {
+            if ( glyph->bitmap.rows && glyph->bitmap.width )
+              vf_composer_blit( comp, &glyph->bitmap, x, y );
+          }
+          else
+            vf_composer_add_box( comp,
+                                 x, y - (FT_Int)glyph->bitmap.rows,
+                                 x + (FT_Int)glyph->bitmap.width, y );
+
+          if ( cmd->op == VF_OP_SET_CHAR )
+            h += glyph->advance;
+        }
+        break;
+
+      case VF_OP_SET_RULE:
+      case VF_OP_PUT_RULE:
+        {
+          FT_Pos  height = VF_SCALE( face, cmd->a );
+          FT_Pos  width  = VF_SCALE( face, cmd->b );
+
+
+          if ( height > 0 && width > 0 )
+          {
+            FT_Int  x_min = (FT_Int)( FT_PIX_ROUND( h ) >> 6 );
+            FT_Int  y_min = -(FT_Int)( FT_PIX_ROUND( v ) >> 6 );
+            FT_Int  x_max = x_min + (FT_Int)( FT_PIX_CEIL( width ) >> 6 );
+            FT_Int  y_max = y_min + (FT_Int)( FT_PIX_CEIL( height ) >> 6 );
+
+
+            if ( comp->target )
+              vf_composer_fill( comp, x_min, y_min, x_max, y_max );
+            else
+              vf_composer_add_box( comp, x_min, y_min, x_max, y_max );
+          }
+
+          if ( cmd->op == VF_OP_SET_RULE )
+            h += width;
+        }
+        break;
+
+      case VF_OP_RIGHT:
+        h += VF_SCALE( face, cmd->a );
+        break;
+
+      case VF_OP_DOWN:
+        v += VF_SCALE( face, cmd->a );
+        break;
+
+      case VF_OP_PUSH:
+        /* the nesting depth has been checked while parsing */
+        stack[top][0] = h;
+        stack[top][1] = v;
+        top++;
+        break;
+
+      case VF_OP_POP:
+        top--;
+        h = stack[top][0];
+        v = stack[top][1];
+        break;
+
+      case VF_OP_FONT:
+        fd = face->fonts + cmd->a;
+        break;
+      }
+    }
+
+  Exit:
+    return error;
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  VF_Glyph_Load( FT_GlyphSlot  slot,
+                 FT_Size       size,
+                 FT_UInt       glyph_index,
+                 FT_Int32      load_flags )
+  {
+    VF_Face         vf     = (VF_Face)FT_SIZE_FACE( size );
+    FT_Face         face   = FT_FACE( vf );
+    FT_Error        error  = FT_Err_Ok;
+    FT_Bitmap*      bitmap = &slot->bitmap;
+    VF_ComposerRec  comp;
+    VF_Char         ch;
+
+    FT_UNUSED( load_flags );
+
+
+    if ( glyph_index >= (FT_UInt)face->num_glyphs )
+    {
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    if ( glyph_index > 0 )
+      glyph_index--;
+
+    FT_TRACE1(( "VF_Glyph_Load: glyph index %d\n", glyph_index ));
+
+    ch = vf->chars + glyph_index;
+
+    comp.empty  = 1;
+    comp.target = NULL;
+
+    error = vf_compose( vf, ch, &comp );
+    if ( error )
+      goto Exit;
+
+    bitmap->pixel_mode = FT_PIXEL_MODE_MONO;
+
+    if ( comp.empty )
+    {
+      comp.x_min = comp.x_max = 0;
+      comp.y_min = comp.y_max = 0;
+    }
+
+    bitmap->width = (unsigned int)( comp.x_max - comp.x_min );
+    bitmap->rows  = (unsigned int)( comp.y_max - comp.y_min );
+    bitmap->pitch = (int)( ( bitmap->width + 7 ) >> 3 );
+
+    if ( bitmap->rows && bitmap->width )
+    {
+      error = ft_glyphslot_alloc_bitmap( slot,
+                                         (FT_ULong)bitmap->pitch *
+                                           bitmap->rows );
+      if ( error )
+        goto Exit;
+
+      comp.target = bitmap;
+
+      error = vf_compose( vf, ch, &comp );
+      if ( error )
+        goto Exit;
+    }
+
+    slot->format      = FT_GLYPH_FORMAT_BITMAP;
+    slot->bitmap_left = comp.x_min;
+    slot->bitmap_top  = comp.y_max;
+
+    slot->metrics.horiAdvance  = FT_PIX_ROUND( VF_SCALE( vf,
+                                                         ch->tfm_width ) );
+    slot->metrics.horiBearingX = (FT_Pos)comp.x_min * 64;
+    slot->metrics.horiBearingY = (FT_Pos)comp.y_max * 64;
+    slot->metrics.width        = (FT_Pos)( bitmap->width * 64 );
+    slot->metrics.height       = (FT_Pos)( bitmap->rows * 64 );
+
+    ft_synthesize_vertical_metrics( &slot->metrics,
+                                    (FT_Pos)bitmap->rows * 64 );
+
+  Exit:
+    return error;
+  }
+
+
+  /**************************************************************************
+   *
+   * Driver.
+   *
+   */
+
+  FT_CALLBACK_DEF( FT_Error )
+  vf_driver_init( FT_Module  module )         /* VF_Driver */
+  {
+    VF_Driver  driver = (VF_Driver)module;
+
+
+    driver->pool.head = NULL;
+    driver->pool.tail = NULL;
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_CALLBACK_DEF( void )
+  vf_driver_done( FT_Module  module )         /* VF_Driver */
+  {
+    VF_Driver  driver = (VF_Driver)module;
+
+
+    /* all faces, and with them all pool references, */
+    /* are gone before the driver gets destroyed     */
+    FT_ASSERT( driver->pool.head == NULL );
+    FT_UNUSED( driver );
+  }
+
+
+ /*
+  *
+  * SERVICES LIST
+  *
+  */
+
+  static const FT_ServiceDescRec  vf_services[] =
+  {
+    { FT_SERVICE_ID_VF,          NULL },
+    { FT_SERVICE_ID_FONT_FORMAT, FT_FONT_FORMAT_VF },
+    { NULL, NULL }
+  };
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  vf_driver_requester( FT_Module    module,
+                       const char*  name )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( vf_services, name );
+  }
+
+
+  FT_CALLBACK_TABLE_DEF
+  const FT_Driver_ClassRec  vf_driver_class =
+  {
+    {
+      FT_MODULE_FONT_DRIVER         |
+      FT_MODULE_DRIVER_NO_OUTLINES,
+      sizeof ( VF_DriverRec ),
+
+      "vf",
+      0x10000L,
+      0x20000L,
+
+      NULL,                     /* module-specific interface */
+
+      vf_driver_init,           /* FT_Module_Constructor  module_init   */
+      vf_driver_done,           /* FT_Module_Destructor   module_done   */
+      vf_driver_requester       /* FT_Module_Requester    get_interface */
+    },
+
+    sizeof ( VF_FaceRec ),
+    sizeof ( FT_SizeRec ),
+    sizeof ( FT_GlyphSlotRec ),
+
+    VF_Face_Init,               /* FT_Face_InitFunc  init_face */
+    VF_Face_Done,               /* FT_Face_DoneFunc  done_face */
+    NULL,                       /* FT_Size_InitFunc  init_size */
+    NULL,                       /* FT_Size_DoneFunc  done_size */
+    NULL,                       /* FT_Slot_InitFunc  init_slot */
+    NULL,                       /* FT_Slot_DoneFunc  done_slot */
+
+    VF_Glyph_Load,              /* FT_Slot_LoadFunc  load_glyph */
+
+    NULL,                       /* FT_Face_GetKerningFunc   get_kerning  */
+    NULL,                       /* FT_Face_AttachFunc       attach_file  */
+    NULL,                       /* FT_Face_GetAdvancesFunc  get_advances */
+
+    VF_Size_Request,            /* FT_Size_RequestFunc  request_size */
+    VF_Size_Select              /* FT_Size_SelectFunc   select_size  */
+  };
+
+
+/* END */
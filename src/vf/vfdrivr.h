@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * vfdrivr.h
+ *
+ *   FreeType font driver for TeX's VF FONT files.
+ *
+ * Copyright 1996-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef VFDRIVR_H_
+#define VFDRIVR_H_
+
+#include <ft2build.h>
+#include FT_INTERNAL_DRIVER_H
+#include FT_LIST_H
+
+#include "vf.h"
+
+
+FT_BEGIN_HEADER
+
+
+  /*
+   * Character packets are translated once into a compact command array.
+   * The DVI registers w, x, y, and z only depend on the packet itself, so
+   * their values get resolved at load time; what remains are the
+   * following commands.  All dimensions are `fix_word' values relative
+   * to the design size of the virtual font.
+   */
+  typedef enum  VF_OpCode_
+  {
+    VF_OP_SET_CHAR = 0,   /* a: character code      */
+    VF_OP_PUT_CHAR,       /* a: character code      */
+    VF_OP_SET_RULE,       /* a: height, b: width    */
+    VF_OP_PUT_RULE,       /* a: height, b: width    */
+    VF_OP_RIGHT,          /* a: horizontal movement */
+    VF_OP_DOWN,           /* a: vertical movement   */
+    VF_OP_PUSH,
+    VF_OP_POP,
+    VF_OP_FONT            /* a: index in `fonts'    */
+
+  } VF_OpCode;
+
+
+  typedef struct  VF_CommandRec_
+  {
+    FT_Byte  op;
+    FT_Long  a, b;
+
+  } VF_CommandRec, *VF_Command;
+
+
+  typedef struct  VF_CharRec_
+  {
+    FT_ULong  code;
+    FT_Long   tfm_width;      /* advance width                   */
+    FT_UInt   first;          /* index of first command of glyph */
+    FT_UInt   count;          /* number of commands              */
+
+  } VF_CharRec, *VF_Char;
+
+
+  /* a glyph of a base font */
+  typedef struct  VF_BaseGlyphRec_
+  {
+    FT_Int     left;        /* bitmap offsets, in pixels  */
+    FT_Int     top;
+    FT_Pos     advance;     /* in 26.6 pixels             */
+    FT_Bitmap  bitmap;      /* monochrome, positive pitch */
+
+  } VF_BaseGlyphRec, *VF_BaseGlyph;
+
+
+  /*
+   * Base fonts are shared between all VF faces of a library; the driver
+   * object keeps them in a pool, keyed by file name.  The glyphs of a
+   * base font are unpacked when it enters the pool; afterwards, the base
+   * face is only used to map character codes to glyph indices, so that
+   * composing glyphs doesn't change any shared object.  The pool itself
+   * is changed by `VF_Face_Init' and `VF_Face_Done' only; like all calls
+   * of FT_New_Face and FT_Done_Face for a library, they must not run
+   * concurrently.
+   */
+  typedef struct  VF_PoolEntryRec_
+  {
+    FT_String*    pathname;
+    FT_Face       face;
+    FT_Int        ref_count;
+
+    FT_UInt       num_glyphs;
+    VF_BaseGlyph  glyphs;       /* by glyph index */
+
+  } VF_PoolEntryRec, *VF_PoolEntry;
+
+
+  typedef struct  VF_FontDefRec_
+  {
+    FT_Long       number;          /* font number used in packets */
+    FT_ULong      checksum;
+    FT_Long       scaled_size;
+    FT_Long       design_size;
+    FT_String*    name;            /* area and name               */
+
+    VF_PoolEntry  base;            /* shared base font, or NULL   */
+
+  } VF_FontDefRec, *VF_FontDef;
+
+
+  typedef struct  VF_FaceRec_
+  {
+    FT_FaceRec      root;
+
+    FT_Long         design_size;    /* in points, as a `fix_word'  */
+    FT_Pos          ds_pixels;      /* design size in 26.6 pixels  */
+    FT_Pos          ascender;       /* in 26.6 pixels              */
+    FT_Pos          descender;
+    FT_Pos          max_advance;
+    FT_String*      dirname;        /* directory of the VF file    */
+
+    FT_UInt         num_fonts;
+    VF_FontDef      fonts;
+
+    FT_UInt         num_chars;
+    VF_Char         chars;          /* sorted by character code    */
+
+    FT_UInt         num_commands;
+    VF_Command      commands;
+
+  } VF_FaceRec, *VF_Face;
+
+
+  typedef struct  VF_DriverRec_
+  {
+    FT_DriverRec  root;
+    FT_ListRec    pool;       /* list of `VF_PoolEntry' objects */
+
+  } VF_DriverRec, *VF_Driver;
+
+
+  FT_LOCAL( FT_Error )
+  vf_load_font( FT_Stream  stream,
+                FT_Memory  memory,
+                VF_Face    face );
+
+  FT_LOCAL( void )
+  vf_free_font( VF_Face  face );
+
+
+  FT_EXPORT_VAR( const FT_Driver_ClassRec )  vf_driver_class;
+
+
+FT_END_HEADER
+
+
+#endif /* VFDRIVR_H_ */
+
+
+/* END */
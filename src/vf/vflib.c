@@ -0,0 +1,526 @@
+/****************************************************************************
+ *
+ * vflib.c
+ *
+ *   FreeType font driver for TeX's VF FONT files.
+ *
+ * Copyright 1996-2018 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+#include <ft2build.h>
+
+#include FT_FREETYPE_H
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_STREAM_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_SYSTEM_H
+#include FT_CONFIG_CONFIG_H
+#include FT_ERRORS_H
+#include FT_TYPES_H
+
+#include "vf.h"
+#include "vfdrivr.h"
+#include "vferror.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  trace_vflib
+
+
+  /**************************************************************************
+   *
+   * VF font utility functions.
+   *
+   */
+
+  /* read a big-endian number of `size' bytes from the stream */
+  static FT_Long
+  vf_read_intn( FT_Stream  stream,
+                FT_Int     size,
+                FT_Bool    is_signed,
+                FT_Error*  aerror )
+  {
+    FT_ULong  v = 0;
+    FT_Byte   tp;
+    FT_Error  error;
+
+
+    if ( FT_READ_BYTE( tp ) )
+      goto Exit;
+
+    v = tp;
+    if ( is_signed && ( tp & 0x80 ) )
+      v = ~0xFFUL | tp;
+
+    while ( --size > 0 )
+    {
+      if ( FT_READ_BYTE( tp ) )
+        goto Exit;
+      v = ( v << 8 ) | tp;
+    }
+
+  Exit:
+    *aerror = error;
+    return (FT_Long)v;
+  }
+
+
+  /* get a big-endian number of `size' bytes from packet data */
+  static FT_Long
+  vf_get_intn( FT_Byte*  p,
+               FT_Int    size,
+               FT_Bool   is_signed )
+  {
+    FT_ULong  v = *p++;
+
+
+    if ( is_signed && ( v & 0x80 ) )
+      v |= ~0xFFUL;
+
+    while ( --size > 0 )
+      v = ( v << 8 ) | *p++;
+
+    return (FT_Long)v;
+  }
+
+
+  static int
+  vf_compare_chars( const void*  a,
+                    const void*  b )
+  {
+    VF_Char  ca = (VF_Char)a;
+    VF_Char  cb = (VF_Char)b;
+
+
+    if ( ca->code < cb->code )
+      return -1;
+    else if ( ca->code > cb->code )
+      return 1;
+    else
+      return 0;
+  }
+
+
+  static FT_Error
+  vf_add_command( FT_Memory  memory,
+                  VF_Face    face,
+                  FT_UInt*   max_commands,
+                  FT_Int     op,
+                  FT_Long    a,
+                  FT_Long    b )
+  {
+    FT_Error    error = FT_Err_Ok;
+    VF_Command  cmd;
+
+
+    if ( face->num_commands >= *max_commands )
+    {
+      FT_UInt  new_max = *max_commands ? *max_commands * 2 : 64;
+
+
+      if ( FT_RENEW_ARRAY( face->commands, *max_commands, new_max ) )
+        return error;
+      *max_commands = new_max;
+    }
+
+    cmd     = face->commands + face->num_commands++;
+    cmd->op = (FT_Byte)op;
+    cmd->a  = a;
+    cmd->b  = b;
+
+    return error;
+  }
+
+
+  /* translate the DVI commands of a character packet */
+  static FT_Error
+  vf_parse_packet( FT_Memory  memory,
+                   VF_Face    face,
+                   FT_UInt*   max_commands,
+                   FT_Byte*   p,
+                   FT_Byte*   limit )
+  {
+    FT_Error  error = FT_Err_Ok;
+    FT_Long   w = 0, x = 0, y = 0, z = 0;
+    FT_Long   stack[VF_MAX_STACK][4];
+    FT_Int    top = 0;
+    FT_Int    op, size, i;
+    FT_Long   a, b;
+
+
+    while ( p < limit )
+    {
+      op = *p++;
+
+      /* number of parameter bytes, if any */
+      if ( op >= VF_SET1 && op <= VF_SET4 )
+        size = op - VF_SET1 + 1;
+      else if ( op >= VF_PUT1 && op <= VF_PUT4 )
+        size = op - VF_PUT1 + 1;
+      else if ( op == VF_SET_RULE || op == VF_PUT_RULE )
+        size = 8;
+      else if ( op >= VF_RIGHT1 && op <= VF_RIGHT4 )
+        size = op - VF_RIGHT1 + 1;
+      else if ( op >= VF_W0 && op <= VF_W4 )
+        size = op - VF_W0;
+      else if ( op >= VF_X0 && op <= VF_X4 )
+        size = op - VF_X0;
+      else if ( op >= VF_DOWN1 && op <= VF_DOWN4 )
+        size = op - VF_DOWN1 + 1;
+      else if ( op >= VF_Y0 && op <= VF_Y4 )
+        size = op - VF_Y0;
+      else if ( op >= VF_Z0 && op <= VF_Z4 )
+        size = op - VF_Z0;
+      else if ( op >= VF_FNT1 && op <= VF_FNT4 )
+        size = op - VF_FNT1 + 1;
+      else if ( op >= VF_XXX1 && op <= VF_XXX4 )
+        size = op - VF_XXX1 + 1;
+      else
+        size = 0;
+
+      if ( limit - p < size )
+        goto Invalid;
+
+      if ( op <= VF_SET_CHAR_127 )
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_SET_CHAR, op, 0 );
+
+      else if ( op <= VF_SET4 )
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_SET_CHAR,
+                                vf_get_intn( p, size, op == VF_SET4 ), 0 );
+
+      else if ( op == VF_SET_RULE || op == VF_PUT_RULE )
+      {
+        a = vf_get_intn( p,     4, 1 );
+        b = vf_get_intn( p + 4, 4, 1 );
+
+        error = vf_add_command( memory, face, max_commands,
+                                op == VF_SET_RULE ? VF_OP_SET_RULE
+                                                  : VF_OP_PUT_RULE,
+                                a, b );
+      }
+
+      else if ( op <= VF_PUT4 )
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_PUT_CHAR,
+                                vf_get_intn( p, size, op == VF_PUT4 ), 0 );
+
+      else if ( op == VF_NOP )
+        ;
+
+      else if ( op == VF_PUSH )
+      {
+        if ( top >= VF_MAX_STACK )
+          goto Invalid;
+
+        stack[top][0] = w;
+        stack[top][1] = x;
+        stack[top][2] = y;
+        stack[top][3] = z;
+        top++;
+
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_PUSH, 0, 0 );
+      }
+
+      else if ( op == VF_POP )
+      {
+        if ( top == 0 )
+          goto Invalid;
+
+        top--;
+        w = stack[top][0];
+        x = stack[top][1];
+        y = stack[top][2];
+        z = stack[top][3];
+
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_POP, 0, 0 );
+      }
+
+      else if ( op >= VF_RIGHT1 && op <= VF_Z4 )
+      {
+        a = size ? vf_get_intn( p, size, 1 ) : 0;
+
+        if ( op <= VF_RIGHT4 )
+          ;
+        else if ( op <= VF_W4 )
+          a = size ? ( w = a ) : w;
+        else if ( op <= VF_X4 )
+          a = size ? ( x = a ) : x;
+        else if ( op <= VF_DOWN4 )
+          ;
+        else if ( op <= VF_Y4 )
+          a = size ? ( y = a ) : y;
+        else
+          a = size ? ( z = a ) : z;
+
+        error = vf_add_command( memory, face, max_commands,
+                                op < VF_DOWN1 ? VF_OP_RIGHT : VF_OP_DOWN,
+                                a, 0 );
+      }
+
+      else if ( op >= VF_FNT_NUM_0 && op <= VF_FNT4 )
+      {
+        a = op <= VF_FNT_NUM_63 ? op - VF_FNT_NUM_0
+                                : vf_get_intn( p, size, op == VF_FNT4 );
+
+        for ( i = 0; i < (FT_Int)face->num_fonts; i++ )
+          if ( face->fonts[i].number == a )
+            break;
+
+        if ( i == (FT_Int)face->num_fonts )
+        {
+          FT_ERROR(( "vf_parse_packet: undefined font %ld\n", a ));
+          goto Invalid;
+        }
+
+        error = vf_add_command( memory, face, max_commands,
+                                VF_OP_FONT, i, 0 );
+      }
+
+      else if ( op >= VF_XXX1 && op <= VF_XXX4 )
+      {
+        /* specials are ignored */
+        a = vf_get_intn( p, size, 0 );
+        if ( a < 0 || limit - p - size < a )
+          goto Invalid;
+
+        p += a;
+      }
+
+      else
+        goto Invalid;
+
+      if ( error )
+        return error;
+
+      p += size;
+    }
+
+    return FT_Err_Ok;
+
+  Invalid:
+    FT_ERROR(( "vf_parse_packet: invalid character packet\n" ));
+    return FT_THROW( Invalid_File_Format );
+  }
+
+
+  /**************************************************************************
+   *
+   * API.
+   *
+   */
+
+  FT_LOCAL_DEF( FT_Error )
+  vf_load_font( FT_Stream  stream,
+                FT_Memory  memory,
+                VF_Face    face )
+  {
+    FT_Error    error;
+    FT_Byte     op, k, a, l;
+    FT_ULong    check_sum;
+    FT_ULong    pl, cc;
+    FT_Long     tfm;
+    FT_UInt     max_fonts    = 0;
+    FT_UInt     max_chars    = 0;
+    FT_UInt     max_commands = 0;
+    VF_FontDef  fd;
+    VF_Char     ch;
+
+
+    if ( FT_STREAM_SEEK( 0 ) )
+      goto Exit;
+
+    if ( FT_READ_BYTE( op ) || op != VF_PRE ||
+         FT_READ_BYTE( op ) || op != VF_ID  )
+    {
+      error = FT_THROW( Unknown_File_Format );
+      goto Exit;
+    }
+
+    if ( FT_READ_BYTE( k )                   ||
+         FT_STREAM_SKIP( k )                 ||
+         FT_READ_ULONG( check_sum )          ||
+         FT_READ_LONG( face->design_size ) )
+      goto Exit;
+
+    FT_TRACE2(( "vf_load_font: checksum is %ld\n", check_sum ));
+
+    if ( face->design_size <= 0 )
+    {
+      FT_ERROR(( "vf_load_font: invalid design size\n" ));
+      error = FT_THROW( Invalid_File_Format );
+      goto Exit;
+    }
+
+    for (;;)
+    {
+      if ( FT_READ_BYTE( op ) )
+        goto Exit;
+
+      if ( op == VF_POST )
+        break;
+
+      if ( op >= VF_FNT_DEF1 && op <= VF_FNT_DEF4 )
+      {
+        if ( face->num_chars > 0 )
+        {
+          FT_ERROR(( "vf_load_font: font definition after characters\n" ));
+          error = FT_THROW( Invalid_File_Format );
+          goto Exit;
+        }
+
+        if ( face->num_fonts >= max_fonts )
+        {
+          FT_UInt  new_max = max_fonts ? max_fonts * 2 : 8;
+
+
+          if ( FT_RENEW_ARRAY( face->fonts, max_fonts, new_max ) )
+            goto Exit;
+          max_fonts = new_max;
+        }
+
+        /* count the entry right away so that its name gets */
+        /* freed even if reading it fails                    */
+        fd         = face->fonts + face->num_fonts++;
+        fd->number = vf_read_intn( stream, op - VF_FNT_DEF1 + 1,
+                                   op == VF_FNT_DEF4, &error );
+        if ( error )
+          goto Exit;
+
+        if ( FT_READ_ULONG( fd->checksum )    ||
+             FT_READ_LONG( fd->scaled_size )  ||
+             FT_READ_LONG( fd->design_size )  ||
+             FT_READ_BYTE( a )                ||
+             FT_READ_BYTE( l )                ||
+             FT_ALLOC( fd->name, a + l + 1 )  ||
+             FT_STREAM_READ( fd->name, a + l ) )
+          goto Exit;
+
+        FT_TRACE4(( "vf_load_font: font %ld is `%s'\n",
+                    fd->number, fd->name ));
+        continue;
+      }
+
+      if ( op > VF_LONG_CHAR )
+      {
+        FT_ERROR(( "vf_load_font: invalid command %d\n", op ));
+        error = FT_THROW( Invalid_File_Format );
+        goto Exit;
+      }
+
+      if ( op == VF_LONG_CHAR )
+      {
+        if ( FT_READ_ULONG( pl ) ||
+             FT_READ_ULONG( cc ) ||
+             FT_READ_LONG( tfm ) )
+          goto Exit;
+      }
+      else
+      {
+        pl = op;
+        if ( FT_READ_BYTE( op ) )
+          goto Exit;
+        cc = op;
+        if ( FT_READ_UOFF3( tfm ) )
+          goto Exit;
+      }
+
+      if ( face->num_fonts == 0 )
+      {
+        FT_ERROR(( "vf_load_font: no base fonts\n" ));
+        error = FT_THROW( Invalid_File_Format );
+        goto Exit;
+      }
+
+      if ( face->num_chars >= max_chars )
+      {
+        FT_UInt  new_max = max_chars ? max_chars * 2 : 128;
+
+
+        if ( FT_RENEW_ARRAY( face->chars, max_chars, new_max ) )
+          goto Exit;
+        max_chars = new_max;
+      }
+
+      ch            = face->chars + face->num_chars++;
+      ch->code      = cc;
+      ch->tfm_width = tfm;
+      ch->first     = face->num_commands;
+
+      if ( pl > stream->size - stream->pos )
+      {
+        error = FT_THROW( Invalid_File_Format );
+        goto Exit;
+      }
+
+      if ( pl > 0 )
+      {
+        if ( FT_FRAME_ENTER( pl ) )
+          goto Exit;
+
+        error = vf_parse_packet( memory, face, &max_commands,
+                                 stream->cursor, stream->limit );
+
+        FT_FRAME_EXIT();
+
+        if ( error )
+          goto Exit;
+      }
+
+      ch->count = face->num_commands - ch->first;
+    }
+
+    if ( face->num_chars == 0 )
+    {
+      FT_ERROR(( "vf_load_font: no characters\n" ));
+      error = FT_THROW( Invalid_File_Format );
+      goto Exit;
+    }
+
+    ft_qsort( face->chars, face->num_chars, sizeof ( VF_CharRec ),
+              vf_compare_chars );
+
+  Exit:
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  vf_free_font( VF_Face  face )
+  {
+    FT_Memory  memory = FT_FACE( face )->memory;
+    FT_UInt    i;
+
+
+    for ( i = 0; i < face->num_fonts; i++ )
+      FT_FREE( face->fonts[i].name );
+
+    FT_FREE( face->fonts );
+    FT_FREE( face->chars );
+    FT_FREE( face->commands );
+    FT_FREE( face->dirname );
+
+    face->num_fonts    = 0;
+    face->num_chars    = 0;
+    face->num_commands = 0;
+  }
+
+
+/* END */